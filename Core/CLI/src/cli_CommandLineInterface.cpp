@@ -31,6 +31,7 @@
 #include "XMLTrace.h"
 
 #include "agent.h"
+#include "memory_manager.h"
 #include "output_manager.h"
 #include "print.h"
 #include "production.h"
@@ -124,6 +125,9 @@ EXPORT bool CommandLineInterface::DoCommand(Connection* pConnection, sml::AgentS
 
     PushCall(CallData(pAgent, rawOutput));
 
+    // Anything the command builds for the agent should come from the agent's own memory pools
+    Memory_Manager::thread_scope lMemoryScope(pAgent ? pAgent->GetSoarAgent()->memoryManager : NULL);
+
     // Log input
     if (m_pLogFile)
     {
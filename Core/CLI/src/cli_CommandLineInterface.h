@@ -32,6 +32,7 @@
 #include <vector>
 
 typedef uint64_t epmem_time_id;
+typedef struct rete_ht_stats_struct rete_ht_stats;
 
 namespace soar_module
 {
@@ -203,6 +204,7 @@ namespace cli
             bool DoIndifferentSelection(const char pOp = 0, const std::string* p1 = 0, const std::string* p2 = 0, const std::string* p3 = 0);
             bool DoLoadLibrary(const std::string& libraryCommand);
             bool DoMatches(const eMatchesMode mode, const eWMEDetail detail = WME_DETAIL_NONE, const std::string* pProduction = 0);
+            bool DoMatchProfile(const char pOp = 0, int n = 0, const std::string* pProduction = 0);
             bool DoMemories(const MemoriesBitset options, int n = 0, const std::string* pProduction = 0);
             bool DoMultiAttributes(const std::string* pAttribute = 0, int n = 0);
             bool DoNumericIndifferentMode(bool query, bool usesAvgNIM);
@@ -227,6 +229,7 @@ namespace cli
             bool ParseFC(std::vector< std::string >& argv);
             bool ParseMemories(std::vector< std::string >& argv);
             bool ParseMatches(std::vector< std::string >& argv);
+            bool ParseMatchProfile(std::vector< std::string >& argv);
             bool ParseMultiAttributes(std::vector< std::string >& argv);
             bool ParsePBreak(std::vector< std::string >& argv);
             bool ParsePFind(std::vector< std::string >& argv);
@@ -282,6 +285,7 @@ namespace cli
             void GetMemoryStats(); // for stats
             void GetMaxStats(); // for stats
             void GetReteStats(); // for stats
+            void GetReteHashTableStats(const char* table_name, rete_ht_stats& stats); // for stats
             void GetAgentStats(); // for stats
 
             bool Evaluate(const char* pInput); // source, formerly StreamSource
@@ -299,7 +303,7 @@ namespace cli
             void GetMemoryPoolStatistics();
 
             void PrintSourceSummary(int sourced, const std::list< std::string >& excised, int ignored);
-            bool Source(const char* input, bool printFileStack = false);
+            bool Source(const char* input, bool printFileStack = false, bool bulkLoad = false);
 
             std::ostringstream      m_Result;                     // Raw output from the command
             bool                    m_RawOutput;                  // True if we want string output.
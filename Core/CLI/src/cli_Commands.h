@@ -1293,6 +1293,7 @@ namespace cli
                     {'g', "get",        OPTARG_NONE},
                     {'h', "history",    OPTARG_NONE},//Testing/unstable - 23-7-2014
                     {'i', "init",       OPTARG_NONE},
+                    {'I', "import",     OPTARG_NONE},
                     {'P', "precalculate", OPTARG_NONE},
                     {'q', "query",      OPTARG_NONE},//Testing/unstable - 23-7-2014
                     {'r', "remove",     OPTARG_NONE},//Testing/unstable - 23-7-2014
@@ -1351,6 +1352,15 @@ namespace cli
 
                         return cli.DoSMem(option, &(argv[2]));
 
+                    case 'I':
+                        // case: import requires one non-option argument
+                        if (!opt.CheckNumNonOptArgs(1, 1))
+                        {
+                            return cli.SetError(opt.GetError().c_str());
+                        }
+
+                        return cli.DoSMem(option, &(argv[2]));
+
                     case 'g':
                     {
                         // case: get requires one non-option argument
@@ -58,6 +58,17 @@ namespace cli
                 return command->Parse(argv);
             }
             
+            /* The command argv would run, after alias expansion, or 0 */
+            ParserCommand* FindCommand(std::vector<std::string> argv)
+            {
+                if (argv.empty())
+                {
+                    return 0;
+                }
+                aliases.Expand(argv);
+                return argv.empty() ? 0 : PartialMatch(argv);
+            }
+            
             ParserCommand* PartialMatch(const std::vector<std::string>& argv)
             {
                 // TODO: use the ordered map to find the command
@@ -116,6 +116,7 @@ bool CommandLineInterface::DoDebug(std::vector< std::string >* argv)
             std::string table_name = argv->at(2);
             if (database_name[0] == 'e')
             {
+                epmem_wait_for_storage(thisAgent);
                 thisAgent->EpMem->epmem_db->print_table(table_name.c_str());
             }
             else if (database_name[0] == 's')
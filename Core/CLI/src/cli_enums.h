@@ -165,6 +165,7 @@ namespace cli
         SOURCE_ALL,
         SOURCE_DISABLE,
         SOURCE_VERBOSE,
+        SOURCE_BULK,
         SOURCE_NUM_OPTIONS,    // must be last
     };
     typedef std::bitset<SOURCE_NUM_OPTIONS> SourceBitset;
@@ -41,6 +41,9 @@ bool CommandLineInterface::DoEpMem(const char pOp, const std::string* pAttr, con
         PrintCLIMessage_Item("append:", thisAgent->EpMem->epmem_params->append_db, 40);
         PrintCLIMessage_Item("path:", thisAgent->EpMem->epmem_params->path, 40);
         PrintCLIMessage_Item("lazy-commit:", thisAgent->EpMem->epmem_params->lazy_commit, 40);
+        PrintCLIMessage_Item("storage-thread:", thisAgent->EpMem->epmem_params->storage_thread, 40);
+        PrintCLIMessage_Item("retention:", thisAgent->EpMem->epmem_params->retention, 40);
+        PrintCLIMessage_Item("retention-batch:", thisAgent->EpMem->epmem_params->retention_batch, 40);
         PrintCLIMessage_Section("Retrieval", 40);
         PrintCLIMessage_Item("balance:", thisAgent->EpMem->epmem_params->balance, 40);
         PrintCLIMessage_Item("graph-match:", thisAgent->EpMem->epmem_params->graph_match, 40);
@@ -49,6 +52,10 @@ bool CommandLineInterface::DoEpMem(const char pOp, const std::string* pAttr, con
         PrintCLIMessage_Item("page-size:", thisAgent->EpMem->epmem_params->page_size, 40);
         PrintCLIMessage_Item("cache-size:", thisAgent->EpMem->epmem_params->cache_size, 40);
         PrintCLIMessage_Item("optimization:", thisAgent->EpMem->epmem_params->opt, 40);
+        PrintCLIMessage_Item("commit-interval:", thisAgent->EpMem->epmem_params->commit_interval, 40);
+        PrintCLIMessage_Item("commit-interval-ms:", thisAgent->EpMem->epmem_params->commit_interval_ms, 40);
+        PrintCLIMessage_Item("checkpoint-thread:", thisAgent->EpMem->epmem_params->checkpoint_thread, 40);
+        PrintCLIMessage_Item("interval-index:", thisAgent->EpMem->epmem_params->interval_index, 40);
         PrintCLIMessage_Item("timers:", thisAgent->EpMem->epmem_params->timers, 40);
         PrintCLIMessage_Section("Experimental", 40);
         PrintCLIMessage_Item("merge:", thisAgent->EpMem->epmem_params->merge, 40);
@@ -212,6 +219,8 @@ bool CommandLineInterface::DoEpMem(const char pOp, const std::string* pAttr, con
             PrintCLIMessage_Item("SQLite Version:", thisAgent->EpMem->epmem_stats->db_lib_version, 40);
             PrintCLIMessage_Item("Memory Usage:", thisAgent->EpMem->epmem_stats->mem_usage, 40);
             PrintCLIMessage_Item("Memory Highwater:", thisAgent->EpMem->epmem_stats->mem_high, 40);
+            PrintCLIMessage_Item("Group Commits:", thisAgent->EpMem->epmem_stats->commits, 40);
+            PrintCLIMessage_Item("WAL Checkpoints:", thisAgent->EpMem->epmem_stats->checkpoints, 40);
             PrintCLIMessage_Item("Retrievals:", thisAgent->EpMem->epmem_stats->ncbr, 40);
             PrintCLIMessage_Item("Queries:", thisAgent->EpMem->epmem_stats->cbr, 40);
             PrintCLIMessage_Item("Nexts:", thisAgent->EpMem->epmem_stats->nexts, 40);
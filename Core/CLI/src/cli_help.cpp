@@ -497,7 +497,8 @@ void initdocstrings()
 		"intensive agent. To mitigate this, blocks can be allocated before a run by\n"
 		"using this command.\n"
 		"Issuing the command with no parameters lists current pool usage, exactly like\n"
-		"stats command's memory flag.\n"
+		"stats command's memory flag. Each agent has its own memory pools, so the pools\n"
+		"listed and allocated are those of the current agent.\n"
 		"Issuing the command with part of a pool's name and a positive integer will\n"
 		"allocate that many additional blocks for the specified pool. Only the first few\n"
 		"letters of the pool's name are necessary. If more than one pool starts with the\n"
@@ -803,16 +804,31 @@ void initdocstrings()
 		"Parameter            Description              Possible values      Default\n"
 		"cache-size           Number of memory pages   1, 2, ...            10000\n"
 		"                     used in the SQLite cache\n"
+		"checkpoint-thread    Checkpoint the log on a  on, off              off\n"
+		"                     separate thread (wal)\n"
+		"commit-interval      Decisions between group  0, 1, ...            100\n"
+		"                     commits (wal)\n"
+		"commit-interval-ms   Milliseconds between     0, 1, ...            1000\n"
+		"                     group commits (wal)\n"
 		"graph-match          Graph matching enabled   on, off              on\n"
 		"graph-match-ordering Ordering of identifiers  undefined, dfs, mcv  undefined\n"
 		"                     during graph match\n"
+		"interval-index       Answer cue queries from  on, off              off\n"
+		"                     an in-memory index\n"
 		"                     Delay writing semantic\n"
 		"lazy-commit          store changes to file    on, off              on\n"
 		"                     until agent exits\n"
-		"optimization         Policy for committing    safety, performance  performance\n"
-		"                     data to disk\n"
+		"optimization         Policy for committing    safety, performance, performance\n"
+		"                     data to disk             wal\n"
 		"page-size            Size of each memory page 1k, 2k, 4k, 8k, 16k, 8k\n"
 		"                     used in the SQLite cache 32k, 64k\n"
+		"retention            Most recent episodes to  0, 1, ...            0\n"
+		"                     keep (0 keeps all)\n"
+		"retention-batch      Rows expired per         1, 2, ...            500\n"
+		"                     decision cycle\n"
+		"storage-thread       Write new episodes to    on, off              off\n"
+		"                     the database on a\n"
+		"                     separate thread\n"
 		"timers               Timer granularity        off, one, two, three off\n"
 		"\n"
 		"The learning parameter turns the episodic memory module on or off. When\n"
@@ -863,6 +879,42 @@ void initdocstrings()
 		"another SQLite process such as SQLiteMan. The lock can be relinquished by\n"
 		"setting the database to memory or another database and issuing init-soar/epmem\n"
 		"--init or by shutting down the Soar kernel.\n"
+		"When optimization is set to wal, the database uses a write-ahead log and, with\n"
+		"lazy-commit on, the agent's transaction is committed every commit-interval\n"
+		"decisions or commit-interval-ms milliseconds, whichever comes first (0 turns\n"
+		"either trigger off). A crash loses at most the changes since the last group\n"
+		"commit and never corrupts the database, while storage runs at close to\n"
+		"lazy-commit speed. With checkpoint-thread on, a file-based database is\n"
+		"checkpointed by a separate connection after each group commit, instead of by\n"
+		"the agent once the log grows large. The database is not locked exclusively in\n"
+		"this mode.\n"
+		"When storage-thread is on, episodic memory still walks working memory during\n"
+		"the storage phase, but the database writes that record the new episode are\n"
+		"handed to a separate writer thread, so they no longer add to decision cycle\n"
+		"time. A retrieve, next or previous command waits only until the episodes it\n"
+		"needs have been written; a query waits for all of them. Like lazy-commit, this\n"
+		"parameter can only be changed while the database is closed.\n"
+		"When interval-index is on, episodic memory keeps a copy of the episode\n"
+		"intervals of every working memory element it has recorded in an in-memory\n"
+		"index, and cue-based queries search it instead of the database tables. The\n"
+		"index is built from the database when it is opened. For a file-based\n"
+		"database it is also saved next to the database file, as <path>-index, when\n"
+		"the database is closed, and read back the next time the database is opened if\n"
+		"the database still holds the stamp written with it. Opening the database for\n"
+		"writing clears that stamp, so an index is never reused after the database has\n"
+		"been changed without it. This parameter can only be changed while the database\n"
+		"is closed.\n"
+		"When retention is greater than 0, only that many of the most recent episodes\n"
+		"are kept. Older episodes are removed a few at a time, at most retention-batch\n"
+		"database rows per decision cycle, so that no single cycle stalls: their\n"
+		"episode, point and range rows are deleted, and intervals that began before the\n"
+		"oldest kept episode are shortened to begin at it. Queries and retrievals never\n"
+		"return a removed episode. The oldest kept episode is saved in the database\n"
+		"(the retention-floor statistic), so a reopened database still hides removed\n"
+		"episodes and finishes any removal that was under way. A database created with\n"
+		"retention on also hands the space it frees back to the file system as it goes.\n"
+		"Retention can only be changed while the database is closed; retention-batch\n"
+		"can be changed at any time.\n"
 		"The balance parameter sets the linear weight of match cardinality vs. cue\n"
 		"activation. As a performance optimization, when the value is 1 (default),\n"
 		"activation is not computed. If this value is not 1 (even close, such as 0.99),\n"
@@ -899,6 +951,12 @@ void initdocstrings()
 		"mem-usage      Memory Usage           Current SQLite memory usage in bytes\n"
 		"mem-high       Memory Highwater       High SQLite memory usage watermark in\n"
 		"                                      bytes\n"
+		"commits        Group Commits          Number of transactions committed by\n"
+		"                                      commit-interval since the database was\n"
+		"                                      opened\n"
+		"checkpoints    WAL Checkpoints        Number of checkpoints made by the\n"
+		"                                      checkpoint thread since the database was\n"
+		"                                      opened\n"
 		"queries        Queries                Number of times the query command has\n"
 		"                                      been processed\n"
 		"nexts          Nexts                  Number of times the next command has been\n"
@@ -1528,7 +1586,7 @@ void initdocstrings()
 		"  load                            [? | help]\n"
 		"  ------------------------------------------------------------\n"
 		"  load file                       [--all --disable] <filename>\n"
-		"  load file                       [--verbose]     ]\n"
+		"  load file                       [--verbose --bulk]\n"
 		"  ------------------------------------------------------------\n"
 		"  load library                    <filename> <args...>\n"
 		"  ------------------------------------------------------------\n"
@@ -1553,6 +1611,18 @@ void initdocstrings()
 		"-a, --all     Enable a summary for each file sourced\n"
 		"-d, --disable Disable all summaries\n"
 		"-v, --verbose Print excised production names\n"
+		"-b, --bulk    Match each run of sp commands against working memory together\n"
+		"\n"
+		"Bulk Loading\n"
+		"\n"
+		"Normally each rule is matched against working memory as soon as it is added.\n"
+		"With --bulk, the rules of each run of consecutive sp commands are first merged\n"
+		"into the rete, and then working memory is pushed through every new part of the\n"
+		"network once for the whole run. This makes loading large rule bases into an\n"
+		"agent with a big working memory much faster. Any other command, including\n"
+		"run, ends the current run of rules first, so the rules end up with the same\n"
+		"matches as if the file had been loaded normally. Files loaded from within the\n"
+		"file are bulk loaded too.\n"
 		"\n"
 		"Summaries\n"
 		"\n"
@@ -1627,6 +1697,10 @@ void initdocstrings()
 		"productions. This command provides a fast method of saving and loading\n"
 		"productions since a special format is used and no parsing is necessary. Rete-\n"
 		"net files are portable across platforms that support Soar.\n"
+		"Rete-net files carry a format version and a checksum, which are checked before\n"
+		"the agent's current productions are excised, so a damaged file is rejected and\n"
+		"leaves the agent as it was. Files saved by older versions of Soar, which have\n"
+		"no checksum, can still be loaded.\n"
 		"If the filename contains a suffix of .Z, then the file is compressed\n"
 		"automatically when it is saved and uncompressed when it is loaded. Compressed\n"
 		"files may not be portable to another platform if that platform does not support\n"
@@ -2217,6 +2291,10 @@ void initdocstrings()
 		"  production matches            [--names --count  ] [--assertions ]\n"
 		"                                [--timetags --wmes] [--retractions]\n"
 		"  ------------------------------------------------------------------\n"
+		"  production match-profile      [--enable --disable --reset]\n"
+		"  production match-profile      [n]\n"
+		"  production match-profile      <prod-name>\n"
+		"  ------------------------------------------------------------------\n"
 		"  production memory-usage       [options] [max]\n"
 		"  production memory-usage       <production_name>\n"
 		"  ------------------------------------------------------------------\n"
@@ -2502,6 +2580,48 @@ void initdocstrings()
 		"\n"
 		"  production matches -t my*first*production\n"
 		"\n"
+		"production match-profile\n"
+		"\n"
+		"Profile how much match work each production causes in the rete.\n"
+		"\n"
+		"Synopsis\n"
+		"\n"
+		"  production match-profile [--enable --disable --reset]\n"
+		"  production match-profile [n]\n"
+		"  production match-profile production_name\n"
+		"\n"
+		"Options:\n"
+		"\n"
+		"Option               Description\n"
+		"-e, --enable, --on   Start gathering match statistics\n"
+		"-d, --disable, --off Stop gathering match statistics (the default)\n"
+		"-r, --reset          Zero all gathered statistics\n"
+		"n                    List only the n most expensive productions\n"
+		"production_name      List the statistics for each node the production uses\n"
+		"\n"
+		"Description\n"
+		"\n"
+		"While the profiler is enabled, every beta node in the rete records its left and\n"
+		"right activations, how many of those were null activations (the opposite memory\n"
+		"was empty), the tokens it created and the time spent in the node itself,\n"
+		"excluding its children. Only additions are counted, not removals. The\n"
+		"profiler costs nothing measurable while disabled, and statistics gathered so\n"
+		"far are kept when it is disabled so they can be examined after a run.\n"
+		"\n"
+		"With no arguments, or with a number n, productions are listed from most to\n"
+		"least expensive by time, with each row summing the statistics of every node\n"
+		"from the production's p-node up to the top of the network. Nodes shared by\n"
+		"several productions are counted in full for each of them. With a production\n"
+		"name, the nodes that production uses are listed one per line, starting at its\n"
+		"p-node.\n"
+		"\n"
+		"Examples:\n"
+		"\n"
+		"  production match-profile --enable\n"
+		"  run 1000\n"
+		"  production match-profile 10\n"
+		"  production match-profile my*expensive*production\n"
+		"\n"
 		"production memory-usage\n"
 		"\n"
 		"Print memory usage for partial matches.\n"
@@ -3052,6 +3172,7 @@ void initdocstrings()
 		"  smem --backup                                <filename>   Save copy of database\n"
 		"  smem --clear                                              Delete contents of smem\n"
 		"  smem --export                        <filename> [<LTI>]   Save database to file\n"
+		"  smem --import                                <filename>   Bulk load --add or .csv file\n"
 		"  smem --init                                               Reinit smem store\n"
 		"  smem --query                           {(cue)* [<num>]}   Query smem via given cue\n"
 		"  smem --remove                 { (id [^attr [value]])* }   Remove smem structures\n"
@@ -3063,7 +3184,7 @@ void initdocstrings()
 		"  -        Semantic Memory Parameters  (use --set)      -\n"
 		"  =======================================================\n"
 		"  enabled                                             off\n"
-		"  database                              [ MEMORY | file ]   Store database in memory or file\n"
+		"  database                     [ MEMORY | file | shared ]   Store database in memory or file\n"
 		"  append                                               on   Append or overwrite after init\n"
 		"  path                                                      Path to database on disk\n"
 		"  ---------------------- Activation ---------------------\n"
@@ -3072,6 +3193,7 @@ void initdocstrings()
 		"  base-decay                                          0.5   Decay amount for base-level activation\n"
 		"  base-update-policy     [ STABLE | naive | incremental ]\n"
 		"  base-incremental-threshes                            10   Integer > 0\n"
+		"  base-batch                                 [ ON | off ]\n"
 		"  thresh                                              100   Integer >= 0\n"
 		"  base-inhibition                            [ on | OFF ]\n"
 		"  ---------- Experimental Spreading Activation ----------\n"
@@ -3084,10 +3206,15 @@ void initdocstrings()
 		"  spreading-edge-updating                    [ on | OFF ]\n"
 		"  spreading-wma-source                       [ on | OFF ]\n"
 		"  spreading-edge-update-factor                       0.99   1 > decimal > 0\n"
+		"  spreading-graph                            [ ON | off ]   Traverse an in-memory copy of the LTI graph\n"
 		"  ------------- Database Optimization Settings ----------\n"
 		"  lazy-commit                                          on   Delay writing store until exit\n"
-		"  optimization                   [ safety | PERFORMANCE ]\n"
+		"  optimization             [ safety | PERFORMANCE | wal ]\n"
+		"  commit-interval                                     100   Decisions between group commits (wal)\n"
+		"  commit-interval-ms                                 1000   Milliseconds between group commits (wal)\n"
+		"  checkpoint-thread                          [ on | OFF ]   Checkpoint the log on a separate thread\n"
 		"  cache-size                                        10000   Number of memory pages for SQLite cache\n"
+		"  lti-cache-size                                     1000   Number of LTIs cached in memory (0 = off)\n"
 		"  page-size                                            8k   Size of each memory page\n"
 		"  ----------------- Timers and Statistics ---------------\n"
 		"  timers                      [ OFF | one | two | three ]   How detailed timers should be\n"
@@ -3097,8 +3224,9 @@ void initdocstrings()
 		"  Timers: smem_api, smem_hash, smem_init, smem_query,\n"
 		"          smem_ncb_retrieval, three_activation\n"
 		"          smem_storage, _total\n"
-		"  Stats:  act_updates, db-lib-version, edges, mem-usage,\n"
-		"          mem-high, nodes, queries, retrieves, stores\n"
+		"  Stats:  act_updates, checkpoints, commits, db-lib-version, edges,\n"
+		"          lti-cache-hits, lti-cache-misses, mem-usage, mem-high,\n"
+		"          nodes, overlay-size, queries, retrieves, stores\n"
 		"  -------------------------------------------------------\n"
 		"  For a detailed explanation of these settings:             help smem\n"
 		"\n"
@@ -3135,6 +3263,7 @@ void initdocstrings()
 		"-q, --query          Print concepts in semantic store matching some cue\n"
 		"-h, --history        Print activation history for some LTI\n"
 		"-b, --backup         Creates a backup of the semantic database on disk\n"
+		"-I, --import         Bulk load concepts into semantic memory from a file\n"
 		"\n"
 		"Printing\n"
 		"\n"
@@ -3147,6 +3276,19 @@ void initdocstrings()
 		"The command trace --smem displays additional trace information for semantic\n"
 		"memory not controlled by this command.\n"
 		"\n"
+		"Importing\n"
+		"\n"
+		"smem --import loads a large knowledge base faster than sourcing smem --add\n"
+		"commands. The file either holds smem --add clauses (such as the output of\n"
+		"smem --export) or, if its name ends in .csv, one augmentation per line:\n"
+		"  lti,attribute,value[,edge weight]\n"
+		"where LTIs are written @N or N and a value of the form @N is an LTI. Other\n"
+		"values are integers or floats if they parse as such and strings otherwise.\n"
+		"The import drops the database's secondary indices, inserts augmentations in\n"
+		"large transactions and rebuilds the indices and augmentation counts once at\n"
+		"the end. Imported memories are not activated, as with smem --add. Import is\n"
+		"not available while spreading is on.\n"
+		"\n"
 		"Parameters\n"
 		"\n"
 		"Due to the large number of parameters, the smem command uses the --get|--set\n"
@@ -3157,7 +3299,8 @@ void initdocstrings()
 		"Parameter Description                                 Possible values  Default\n"
 		"append    Controls whether database is overwritten or on, off          off\n"
 		"          appended when opening or re-initializing\n"
-		"database  Database storage method                     file, memory     memory\n"
+		"database  Database storage method                     file, memory,    memory\n"
+		"                                                      shared\n"
 		"learning  Semantic memory enabled                     on, off          off\n"
 		"path      Location of database file                   empty, some path empty\n"
 		"\n"
@@ -3177,6 +3320,15 @@ void initdocstrings()
 		"switch databases or database storage types while running, set your new\n"
 		"parameters and then perform an smem --init command.\n"
 		"\n"
+		"With database set to shared, the file at path is a knowledge base shared by\n"
+		"every agent in the process that opens it this way. It is mapped into memory\n"
+		"once and never written. Each agent keeps its own changes to it (stores,\n"
+		"activation and history) in memory, in an overlay of the pages it has written,\n"
+		"and its queries see the knowledge base and its own changes together. The\n"
+		"overlay is discarded when the database is closed; smem --backup saves the\n"
+		"combined database. The knowledge base must already exist (for example, built\n"
+		"by an agent with database set to file) and must not change while shared.\n"
+		"\n"
 		"Activation Parameters:\n"
 		"\n"
 		"Parameter          Description               Possible values           Default\n"
@@ -3196,6 +3348,9 @@ void initdocstrings()
 		"base-incremental-  which base-level          1, 2, 3, ...              10\n"
 		"threshes           activation is re-computed\n"
 		"                   for old memories\n"
+		"                   Recomputes the base-level\n"
+		"base-batch         activations of many       on, off                   on\n"
+		"                   memories together\n"
 		"thresh             Threshold for activation  0, 1, ...                 100\n"
 		"                   locality\n"
 		"                   Sets whether or not base-\n"
@@ -3215,17 +3370,28 @@ void initdocstrings()
 		"or those agents that require high-fidelity retrievals. The incremental policy\n"
 		"updates a constant number of memories, those with last-access ages defined by\n"
 		"the base-incremental-threshes set. The base-inhibition parameter switches an\n"
-		"additional prohibition factor on or off.\n"
+		"additional prohibition factor on or off. With base-batch on (the default),\n"
+		"the memories a naive or incremental update touches are recomputed together,\n"
+		"and a value already computed for the same time and access history is reused;\n"
+		"turning it off recomputes them one at a time, which gives the same values.\n"
 		"\n"
 		"Performance Parameters:\n"
 		"\n"
 		"Parameter    Description                  Possible values           Default\n"
 		"cache-size   Number of memory pages used  1, 2, ...                 10000\n"
 		"             in the SQLite cache\n"
+		"checkpoint-  Checkpoint the log on a      on, off                   off\n"
+		"thread       separate thread (wal)\n"
+		"commit-      Decisions between group      0, 1, ...                 100\n"
+		"interval     commits (wal)\n"
+		"commit-      Milliseconds between group   0, 1, ...                 1000\n"
+		"interval-ms  commits (wal)\n"
 		"             Delay writing semantic store\n"
 		"lazy-commit  changes to file until agent  on, off                   on\n"
 		"             exits\n"
-		"optimization Policy for committing data   safety, performance       performance\n"
+		"lti-cache-   Number of LTIs whose rows    0, 1, ...                 1000\n"
+		"size         are cached in memory\n"
+		"optimization Policy for committing data   safety, performance, wal  performance\n"
 		"             to disk\n"
 		"page-size    Size of each memory page     1k, 2k, 4k, 8k, 16k, 32k, 8k\n"
 		"             used in the SQLite cache     64k\n"
@@ -3239,6 +3405,19 @@ void initdocstrings()
 		"another SQLite process such as SQLiteMan. The lock can be relinquished by\n"
 		"setting the database to memory or another database and issuing init-soar/smem -\n"
 		"-init or by shutting down the Soar kernel.\n"
+		"When optimization is set to wal, the database uses a write-ahead log and, with\n"
+		"lazy-commit on, changes are committed in groups every commit-interval decisions\n"
+		"or commit-interval-ms milliseconds, whichever comes first (0 turns either\n"
+		"trigger off). A crash loses at most the changes since the last group commit.\n"
+		"With checkpoint-thread on, a file-based database is checkpointed by a separate\n"
+		"connection after each group commit.\n"
+		"The lti-cache-size parameter sets how many LTIs keep their access records,\n"
+		"activation histories, augmentation counts and augmentations in memory, so that\n"
+		"repeated retrievals and activation updates of the same memories do not go back\n"
+		"to the database. Changes to access records and histories are written back when\n"
+		"an LTI leaves the cache and at each commit: every decision without lazy-commit,\n"
+		"at each group commit with wal, and when the database is backed up or closed.\n"
+		"Setting it to 0 turns the cache off.\n"
 		"\n"
 		"Statistics\n"
 		"\n"
@@ -3251,11 +3430,22 @@ void initdocstrings()
 		"Name           Label              Description\n"
 		"act_updates    Activation Updates Number of times memory activation has been\n"
 		"                                  calculated\n"
+		"checkpoints    WAL Checkpoints    Number of checkpoints made by the\n"
+		"                                  checkpoint thread since the database was\n"
+		"                                  opened\n"
+		"commits        Group Commits      Number of transactions committed by\n"
+		"                                  commit-interval since the database was\n"
+		"                                  opened\n"
 		"db-lib-version SQLite Version     SQLite library version\n"
 		"edges          Edges              Number of edges in the semantic store\n"
+		"lti-cache-hits LTI Cache Hits     Number of LTI rows read from the cache\n"
+		"lti-cache-     LTI Cache Misses   Number of LTI rows read from the database\n"
+		"misses                            into the cache\n"
 		"mem-usage      Memory Usage       Current SQLite memory usage in bytes\n"
 		"mem-high       Memory Highwater   High SQLite memory usage watermark in bytes\n"
 		"nodes          Nodes              Number of nodes in the semantic store\n"
+		"overlay-size   Shared Overlay     Bytes of a shared database this agent\n"
+		"                                  holds its own copy of\n"
 		"queries        Queries            Number of times the query command has been\n"
 		"                                  issued\n"
 		"retrieves      Retrieves          Number of times the retrieve command has been\n"
@@ -3405,6 +3595,8 @@ void initdocstrings()
 		"probability              spread with distance)\n"
 		"spreading-loop-avoidance Controls whether spread      on, off         off\n"
 		"                         traversal avoids self-loops\n"
+		"spreading-graph          Traverse an in-memory copy   on, off         on\n"
+		"                         of the LTI graph\n"
 		"\n"
 		"Spreading activation has been added as an additional mechanism for ranking LTIs\n"
 		"in response to a query. Spreading activation is only compatible with base-level\n"
@@ -3426,6 +3618,11 @@ void initdocstrings()
 		"is the loss of spread magnitude with depth.) spreading-loop-avoidance is a\n"
 		"boolean parameter which controls whether or not any given spread traversal can\n"
 		"loop back onto itself.\n"
+		"spreading-graph controls how trajectories are computed. When on, the edges\n"
+		"between LTIs are read once into an in-memory sparse graph, which is kept in\n"
+		"sync as memories are stored, and traversal walks that graph instead of querying\n"
+		"the database for the children of every LTI it visits. The resulting spread is\n"
+		"the same either way.\n"
 		"Note that the default settings here are not necessarily appropriate for your\n"
 		"application. For many applications, simply changing the structure of the\n"
 		"network can yield wildly different query results even with the same spreading\n"
@@ -3453,6 +3650,7 @@ void initdocstrings()
 		"  max-dc-time                                       0    Interrupt after this much time\n"
 		"  max-memory-usage                          100000000    Threshold for memory warning\n"
 		"  max-gp                                        20000    Max rules gp can generate\n"
+		"  run-threads                                       1    Threads used to run agents in parallel\n"
 		"  stop-phase   [input|proposal|decision|APPLY|output]    Phase before which Soar will stop\n"
 		"  tcl                                    [ on | OFF ]    Allow Tcl code in commands\n"
 		"  timers                                 [ ON | off ]    Profile Soar\n"
@@ -3491,6 +3689,8 @@ void initdocstrings()
 		"firing counts for all productions are reset to zero. The soar init command\n"
 		"allows a Soar program that has been halted to be reset and start its execution\n"
 		"from the beginning.\n"
+		"Memory pool blocks that are left completely unused once working memory has been\n"
+		"cleared are returned to the operating system.\n"
 		"soar init does not remove any productions from production memory; to do this,\n"
 		"use the production_excise command. Note, however, that all justifications will\n"
 		"be removed because they will no longer be supported.\n"
@@ -3528,6 +3728,7 @@ void initdocstrings()
 		"max-gp                > 0          20000\n"
 		"max-memory-usage      > 0          100000000\n"
 		"max-nil-output-cycles > 0          15\n"
+		"run-threads           >= 1         1\n"
 		"stop-phase                         apply\n"
 		"tcl                   on or off    off\n"
 		"timers                on or off    on\n"
@@ -3610,6 +3811,19 @@ void initdocstrings()
 		"generate no output allowed when a run --out command is issued. After this limit\n"
 		"has been reached, Soar stops. The default initial setting of n is 15.\n"
 		"\n"
+		"soar run-threads\n"
+		"\n"
+		"run-threads sets the number of threads the kernel uses to run agents. It is a\n"
+		"kernel setting shared by all agents, so setting it from any agent changes it\n"
+		"for every agent. With the default of 1, agents are stepped one at a time.\n"
+		"With a larger value, agents that are interleaved by decision or by output are\n"
+		"stepped in parallel, one agent per thread, and the scheduler waits for all of\n"
+		"them to finish each step before going on. Runs interleaved by phase or\n"
+		"elaboration are always stepped one agent at a time. Callbacks to clients are\n"
+		"never made from more than one thread at once. Each agent always draws random\n"
+		"numbers from its own generator, which srand seeds, so the number of threads\n"
+		"does not change an agent's results.\n"
+		"\n"
 		"soar stop-phase\n"
 		"\n"
 		"stop-phase allows the user to control which phase Soar stops in. When running\n"
@@ -3880,7 +4094,10 @@ void initdocstrings()
 		"stats provides. For statistics about a specific rule learned, see the explain\n"
 		"command.\n"
 		"The stats argument --rete provides information about node usage in the Rete\n"
-		"net, the large data structure used for efficient matching in Soar.\n"
+		"net, the large data structure used for efficient matching in Soar. It also\n"
+		"lists the size of the left (token) and right (WME) memory hash tables, which\n"
+		"grow and shrink with working memory, along with how many of their buckets are\n"
+		"in use and the average and longest bucket chains.\n"
 		"The --max argument reports per-cycle maximum statistics for decision cycle\n"
 		"time, working memory changes, and production fires. For example, if Soar runs\n"
 		"for three cycles and there were 23 working memory changes in the first cycle,\n"
@@ -293,6 +293,7 @@ bool CommandLineInterface::ParseSource(std::vector< std::string >& argv)
         {'a', "all",            OPTARG_NONE},
         {'d', "disable",        OPTARG_NONE},
         {'v', "verbose",        OPTARG_NONE},
+        {'b', "bulk",           OPTARG_NONE},
         {0, 0, OPTARG_NONE}
     };
 
@@ -321,12 +322,15 @@ bool CommandLineInterface::ParseSource(std::vector< std::string >& argv)
             case 'v':
                 options.set(cli::SOURCE_VERBOSE);
                 break;
+            case 'b':
+                options.set(cli::SOURCE_BULK);
+                break;
         }
     }
 
     if (opt.GetNonOptionArguments() < 2)
     {
-        return SetError("Syntax: load file [--all | --disable | --verbose] <filename>");
+        return SetError("Syntax: load file [--all | --disable | --verbose | --bulk] <filename>");
     }
     else if (opt.GetNonOptionArguments() > 3)
     {
@@ -619,14 +623,18 @@ bool CommandLineInterface::DoReteNet(bool save, std::string filename)
             return SetError("Open file failed.");
         }
 
-        if (! save_rete_net(thisAgent, file, true))
+        bool saved = save_rete_net(thisAgent, file, true);
+        if (fclose(file) != 0)
+        {
+            saved = false;
+        }
+
+        if (!saved)
         {
             // TODO: additional error information
             return SetError("Rete save operation failed.");
         }
 
-        fclose(file);
-
     }
     else
     {
@@ -637,13 +645,14 @@ bool CommandLineInterface::DoReteNet(bool save, std::string filename)
             return SetError("Open file failed.");
         }
 
-        if (! load_rete_net(thisAgent, file))
+        bool loaded = load_rete_net(thisAgent, file);
+        fclose(file);
+
+        if (!loaded)
         {
             // TODO: additional error information
             return SetError("Rete load operation failed.");
         }
-
-        fclose(file);
     }
 
     return true;
@@ -843,7 +852,7 @@ bool CommandLineInterface::DoSource(std::string path, SourceBitset* pOptions)
             AppendArgTagFast(sml_Names::kParamChunkNamePrefix, sml_Names::kTypeString, outString);
         }
     }
-    bool ret = Source(buffer, true);
+    bool ret = Source(buffer, true, m_pSourceOptions && m_pSourceOptions->test(SOURCE_BULK));
 
     if (m_pSourceOptions && m_pSourceOptions->test(SOURCE_ALL))
     {
@@ -888,11 +897,73 @@ bool CommandLineInterface::DoSource(std::string path, SourceBitset* pOptions)
     return ret;
 }
 
-bool CommandLineInterface::Source(const char* buffer, bool printFileStack)
+namespace
+{
+    /* Passes commands on to the parser, putting each run of consecutive sp
+     * commands into one rete bulk load, see begin_rete_bulk_load() */
+    class BulkLoadHandler : public soar::tokenizer_callback
+    {
+        public:
+            BulkLoadHandler(cli::Parser& parser, agent* thisAgent)
+                : m_Parser(parser), m_Agent(thisAgent), m_InBatch(false) {}
+
+            virtual ~BulkLoadHandler()
+            {
+                EndBatch();
+            }
+
+            virtual bool handle_command(std::vector< std::string >& argv)
+            {
+                cli::ParserCommand* command = m_Parser.FindCommand(argv);
+                if (command && !strcmp(command->GetString(), "sp"))
+                {
+                    if (!m_InBatch)
+                    {
+                        begin_rete_bulk_load(m_Agent);
+                        m_InBatch = true;
+                    }
+                }
+                else
+                {
+                    EndBatch();
+                }
+                return m_Parser.handle_command(argv);
+            }
+
+            void EndBatch()
+            {
+                if (m_InBatch)
+                {
+                    end_rete_bulk_load(m_Agent);
+                    m_InBatch = false;
+                }
+            }
+
+        private:
+            cli::Parser& m_Parser;
+            agent*       m_Agent;
+            bool         m_InBatch;
+
+            BulkLoadHandler& operator=(const BulkLoadHandler&);
+    };
+}
+
+bool CommandLineInterface::Source(const char* buffer, bool printFileStack, bool bulkLoad)
 {
     soar::tokenizer tokenizer;
-    tokenizer.set_handler(&m_Parser);
-    if (tokenizer.evaluate(buffer))
+    bool evaluated;
+    if (bulkLoad && m_pAgentSML)
+    {
+        BulkLoadHandler handler(m_Parser, m_pAgentSML->GetSoarAgent());
+        tokenizer.set_handler(&handler);
+        evaluated = tokenizer.evaluate(buffer);
+    }
+    else
+    {
+        tokenizer.set_handler(&m_Parser);
+        evaluated = tokenizer.evaluate(buffer);
+    }
+    if (evaluated)
     {
         return true;
     }
@@ -45,6 +45,7 @@ namespace cli
                     {'a', "all",            OPTARG_NONE},
                     {'d', "disable",        OPTARG_NONE},
                     {'v', "verbose",        OPTARG_NONE},
+                    {'b', "bulk",           OPTARG_NONE},
                     {0, 0, OPTARG_NONE}
                 };
 
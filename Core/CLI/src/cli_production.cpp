@@ -68,6 +68,10 @@ bool CommandLineInterface::DoProduction(std::vector<std::string>& argv, const st
     {
         return ParseMatches(argv);
     }
+    else if (my_param == thisAgent->command_params->production_params->match_profile_cmd)
+    {
+        return ParseMatchProfile(argv);
+    }
     else if (my_param == thisAgent->command_params->production_params->memories_cmd)
     {
         return ParseMemories(argv);
@@ -574,6 +578,69 @@ bool CommandLineInterface::ParsePWatch(std::vector< std::string >& argv)
     return DoPWatch(query, 0);
 }
 
+bool CommandLineInterface::ParseMatchProfile(std::vector< std::string >& argv)
+{
+    cli::Options opt;
+    OptionsData optionsData[] =
+    {
+        {'d', "disable",    OPTARG_NONE},
+        {'e', "enable",     OPTARG_NONE},
+        {'d', "off",        OPTARG_NONE},
+        {'e', "on",         OPTARG_NONE},
+        {'r', "reset",      OPTARG_NONE},
+        {0, 0, OPTARG_NONE}
+    };
+
+    char op = 0;
+
+    for (;;)
+    {
+        if (!opt.ProcessOptions(argv, optionsData))
+        {
+            return SetError(opt.GetError().c_str());
+        }
+        if (opt.GetOption() == -1)
+        {
+            break;
+        }
+        if (op)
+        {
+            return SetError("Only one of --enable, --disable or --reset allowed.");
+        }
+        op = static_cast<char>(opt.GetOption());
+    }
+
+    if (op)
+    {
+        if (opt.GetNonOptionArguments() > 1)
+        {
+            return SetError("Too many parameters.");
+        }
+        return DoMatchProfile(op);
+    }
+
+    if (opt.GetNonOptionArguments() > 2)
+    {
+        return SetError("Syntax: production match-profile [n]\nproduction match-profile production_name");
+    }
+
+    // It is either a production or a number
+    int n = 0;
+    if (opt.GetNonOptionArguments() == 2)
+    {
+        int optind = opt.GetArgument() - opt.GetNonOptionArguments() + 1;
+        if (!from_string(n, argv[optind]))
+        {
+            return DoMatchProfile(0, 0, &argv[optind]);
+        }
+        if (n <= 0)
+        {
+            return SetError("Expected positive integer.");
+        }
+    }
+    return DoMatchProfile(0, n);
+}
+
 bool CommandLineInterface::DoPbreak(const char& mode, const std::string& production)
 {
     agent* thisAgent = m_pAgentSML->GetSoarAgent();
@@ -1862,6 +1929,138 @@ bool CommandLineInterface::DoMemories(const MemoriesBitset options, int n, const
     return true;
 }
 
+struct MatchProfileSort
+{
+    bool operator()(const std::pair< std::string, rete_node_profile >& a, const std::pair< std::string, rete_node_profile >& b) const
+    {
+        return a.second.raw_time < b.second.raw_time;
+    }
+};
+
+bool CommandLineInterface::DoMatchProfile(const char pOp, int n, const std::string* pProduction)
+{
+    agent* thisAgent = m_pAgentSML->GetSoarAgent();
+
+    switch (pOp)
+    {
+        case 'e':
+            set_rete_profiling(thisAgent, true);
+            return true;
+        case 'd':
+            set_rete_profiling(thisAgent, false);
+            return true;
+        case 'r':
+            reset_rete_profile(thisAgent);
+            return true;
+    }
+
+    double raw_per_msec = get_raw_time_per_usec() * 1000.0;
+    std::string temp;
+
+    if (pProduction)
+    {
+        Symbol* sym = thisAgent->symbolManager->find_str_constant(pProduction->c_str());
+
+        if (!sym || !(sym->sc->production))
+        {
+            return SetError("Production not found.");
+        }
+
+        rete_node_profile totals;
+        std::vector< std::pair< const char*, rete_node_profile > > nodes;
+        get_rete_profile_for_production(thisAgent, sym->sc->production, &totals, &nodes);
+
+        if (m_RawOutput)
+        {
+            m_Result << *pProduction << "\n";
+            m_Result << "      Time (ms)       Left  Null-left      Right Null-right     Tokens  Node\n";
+        }
+        for (std::vector< std::pair< const char*, rete_node_profile > >::iterator j = nodes.begin(); j != nodes.end(); ++j)
+        {
+            if (m_RawOutput)
+            {
+                std::ostringstream line;
+                line << std::fixed << std::setprecision(3) << std::setw(15) << (j->second.raw_time / raw_per_msec)
+                     << std::setw(11) << j->second.left_activations
+                     << std::setw(11) << j->second.null_left_activations
+                     << std::setw(11) << j->second.right_activations
+                     << std::setw(11) << j->second.null_right_activations
+                     << std::setw(11) << j->second.tokens_created
+                     << "  " << j->first << "\n";
+                m_Result << line.str();
+            }
+            else
+            {
+                // one type, time and activation count per node, starting at the p-node
+                AppendArgTagFast(sml_Names::kParamName, sml_Names::kTypeString, j->first);
+                AppendArgTagFast(sml_Names::kParamRealSeconds, sml_Names::kTypeDouble,
+                                 to_string(j->second.raw_time / raw_per_msec / 1000.0, temp));
+                AppendArgTagFast(sml_Names::kParamCount, sml_Names::kTypeInt,
+                                 to_string(j->second.left_activations + j->second.right_activations, temp));
+            }
+        }
+        return true;
+    }
+
+    std::vector< std::pair< std::string, rete_node_profile > > profiles;
+
+    for (unsigned int i = 0; i < NUM_PRODUCTION_TYPES; ++i)
+    {
+        for (production* pSoarProduction = thisAgent->all_productions_of_type[i];
+                pSoarProduction != 0;
+                pSoarProduction = pSoarProduction->next)
+        {
+            std::pair< std::string, rete_node_profile > profile;
+            profile.first = pSoarProduction->name->sc->name;
+            get_rete_profile_for_production(thisAgent, pSoarProduction, &profile.second);
+            profiles.push_back(profile);
+        }
+    }
+
+    if (profiles.empty())
+    {
+        return SetError("No productions in memory.");
+    }
+
+    MatchProfileSort s;
+    sort(profiles.begin(), profiles.end(), s);
+
+    if (m_RawOutput)
+    {
+        m_Result << "Match profiling is " << (thisAgent->rete_profiling ? "on" : "off") << ".\n";
+        m_Result << "      Time (ms)       Left  Null-left      Right Null-right     Tokens  Production\n";
+    }
+
+    int i = 0;
+    for (std::vector< std::pair< std::string, rete_node_profile > >::reverse_iterator j = profiles.rbegin();
+            j != profiles.rend() && (n == 0 || i < n);
+            ++j, ++i)
+    {
+        if (m_RawOutput)
+        {
+            // format in a local stream so std::fixed doesn't stick to m_Result
+            std::ostringstream line;
+            line << std::fixed << std::setprecision(3) << std::setw(15) << (j->second.raw_time / raw_per_msec)
+                 << std::setw(11) << j->second.left_activations
+                 << std::setw(11) << j->second.null_left_activations
+                 << std::setw(11) << j->second.right_activations
+                 << std::setw(11) << j->second.null_right_activations
+                 << std::setw(11) << j->second.tokens_created
+                 << "  " << j->first << "\n";
+            m_Result << line.str();
+        }
+        else
+        {
+            AppendArgTagFast(sml_Names::kParamName, sml_Names::kTypeString, j->first);
+            AppendArgTagFast(sml_Names::kParamRealSeconds, sml_Names::kTypeDouble,
+                             to_string(j->second.raw_time / raw_per_msec / 1000.0, temp));
+            AppendArgTagFast(sml_Names::kParamCount, sml_Names::kTypeInt,
+                             to_string(j->second.left_activations + j->second.right_activations, temp));
+        }
+    }
+    return true;
+}
+
 bool CommandLineInterface::ParseMemories(std::vector< std::string >& argv)
 {
     cli::Options opt;
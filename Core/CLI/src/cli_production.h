@@ -42,13 +42,18 @@ namespace cli
                     {'e', "clear",              OPTARG_NONE},
                     {'f', "count",              OPTARG_NONE},
                     {'d', "default",            OPTARG_NONE},
+                    {'z', "disable",            OPTARG_NONE},
+                    {'g', "enable",             OPTARG_NONE},
                     {'j', "justifications",     OPTARG_NONE},
                     {'l', "lhs",                OPTARG_NONE},
                     {'n', "names",              OPTARG_NONE},
                     {'o', "never-fired",        OPTARG_NONE},
+                    {'z', "off",                OPTARG_NONE},
+                    {'g', "on",                 OPTARG_NONE},
                     {'q', "nochunks",           OPTARG_NONE},
                     {'p', "print",              OPTARG_NONE},
                     {'r', "retractions",        OPTARG_NONE},
+                    {'k', "reset",              OPTARG_NONE},
                     {'v', "rhs",                OPTARG_NONE},
                     {'r', "rl",                 OPTARG_NONE},
                     {'s', "set",                OPTARG_NONE},
@@ -26,6 +26,8 @@
 #include "slot.h"
 #include "soar_db.h"
 
+#include <iomanip>
+
 using namespace cli;
 using namespace sml;
 
@@ -145,6 +147,25 @@ bool CommandLineInterface::DoSMem(const char pOp, const std::string* pArg1, cons
         }
         return true;
     }
+    else if (pOp == 'I')
+    {
+        std::string* err = new std::string;
+        std::string* imported = new std::string;
+
+        bool result = thisAgent->SMem->CLI_import(pArg1->c_str(), &(err), &(imported));
+
+        if (!result)
+        {
+            SetError("Error while importing " + *pArg1 + "\n" + *err);
+        }
+        else
+        {
+            PrintCLIMessage(imported);
+        }
+        delete err;
+        delete imported;
+        return result;
+    }
     else if (pOp == 'h')
     {
         uint64_t lti_id = NIL;
@@ -330,12 +351,22 @@ bool CommandLineInterface::DoSMem(const char pOp, const std::string* pArg1, cons
             PrintCLIMessage_Item("SQLite Version:", thisAgent->SMem->statistics->db_lib_version, 40);
             PrintCLIMessage_Item("Memory Usage:", thisAgent->SMem->statistics->mem_usage, 40);
             PrintCLIMessage_Item("Memory Highwater:", thisAgent->SMem->statistics->mem_high, 40);
+            PrintCLIMessage_Item("Shared Overlay:", thisAgent->SMem->statistics->overlay_size, 40);
+            PrintCLIMessage_Item("Group Commits:", thisAgent->SMem->statistics->commits, 40);
+            PrintCLIMessage_Item("WAL Checkpoints:", thisAgent->SMem->statistics->checkpoints, 40);
             PrintCLIMessage_Item("Retrieves:", thisAgent->SMem->statistics->retrievals, 40);
             PrintCLIMessage_Item("Queries:", thisAgent->SMem->statistics->queries, 40);
             PrintCLIMessage_Item("Stores:", thisAgent->SMem->statistics->stores, 40);
             PrintCLIMessage_Item("Activation Updates:", thisAgent->SMem->statistics->act_updates, 40);
             PrintCLIMessage_Item("Nodes:", thisAgent->SMem->statistics->nodes, 40);
             PrintCLIMessage_Item("Edges:", thisAgent->SMem->statistics->edges, 40);
+            PrintCLIMessage_Item("LTI Cache Hits:", thisAgent->SMem->statistics->lti_cache_hits, 40);
+            PrintCLIMessage_Item("LTI Cache Misses:", thisAgent->SMem->statistics->lti_cache_misses, 40);
+            int64_t lti_cache_lookups = thisAgent->SMem->statistics->lti_cache_hits->get_value() + thisAgent->SMem->statistics->lti_cache_misses->get_value();
+            std::ostringstream s_hit_rate_output_string;
+            s_hit_rate_output_string << std::fixed << std::setprecision(1) << ((lti_cache_lookups > 0) ? (100.0 * thisAgent->SMem->statistics->lti_cache_hits->get_value() / lti_cache_lookups) : 0.0) << "%";
+            std::string hit_rate_output_string = s_hit_rate_output_string.str();
+            PrintCLIMessage_Justify("LTI Cache Hit Rate:", hit_rate_output_string.c_str(), 40);
             uint64_t number_spread_elements = thisAgent->SMem->spread_size();
             std::ostringstream s_spread_output_string;
             s_spread_output_string << number_spread_elements;
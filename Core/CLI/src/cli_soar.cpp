@@ -14,6 +14,7 @@
 #include "sml_AgentSML.h"
 #include "sml_Names.h"
 #include "sml_KernelSML.h"
+#include "sml_RunScheduler.h"
 #include "sml_Utils.h"
 
 #include "agent.h"
@@ -37,6 +38,33 @@ bool CommandLineInterface::DoSoar(const char pOp, const std::string* pArg1, cons
     std::ostringstream tempStringStream;
     std::string tempString;
 
+    // run-threads belongs to the kernel's run scheduler, not to any one
+    // agent, so it isn't one of the decider's params
+    if (((pOp == 'G') || (pOp == 'S')) && pArg1 && (*pArg1 == "run-threads"))
+    {
+        RunScheduler* pScheduler = m_pKernelSML->GetRunScheduler();
+        if (pOp == 'G')
+        {
+            PrintCLIMessage_Justify("run-threads is", to_string(pScheduler->GetRunThreads(), tempString).c_str(), 0);
+            return true;
+        }
+
+        int runThreads;
+        if (!pArg2 || !from_string(runThreads, *pArg2) || (runThreads < 1))
+        {
+            return SetError("Invalid argument. run-threads must be an integer of at least 1.");
+        }
+        pScheduler->SetRunThreads(runThreads);
+        if (runThreads > 1)
+        {
+            thisAgent->outputManager->sprint_sf(tempString, "Agents will now run in parallel on up to %d threads when interleaving by decision or output.", runThreads);
+            PrintCLIMessage(tempString.c_str());
+        } else {
+            PrintCLIMessage("Agents will now run one at a time. (default)");
+        }
+        return true;
+    }
+
     if (!pOp)
     {
         thisAgent->Decider->params->print_status(thisAgent);
@@ -127,7 +155,7 @@ bool CommandLineInterface::DoSoar(const char pOp, const std::string* pArg1, cons
         }
         else if ((my_param == thisAgent->Decider->params->help_cmd) || (my_param == thisAgent->Decider->params->qhelp_cmd))
         {
-            thisAgent->Decider->params->print_settings(thisAgent);
+            thisAgent->Decider->params->print_settings(thisAgent, m_pKernelSML->GetRunScheduler()->GetRunThreads());
         }
         else {
             /* Command was a valid ebc_param name, so print it's value */
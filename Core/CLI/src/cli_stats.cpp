@@ -554,6 +554,7 @@ void CommandLineInterface::GetMemoryStats()
     m_Result << std::setw(8) << thisAgent->memoryManager->memory_for_usage[HASH_TABLE_MEM_USAGE] << " bytes for hash tables\n";
     m_Result << std::setw(8) << thisAgent->memoryManager->memory_for_usage[POOL_MEM_USAGE] << " bytes for various memory pools\n";
     m_Result << std::setw(8) << thisAgent->memoryManager->memory_for_usage[MISCELLANEOUS_MEM_USAGE] << " bytes for miscellaneous other things\n";
+    m_Result << std::setw(8) << Memory_Manager::Get_MPM().memory_for_usage[POOL_MEM_USAGE] << " bytes for memory pools shared by all agents\n";
 
     GetMemoryPoolStatistics();
 }
@@ -653,6 +654,27 @@ void CommandLineInterface::GetReteStats()
              << thisAgent->num_null_right_activations << " null), "
              << thisAgent->num_left_activations << " left ("
              << thisAgent->num_null_left_activations << " null)\n";
+
+    rete_ht_stats left_stats, right_stats;
+    get_memory_hash_table_stats(thisAgent, &left_stats, &right_stats);
+
+    m_Result << "\n   Memory Hash Table     Buckets     Entries   Non-empty  Avg Chain  Longest\n";
+    m_Result << "--------------------  ----------  ----------  ----------  ---------  -------\n";
+    GetReteHashTableStats("left (tokens)", left_stats);
+    GetReteHashTableStats("right (wmes)", right_stats);
+}
+
+void CommandLineInterface::GetReteHashTableStats(const char* table_name, rete_ht_stats& stats)
+{
+    double avg_chain = stats.used_buckets ? static_cast<double>(stats.entries) / stats.used_buckets : 0.0;
+
+    m_Result << std::setw(20) << table_name << "  "
+             << std::setw(10) << stats.buckets << "  "
+             << std::setw(10) << stats.entries << "  "
+             << std::setw(10) << stats.used_buckets << "  "
+             << std::setw(9) << std::fixed << std::setprecision(2) << avg_chain << "  "
+             << std::setw(7) << stats.longest_chain << "\n";
+    m_Result.unsetf(std::ios_base::floatfield);
 }
 
 
@@ -1,5 +1,6 @@
 #include "src/sml_ClientAgent.cpp"
 #include "src/sml_ClientAnalyzedXML.cpp"
+#include "src/sml_ClientCommandFuture.cpp"
 #include "src/sml_ClientErrors.cpp"
 #include "src/sml_ClientFloatElement.cpp"
 #include "src/sml_ClientIdentifier.cpp"
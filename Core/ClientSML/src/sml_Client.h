@@ -21,5 +21,6 @@
 #include "sml_ClientXML.h"
 #include "sml_ClientTraceXML.h"
 #include "sml_ClientAnalyzedXML.h"
+#include "sml_ClientCommandFuture.h"
 
 #endif //SML_CLIENT_SML_H
@@ -1178,6 +1178,11 @@ bool Agent::Commit()
     return GetWM()->Commit() ;
 }
 
+CommandFuture* Agent::CommitAsync()
+{
+    return GetKernel()->SendCommandAsync(GetWM()->CreateCommitMessage()) ;
+}
+
 bool Agent::IsCommitRequired()
 {
     return GetWM()->IsCommitRequired() ;
@@ -1414,6 +1419,11 @@ char const* Agent::ExecuteCommandLine(char const* pCommandLine, bool echoResults
     return GetKernel()->ExecuteCommandLine(pCommandLine, GetAgentName(), echoResults, noFilter) ;
 }
 
+CommandFuture* Agent::ExecuteCommandLineAsync(char const* pCommandLine, bool echoResults, bool noFilter)
+{
+    return GetKernel()->ExecuteCommandLineAsync(pCommandLine, GetAgentName(), echoResults, noFilter) ;
+}
+
 bool Agent::ExecuteCommandLineXML(char const* pCommandLine, ClientAnalyzedXML* pResponse)
 {
     return GetKernel()->ExecuteCommandLineXML(pCommandLine, GetAgentName(), pResponse) ;
@@ -38,6 +38,7 @@ namespace sml
     class AnalyzeXML ;
     class ClientXML ;
     class ClientAnalyzedXML ;
+    class CommandFuture ;
     struct DebuggerProcessInformation;
 
     class RunEventHandlerPlusData : public EventHandlerPlusData
@@ -719,6 +720,16 @@ namespace sml
             *************************************************************/
             bool Commit() ;
 
+            /*************************************************************
+            * @brief Send the most recent list of changes to working memory
+            *        over to the kernel, without waiting for them to be applied.
+            *        (See Kernel::ExecuteCommandLineAsync()).
+            *
+            * @returns An object that will hold the result once it arrives.
+            *          The caller owns this and must delete it.
+            *************************************************************/
+            CommandFuture* CommitAsync() ;
+
             /*************************************************************
             * @brief Returns true if this agent has uncommitted changes.
             *************************************************************/
@@ -808,6 +819,15 @@ namespace sml
             *************************************************************/
             char const* ExecuteCommandLine(char const* pCommandLine, bool echoResults = false, bool noFilter = false) ;
 
+            /*************************************************************
+            * @brief Send a command line command without waiting for it to
+            *        execute (see Kernel::ExecuteCommandLineAsync()).
+            *
+            * @returns An object that will hold the result once it arrives.
+            *          The caller owns this and must delete it.
+            *************************************************************/
+            CommandFuture* ExecuteCommandLineAsync(char const* pCommandLine, bool echoResults = false, bool noFilter = false) ;
+
             /*************************************************************
             * @brief Execute a command line command and return the result
             *        as an XML object.
@@ -0,0 +1,93 @@
+#include "portability.h"
+
+/////////////////////////////////////////////////////////////////
+// CommandFuture class
+//
+// The result of a command that was sent without waiting for
+// the kernel to reply (see Kernel::ExecuteCommandLineAsync()).
+//
+/////////////////////////////////////////////////////////////////
+#include "sml_ClientCommandFuture.h"
+#include "sml_ClientKernel.h"
+#include "sml_AnalyzeXML.h"
+#include "sml_Names.h"
+#include "ElementXML.h"
+
+using namespace sml ;
+using namespace soarxml;
+
+CommandFuture::CommandFuture(Kernel* pKernel, ElementXML* pMsg)
+{
+    m_Kernel    = pKernel ;
+    m_pMsg      = pMsg ;
+    m_InFlight  = false ;
+    m_Finished  = (pMsg == NULL) ;
+    m_Succeeded = (pMsg == NULL) ;
+
+    if (pMsg)
+    {
+        char const* pID = pMsg->GetAttribute(sml_Names::kID) ;
+        m_ID = pID ? pID : "" ;
+    }
+}
+
+CommandFuture::~CommandFuture()
+{
+    // Take ourselves out of the kernel's batch, or let it know
+    // we won't be collecting our response.
+    if (!m_Finished)
+    {
+        m_Kernel->ForgetCommand(this) ;
+    }
+
+    delete m_pMsg ;
+}
+
+/*************************************************************
+* @brief Records the response from the kernel, in the same form
+*        ExecuteCommandLine() reports it.
+*************************************************************/
+void CommandFuture::SetResponse(AnalyzeXML* pResponse, bool succeeded)
+{
+    m_Finished  = true ;
+    m_InFlight  = false ;
+    m_Succeeded = succeeded ;
+
+    Kernel::GetCommandLineResult(pResponse, succeeded, &m_Result) ;
+}
+
+bool CommandFuture::IsReady()
+{
+    if (!m_Finished && m_InFlight)
+    {
+        m_Kernel->CollectCommand(this, false) ;
+    }
+
+    return m_Finished ;
+}
+
+bool CommandFuture::Wait()
+{
+    if (!m_Finished)
+    {
+        // If we're being held in a batch, send it now
+        if (!m_InFlight)
+        {
+            m_Kernel->SendCommandBatch() ;
+        }
+
+        if (m_InFlight)
+        {
+            m_Kernel->CollectCommand(this, true) ;
+        }
+    }
+
+    return m_Succeeded ;
+}
+
+char const* CommandFuture::GetResult()
+{
+    Wait() ;
+
+    return m_Result.c_str() ;
+}
@@ -0,0 +1,91 @@
+/////////////////////////////////////////////////////////////////
+// CommandFuture class
+//
+// The result of a command that was sent without waiting for
+// the kernel to reply (see Kernel::ExecuteCommandLineAsync()).
+//
+// Any number of these can be in flight on one connection at once.
+// Responses are matched to them by message id as they come in,
+// so a client driving many agents over a remote connection can send
+// all of its commands and then collect the results, rather than
+// paying for a round trip per command.
+//
+// The client owns the object and should delete it once it has the
+// result (and always before deleting the kernel it came from).
+//
+/////////////////////////////////////////////////////////////////
+
+#ifndef SML_CLIENT_COMMAND_FUTURE_H
+#define SML_CLIENT_COMMAND_FUTURE_H
+
+#include <string>
+#include "Export.h"
+
+namespace soarxml
+{
+    class ElementXML ;
+}
+
+namespace sml
+{
+
+    class Kernel ;
+    class AnalyzeXML ;
+
+    class EXPORT CommandFuture
+    {
+            // The kernel sends the command and fills in the result
+            friend class Kernel ;
+
+        protected:
+            Kernel*     m_Kernel ;
+
+            // The command, until it's been sent (we own it)
+            soarxml::ElementXML* m_pMsg ;
+
+            // The id of the command, which its response will carry
+            std::string m_ID ;
+
+            // True once the command is on its way and until we've collected its response
+            bool        m_InFlight ;
+
+            bool        m_Finished ;
+            bool        m_Succeeded ;
+            std::string m_Result ;
+
+            // Pass a NULL message for a command that had nothing to do and so has already succeeded
+            CommandFuture(Kernel* pKernel, soarxml::ElementXML* pMsg) ;
+
+            // Records the response from the kernel
+            void SetResponse(AnalyzeXML* pResponse, bool succeeded) ;
+
+        public:
+            virtual ~CommandFuture() ;
+
+            /*************************************************************
+            * @brief Returns true if the result has come back.
+            *        This never blocks.
+            *************************************************************/
+            bool IsReady() ;
+
+            /*************************************************************
+            * @brief Waits for the result (sending the command first, if it's
+            *        still being held in a batch).
+            *
+            * @returns True if the command succeeded.
+            *************************************************************/
+            bool Wait() ;
+
+            /*************************************************************
+            * @brief Waits for the result and returns it: the output of the
+            *        command or, if it failed, the error message (the same
+            *        string ExecuteCommandLine() would have returned).
+            *
+            *        The string is valid until this object is deleted.
+            *************************************************************/
+            char const* GetResult() ;
+    } ;
+
+}//closes namespace
+
+#endif //SML_CLIENT_COMMAND_FUTURE_H
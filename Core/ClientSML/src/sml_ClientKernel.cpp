@@ -20,6 +20,7 @@
 #include "sml_EventThread.h"
 #include "sml_Events.h"
 #include "sml_ClientAnalyzedXML.h"
+#include "sml_ClientCommandFuture.h"
 #include "sml_KernelSML.h"
 #include "sml_EmbeddedConnection.h" // For access to direct methods
 #include "sml_ClientDirect.h"
@@ -37,6 +38,7 @@
 #include <iostream>
 #include <sstream>
 #include <iomanip>
+#include <vector>
 
 using namespace sml ;
 using namespace soarxml;
@@ -57,6 +59,7 @@ Kernel::Kernel(Connection* pConnection)
     m_bIgnoreOutput = false ;
     m_FilteringEnabled = true ;
     m_CommandLineSucceeded = false;
+    m_BatchingCommands = false ;
 
     // We're turning on auto commit by default, so clients are a bit slower but easier to write.
     // Power users are free to turn it off and use explicit commit calls.
@@ -791,7 +794,7 @@ int Kernel::GetListenerPort()
     return -1;
 }
 
-Kernel* Kernel::CreateRemoteConnection(bool sharedFileSystem, char const* pIPaddress, int port, bool ignoreOutput)
+Kernel* Kernel::CreateRemoteConnection(bool sharedFileSystem, char const* pIPaddress, int port, bool ignoreOutput, bool useSharedMemory)
 {
     ErrorCode errorCode = 0 ;
 
@@ -822,6 +825,13 @@ Kernel* Kernel::CreateRemoteConnection(bool sharedFileSystem, char const* pIPadd
         return pKernel;
     }
 
+    // Switch before anything else is sent.  This does nothing for a kernel on another
+    // machine, and we stay on the socket if either side can't.
+    if (useSharedMemory)
+    {
+        pConnection->UseSharedMemory() ;
+    }
+
     // Register for "calls" from the kernel.
     pConnection->RegisterCallback(ReceivedCall, pKernel, sml_Names::kDocType_Call, true) ;
 
@@ -1229,28 +1239,206 @@ char const* Kernel::ExecuteCommandLine(char const* pCommandLine, char const* pAg
                              sml_Names::kParamNoFiltering, !m_FilteringEnabled || noFilter ? sml_Names::kTrue : sml_Names::kFalse,
                              wantRawOutput);
 
-    if (m_CommandLineSucceeded)
+    GetCommandLineResult(&response, m_CommandLineSucceeded, &m_CommandLineResult) ;
+
+    return m_CommandLineResult.c_str();
+}
+
+/*************************************************************
+* @brief Builds the string ExecuteCommandLine() reports from
+*        the response to a command: its output if it succeeded,
+*        otherwise the error message.
+*************************************************************/
+void Kernel::GetCommandLineResult(AnalyzeXML* pResponse, bool succeeded, std::string* pResult)
+{
+    if (succeeded)
     {
         // Get the result as a string
-        char const* pResult = response.GetResultString();
-        m_CommandLineResult = (pResult == NULL) ? "" : pResult ;
+        char const* pResultString = pResponse->GetResultString();
+        *pResult = (pResultString == NULL) ? "" : pResultString ;
     }
     else
     {
         // Get the error message
-//        m_CommandLineResult = "Error: ";
-        m_CommandLineResult = "";
-        if (response.GetErrorTag())
+//        *pResult = "Error: ";
+        *pResult = "";
+        if (pResponse->GetErrorTag())
         {
-            m_CommandLineResult += response.GetErrorTag()->GetCharacterData();
+            *pResult += pResponse->GetErrorTag()->GetCharacterData();
         }
         else
         {
-            m_CommandLineResult += "<No error message returned by command>";
+            *pResult += "<No error message returned by command>";
         }
     }
+}
 
-    return m_CommandLineResult.c_str();
+/*************************************************************
+* @brief Send a command line command without waiting for it
+*        to execute.
+*
+* @param pCommandLine Command line string to process.
+* @param pAgentName   Agent name to apply the command line to (can be NULL)
+* @param echoResults  If true the results are also echoed through the smlEVENT_ECHO event
+* @param noFilter     If true this command line by-passes any external filters that have been registered
+* @returns An object holding the result once it arrives (the caller must delete it).
+*************************************************************/
+CommandFuture* Kernel::ExecuteCommandLineAsync(char const* pCommandLine, char const* pAgentName, bool echoResults, bool noFilter)
+{
+    bool wantRawOutput = true ;
+
+    // Build the same message ExecuteCommandLine() sends
+    ElementXML* pMsg = GetConnection()->CreateSMLCommand(sml_Names::kCommand_CommandLine, wantRawOutput) ;
+
+    if (pAgentName)
+    {
+        GetConnection()->AddParameterToSMLCommand(pMsg, sml_Names::kParamAgent, pAgentName) ;
+    }
+
+    GetConnection()->AddParameterToSMLCommand(pMsg, sml_Names::kParamLine, pCommandLine) ;
+    GetConnection()->AddParameterToSMLCommand(pMsg, sml_Names::kParamEcho, echoResults ? sml_Names::kTrue : sml_Names::kFalse) ;
+    GetConnection()->AddParameterToSMLCommand(pMsg, sml_Names::kParamNoFiltering, !m_FilteringEnabled || noFilter ? sml_Names::kTrue : sml_Names::kFalse) ;
+
+    return SendCommandAsync(pMsg) ;
+}
+
+/*************************************************************
+* @brief Start holding asynchronous commands so they can all
+*        be sent in one go.
+*************************************************************/
+void Kernel::BeginCommandBatch()
+{
+    m_BatchingCommands = true ;
+}
+
+/*************************************************************
+* @brief Send the asynchronous commands held since
+*        BeginCommandBatch() and stop holding them.
+*************************************************************/
+void Kernel::SendCommandBatch()
+{
+    m_BatchingCommands = false ;
+
+    std::vector<CommandFuture*> commands(m_UnsentCommands.begin(), m_UnsentCommands.end()) ;
+    m_UnsentCommands.clear() ;
+
+    if (!commands.empty())
+    {
+        SendCommands(&commands[0], static_cast<int>(commands.size())) ;
+    }
+}
+
+/*************************************************************
+* @brief Sends a command without waiting for the response,
+*        or holds it if a batch is open.  Takes ownership of
+*        the message (NULL means there was nothing to send).
+*************************************************************/
+CommandFuture* Kernel::SendCommandAsync(ElementXML* pMsg)
+{
+    CommandFuture* pCommand = new CommandFuture(this, pMsg) ;
+
+    if (!pMsg)
+    {
+        return pCommand ;
+    }
+
+    if (m_BatchingCommands)
+    {
+        m_UnsentCommands.push_back(pCommand) ;
+    }
+    else
+    {
+        SendCommands(&pCommand, 1) ;
+    }
+
+    return pCommand ;
+}
+
+/*************************************************************
+* @brief Sends a series of asynchronous commands in one go.
+*************************************************************/
+void Kernel::SendCommands(CommandFuture** ppCommands, int count)
+{
+    Connection* pConnection = GetConnection() ;
+
+    // A synchronous connection executes each command as it's sent
+    // (and only keeps the last response), so there's nothing to
+    // overlap and we just execute them in turn.
+    if (!pConnection->IsAsynchronous())
+    {
+        for (int i = 0 ; i < count ; i++)
+        {
+            CommandFuture* pCommand = ppCommands[i] ;
+
+            AnalyzeXML response ;
+            bool ok = pConnection->SendMessageGetResponse(&response, pCommand->m_pMsg) ;
+            pCommand->SetResponse(&response, ok) ;
+
+            delete pCommand->m_pMsg ;
+            pCommand->m_pMsg = NULL ;
+        }
+
+        return ;
+    }
+
+    std::vector<ElementXML*> messages(count) ;
+    for (int i = 0 ; i < count ; i++)
+    {
+        messages[i] = ppCommands[i]->m_pMsg ;
+    }
+
+    bool ok = pConnection->SendPipelinedMessages(&messages[0], count) ;
+
+    for (int i = 0 ; i < count ; i++)
+    {
+        CommandFuture* pCommand = ppCommands[i] ;
+
+        delete pCommand->m_pMsg ;
+        pCommand->m_pMsg = NULL ;
+
+        if (ok)
+        {
+            pCommand->m_InFlight = true ;
+        }
+        else
+        {
+            AnalyzeXML noResponse ;
+            pCommand->SetResponse(&noResponse, false) ;
+        }
+    }
+}
+
+/*************************************************************
+* @brief Picks up the response to an asynchronous command if
+*        it's arrived (or waits for it).
+*************************************************************/
+void Kernel::CollectCommand(CommandFuture* pCommand, bool wait)
+{
+    AnalyzeXML response ;
+    bool finished = true ;
+
+    bool ok = GetConnection()->GetPipelinedResponse(&response, pCommand->m_ID.c_str(), wait, &finished) ;
+
+    if (finished)
+    {
+        pCommand->SetResponse(&response, ok) ;
+    }
+}
+
+/*************************************************************
+* @brief Called when an unfinished asynchronous command is
+*        deleted, so we don't send it or keep its response.
+*************************************************************/
+void Kernel::ForgetCommand(CommandFuture* pCommand)
+{
+    if (pCommand->m_InFlight)
+    {
+        GetConnection()->AbandonPipelinedResponse() ;
+    }
+    else
+    {
+        m_UnsentCommands.remove(pCommand) ;
+    }
 }
 
 /*************************************************************
@@ -1285,10 +1473,30 @@ void Kernel::CommitAll()
 {
     int numberAgents = GetNumberAgents() ;
 
+    // Send all of the commits together and then collect the responses,
+    // rather than waiting for each agent's in turn.  Any commands the
+    // caller is holding in a batch are set aside, so they stay held.
+    bool batching = m_BatchingCommands ;
+    std::list<CommandFuture*> held ;
+    held.swap(m_UnsentCommands) ;
+    BeginCommandBatch() ;
+
+    std::vector<CommandFuture*> commits ;
     for (int i = 0 ; i < numberAgents ; i++)
     {
         Agent* pAgent = GetAgentByIndex(i) ;
-        pAgent->Commit() ;
+        commits.push_back(pAgent->CommitAsync()) ;
+    }
+
+    SendCommandBatch() ;
+
+    m_UnsentCommands.swap(held) ;
+    m_BatchingCommands = batching ;
+
+    for (size_t i = 0 ; i < commits.size() ; i++)
+    {
+        commits[i]->Wait() ;
+        delete commits[i] ;
     }
 }
 
@@ -44,6 +44,7 @@ namespace sml
     class Events ;
     class AnalyzeXML ;
     class ClientAnalyzedXML ;
+    class CommandFuture ;
 
     class SystemEventHandlerPlusData : public EventHandlerPlusData
     {
@@ -163,6 +164,7 @@ namespace sml
             // Allow the agent to call to get the connection from the kernel.
             friend class Agent ;
             friend class WorkingMemory ;    // Access to generate next ID methods
+            friend class CommandFuture ;    // Access to send and collect pipelined commands
 
         public:
             enum
@@ -190,6 +192,10 @@ namespace sml
             bool                m_CommandLineSucceeded ;
             sock::SocketLib*    m_SocketLibrary ;
 
+            // Asynchronous commands being held until the batch they're in is sent
+            std::list<CommandFuture*> m_UnsentCommands ;
+            bool                m_BatchingCommands ;
+
             // Info about all connections (have to explicitly request this)
             std::list<ConnectionInfo*> m_ConnectionInfoList ;
             typedef std::list<ConnectionInfo*>::iterator ConnectionListIter ;
@@ -256,6 +262,34 @@ namespace sml
             *************************************************************/
             void    UnregisterForEventWithKernel(int id, char const* pAgentName) ;
 
+            /*************************************************************
+            * @brief Sends a command without waiting for the response
+            *        (or holds it, if a batch is open).  Takes ownership of
+            *        the message, which may be NULL if there's nothing to do.
+            *************************************************************/
+            CommandFuture* SendCommandAsync(soarxml::ElementXML* pMsg) ;
+
+            /*************************************************************
+            * @brief Sends a series of asynchronous commands in one go.
+            *************************************************************/
+            void    SendCommands(CommandFuture** ppCommands, int count) ;
+
+            /*************************************************************
+            * @brief Picks up the response to an asynchronous command if
+            *        it's arrived (or waits for it).
+            *************************************************************/
+            void    CollectCommand(CommandFuture* pCommand, bool wait) ;
+
+            /*************************************************************
+            * @brief Called when an unfinished asynchronous command is deleted.
+            *************************************************************/
+            void    ForgetCommand(CommandFuture* pCommand) ;
+
+            /*************************************************************
+            * @brief Builds the string ExecuteCommandLine() reports from a response.
+            *************************************************************/
+            static void GetCommandLineResult(AnalyzeXML* pResponse, bool succeeded, std::string* pResult) ;
+
             /*************************************************************
             * @brief Creates a new Agent* object (not to be confused
             *        with actually creating a Soar agent -- see CreateAgent for that)
@@ -354,11 +388,14 @@ namespace sml
             *                   If connecting to a local machine with a kernel created using kUseAnyPort, you can pass the PID here to connect to a high-performance
             *                   local connection.
             * @param ignoreOutput Setting this to true means output link changes won't be sent to this client (improving performance if you aren't interested in output)
+            * @param useSharedMemory If the kernel is on this machine, pass messages through a shared memory segment rather than the socket
+            *                   (on platforms that support it).  If the kernel is elsewhere, or either side can't, the connection carries on
+            *                   over the socket, so this only needs turning off to keep a local connection on its socket.
             *
             * @returns A new kernel object which is used to communicate with the kernel
             *          If an error occurs a Kernel object is still returned.  Call "HadError()" and "GetLastErrorDescription()" on it.
             *************************************************************/
-            static Kernel* CreateRemoteConnection(bool sharedFileSystem = true, char const* pIPaddress = 0, int port = kDefaultSMLPort, bool ignoreOutput = false) ;
+            static Kernel* CreateRemoteConnection(bool sharedFileSystem = true, char const* pIPaddress = 0, int port = kDefaultSMLPort, bool ignoreOutput = false, bool useSharedMemory = true) ;
 
             /*************************************************************
             * @brief Returns the default port we use for remote connections.
@@ -519,6 +556,38 @@ namespace sml
             *************************************************************/
             bool ExecuteCommandLineXML(char const* pCommandLine, char const* pAgentName, ClientAnalyzedXML* pResponse) ;
 
+            /*************************************************************
+            * @brief Send a command line command without waiting for it to
+            *        execute.  Any number of these can be in flight at once,
+            *        so a client driving many agents doesn't have to wait for
+            *        a round trip to the kernel per command.
+            *
+            *        The parameters are the same as ExecuteCommandLine().
+            *
+            * @returns An object that will hold the result once it arrives.
+            *          The caller owns this and must delete it (before
+            *          deleting this kernel).
+            *************************************************************/
+            CommandFuture* ExecuteCommandLineAsync(char const* pCommandLine, char const* pAgentName, bool echoResults = false, bool noFilter = false) ;
+
+            /*************************************************************
+            * @brief Start holding asynchronous commands (from this kernel and
+            *        its agents), so SendCommandBatch() can send them all in a
+            *        single write.
+            *
+            *        Waiting on a command that's being held sends the batch
+            *        (as SendCommandBatch() would).
+            *        Commands executed synchronously (e.g. with ExecuteCommandLine())
+            *        while a batch is open are not held, so they arrive first.
+            *************************************************************/
+            void BeginCommandBatch() ;
+
+            /*************************************************************
+            * @brief Send the asynchronous commands held since BeginCommandBatch(),
+            *        in the order they were issued, and stop holding them.
+            *************************************************************/
+            void SendCommandBatch() ;
+
             /*************************************************************
             * @brief   Run Soar for the specified number of decisions
             *
@@ -933,6 +1002,9 @@ namespace sml
             /*************************************************************
             * @brief Calls Commit() for all agents -- sending any queued I/O operations
             *        over to the kernel for processing.
+            *
+            *        The agents' changes are sent together (see Agent::CommitAsync()),
+            *        so we only wait for one round trip rather than one per agent.
             *************************************************************/
             void CommitAll() ;
 
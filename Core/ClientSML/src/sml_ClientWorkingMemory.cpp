@@ -1326,16 +1326,40 @@ bool WorkingMemory::IsAutoCommitEnabled()
 *************************************************************/
 bool WorkingMemory::Commit()
 {
-    int deltas = m_DeltaList.GetSize() ;
+    ElementXML* pMsg = CreateCommitMessage() ;
     
     // If nothing has changed, we have no work to do.
     // This allows us to call Commit() multiple times without causing problems
     // as later calls will be ignored if the current set of changes has been sent already.
-    if (deltas == 0)
+    if (!pMsg)
     {
         return true ;
     }
     
+    // Send the message
+    AnalyzeXML response ;
+    bool ok = GetConnection()->SendMessageGetResponse(&response, pMsg) ;
+    
+    // Clean up
+    delete pMsg ;
+    
+    return ok ;
+}
+
+/*************************************************************
+* @brief Build the message that sends the most recent list of
+*        changes to working memory over to the kernel, clearing
+*        the list.  Returns NULL if nothing has changed.
+*************************************************************/
+ElementXML* WorkingMemory::CreateCommitMessage()
+{
+    int deltas = m_DeltaList.GetSize() ;
+    
+    if (deltas == 0)
+    {
+        return NULL ;
+    }
+    
     // Build the SML message we're doing to send.
     ElementXML* pMsg = GetConnection()->CreateSMLCommand(sml_Names::kCommand_Input) ;
     
@@ -1369,14 +1393,7 @@ bool WorkingMemory::Commit()
     pMsg->DeleteString(pStr) ;
 #endif
     
-    // Send the message
-    AnalyzeXML response ;
-    bool ok = GetConnection()->SendMessageGetResponse(&response, pMsg) ;
-    
-    // Clean up
-    delete pMsg ;
-    
-    return ok ;
+    return pMsg ;
 }
 
 /*************************************************************
@@ -165,6 +165,7 @@ namespace sml
             
             bool            IsCommitRequired() ;
             bool            Commit() ;
+            soarxml::ElementXML* CreateCommitMessage() ;
             bool            IsAutoCommitEnabled() ;
             
     };
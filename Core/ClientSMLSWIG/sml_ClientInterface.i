@@ -27,6 +27,13 @@
 %newobject sml::Kernel::CreateKernelInNewThread;
 %newobject sml::Kernel::CreateRemoteConnection;
 
+//
+// These create a new CommandFuture object that the caller owns
+//
+%newobject sml::Kernel::ExecuteCommandLineAsync;
+%newobject sml::Agent::ExecuteCommandLineAsync;
+%newobject sml::Agent::CommitAsync;
+
 //
 // These static functions generate a new char* object that should be destroyed later
 // We also need to tell SWIG how to delete the object (hence the typemaps)
@@ -115,6 +122,7 @@
 #include "sml_ClientXML.h"
 #include "sml_ClientTraceXML.h"
 #include "sml_ClientAnalyzedXML.h"
+#include "sml_ClientCommandFuture.h"
 #include "soar_instance.h"
 %}
 // name this () operator from soar_instance.h so it can be wrapped
@@ -144,6 +152,7 @@
 %include "sml_ClientXML.h"
 %include "sml_ClientTraceXML.h"
 %include "sml_ClientAnalyzedXML.h"
+%include "sml_ClientCommandFuture.h"
 %include "soar_instance.h"
 
 
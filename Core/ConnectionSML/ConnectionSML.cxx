@@ -1,5 +1,6 @@
 #include "src/sml_AnalyzeXML.cpp"
 #include "src/sml_ArgMap.cpp"
+#include "src/sml_BinaryEncoding.cpp"
 #include "src/sml_Connection.cpp"
 #include "src/sml_EmbeddedConnection.cpp"
 #include "src/sml_EmbeddedConnectionAsynch.cpp"
@@ -7,6 +8,7 @@
 #include "src/sml_Events.cpp"
 #include "src/sml_EventThread.cpp"
 #include "src/sml_MessageSML.cpp"
+#include "src/sml_MessageWaiter.cpp"
 #include "src/sml_Names.cpp"
 #include "src/sml_RemoteConnection.cpp"
 #include "src/sml_StringOps.cpp"
@@ -25,6 +27,7 @@
 #include "src/sock_ListenerSocket.cpp"
 #include "src/sock_NamedPipe.cpp"
 #include "src/sock_OSspecific.cpp"
+#include "src/sock_SharedMemory.cpp"
 #include "src/sock_Socket.cpp"
 #include "src/sock_SocketLib.cpp"
 #include "src/thread_Event.cpp"
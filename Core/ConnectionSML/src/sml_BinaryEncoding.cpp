@@ -0,0 +1,564 @@
+#include "portability.h"
+
+/////////////////////////////////////////////////////////////////
+// BinaryEncoding class
+//
+// A compact binary form of an SML message, used in place of XML text
+// over remote connections once both sides have said they can read it.
+// See sml_BinaryEncoding.h for the layout.
+//
+/////////////////////////////////////////////////////////////////
+
+#include "sml_BinaryEncoding.h"
+#include "sml_Names.h"
+#include "ElementXML.h"
+
+#include <stdio.h>
+#include <unordered_map>
+
+using namespace sml ;
+using namespace soarxml ;
+
+char const* const BinaryEncoding::kVersionValue = "1" ;
+
+namespace
+{
+    // Leading bytes of an encoded message
+    unsigned char const kMagic   = 0 ;
+    unsigned char const kVersion = 1 ;
+
+    // Element flags
+    unsigned char const kHasComment     = 1 ;
+    unsigned char const kHasText        = 2 ;
+    unsigned char const kHasBinary      = 4 ;
+
+    // Value types
+    unsigned char const kValueString    = 0 ;
+    unsigned char const kValueInteger   = 1 ;
+    unsigned char const kValueName      = 2 ;
+
+    // Elements nested deeper than this are rejected rather than read
+    // with one more level of recursion each
+    int const kMaxDepth = 1000 ;
+
+    // The names and values SML messages are mostly made of.
+    // This list is part of the wire format: only ever append to it.
+    char const* const kDictionary[] =
+    {
+        // <sml> envelope
+        "sml", "id", "ack", "doctype", "call", "response", "notify", "smlversion",
+        // commands, arguments, results and errors
+        "command", "name", "output", "arg", "param", "type", "result", "error", "code",
+        "string", "int", "double", "char", "boolean", "variable", "true", "false",
+        "agent", "kernel", "this", "filename", "eventid", "phase", "self", "value", "raw",
+        "structured", "connection", "status", "agent-status", "ready", "not-ready",
+        // working memory
+        "wme", "tag", "attr", "valtype", "action", "add", "remove", "att", "output-link",
+        // trace output
+        "trace", "filter", "message", "state", "operator", "production", "prodname",
+        "firing_production", "retracting_production", "adding_wme", "removing_wme",
+        "preference", "pref_type", "current_state_id", "current_operator_id",
+        "decision_cycle_count", "stack_level", "impasse_object", "impasse_type",
+        "level_num", "firing_type", "begin", "end", "input", "propose", "apply", "decision",
+        "workingmemory", "subphase", "warning", "learning", "verbose", "rhs_write",
+        // common command names
+        "cmdline", "run", "get_input_link", "get_output_link", "create_agent",
+        "destroy_agent", "get_agent_list", "register_for_event", "unregister_for_event",
+        "event", "check_for_incoming_commands", "is_running", "get_run_state",
+        "get_all_input", "get_all_output", "get_connections", "set_connection_info",
+        "send_client_message", "last_run_result", "initial_time_tag", "output_init",
+        "svs_input", "svs_output", "svs_query", "version",
+    } ;
+
+    uint64_t const kDictionarySize = sizeof(kDictionary) / sizeof(kDictionary[0]) ;
+
+    struct NameHash
+    {
+        size_t operator()(char const* pStr) const
+        {
+            // FNV-1a
+            size_t hash = static_cast<size_t>(2166136261u) ;
+            for (; *pStr ; pStr++)
+            {
+                hash = (hash ^ static_cast<unsigned char>(*pStr)) * static_cast<size_t>(16777619u) ;
+            }
+            return hash ;
+        }
+    } ;
+
+    struct NameEqual
+    {
+        bool operator()(char const* pStr1, char const* pStr2) const
+        {
+            return strcmp(pStr1, pStr2) == 0 ;
+        }
+    } ;
+
+    typedef std::unordered_map<char const*, uint64_t, NameHash, NameEqual> DictionaryIndex ;
+
+    DictionaryIndex const& GetDictionaryIndex()
+    {
+        static DictionaryIndex const index = []
+        {
+            DictionaryIndex result ;
+            for (uint64_t i = 0 ; i < kDictionarySize ; i++)
+            {
+                result[kDictionary[i]] = i ;
+            }
+            return result ;
+        }() ;
+
+        return index ;
+    }
+
+    // Returns true (and sets *pIndex) if the string is in the dictionary
+    inline bool FindInDictionary(char const* pStr, uint64_t* pIndex)
+    {
+        DictionaryIndex const& index = GetDictionaryIndex() ;
+        DictionaryIndex::const_iterator iter = index.find(pStr) ;
+
+        if (iter == index.end())
+        {
+            return false ;
+        }
+
+        *pIndex = iter->second ;
+        return true ;
+    }
+
+    // Returns true (and sets *pValue) if the string is a decimal integer
+    // that prints back exactly as it is written ("12", "-3", but not "012" or "+3").
+    inline bool IsCanonicalInteger(char const* pStr, int64_t* pValue)
+    {
+        char const* p = pStr ;
+        bool negative = (*p == '-') ;
+        if (negative)
+        {
+            p++ ;
+        }
+
+        if (*p < '0' || *p > '9' || (*p == '0' && (negative || p[1] != 0)))
+        {
+            return false ;
+        }
+
+        // 18 digits always fit in an int64_t
+        int64_t value = 0 ;
+        int digits = 0 ;
+        for (; *p ; p++, digits++)
+        {
+            if (*p < '0' || *p > '9' || digits == 18)
+            {
+                return false ;
+            }
+            value = value * 10 + (*p - '0') ;
+        }
+
+        *pValue = negative ? -value : value ;
+        return true ;
+    }
+
+    /////////////////////////////////////////////////////////////////
+    // Writing
+    /////////////////////////////////////////////////////////////////
+
+    inline void WriteVarint(std::string* pBuffer, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            pBuffer->push_back(static_cast<char>((value & 0x7F) | 0x80)) ;
+            value >>= 7 ;
+        }
+        pBuffer->push_back(static_cast<char>(value)) ;
+    }
+
+    inline void WriteBytes(std::string* pBuffer, char const* pBytes, size_t length)
+    {
+        WriteVarint(pBuffer, length) ;
+        pBuffer->append(pBytes, length) ;
+    }
+
+    inline void WriteName(std::string* pBuffer, char const* pName)
+    {
+        if (!pName)
+        {
+            pName = "" ;
+        }
+
+        uint64_t index ;
+        if (FindInDictionary(pName, &index))
+        {
+            WriteVarint(pBuffer, index + 1) ;
+        }
+        else
+        {
+            WriteVarint(pBuffer, 0) ;
+            WriteBytes(pBuffer, pName, strlen(pName)) ;
+        }
+    }
+
+    inline void WriteValue(std::string* pBuffer, char const* pValue)
+    {
+        uint64_t index ;
+        int64_t integer ;
+
+        if (IsCanonicalInteger(pValue, &integer))
+        {
+            pBuffer->push_back(static_cast<char>(kValueInteger)) ;
+            // Zigzag so small negative numbers stay short
+            WriteVarint(pBuffer, (static_cast<uint64_t>(integer) << 1) ^ static_cast<uint64_t>(integer >> 63)) ;
+        }
+        else if (FindInDictionary(pValue, &index))
+        {
+            pBuffer->push_back(static_cast<char>(kValueName)) ;
+            WriteVarint(pBuffer, index) ;
+        }
+        else
+        {
+            pBuffer->push_back(static_cast<char>(kValueString)) ;
+            WriteBytes(pBuffer, pValue, strlen(pValue)) ;
+        }
+    }
+
+    void WriteElement(std::string* pBuffer, ElementXML_Handle hXML)
+    {
+        WriteName(pBuffer, soarxml_GetTagName(hXML)) ;
+
+        int numberAttributes = soarxml_GetNumberAttributes(hXML) ;
+        WriteVarint(pBuffer, numberAttributes) ;
+        for (int i = 0 ; i < numberAttributes ; i++)
+        {
+            WriteName(pBuffer, soarxml_GetAttributeName(hXML, i)) ;
+            WriteValue(pBuffer, soarxml_GetAttributeValue(hXML, i)) ;
+        }
+
+        // Empty comments and character data aren't sent, just as they
+        // wouldn't survive a trip through XML.
+        char const* pComment = soarxml_GetComment(hXML) ;
+        size_t commentLength = pComment ? strlen(pComment) : 0 ;
+        int dataLength = soarxml_GetCharacterDataLength(hXML) ;
+        bool binary = soarxml_IsCharacterDataBinary(hXML) ;
+
+        unsigned char flags = 0 ;
+        if (commentLength > 0)
+        {
+            flags |= kHasComment ;
+        }
+        if (dataLength > 0)
+        {
+            flags |= binary ? kHasBinary : kHasText ;
+        }
+        pBuffer->push_back(static_cast<char>(flags)) ;
+
+        if (flags & kHasComment)
+        {
+            WriteBytes(pBuffer, pComment, commentLength) ;
+        }
+        if (dataLength > 0)
+        {
+            WriteBytes(pBuffer, soarxml_GetCharacterData(hXML), dataLength) ;
+        }
+
+        int numberChildren = soarxml_GetNumberChildren(hXML) ;
+        WriteVarint(pBuffer, numberChildren) ;
+        for (int i = 0 ; i < numberChildren ; i++)
+        {
+            WriteElement(pBuffer, soarxml_GetChild(hXML, i)) ;
+        }
+    }
+
+    /////////////////////////////////////////////////////////////////
+    // Reading
+    /////////////////////////////////////////////////////////////////
+
+    // Reads a message that has been copied into its root element's arena.
+    // Strings are left where they are in the copy (rather than each being
+    // copied out), so the message's elements just point into it.
+    class Reader
+    {
+        public:
+            Reader(char* pBuffer, size_t length, ElementXML_Handle hRoot)
+            {
+                m_pNext  = reinterpret_cast<unsigned char*>(pBuffer) ;
+                m_pEnd   = m_pNext + length ;
+                m_hRoot  = hRoot ;
+            }
+
+            bool ReadByte(unsigned char* pByte)
+            {
+                if (m_pNext == m_pEnd)
+                {
+                    return false ;
+                }
+                *pByte = *m_pNext++ ;
+                return true ;
+            }
+
+            bool ReadVarint(uint64_t* pValue)
+            {
+                uint64_t value = 0 ;
+                for (int shift = 0 ; shift < 64 ; shift += 7)
+                {
+                    unsigned char byte ;
+                    if (!ReadByte(&byte))
+                    {
+                        return false ;
+                    }
+                    value |= static_cast<uint64_t>(byte & 0x7F) << shift ;
+                    if (!(byte & 0x80))
+                    {
+                        *pValue = value ;
+                        return true ;
+                    }
+                }
+                return false ;
+            }
+
+            // Reads a length-prefixed string, returning a null terminated string in the buffer.
+            // The string is moved back one byte, over the end of the length we've just read,
+            // to make room for the null.
+            bool ReadString(char const** ppString, int* pLength)
+            {
+                uint64_t length ;
+                if (!ReadVarint(&length) || length > static_cast<uint64_t>(m_pEnd - m_pNext) || length > 0x7FFFFFFF)
+                {
+                    return false ;
+                }
+
+                char* pString = reinterpret_cast<char*>(m_pNext - 1) ;
+                memmove(pString, m_pNext, static_cast<size_t>(length)) ;
+                pString[length] = 0 ;
+                m_pNext += length ;
+
+                *ppString = pString ;
+                if (pLength)
+                {
+                    *pLength = static_cast<int>(length) ;
+                }
+                return true ;
+            }
+
+            // Reads a name, which is either from the dictionary or in the buffer.
+            bool ReadName(char const** ppName)
+            {
+                uint64_t index ;
+                if (!ReadVarint(&index))
+                {
+                    return false ;
+                }
+
+                // 0 means the name follows as a string, n is entry n-1
+                if (index == 0)
+                {
+                    return ReadString(ppName, NULL) ;
+                }
+
+                uint64_t entry = index - 1 ;
+                if (entry >= kDictionarySize)
+                {
+                    return false ;
+                }
+                *ppName = kDictionary[entry] ;
+                return true ;
+            }
+
+            bool ReadValue(char const** ppValue)
+            {
+                unsigned char type ;
+                uint64_t value ;
+                if (!ReadByte(&type))
+                {
+                    return false ;
+                }
+
+                switch (type)
+                {
+                    case kValueString:
+                        return ReadString(ppValue, NULL) ;
+
+                    case kValueInteger:
+                    {
+                        if (!ReadVarint(&value))
+                        {
+                            return false ;
+                        }
+                        int64_t integer = static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1) ;
+                        char* pString = soarxml_AllocateElementString(m_hRoot, 20) ;
+                        snprintf(pString, 21, "%lld", static_cast<long long>(integer)) ;
+                        *ppValue = pString ;
+                        return true ;
+                    }
+
+                    case kValueName:
+                        if (!ReadVarint(&value) || value >= kDictionarySize)
+                        {
+                            return false ;
+                        }
+                        *ppValue = kDictionary[value] ;
+                        return true ;
+
+                    default:
+                        return false ;
+                }
+            }
+
+            bool AtEnd() const
+            {
+                return m_pNext == m_pEnd ;
+            }
+
+        private:
+            unsigned char*      m_pNext ;
+            unsigned char*      m_pEnd ;
+            ElementXML_Handle   m_hRoot ;
+    } ;
+
+    // Fills in hXML from the reader.  On failure hXML may be partly filled in,
+    // but everything read so far is owned by it.  depth is 1 for the root.
+    bool ReadElement(Reader* pReader, ElementXML_Handle hXML, int depth)
+    {
+        char const* pName ;
+
+        if (depth > kMaxDepth)
+        {
+            return false ;
+        }
+
+        if (!pReader->ReadName(&pName))
+        {
+            return false ;
+        }
+        soarxml_SetTagNameFast(hXML, pName) ;
+
+        uint64_t numberAttributes ;
+        if (!pReader->ReadVarint(&numberAttributes))
+        {
+            return false ;
+        }
+        for (uint64_t i = 0 ; i < numberAttributes ; i++)
+        {
+            char const* pValue ;
+
+            if (!pReader->ReadName(&pName) || !pReader->ReadValue(&pValue))
+            {
+                return false ;
+            }
+
+            soarxml_AddAttributeFastFast(hXML, pName, pValue) ;
+        }
+
+        unsigned char flags ;
+        if (!pReader->ReadByte(&flags))
+        {
+            return false ;
+        }
+
+        if (flags & kHasComment)
+        {
+            char const* pComment ;
+            if (!pReader->ReadString(&pComment, NULL))
+            {
+                return false ;
+            }
+            soarxml_SetComment(hXML, pComment) ;
+        }
+
+        if (flags & (kHasText | kHasBinary))
+        {
+            char const* pData ;
+            int length ;
+            if (!pReader->ReadString(&pData, &length))
+            {
+                return false ;
+            }
+            if (flags & kHasBinary)
+            {
+                soarxml_SetBinaryCharacterDataFast(hXML, pData, length) ;
+            }
+            else
+            {
+                soarxml_SetCharacterDataFast(hXML, pData) ;
+            }
+        }
+
+        uint64_t numberChildren ;
+        if (!pReader->ReadVarint(&numberChildren))
+        {
+            return false ;
+        }
+        for (uint64_t i = 0 ; i < numberChildren ; i++)
+        {
+            // The parent owns the child from here on, even if it's incomplete
+            ElementXML_Handle hChild = soarxml_AddNewChild(hXML) ;
+
+            if (!ReadElement(pReader, hChild, depth + 1))
+            {
+                return false ;
+            }
+        }
+
+        return true ;
+    }
+}
+
+bool BinaryEncoding::IsBinaryMessage(char const* pBuffer, size_t length)
+{
+    return length > 0 && static_cast<unsigned char>(pBuffer[0]) == kMagic ;
+}
+
+void BinaryEncoding::EncodeMessage(ElementXML const* pMsg, std::string* pBuffer)
+{
+    pBuffer->push_back(static_cast<char>(kMagic)) ;
+    pBuffer->push_back(static_cast<char>(kVersion)) ;
+
+    WriteElement(pBuffer, pMsg->GetXMLHandle()) ;
+}
+
+ElementXML* BinaryEncoding::DecodeMessage(char const* pBuffer, size_t length)
+{
+    if (length < 2 || static_cast<unsigned char>(pBuffer[0]) != kMagic || static_cast<unsigned char>(pBuffer[1]) != kVersion || length > 0x7FFFFFFF)
+    {
+        return NULL ;
+    }
+
+    // The whole message lives in one arena, starting with a copy of the buffer
+    // that its strings are read in place from.
+    ElementXML* pMsg = new ElementXML(soarxml_NewMessageElementXML(static_cast<int>(length) * 2)) ;
+
+    char* pCopy = soarxml_AllocateElementString(pMsg->GetXMLHandle(), static_cast<int>(length)) ;
+    memcpy(pCopy, pBuffer, length) ;
+
+    Reader reader(pCopy + 2, length - 2, pMsg->GetXMLHandle()) ;
+
+    if (!ReadElement(&reader, pMsg->GetXMLHandle(), 1) || !reader.AtEnd())
+    {
+        delete pMsg ;
+        return NULL ;
+    }
+
+    return pMsg ;
+}
+
+void BinaryEncoding::AddVersionOffer(std::string* pXML)
+{
+    // The root's tag name ends at the first space, '/' or '>' after its '<',
+    // skipping over a comment the message may start with
+    size_t start = 0 ;
+    if (pXML->compare(0, 4, "<!--") == 0)
+    {
+        start = pXML->find("-->") ;
+        if (start == std::string::npos)
+        {
+            return ;
+        }
+    }
+
+    start = pXML->find('<', start) ;
+    size_t nameEnd = (start == std::string::npos) ? start : pXML->find_first_of(" \t\r\n/>", start + 1) ;
+    if (nameEnd == std::string::npos)
+    {
+        return ;
+    }
+
+    pXML->insert(nameEnd, std::string(" ") + sml_Names::kBinaryEncoding + "=\"" + kVersionValue + "\"") ;
+}
@@ -0,0 +1,85 @@
+/////////////////////////////////////////////////////////////////
+// BinaryEncoding class
+//
+// A compact binary form of an SML message, used in place of XML text
+// over remote connections once both sides have said they can read it.
+//
+// A message is a 0 byte (XML always starts with '<' so the two can't be
+// confused), a version byte and then the root element.  Each element is:
+//
+//   name            tag name
+//   varint          number of attributes, then for each a name and a value
+//   byte            flags (comment, text character data, binary character data)
+//   [string]        comment, if flagged
+//   [string]        character data, if flagged
+//   varint          number of children, then each child element
+//
+// A name is a varint: 0 means a string follows, n means entry n-1 of a
+// fixed dictionary of the names SML uses.  A value is a type byte followed
+// by a string, a zigzag varint (for canonical decimal integers) or a
+// dictionary index.  A string is a varint length followed by its bytes.
+//
+// The dictionary is part of the format: entries may only be appended,
+// and changing the meaning of an existing one needs a new version.
+//
+// A message whose elements nest more than 1000 deep is not decoded.
+//
+/////////////////////////////////////////////////////////////////
+
+#ifndef SML_BINARY_ENCODING_H
+#define SML_BINARY_ENCODING_H
+
+#include "Export.h"
+
+#include <string>
+#include <stddef.h>
+
+namespace soarxml
+{
+    class ElementXML ;
+}
+
+namespace sml
+{
+
+    class EXPORT BinaryEncoding
+    {
+        public:
+            // The version this code writes (and the highest it reads)
+            static char const* const kVersionValue ;
+
+            /*************************************************************
+            * @brief Returns true if the buffer holds a binary encoded message
+            *        rather than XML text.
+            *************************************************************/
+            static bool IsBinaryMessage(char const* pBuffer, size_t length) ;
+
+            /*************************************************************
+            * @brief Appends the binary encoding of the message (and all
+            *        of its children) to the buffer.
+            *************************************************************/
+            static void EncodeMessage(soarxml::ElementXML const* pMsg, std::string* pBuffer) ;
+
+            /*************************************************************
+            * @brief Builds a message from its binary encoding.
+            *
+            * @returns NULL if the buffer is malformed, nests elements too
+            *          deeply or was written in a version we can't read.
+            *          The caller owns the result.
+            *************************************************************/
+            static soarxml::ElementXML* DecodeMessage(char const* pBuffer, size_t length) ;
+
+            /*************************************************************
+            * @brief Adds a binaryencoding attribute, telling the reader we
+            *        can read binary messages, to the root start tag of a
+            *        message that has been written out as XML text.
+            *
+            *        Only the text changes, so the message it was generated
+            *        from is left as the caller built it.
+            *************************************************************/
+            static void AddVersionOffer(std::string* pXML) ;
+    };
+
+} // End of namespace
+
+#endif // SML_BINARY_ENCODING_H
@@ -21,6 +21,7 @@
 
 #include "sml_Utils.h"
 #include "sml_Connection.h"
+#include "sml_MessageWaiter.h"
 #include "ElementXML.h"
 #include "sml_MessageSML.h"
 #include "sml_EmbeddedConnection.h"
@@ -39,6 +40,7 @@
 #include "sock_ClientNamedPipe.h"
 #endif
 
+#include <assert.h>
 #include <time.h>   // For debug random start of message id's
 #include <sstream>
 
@@ -64,6 +66,7 @@ Connection::Connection()
     m_bIsDirectConnection = false ;
     m_bTraceCommunications = false ;
     m_bIsKernelSide = false ;
+    m_PipelinedResponses = 0 ;
     
     m_Timer.reset();
     m_IncomingTime.reset();
@@ -519,6 +522,15 @@ bool Connection::SendMessageGetResponse(AnalyzeXML* pAnalysis, ElementXML* pMsg)
         return false ;
     }
     
+    return AnalyzeResponse(pAnalysis, pResponse) ;
+}
+
+/*************************************************************
+* @brief Analyzes the response to a call and deletes it.
+*        Returns true if it's valid SML and isn't an error.
+*************************************************************/
+bool Connection::AnalyzeResponse(AnalyzeXML* pAnalysis, ElementXML* pResponse)
+{
     // Analyze the response and return the analysis
     pAnalysis->Analyze(pResponse) ;
     
@@ -546,6 +558,95 @@ bool Connection::SendMessageGetResponse(AnalyzeXML* pAnalysis, ElementXML* pMsg)
     return true ;
 }
 
+/*************************************************************
+* @brief Send a series of messages, in order.
+*        Connections that can do better override this.
+*************************************************************/
+void Connection::SendMsgs(ElementXML* const* pMsgs, int count)
+{
+    ClearError() ;
+    
+    for (int i = 0 ; i < count && !HadError() ; i++)
+    {
+        SendMsg(pMsgs[i]) ;
+    }
+}
+
+/*************************************************************
+* @brief Send a series of call messages without waiting for
+*        their responses.
+*************************************************************/
+bool Connection::SendPipelinedMessages(ElementXML* const* pMsgs, int count)
+{
+    // If the connection is already closed, don't do anything
+    if (IsClosed() || count <= 0)
+    {
+        return false ;
+    }
+    
+    // A synchronous connection would throw away all but the last response
+    assert(IsAsynchronous() && "Pipelined messages need an asynchronous connection") ;
+    
+    soar_thread::Lock lock(&m_ClientMutex) ;
+    
+    SendMsgs(pMsgs, count) ;
+    
+    if (HadError())
+    {
+        return false ;
+    }
+    
+    // From here on responses we read are kept until they're collected
+    m_PipelinedResponses += count ;
+    
+    return true ;
+}
+
+/*************************************************************
+* @brief Collect the response to a message sent with
+*        SendPipelinedMessages().
+*************************************************************/
+bool Connection::GetPipelinedResponse(AnalyzeXML* pAnalysis, char const* pID, bool wait, bool* pFinished)
+{
+    soar_thread::Lock lock(&m_ClientMutex) ;
+    
+    ClearError() ;
+    
+    ElementXML* pResponse = GetResponseForID(pID, wait) ;
+    
+    // Still waiting for it
+    if (!pResponse && !wait && !IsClosed())
+    {
+        *pFinished = false ;
+        return false ;
+    }
+    
+    *pFinished = true ;
+    m_PipelinedResponses-- ;
+    
+    if (!pResponse)
+    {
+        if (!HadError())
+        {
+            SetError(Error::kFailedToGetResponse) ;
+        }
+        return false ;
+    }
+    
+    return AnalyzeResponse(pAnalysis, pResponse) ;
+}
+
+/*************************************************************
+* @brief Record that the response to a pipelined message
+*        will never be collected.
+*************************************************************/
+void Connection::AbandonPipelinedResponse()
+{
+    soar_thread::Lock lock(&m_ClientMutex) ;
+    
+    m_PipelinedResponses-- ;
+}
+
 /*************************************************************
 * @brief Build an SML message and send it over the connection
 *        returning the analyzed version of the response.
@@ -1082,6 +1183,33 @@ void Connection::AddSimpleResultToSMLResponse(ElementXML* pResponse, char const*
     pResponse->AddChild(pTag) ;
 }
 
+/*************************************************************
+* @brief Registers a waiter to be woken when a message arrives.
+*
+*        The base class only records it: connections with an
+*        incoming message queue signal it as messages are queued
+*        and remote connections also have it watch their socket.
+*************************************************************/
+void Connection::AddMessageWaiter(MessageWaiter* pWaiter)
+{
+    soar_thread::Lock lock(&m_IncomingMutex) ;
+    
+    m_MessageWaiters.push_back(pWaiter) ;
+    
+    // If messages are already waiting, make sure the waiter sees them
+    if (!m_IncomingMessageQueue.empty())
+    {
+        pWaiter->Signal() ;
+    }
+}
+
+void Connection::RemoveMessageWaiter(MessageWaiter* pWaiter)
+{
+    soar_thread::Lock lock(&m_IncomingMutex) ;
+    
+    m_MessageWaiters.remove(pWaiter) ;
+}
+
 /*************************************************************
 * @brief Removes the top message from the incoming message queue
 *        in a thread safe way.
@@ -64,6 +64,7 @@ namespace sml
     class ConnectionManager ;
     class Connection ;
     class AnalyzeXML ;
+    class MessageWaiter ;
     
 // Define the ListenerCallback to pass the new connection and some user data.
     typedef void (*ListenerCallback)(Connection*, void*);
@@ -162,6 +163,9 @@ namespace sml
             // We use this mutex to serialize acccess to the incoming message queue (for certain types of connections)
             soar_thread::Mutex  m_IncomingMutex ;
             
+            // Threads waiting for messages to arrive on this connection (guarded by m_IncomingMutex)
+            std::list<MessageWaiter*>   m_MessageWaiters ;
+            
             // True if we can make direct calls to gSKI to optimize I/O
             bool m_bIsDirectConnection ;
             
@@ -177,6 +181,9 @@ namespace sml
             // alive even when the client itself goes to sleep.
             soar_thread::Mutex  m_ClientMutex ;
             
+            // The number of messages sent with SendPipelinedMessages() whose responses haven't been collected (guarded by m_ClientMutex)
+            int         m_PipelinedResponses ;
+            
             // This information can be requested and set by clients, so one client can
             // find out who else is connected.
             std::string m_ID ;          // Unique ID, machine generated (by kernel)
@@ -274,6 +281,33 @@ namespace sml
                 return m_bIsDirectConnection ;
             }
             
+            /*************************************************************
+            * @brief Moves a remote connection to a kernel on this machine
+            *        from its socket to a shared memory segment, if both
+            *        sides can.  Connections only do this when asked.
+            *
+            * @returns False if this connection can't, in which case it
+            *          carries on as before.
+            *************************************************************/
+            virtual bool UseSharedMemory()
+            {
+                return false ;
+            }
+            
+            /*************************************************************
+            * @brief The kernel side of switching a remote connection over to
+            *        shared memory (see UseSharedMemory()).
+            *        Opens the segment the client created, and starts using it
+            *        once the response to the current command has been sent.
+            *
+            * @returns False if this connection can't use the segment, in which
+            *          case it carries on as before.
+            *************************************************************/
+            virtual bool AcceptSharedMemory(char const* /*pSegmentName*/)
+            {
+                return false ;
+            }
+            
             /*************************************************************
             * @brief Print out debug information about the messages we are sending and receiving.
             *        Currently only affects remote connections, but we may extend things.
@@ -311,6 +345,13 @@ namespace sml
             *************************************************************/
             virtual void SendMsg(soarxml::ElementXML* pMsg) = 0 ;
             
+            /*************************************************************
+            * @brief Send a series of messages, in order.  This is the same as
+            *        calling SendMsg() for each, except that a remote connection
+            *        ships them all in a single write.
+            *************************************************************/
+            virtual void SendMsgs(soarxml::ElementXML* const* pMsgs, int count) ;
+            
             /*************************************************************
             * @brief Retrieve any commands, notifications, responses etc. that are waiting.
             *        Messages that are received are routed to callback functions in the client for processing.
@@ -328,6 +369,16 @@ namespace sml
             *************************************************************/
             virtual bool ReceiveMessages(bool allMessages) = 0 ;
             
+            /*************************************************************
+            * @brief Registers a waiter (see sml_MessageWaiter.h) to be woken when a
+            *        message arrives on this connection, so a thread can sleep until
+            *        there's something for ReceiveMessages() to read rather than polling.
+            *
+            *        Remove the waiter before deleting it or this connection.
+            *************************************************************/
+            virtual void AddMessageWaiter(MessageWaiter* pWaiter) ;
+            virtual void RemoveMessageWaiter(MessageWaiter* pWaiter) ;
+            
             /*************************************************************
             * @brief Retrieve the response to the last call message sent.
             *
@@ -487,6 +538,41 @@ namespace sml
             *************************************************************/
             bool SendMessageGetResponse(AnalyzeXML* pAnalysis, soarxml::ElementXML* pMsg) ;
             
+            /*************************************************************
+            * @brief Send a series of call messages without waiting for their
+            *        responses, so they are all in flight together.  Collect each
+            *        response later with GetPipelinedResponse() (or give up on it
+            *        with AbandonPipelinedResponse()).
+            *
+            *        Until every response has been collected, responses read
+            *        from the connection (on any thread) are kept for their
+            *        owners rather than being thrown away.
+            *
+            *        This needs an asynchronous connection.  A synchronous one
+            *        executes each message as it's sent and only holds on to the
+            *        last response, so use SendMessageGetResponse() there.
+            *
+            * @returns  True if the messages were sent.
+            *************************************************************/
+            bool SendPipelinedMessages(soarxml::ElementXML* const* pMsgs, int count) ;
+            
+            /*************************************************************
+            * @brief Collect the response to a message sent with SendPipelinedMessages().
+            *
+            * @param pAnalysis  This will be filled in with the analyzed response
+            * @param pID        The id of the message we sent
+            * @param wait       If false and the response hasn't arrived yet, return at once
+            * @param pFinished  Set to false if we didn't wait and the response hasn't arrived
+            * @returns          True if got a reply and there were no errors.
+            *************************************************************/
+            bool GetPipelinedResponse(AnalyzeXML* pAnalysis, char const* pID, bool wait, bool* pFinished) ;
+            
+            /*************************************************************
+            * @brief Record that the response to a pipelined message will
+            *        never be collected, so we can stop keeping responses for it.
+            *************************************************************/
+            void AbandonPipelinedResponse() ;
+            
             /*************************************************************
             * @brief Build an SML message and send it over the connection
             *        returning the analyzed version of the response.
@@ -694,6 +780,12 @@ namespace sml
             **************************************************************/
             virtual CallbackList* GetCallbackList(char const* pType) ;
             
+            /*************************************************************
+            * @brief Analyzes the response to a call and deletes it.
+            *        Returns true if it's valid SML and isn't an error.
+            **************************************************************/
+            bool AnalyzeResponse(AnalyzeXML* pAnalysis, soarxml::ElementXML* pResponse) ;
+            
             /*************************************************************
             * @brief Removes the top message from the incoming message queue
             *        in a thread safe way.
@@ -131,7 +131,8 @@ void EmbeddedConnectionAsynch::AddResponseToList(ElementXML* pResponse)
     // that will never be retrieved.  I believe (but haven't conclusively proved to my satisfaction yet)
     // that we will never have more messages pending here, for which the client is interested in the
     // response, than there are threads sending commands, so a small max list size should be fine.
-    while (m_ReceivedMessageList.size() > kMaxListSize)
+    // Pipelined commands can each have a response waiting here too, so we allow for those.
+    while (m_ReceivedMessageList.size() > kMaxListSize + static_cast<size_t>(m_PipelinedResponses > 0 ? m_PipelinedResponses : 0))
     {
         if (m_bTraceCommunications)
         {
@@ -272,6 +273,12 @@ ElementXML* EmbeddedConnectionAsynch::GetResponseForID(char const* pID, bool wai
             return pResponse ;
         }
         
+        // If we're not waiting, we only look at what's already arrived
+        if (!wait)
+        {
+            break ;
+        }
+        
 #ifdef PROFILE_CONNECTIONS
         m_Timer.start() ;
 #endif
@@ -339,8 +346,16 @@ bool EmbeddedConnectionAsynch::ReceiveMessages(bool allMessages)
         // We're done with the response
         delete pResponse ;
         
-        // Record the last incoming message
-        delete m_pLastResponse ;
+        // Record the last incoming message.  While pipelined commands are in flight
+        // the one it replaces may be a response that's still to be collected, so keep it.
+        if (m_PipelinedResponses > 0)
+        {
+            AddResponseToList(m_pLastResponse) ;
+        }
+        else
+        {
+            delete m_pLastResponse ;
+        }
         m_pLastResponse = pIncomingMsg ;
         
         // If we're only asked to read one message, we're done.
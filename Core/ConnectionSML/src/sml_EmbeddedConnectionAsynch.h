@@ -14,6 +14,7 @@
 #define SML_EMBEDDEDCONNECTION_ASYNCH_H
 
 #include "sml_Connection.h"
+#include "sml_MessageWaiter.h"
 #include "sml_EmbeddedConnection.h"
 #include "thread_Event.h"
 
@@ -66,6 +67,12 @@ namespace sml
                 
                 // Wake up anybody who's waiting for a response
                 m_WaitEvent.TriggerEvent() ;
+                
+                // And any thread waiting to receive messages
+                for (std::list<MessageWaiter*>::iterator iter = m_MessageWaiters.begin() ; iter != m_MessageWaiters.end() ; iter++)
+                {
+                    (*iter)->Signal() ;
+                }
             }
             
             virtual bool IsAsynchronous()
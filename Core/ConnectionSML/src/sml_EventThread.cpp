@@ -22,7 +22,6 @@
 #include "sml_EventThread.h"
 #include "sml_Connection.h"
 
-#include <time.h>   // To get clock
 
 using namespace sml ;
 
@@ -53,68 +52,32 @@ EventThread::EventThread(Connection* pConnection)
 * By putting this in "SendMessageGetResponse" the client itself will lock
 * out this thread for long periods (e.g. during an entire "run" call).
 *
-* Then when this thread is functional, it's either polling really
-* fast (Sleep(0)) or pausing for decent spans (Sleep(5)) which
-* will lead to close to 0% CPU usage when everyone is sleeping
-* (empirical tests on my laptop show 0%).
+* Between calls the thread sleeps on a MessageWaiter, which the
+* connection wakes as soon as a message arrives (on the socket for a
+* remote connection, or in the incoming queue for an embedded one).
+* So events are handled as soon as they come in, without using any
+* CPU while everyone is sleeping.
 *************************************************************/
 void EventThread::Run()
 {
-    // When we last received a message (if its recent we barely sleep so we're maximally responsive)
-    clock_t last = 0 ;
+    m_pConnection->AddMessageWaiter(&m_Waiter) ;
     
-    // How long to wait before sleeping (currently 1 sec)
-    clock_t delay = CLOCKS_PER_SEC ;
-    /*
-    #ifdef _DEBUG
-        sml::PrintDebugFormat("Starting EventThread\n") ;
-        int64_t counter = 0 ;
-    #endif
-    */
     while (!m_QuitNow && !m_pConnection->IsClosed())
     {
         // Our purpose is to check for incoming messages when the
         // client itself is sleeping for some reason.  It makes
         // the client logic simpler.
-        bool receivedMessage = m_pConnection->ReceiveMessages(true) ;
+        m_pConnection->ReceiveMessages(true) ;
         
-        if (receivedMessage)
-        {
-            // Record the time of the last incoming message
-            last = clock() ;
-        }
-        
-        /*
-        #ifdef _DEBUG
-                counter++ ;
-                if (counter % 1000 == 0)
-                    sml::PrintDebugFormat("EventThread alive\n") ;
-        #endif
-        */
-        clock_t current = clock() ;
-        
-        // If it's been a while since the last incoming message
-        // then start sleeping a reasonable amount.
-        // Sleep(0) just allows other threads to run before we continue
-        // to execute.
-        if (current - last > delay)
-        {
-            sml::Sleep(0, 5) ;
-        }
-        else
-            // Changed this to always use sleep 5 now.
-            // Calling sleep(0) here as we used to can cause a single threaded app
-            // to take over the CPU, slowing down the entire system.  Doesn't happen
-            // on a hyper threaded CPU, but on a normal CPU it's a significant problem.
-            // The trade-off is that the response to events may not be quite as fast.
-        {
-            sml::Sleep(0, 5) ;
-        }
+        // Sleep until there's another message.  The timeout is just a safety net
+        // (e.g. so we notice if the connection closes without waking us).
+        m_Waiter.Wait(1, 0) ;
     }
     
-    /*
-    #ifdef _DEBUG
-        sml::PrintDebugFormat("EventThread terminated\n") ;
-    #endif
-    */
+    m_pConnection->RemoveMessageWaiter(&m_Waiter) ;
+}
+
+void EventThread::Wake()
+{
+    m_Waiter.Signal() ;
 }
@@ -20,6 +20,7 @@
 #define SML_EVENT_THREAD_H
 
 #include "thread_Thread.h"
+#include "sml_MessageWaiter.h"
 
 namespace sml
 {
@@ -32,6 +33,11 @@ namespace sml
         protected:
             Connection* m_pConnection ;
             
+            // Wakes us when a message arrives on the connection
+            MessageWaiter m_Waiter ;
+            
+            void Wake() ;
+            
         public:
             EventThread(Connection* pConnection) ;
             void Run() ;
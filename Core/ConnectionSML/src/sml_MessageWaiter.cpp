@@ -0,0 +1,176 @@
+#include "portability.h"
+
+/////////////////////////////////////////////////////////////////
+// MessageWaiter class
+//
+// Lets a thread sleep until there's a message for it to read,
+// rather than polling its connections and sleeping in between.
+//
+/////////////////////////////////////////////////////////////////
+
+#include "sml_MessageWaiter.h"
+#include "sml_Utils.h"
+
+#include <assert.h>
+
+#ifdef __linux__
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
+using namespace sml ;
+
+#ifdef __linux__
+
+MessageWaiter::MessageWaiter()
+{
+    m_EpollDescriptor  = epoll_create1(EPOLL_CLOEXEC) ;
+    m_SignalDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC) ;
+
+    if (m_EpollDescriptor == -1 || m_SignalDescriptor == -1)
+    {
+        sml::PrintDebug("Error: Unable to create the descriptors to wait for messages on") ;
+        return ;
+    }
+
+    Watch(m_SignalDescriptor) ;
+}
+
+MessageWaiter::~MessageWaiter()
+{
+    if (m_SignalDescriptor != -1)
+    {
+        close(m_SignalDescriptor) ;
+    }
+    if (m_EpollDescriptor != -1)
+    {
+        close(m_EpollDescriptor) ;
+    }
+}
+
+void MessageWaiter::Watch(int descriptor)
+{
+    if (descriptor == -1 || m_EpollDescriptor == -1)
+    {
+        return ;
+    }
+
+    epoll_event event ;
+    event.events  = EPOLLIN ;
+    event.data.fd = descriptor ;
+
+    // EEXIST just means we're already watching it
+    epoll_ctl(m_EpollDescriptor, EPOLL_CTL_ADD, descriptor, &event) ;
+}
+
+void MessageWaiter::Unwatch(int descriptor, bool closed)
+{
+    if (descriptor == -1 || closed || m_EpollDescriptor == -1)
+    {
+        return ;
+    }
+
+    // (The kernel needs a non-null event pointer here on older versions)
+    epoll_event event ;
+    epoll_ctl(m_EpollDescriptor, EPOLL_CTL_DEL, descriptor, &event) ;
+}
+
+void MessageWaiter::Signal()
+{
+    if (m_SignalDescriptor == -1)
+    {
+        return ;
+    }
+
+    uint64_t one = 1 ;
+    ssize_t res = write(m_SignalDescriptor, &one, sizeof(one)) ;
+    (void)res ; // Can only fail if the counter is about to overflow, in which case the waiter will wake anyway
+}
+
+bool MessageWaiter::Wait(int secondsWait, int millisecondsWait)
+{
+    assert(millisecondsWait < 1000 && "specified milliseconds must be less than 1000");
+
+    if (m_EpollDescriptor == -1)
+    {
+        sml::Sleep(0, 5) ;
+        return false ;
+    }
+
+    enum { kMaxEvents = 16 } ;
+    epoll_event events[kMaxEvents] ;
+
+    int count = epoll_wait(m_EpollDescriptor, events, kMaxEvents, secondsWait * 1000 + millisecondsWait) ;
+
+    for (int i = 0 ; i < count ; i++)
+    {
+        // Reset the signal.  Sockets stay ready until they're read.
+        if (events[i].data.fd == m_SignalDescriptor)
+        {
+            uint64_t value ;
+            ssize_t res = read(m_SignalDescriptor, &value, sizeof(value)) ;
+            (void)res ;
+        }
+    }
+
+    // An error here is EINTR, which is the same to our callers as timing out
+    return count > 0 ;
+}
+
+#else // __linux__
+
+// How often we wake to check sockets, since we can't wait on them and an event together
+static const int kSocketCheckMilliseconds = 5 ;
+
+MessageWaiter::MessageWaiter()
+{
+    m_NumberWatched = 0 ;
+}
+
+MessageWaiter::~MessageWaiter()
+{
+}
+
+void MessageWaiter::Watch(int descriptor)
+{
+    if (descriptor == -1)
+    {
+        return ;
+    }
+
+    soar_thread::Lock lock(&m_WatchMutex) ;
+    m_NumberWatched++ ;
+}
+
+void MessageWaiter::Unwatch(int descriptor, bool /*closed*/)
+{
+    if (descriptor == -1)
+    {
+        return ;
+    }
+
+    soar_thread::Lock lock(&m_WatchMutex) ;
+    m_NumberWatched-- ;
+}
+
+void MessageWaiter::Signal()
+{
+    m_Event.TriggerEvent() ;
+}
+
+bool MessageWaiter::Wait(int secondsWait, int millisecondsWait)
+{
+    // If we have sockets to check, report a possible message at short intervals
+    // so the caller reads them (this is how we always used to poll).
+    if (m_NumberWatched > 0 && (secondsWait > 0 || millisecondsWait > kSocketCheckMilliseconds))
+    {
+        m_Event.WaitForEvent(0, kSocketCheckMilliseconds) ;
+        return true ;
+    }
+
+    return m_Event.WaitForEvent(secondsWait, millisecondsWait) ;
+}
+
+#endif // __linux__
@@ -0,0 +1,65 @@
+/////////////////////////////////////////////////////////////////
+// MessageWaiter class
+//
+// Lets a thread sleep until there's a message for it to read,
+// rather than polling its connections and sleeping in between.
+//
+// The thread waits on one of these objects.  It is woken when
+// one of the sockets it watches has data (or closes), or when
+// another thread signals it (e.g. because it has queued a message
+// on an embedded connection, or wants the waiting thread to stop).
+//
+// On Linux this is an epoll set plus an eventfd, so one thread can
+// wait on any number of connections at once.  Elsewhere it's an
+// event, and sockets are checked by waking at short intervals.
+//
+/////////////////////////////////////////////////////////////////
+
+#ifndef SML_MESSAGE_WAITER_H
+#define SML_MESSAGE_WAITER_H
+
+#include "Export.h"
+
+#ifndef __linux__
+#include "thread_Event.h"
+#include "thread_Lock.h"
+#endif
+
+namespace sml
+{
+
+    class EXPORT MessageWaiter
+    {
+        protected:
+#ifdef __linux__
+            int     m_EpollDescriptor ;
+            int     m_SignalDescriptor ;
+#else
+            soar_thread::Event  m_Event ;
+            soar_thread::Mutex  m_WatchMutex ;
+            int     m_NumberWatched ;
+#endif
+
+        public:
+            MessageWaiter() ;
+            ~MessageWaiter() ;
+
+            // Wake the waiting thread when this socket has data to read (or closes)
+            void Watch(int descriptor) ;
+
+            // Stop watching a socket.  Pass closed = true if the socket has been closed since
+            // it was watched (closing drops it already, and its descriptor may have been reused).
+            void Unwatch(int descriptor, bool closed) ;
+
+            // Wake the waiting thread.  If no thread is waiting, the next wait returns at once.
+            void Signal() ;
+
+            // Sleep until a watched socket has data, Signal() is called or the timeout passes.
+            // The timeout is secondsWait + millisecondsWait, where millisecondsWait < 1000.
+            // Returns false if we timed out.
+            bool Wait(int secondsWait, int millisecondsWait) ;
+    } ;
+
+} // Namespace
+
+#endif // SML_MESSAGE_WAITER_H
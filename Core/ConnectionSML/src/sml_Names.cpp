@@ -27,6 +27,7 @@ char const* const sml_Names::kDocType_Response  = "response" ;
 char const* const sml_Names::kDocType_Notify    = "notify" ;
 char const* const sml_Names::kSMLVersion        = "smlversion" ;
 char const* const sml_Names::kOutputLinkName    = "output-link" ;
+char const* const sml_Names::kBinaryEncoding    = "binaryencoding" ;  // Highest binary encoding version the sender can read (remote connections only)
 
 // Version strings
 char const* const sml_Names::kSoarVersionValue = VERSION_STRING();
@@ -441,6 +442,7 @@ char const* const sml_Names::kCommand_GetInitialTimeTag     = "initial_time_tag"
 char const* const sml_Names::kCommand_OutputInit            = "output_init" ;
 char const* const sml_Names::kCommand_ConvertIdentifier     = "convert_identifier";
 char const* const sml_Names::kCommand_GetListenerPort       = "get_listener_port";
+char const* const sml_Names::kCommand_SharedMemory          = "shared_memory" ;
 
 // command line interface
 char const* const sml_Names::kCommand_CommandLine        = "cmdline" ;
@@ -29,6 +29,7 @@ namespace sml
             static char const* const kDocType_Notify ;
             static char const* const kSMLVersion ;
             static char const* const kOutputLinkName ;
+            static char const* const kBinaryEncoding ;
 
             static const char* const kSoarVersionValue;
             static const char* const kSMLVersionValue;
@@ -431,6 +432,7 @@ namespace sml
             static char const* const kCommand_OutputInit ;
             static char const* const kCommand_ConvertIdentifier ;
             static char const* const kCommand_GetListenerPort ;
+            static char const* const kCommand_SharedMemory ;
 
             // Command line interface
             static char const* const kCommand_CommandLine ;
@@ -17,7 +17,12 @@
 
 #include "sml_Utils.h"
 #include "sml_RemoteConnection.h"
+#include "sml_BinaryEncoding.h"
+#include "sml_Names.h"
+#include "sml_MessageWaiter.h"
+#include "sml_AnalyzeXML.h"
 #include "sock_Socket.h"
+#include "sock_SharedMemory.h"
 #include "thread_Thread.h"
 
 #include <assert.h>
@@ -30,11 +35,15 @@ RemoteConnection::RemoteConnection(bool sharedFileSystem, sock::DataSender* pDat
     m_SharedFileSystem = sharedFileSystem ;
     m_DataSender = pDataSender ;
     m_pLastResponse = NULL ;
+    m_PeerReadsBinary = false ;
+    m_ReadDescriptor = pDataSender->GetReadDescriptor() ;
+    m_pPendingDataSender = NULL ;
 }
 
 RemoteConnection::~RemoteConnection()
 {
     delete m_pLastResponse ;
+    delete m_pPendingDataSender ;
     delete m_DataSender ;
     
     for (MessageListIter iter = m_ReceivedMessageList.begin() ; iter != m_ReceivedMessageList.end() ; iter++)
@@ -90,7 +99,8 @@ void RemoteConnection::AddResponseToList(ElementXML* pResponse)
     // that will never be retrieved.  I believe (but haven't conclusively proved to my satisfaction yet)
     // that we will never have more messages pending here, for which the client is interested in the
     // response, than there are threads sending commands, so a small max list size should be fine.
-    while (m_ReceivedMessageList.size() > kMaxListSize)
+    // Pipelined commands can each have a response waiting here too, so we allow for those.
+    while (m_ReceivedMessageList.size() > kMaxListSize + static_cast<size_t>(m_PipelinedResponses > 0 ? m_PipelinedResponses : 0))
     {
         if (m_bTraceCommunications)
         {
@@ -169,7 +179,9 @@ bool RemoteConnection::DoesResponseMatch(ElementXML* pResponse, char const* pID)
 * @brief Send a message to the other side of this connection.
 *
 * For an remote connection this is done by sending the command
-* over a socket as an actual XML string.
+* over a socket, either as an actual XML string or (once the
+* other side has told us it can read it) in the more compact
+* binary encoding.
 *
 * There is no immediate response because we have to wait for
 * the other side to read from the socket and execute the command.
@@ -177,30 +189,25 @@ bool RemoteConnection::DoesResponseMatch(ElementXML* pResponse, char const* pID)
 * and wait for the response to occur.
 *************************************************************/
 void RemoteConnection::SendMsg(ElementXML* pMsg)
+{
+    SendMsgs(&pMsg, 1) ;
+}
+
+/*************************************************************
+* @brief Send a series of messages over the socket in a single
+*        write, rather than paying for one per message.
+*************************************************************/
+void RemoteConnection::SendMsgs(ElementXML* const* pMsgs, int count)
 {
     ClearError() ;
     
-    // Convert the message to an XML string
-    char* pXMLString = pMsg->GenerateXMLString(true) ;
-    
-    // Send it
-    bool ok = m_DataSender->SendString(pXMLString) ;
-    
-    // Dump the message if we're tracing
-    if (m_bTraceCommunications)
+    std::string buffer ;
+    for (int i = 0 ; i < count ; i++)
     {
-        if (IsKernelSide())
-        {
-            sml::PrintDebugFormat("Kernel remote send: %s\n", pXMLString) ;
-        }
-        else
-        {
-            sml::PrintDebugFormat("Client remote send: %s\n", pXMLString) ;
-        }
+        AppendMessage(pMsgs[i], &buffer) ;
     }
     
-    // Release the XML string
-    pMsg->DeleteString(pXMLString) ;
+    bool ok = m_DataSender->SendStrings(buffer) ;
     
     // If we had an error close the connection
     if (!ok)
@@ -211,6 +218,72 @@ void RemoteConnection::SendMsg(ElementXML* pMsg)
     }
 }
 
+/*************************************************************
+* @brief Adds a message to the buffer we're about to send, either
+*        as an actual XML string or (once the other side has told
+*        us it can read it) in the more compact binary encoding.
+*************************************************************/
+void RemoteConnection::AppendMessage(ElementXML* pMsg, std::string* pBuffer)
+{
+    if (m_PeerReadsBinary)
+    {
+        std::string encoded ;
+        BinaryEncoding::EncodeMessage(pMsg, &encoded) ;
+        
+        sock::DataSender::AppendString(pBuffer, encoded.data(), static_cast<uint32_t>(encoded.size())) ;
+        
+        // Dump the message if we're tracing
+        if (m_bTraceCommunications)
+        {
+            TraceMessage("send", pMsg, NULL) ;
+        }
+    }
+    else
+    {
+        // Convert the message to an XML string
+        char* pXMLString = pMsg->GenerateXMLString(true) ;
+        std::string xml(pXMLString) ;
+        
+        // Release the XML string
+        pMsg->DeleteString(pXMLString) ;
+        
+        // Let the other side know it can send us binary messages.
+        // (Older versions ignore attributes they don't know about).
+        // The attribute only goes into the text we send, as the
+        // message belongs to the caller.
+        if (!pMsg->GetAttribute(sml_Names::kBinaryEncoding))
+        {
+            BinaryEncoding::AddVersionOffer(&xml) ;
+        }
+        
+        sock::DataSender::AppendString(pBuffer, xml.data(), static_cast<uint32_t>(xml.size())) ;
+        
+        // Dump the message if we're tracing
+        if (m_bTraceCommunications)
+        {
+            TraceMessage("send", pMsg, xml.c_str()) ;
+        }
+    }
+}
+
+/*************************************************************
+* @brief Prints a message we're sending or have received.
+*        Binary messages are printed as the XML they stand for.
+*************************************************************/
+void RemoteConnection::TraceMessage(char const* pDirection, ElementXML* pMsg, char const* pXMLString)
+{
+    char* pGenerated = NULL ;
+    if (!pXMLString)
+    {
+        pGenerated = pMsg->GenerateXMLString(true) ;
+        pXMLString = pGenerated ;
+    }
+    
+    sml::PrintDebugFormat("%s remote %s%s: %s\n", IsKernelSide() ? "Kernel" : "Client", pDirection, pGenerated ? " (binary)" : "", pXMLString) ;
+    
+    ElementXML::DeleteString(pGenerated) ;
+}
+
 /*************************************************************
 * @brief    Look for a response to the given message (based on its ID).
 *           Optionally, wait for that response to come in.
@@ -236,14 +309,12 @@ ElementXML* RemoteConnection::GetResponseForID(char const* pID, bool wait)
         return pResponse ;
     }
     
-    int sleepTimeSecs = 0 ;         // How long we sleep in seconds each pass through
-    int sleepTimeMillisecs = 0 ;        // How long we sleep in milliseconds each pass through
-    
     // How long we sleep on the socket waiting for data in msecs
     // We want to wait for a long time.  We used to set this to 0 and just poll the socket,
     // but that means we're consuming all of the CPU.  Setting a long wait doesn't
     // impact performance because we're not trying to do anything else other than get a response here.
-    int waitForMessageTimeSeconds = 1 ;
+    // (If we're not waiting, we only read what's already arrived).
+    int waitForMessageTimeSeconds = wait ? 1 : 0 ;
     int waitForMessageTimeMilliseconds = 0 ;
     
     // If we don't already have this response cached,
@@ -276,11 +347,6 @@ ElementXML* RemoteConnection::GetResponseForID(char const* pID, bool wait)
             return pResponse ;
         }
         
-        // Allow other threads the chance to update
-        // (by calling with 0 for sleep time we don't give away cycles if
-        //  no other thread is waiting to execute).
-        sml::Sleep(sleepTimeSecs, sleepTimeMillisecs) ;
-        
         // Check if the connection has been closed
         if (IsClosed())
         {
@@ -353,22 +419,40 @@ bool RemoteConnection::ReceiveMessages(bool allMessages, int secondsWait, int mi
             return receivedMessage ;
         }
         
-        // Dump the message if we're tracing
-        if (m_bTraceCommunications)
+        ElementXML* pIncomingMsg ;
+        
+        if (BinaryEncoding::IsBinaryMessage(xmlString.data(), xmlString.size()))
         {
-            if (IsKernelSide())
+            pIncomingMsg = BinaryEncoding::DecodeMessage(xmlString.data(), xmlString.size()) ;
+            
+            // Dump the message if we're tracing
+            if (m_bTraceCommunications && pIncomingMsg)
             {
-                sml::PrintDebugFormat("Kernel remote receive: %s\n", xmlString.c_str()) ;
+                TraceMessage("receive", pIncomingMsg, NULL) ;
             }
-            else
+            
+            // If the other side sends binary it can read it too
+            m_PeerReadsBinary = true ;
+        }
+        else
+        {
+            // Dump the message if we're tracing
+            if (m_bTraceCommunications)
+            {
+                TraceMessage("receive", NULL, xmlString.c_str()) ;
+            }
+            
+            // Get an XML message from the incoming string
+            pIncomingMsg = ElementXML::ParseXMLFromString(xmlString.c_str()) ;
+            
+            // See if the other side has offered to read binary messages
+            if (pIncomingMsg && !m_PeerReadsBinary)
             {
-                sml::PrintDebugFormat("Client remote receive: %s\n", xmlString.c_str()) ;
+                char const* pVersion = pIncomingMsg->GetAttribute(sml_Names::kBinaryEncoding) ;
+                m_PeerReadsBinary = pVersion && atoi(pVersion) >= atoi(BinaryEncoding::kVersionValue) ;
             }
         }
         
-        // Get an XML message from the incoming string
-        ElementXML* pIncomingMsg = ElementXML::ParseXMLFromString(xmlString.c_str()) ;
-        
         if (!pIncomingMsg)
         {
             this->SetError(Error::kParsingXMLError) ;
@@ -396,8 +480,23 @@ bool RemoteConnection::ReceiveMessages(bool allMessages, int secondsWait, int mi
         // We're done with the response
         delete pResponse ;
         
-        // Record the last incoming message
-        delete m_pLastResponse ;
+        // If that command moved us to shared memory, switch now its response has gone
+        // over the socket (the client switches once it's read it).
+        if (m_pPendingDataSender)
+        {
+            SwitchDataSender() ;
+        }
+        
+        // Record the last incoming message.  While pipelined commands are in flight
+        // the one it replaces may be a response that's still to be collected, so keep it.
+        if (m_PipelinedResponses > 0)
+        {
+            AddResponseToList(m_pLastResponse) ;
+        }
+        else
+        {
+            delete m_pLastResponse ;
+        }
         m_pLastResponse = pIncomingMsg ;
         
         // If we're only asked to read one message, we're done.
@@ -410,6 +509,22 @@ bool RemoteConnection::ReceiveMessages(bool allMessages, int secondsWait, int mi
     return receivedMessage ;
 }
 
+/*************************************************************
+* @brief    Have the waiter watch our socket, as well as being
+*           registered with the connection.
+*************************************************************/
+void RemoteConnection::AddMessageWaiter(MessageWaiter* pWaiter)
+{
+    Connection::AddMessageWaiter(pWaiter) ;
+    pWaiter->Watch(m_ReadDescriptor) ;
+}
+
+void RemoteConnection::RemoveMessageWaiter(MessageWaiter* pWaiter)
+{
+    Connection::RemoveMessageWaiter(pWaiter) ;
+    pWaiter->Unwatch(m_ReadDescriptor, !m_DataSender->IsAlive()) ;
+}
+
 void RemoteConnection::SetTraceCommunications(bool state)
 {
     m_bTraceCommunications = state ;
@@ -419,6 +534,99 @@ void RemoteConnection::SetTraceCommunications(bool state)
     }
 }
 
+/*************************************************************
+* @brief    The client side of moving a connection to shared memory.
+*
+*           If the kernel is on this machine we create a segment and
+*           send its name to the kernel.  If it can open it, both sides
+*           move over to it once the kernel's response has been sent
+*           (and everything after that goes through the segment).
+*           Kernels that don't know the command reply with an error,
+*           and we just carry on using the socket.
+*************************************************************/
+bool RemoteConnection::UseSharedMemory()
+{
+#ifdef ENABLE_SHARED_MEMORY
+    if (!m_DataSender->IsLocalPeer())
+    {
+        return false ;
+    }
+    
+    sock::SharedMemory* pShared = sock::SharedMemory::CreateSegment() ;
+    
+    if (!pShared)
+    {
+        return false ;
+    }
+    
+    ElementXML* pMsg = CreateSMLCommand(sml_Names::kCommand_SharedMemory) ;
+    AddParameterToSMLCommand(pMsg, sml_Names::kParamName, pShared->GetSegmentName()) ;
+    
+    AnalyzeXML response ;
+    bool ok = SendMessageGetResponse(&response, pMsg) && response.GetResultBool(false) ;
+    
+    delete pMsg ;
+    
+    // The kernel has opened the segment by now (or never will), so we can remove its name
+    pShared->UnlinkSegment() ;
+    
+    if (!ok)
+    {
+        delete pShared ;
+        ClearError() ;
+        return false ;
+    }
+    
+    m_pPendingDataSender = pShared ;
+    SwitchDataSender() ;
+    
+    return true ;
+#else
+    return false ;
+#endif
+}
+
+/*************************************************************
+* @brief    The kernel side of moving a connection to shared memory.
+*           We switch over in ReceiveMessages(), once the response
+*           to this command has gone out over the socket.
+*************************************************************/
+bool RemoteConnection::AcceptSharedMemory(char const* pSegmentName)
+{
+#ifdef ENABLE_SHARED_MEMORY
+    // Only a client on this machine can have created the segment
+    if (m_pPendingDataSender || !m_DataSender->IsLocalPeer())
+    {
+        return false ;
+    }
+    
+    m_pPendingDataSender = sock::SharedMemory::OpenSegment(pSegmentName) ;
+    
+    return m_pPendingDataSender != NULL ;
+#else
+    (void)pSegmentName ;
+    return false ;
+#endif
+}
+
+/*************************************************************
+* @brief    Start sending and receiving through the pending data sender.
+*           The one we were using is kept on to wake the other side
+*           (so our read descriptor doesn't change).
+*************************************************************/
+void RemoteConnection::SwitchDataSender()
+{
+#ifdef ENABLE_SHARED_MEMORY
+    sock::SharedMemory* pShared = static_cast<sock::SharedMemory*>(m_pPendingDataSender) ;
+    
+    pShared->SetTraceCommunications(m_bTraceCommunications) ;
+    pShared->Attach(m_DataSender) ;
+    
+    m_DataSender = pShared ;
+    m_pPendingDataSender = NULL ;
+#endif
+}
+
 void RemoteConnection::CloseConnection()
 {
     m_DataSender->Close() ;
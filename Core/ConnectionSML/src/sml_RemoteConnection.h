@@ -44,6 +44,14 @@ namespace sml
             // breaking of existing code.
             bool m_SharedFileSystem ;
             
+            // Whether the other side can read binary encoded messages (see sml_BinaryEncoding.h).
+            // Until it says so we send XML (so older peers keep working), and offer binary by
+            // marking each message we send with the version we can read.
+            bool m_PeerReadsBinary ;
+            
+            // The socket that message waiters watch for us (-1 if it can't be watched)
+            int m_ReadDescriptor ;
+            
             /** We need to cache the responses to calls **/
             soarxml::ElementXML* m_pLastResponse ;
             
@@ -61,15 +69,29 @@ namespace sml
             
             bool DoesResponseMatch(soarxml::ElementXML* pResponse, char const* pID) ;
             
+            /** A shared memory data sender to switch to once we've sent our current response (see AcceptSharedMemory()) **/
+            sock::DataSender*   m_pPendingDataSender ;
+            
+            void SwitchDataSender() ;
+            
             /** The timeout for receiving messages is secondsWait + millisecondsWait, where millisecondsWait < 1000 */
             bool ReceiveMessages(bool allMessages, int secondsWait, int millisecondsWait) ;
             
+            /** Adds a message to a buffer of messages to send, in whichever encoding the other side reads **/
+            void AppendMessage(soarxml::ElementXML* pMsg, std::string* pBuffer) ;
+            
+            /** Prints a message we're sending or have received when tracing communications **/
+            void TraceMessage(char const* pDirection, soarxml::ElementXML* pMsg, char const* pXMLString) ;
+            
         public:
             virtual ~RemoteConnection();
             
             virtual void SendMsg(soarxml::ElementXML* pMsg) ;
+            virtual void SendMsgs(soarxml::ElementXML* const* pMsgs, int count) ;
             virtual soarxml::ElementXML* GetResponseForID(char const* pID, bool wait) ;
             virtual bool ReceiveMessages(bool allMessages) ;
+            virtual void AddMessageWaiter(MessageWaiter* pWaiter) ;
+            virtual void RemoveMessageWaiter(MessageWaiter* pWaiter) ;
             virtual void CloseConnection() ;
             virtual bool IsClosed() ;
             virtual bool IsRemoteConnection()
@@ -81,6 +103,8 @@ namespace sml
                 return true ;
             }
             virtual void SetTraceCommunications(bool state) ;
+            virtual bool UseSharedMemory() ;
+            virtual bool AcceptSharedMemory(char const* pSegmentName) ;
             
     };
     
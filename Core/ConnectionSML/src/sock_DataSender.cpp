@@ -17,21 +17,66 @@ using namespace sock ;
 /////////////////////////////////////////////////////////////////////
 bool DataSender::SendString(char const* pString)
 {
-    uint32_t len = static_cast<uint32_t>(strlen(pString));
-    
+    return SendString(pString, static_cast<uint32_t>(strlen(pString))) ;
+}
+
+bool DataSender::SendString(char const* pData, uint32_t len)
+{
     // Convert the value into network byte ordering (so it's compatible if we send it
     // from a big-endian machine to a little endian one or vice-versa).
     uint32_t netLen = htonl(len) ;
     
+    // Small messages go out in a single send, so we don't pay for two
+    // system calls (and a second packet) on every command.
+    enum { kCombinedSendSize = 1024 } ;
+    if (len <= kCombinedSendSize)
+    {
+        char buffer[sizeof(netLen) + kCombinedSendSize] ;
+        memcpy(buffer, &netLen, sizeof(netLen)) ;
+        memcpy(buffer + sizeof(netLen), pData, len) ;
+        
+        return SendBuffer(buffer, static_cast<uint32_t>(sizeof(netLen) + len)) ;
+    }
+    
     // Send the length out first
     bool ok = SendBuffer(reinterpret_cast<const char*>(&netLen), sizeof(netLen)) ;
     
     // Now send the string of characters
-    ok = ok && SendBuffer(pString, len) ;
+    ok = ok && SendBuffer(pData, len) ;
     
     return ok ;
 }
 
+/////////////////////////////////////////////////////////////////////
+// Function name  : DataSender::AppendString
+//
+// Argument       : std::string* pBuffer
+// Argument       : char const* pData
+// Argument       : uint32_t len
+//
+// Description    : Add a string to a buffer in the format SendString uses
+//                  (a 4-byte length followed by the data), so a series
+//                  of strings can be sent with a single SendStrings call.
+//
+/////////////////////////////////////////////////////////////////////
+void DataSender::AppendString(std::string* pBuffer, char const* pData, uint32_t len)
+{
+    uint32_t netLen = htonl(len) ;
+    
+    pBuffer->append(reinterpret_cast<const char*>(&netLen), sizeof(netLen)) ;
+    pBuffer->append(pData, len) ;
+}
+
+bool DataSender::SendStrings(std::string const& buffer)
+{
+    if (buffer.empty())
+    {
+        return true ;
+    }
+    
+    return SendBuffer(buffer.data(), static_cast<uint32_t>(buffer.size())) ;
+}
+
 /////////////////////////////////////////////////////////////////////
 // Function name  : DataSender::SendBuffer
 //
@@ -56,30 +101,21 @@ bool DataSender::ReceiveString(std::string* pString)
     // Convert the length from network byte ordering back to our local order
     uint32_t len = ntohl(netLen) ;
     
-    // If we got a zero length string.
-    if (len == 0)
+    // If we got a zero length string (or couldn't read the length).
+    if (len == 0 || !ok)
     {
         return ok ;
     }
     
-    // Create the buffer into which we'll receive data
-    char* buffer = new char[len + 1] ;
+    // Receive straight into the string (which keeps any nulls in the data)
+    pString->resize(len) ;
+    ok = ok && ReceiveBuffer(&(*pString)[0], len) ;
     
-    // Receive the string
-    ok = ok && ReceiveBuffer(buffer, len) ;
-    
-    // Make it null terminated
-    buffer[len] = 0 ;
-    
-    // Return the result in the string
-    if (ok)
+    if (!ok)
     {
-        pString->assign(buffer) ;
+        pString->clear() ;
     }
     
-    // Release our temp buffer
-    delete [] buffer ;
-    
     return ok ;
 }
 
@@ -25,11 +25,12 @@
 
 #include <string>
 #include "thread_Lock.h"
+#include "Export.h"
 
 namespace sock
 {
 
-    class DataSender
+    class EXPORT DataSender
     {
     
         protected:
@@ -60,6 +61,19 @@ namespace sock
             // The timeout for waiting for data is secondsWait + millisecondsWait, where millisecondsWait < 1000
             virtual bool        IsReadDataAvailable(int secondsWait = 0, int millisecondsWait = 0) = 0;
             
+            // A descriptor that becomes readable when data arrives (so one thread can wait on many
+            // data senders at once) or -1 if this kind of data sender can't be waited on that way.
+            virtual int         GetReadDescriptor()
+            {
+                return -1 ;
+            }
+            
+            // True if the other end is on this machine (so we could talk to it through shared memory)
+            virtual bool        IsLocalPeer()
+            {
+                return false ;
+            }
+            
             // Close down our side of the data sender, locks and calls CloseInternal
             void        Close();
             
@@ -80,7 +94,17 @@ namespace sock
             // Send a string of characters.  Outgoing format will be "<4-byte length>"+string data
             bool        SendString(char const* pString) ;
             
+            // Send a buffer which may contain nulls, in the same format as SendString
+            bool        SendString(char const* pData, uint32_t length) ;
+            
+            // Add a string to a buffer in the same format, so several can be sent in one go with SendStrings()
+            static void AppendString(std::string* pBuffer, char const* pData, uint32_t length) ;
+            
+            // Send a buffer of strings built up with AppendString()
+            bool        SendStrings(std::string const& buffer) ;
+            
             // Receive a string of characters.  Incoming format on socket should be "<4-byte length>"+string data
+            // (The data may contain nulls, in which case use pString->size() rather than strlen).
             bool        ReceiveString(std::string* pString) ;
             
         protected:
@@ -0,0 +1,588 @@
+#include "portability.h"
+
+/////////////////////////////////////////////////////////////////
+// SharedMemory class
+//
+// Represents a connection between a client and the kernel when
+// both are on the same machine, through a pair of ring buffers
+// in a POSIX shared memory segment.
+//
+/////////////////////////////////////////////////////////////////
+
+#ifdef ENABLE_SHARED_MEMORY
+
+#include "sml_Utils.h"
+#include "sock_SharedMemory.h"
+
+#include <atomic>
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <time.h>
+
+using namespace sock ;
+
+namespace
+{
+    // Identifies a segment as one of ours (and the layout version)
+    const uint32_t kSegmentMagic = 0x534d4c31 ; // "SML1"
+
+    // Every segment name starts with this
+    char const* const kSegmentPrefix = "/soar-sml-" ;
+
+    // The size of each ring (a power of two, so the free running counts wrap cleanly)
+    const uint32_t kRingSize = 1 << 20 ;
+
+    // How many times we check for data before going to sleep.  A reply often
+    // arrives within this time and spinning is far cheaper than sleeping.
+    const int kSpinCount = 2000 ;
+
+    // How long we sleep before checking whether the other side has gone away
+    const int kCheckPeerMilliseconds = 1000 ;
+
+    int FutexWait(std::atomic<uint32_t>* pAddress, uint32_t expected, int milliseconds)
+    {
+        timespec timeout ;
+        timeout.tv_sec  = milliseconds / 1000 ;
+        timeout.tv_nsec = (milliseconds % 1000) * 1000000L ;
+
+        // The segment is shared between processes, so this can't be a private futex
+        return static_cast<int>(syscall(SYS_futex, reinterpret_cast<uint32_t*>(pAddress), FUTEX_WAIT, expected, &timeout, NULL, 0)) ;
+    }
+
+    void FutexWake(std::atomic<uint32_t>* pAddress)
+    {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(pAddress), FUTEX_WAKE, INT_MAX, NULL, NULL, 0) ;
+    }
+}
+
+// One direction of the connection.  The counts of bytes written and read
+// are free running, so the amount waiting to be read is written - read.
+// Each count is on its own cache line, as each is only written by one side.
+struct SharedMemory::Ring
+{
+    std::atomic<uint32_t>   m_Written ;
+    char                    m_Pad1[60] ;
+    std::atomic<uint32_t>   m_Read ;
+    char                    m_Pad2[60] ;
+
+    // Set while the reader is asleep on m_Written (or the writer on m_Read)
+    std::atomic<uint32_t>   m_ReaderSleeping ;
+    std::atomic<uint32_t>   m_WriterSleeping ;
+
+    // Set when the reader wants a byte sent down the socket when data arrives
+    std::atomic<uint32_t>   m_WakeupWanted ;
+    char                    m_Pad3[52] ;
+
+    char                    m_Data[kRingSize] ;
+} ;
+
+namespace
+{
+    // The start of the segment.  The client writes to the first ring and reads from the second.
+    struct SegmentHeader
+    {
+        uint32_t    m_Magic ;
+        uint32_t    m_RingSize ;
+        char        m_Pad[56] ;
+    } ;
+}
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "Futexes need plain 32 bit counts") ;
+
+SharedMemory::SharedMemory()
+{
+    m_pConnection   = NULL ;
+    m_pMemory       = NULL ;
+    m_MemorySize    = sizeof(SegmentHeader) + 2 * sizeof(Ring) ;
+    m_pSendRing     = NULL ;
+    m_pReceiveRing  = NULL ;
+    m_PeerClosed    = false ;
+    m_bTraceCommunications = false ;
+}
+
+SharedMemory::~SharedMemory()
+{
+    delete m_pConnection ;
+
+    if (m_pMemory)
+    {
+        munmap(m_pMemory, m_MemorySize) ;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////
+// Function name  : SharedMemory::CreateSegment
+//
+// Return type    : SharedMemory*
+//
+// Description    : Create a new, empty segment for a client to talk
+//                  to the kernel through.  The name includes our
+//                  process id and a counter, so it's unique.
+//
+/////////////////////////////////////////////////////////////////////
+SharedMemory* SharedMemory::CreateSegment()
+{
+    static std::atomic<uint32_t> counter(0) ;
+
+    char name[64] ;
+    snprintf(name, sizeof(name), "%s%d-%u-%lx", kSegmentPrefix, static_cast<int>(getpid()), counter++, static_cast<unsigned long>(time(NULL))) ;
+
+    int descriptor = shm_open(name, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR) ;
+    if (descriptor == -1)
+    {
+        return NULL ;
+    }
+
+    SharedMemory* pShared = new SharedMemory() ;
+    pShared->m_SegmentName = name ;
+
+    bool ok = ftruncate(descriptor, static_cast<off_t>(pShared->m_MemorySize)) == 0 ;
+    ok = ok && pShared->MapSegment(descriptor, true) ;
+
+    close(descriptor) ;
+
+    if (!ok)
+    {
+        pShared->UnlinkSegment() ;
+        delete pShared ;
+        return NULL ;
+    }
+
+    return pShared ;
+}
+
+/////////////////////////////////////////////////////////////////////
+// Function name  : SharedMemory::OpenSegment
+//
+// Return type    : SharedMemory*
+// Argument       : char const* pSegmentName
+//
+// Description    : Open a segment a client has created.
+//
+/////////////////////////////////////////////////////////////////////
+SharedMemory* SharedMemory::OpenSegment(char const* pSegmentName)
+{
+    // Only open segments that look like ours
+    if (!pSegmentName || strncmp(pSegmentName, kSegmentPrefix, strlen(kSegmentPrefix)) != 0 || strchr(pSegmentName + 1, '/'))
+    {
+        return NULL ;
+    }
+
+    int descriptor = shm_open(pSegmentName, O_RDWR, 0) ;
+    if (descriptor == -1)
+    {
+        return NULL ;
+    }
+
+    SharedMemory* pShared = new SharedMemory() ;
+    pShared->m_SegmentName = pSegmentName ;
+
+    struct stat info ;
+    bool ok = fstat(descriptor, &info) == 0 && static_cast<size_t>(info.st_size) == pShared->m_MemorySize ;
+    ok = ok && pShared->MapSegment(descriptor, false) ;
+
+    close(descriptor) ;
+
+    if (!ok)
+    {
+        delete pShared ;
+        return NULL ;
+    }
+
+    return pShared ;
+}
+
+/////////////////////////////////////////////////////////////////////
+// Function name  : SharedMemory::MapSegment
+//
+// Description    : Map the segment into our address space and find
+//                  the rings.  The creator sets up the header, the
+//                  other side checks it.
+//
+/////////////////////////////////////////////////////////////////////
+bool SharedMemory::MapSegment(int descriptor, bool create)
+{
+    void* pMemory = mmap(NULL, m_MemorySize, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0) ;
+    if (pMemory == MAP_FAILED)
+    {
+        return false ;
+    }
+
+    m_pMemory = pMemory ;
+
+    SegmentHeader* pHeader = static_cast<SegmentHeader*>(m_pMemory) ;
+    Ring* pClientToKernel = reinterpret_cast<Ring*>(static_cast<char*>(m_pMemory) + sizeof(SegmentHeader)) ;
+    Ring* pKernelToClient = pClientToKernel + 1 ;
+
+    if (create)
+    {
+        // A new segment is filled with zeros, which is an empty ring with nobody waiting,
+        // so we only have to fill in the header.
+        pHeader->m_Magic    = kSegmentMagic ;
+        pHeader->m_RingSize = kRingSize ;
+
+        m_pSendRing    = pClientToKernel ;
+        m_pReceiveRing = pKernelToClient ;
+    }
+    else
+    {
+        if (pHeader->m_Magic != kSegmentMagic || pHeader->m_RingSize != kRingSize)
+        {
+            return false ;
+        }
+
+        m_pSendRing    = pKernelToClient ;
+        m_pReceiveRing = pClientToKernel ;
+    }
+
+    return true ;
+}
+
+void SharedMemory::UnlinkSegment()
+{
+    shm_unlink(m_SegmentName.c_str()) ;
+}
+
+void SharedMemory::Attach(DataSender* pConnection)
+{
+    assert(!m_pConnection) ;
+
+    m_pConnection = pConnection ;
+}
+
+bool SharedMemory::IsAlive()
+{
+    return !m_PeerClosed && m_pConnection && m_pConnection->IsAlive() ;
+}
+
+int SharedMemory::GetReadDescriptor()
+{
+    return m_pConnection ? m_pConnection->GetReadDescriptor() : -1 ;
+}
+
+std::string SharedMemory::GetName()
+{
+    return (m_pConnection ? m_pConnection->GetName() : name) + " (shared memory)" ;
+}
+
+void SharedMemory::CloseInternal()
+{
+    // Closing the socket is what tells the other side we've gone
+    if (m_pConnection)
+    {
+        m_pConnection->Close() ;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////
+// Function name  : SharedMemory::DrainWakeups
+//
+// Description    : The socket only carries wake up bytes now, so read
+//                  and discard anything waiting there.  Reading nothing
+//                  from a readable socket means the other side closed it.
+//
+/////////////////////////////////////////////////////////////////////
+void SharedMemory::DrainWakeups()
+{
+    int descriptor = GetReadDescriptor() ;
+    if (descriptor == -1)
+    {
+        m_PeerClosed = true ;
+        return ;
+    }
+
+    char buffer[64] ;
+    for (;;)
+    {
+        ssize_t bytes = recv(descriptor, buffer, sizeof(buffer), MSG_DONTWAIT) ;
+
+        if (bytes > 0)
+        {
+            continue ;
+        }
+
+        if (bytes == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+        {
+            m_PeerClosed = true ;
+        }
+
+        break ;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////
+// Function name  : SharedMemory::CheckPeer
+//
+// Description    : See if the other side has closed the socket, without
+//                  reading any wake ups waiting on it (they're for
+//                  whichever of our threads is reading).
+//
+/////////////////////////////////////////////////////////////////////
+void SharedMemory::CheckPeer()
+{
+    int descriptor = GetReadDescriptor() ;
+
+    char wakeup ;
+    if (descriptor == -1 || recv(descriptor, &wakeup, 1, MSG_PEEK | MSG_DONTWAIT) == 0)
+    {
+        m_PeerClosed = true ;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////
+// Function name  : SharedMemory::WakeReader
+//
+// Description    : Called after we've added data to the ring.
+//                  A reader sleeping on the ring gets a futex wake,
+//                  one waiting on the socket gets a byte sent to it.
+//
+/////////////////////////////////////////////////////////////////////
+void SharedMemory::WakeReader(Ring* pRing)
+{
+    if (pRing->m_ReaderSleeping.load())
+    {
+        FutexWake(&pRing->m_Written) ;
+    }
+
+    if (pRing->m_WakeupWanted.exchange(0))
+    {
+        int descriptor = GetReadDescriptor() ;
+        if (descriptor != -1)
+        {
+            // If the socket's full the reader has wake ups waiting already
+            char wakeup = 0 ;
+            ssize_t res = send(descriptor, &wakeup, 1, MSG_DONTWAIT | MSG_NOSIGNAL) ;
+            (void)res ;
+        }
+    }
+}
+
+/////////////////////////////////////////////////////////////////////
+// Function name  : SharedMemory::WaitForData
+//
+// Description    : Wait for the writer to add to the ring.
+//                  We spin for a short time first, as the data is often
+//                  on its way, and then sleep on the count of bytes written.
+//                  The writer checks m_ReaderSleeping after updating the
+//                  count, and we check the count after setting the flag,
+//                  so one of us always sees the other.
+//                  With no time to wait we don't spin at all.
+//
+/////////////////////////////////////////////////////////////////////
+bool SharedMemory::WaitForData(Ring* pRing, uint32_t writtenSeen, int millisecondsWait)
+{
+    if (millisecondsWait <= 0)
+    {
+        return pRing->m_Written.load(std::memory_order_acquire) != writtenSeen ;
+    }
+
+    for (int i = 0 ; i < kSpinCount ; i++)
+    {
+        if (pRing->m_Written.load(std::memory_order_acquire) != writtenSeen)
+        {
+            return true ;
+        }
+    }
+
+    pRing->m_ReaderSleeping.store(1) ;
+
+    if (pRing->m_Written.load() == writtenSeen)
+    {
+        FutexWait(&pRing->m_Written, writtenSeen, millisecondsWait) ;
+    }
+
+    pRing->m_ReaderSleeping.store(0) ;
+
+    return pRing->m_Written.load(std::memory_order_acquire) != writtenSeen ;
+}
+
+bool SharedMemory::WaitForSpace(Ring* pRing, uint32_t readSeen)
+{
+    for (int i = 0 ; i < kSpinCount ; i++)
+    {
+        if (pRing->m_Read.load(std::memory_order_acquire) != readSeen)
+        {
+            return true ;
+        }
+    }
+
+    pRing->m_WriterSleeping.store(1) ;
+
+    if (pRing->m_Read.load() == readSeen)
+    {
+        FutexWait(&pRing->m_Read, readSeen, kCheckPeerMilliseconds) ;
+    }
+
+    pRing->m_WriterSleeping.store(0) ;
+
+    return pRing->m_Read.load(std::memory_order_acquire) != readSeen ;
+}
+
+/////////////////////////////////////////////////////////////////////
+// Function name  : SharedMemory::SendBuffer
+//
+// Return type    : bool
+// Argument       : char const* pSendBuffer
+// Argument       : uint32_t bufferSize
+//
+// Description    : Copy a buffer into the ring, waiting for the reader
+//                  to make room if it's full.
+//
+/////////////////////////////////////////////////////////////////////
+bool SharedMemory::SendBuffer(char const* pSendBuffer, uint32_t bufferSize)
+{
+    soar_thread::Lock lock(&m_SendMutex) ;
+
+    Ring* pRing = m_pSendRing ;
+
+    while (bufferSize > 0)
+    {
+        if (m_PeerClosed)
+        {
+            return false ;
+        }
+
+        uint32_t written = pRing->m_Written.load(std::memory_order_relaxed) ;
+        uint32_t read    = pRing->m_Read.load(std::memory_order_acquire) ;
+        uint32_t space   = kRingSize - (written - read) ;
+
+        if (space == 0)
+        {
+            if (!WaitForSpace(pRing, read))
+            {
+                CheckPeer() ;
+            }
+            continue ;
+        }
+
+        uint32_t bytes  = bufferSize < space ? bufferSize : space ;
+        uint32_t offset = written & (kRingSize - 1) ;
+        uint32_t first  = bytes < kRingSize - offset ? bytes : kRingSize - offset ;
+
+        memcpy(pRing->m_Data + offset, pSendBuffer, first) ;
+        memcpy(pRing->m_Data, pSendBuffer + first, bytes - first) ;
+
+        pRing->m_Written.store(written + bytes) ;
+
+        WakeReader(pRing) ;
+
+        pSendBuffer += bytes ;
+        bufferSize  -= bytes ;
+    }
+
+    return true ;
+}
+
+/////////////////////////////////////////////////////////////////////
+// Function name  : SharedMemory::ReceiveBuffer
+//
+// Return type    : bool
+// Argument       : char* pRecvBuffer
+// Argument       : uint32_t bufferSize
+//
+// Description    : Copy data out of the ring, waiting until all of
+//                  it has arrived (as a blocking socket would).
+//
+/////////////////////////////////////////////////////////////////////
+bool SharedMemory::ReceiveBuffer(char* pRecvBuffer, uint32_t bufferSize)
+{
+    soar_thread::Lock lock(&m_ReceiveMutex) ;
+
+    Ring* pRing = m_pReceiveRing ;
+
+    while (bufferSize > 0)
+    {
+        uint32_t read      = pRing->m_Read.load(std::memory_order_relaxed) ;
+        uint32_t written   = pRing->m_Written.load(std::memory_order_acquire) ;
+        uint32_t available = written - read ;
+
+        if (available == 0)
+        {
+            if (m_PeerClosed)
+            {
+                return false ;
+            }
+
+            if (!WaitForData(pRing, written, kCheckPeerMilliseconds))
+            {
+                DrainWakeups() ;
+
+                if (m_PeerClosed)
+                {
+                    return false ;
+                }
+            }
+            continue ;
+        }
+
+        uint32_t bytes  = bufferSize < available ? bufferSize : available ;
+        uint32_t offset = read & (kRingSize - 1) ;
+        uint32_t first  = bytes < kRingSize - offset ? bytes : kRingSize - offset ;
+
+        memcpy(pRecvBuffer, pRing->m_Data + offset, first) ;
+        memcpy(pRecvBuffer + first, pRing->m_Data, bytes - first) ;
+
+        pRing->m_Read.store(read + bytes) ;
+
+        if (pRing->m_WriterSleeping.load())
+        {
+            FutexWake(&pRing->m_Read) ;
+        }
+
+        pRecvBuffer += bytes ;
+        bufferSize  -= bytes ;
+    }
+
+    return true ;
+}
+
+/////////////////////////////////////////////////////////////////////
+// Function name  : SharedMemory::IsReadDataAvailable
+//
+// Argument       : int secondsWait -- Seconds part of how long to wait for data (0 is default)
+// Argument       : int millisecondsWait -- Milliseconds part of how long to wait for data (0 is default, must be < 1000)
+// Return type    : bool
+//
+// Description    : Returns true if data is waiting in the ring.
+//                  If there isn't any, we ask the writer to wake us
+//                  through the socket when there is, so a thread can
+//                  wait on the socket's descriptor for it.
+//
+/////////////////////////////////////////////////////////////////////
+bool SharedMemory::IsReadDataAvailable(int secondsWait, int millisecondsWait)
+{
+    assert(millisecondsWait < 1000 && "specified milliseconds must be less than 1000");
+
+    soar_thread::Lock lock(&m_ReceiveMutex) ;
+
+    Ring* pRing = m_pReceiveRing ;
+
+    DrainWakeups() ;
+
+    uint32_t written = pRing->m_Written.load(std::memory_order_acquire) ;
+    if (written != pRing->m_Read.load(std::memory_order_relaxed) || m_PeerClosed)
+    {
+        return true ;
+    }
+
+    if (WaitForData(pRing, written, secondsWait * 1000 + millisecondsWait))
+    {
+        return true ;
+    }
+
+    // Set the flag and then check again, in case the writer added data
+    // before it could see the flag.
+    pRing->m_WakeupWanted.store(1) ;
+
+    return pRing->m_Written.load() != pRing->m_Read.load(std::memory_order_relaxed) ;
+}
+
+#endif // ENABLE_SHARED_MEMORY
@@ -0,0 +1,129 @@
+/////////////////////////////////////////////////////////////////
+// SharedMemory class
+//
+// Represents a connection between a client and the kernel when
+// both are on the same machine.  Data goes through a pair of
+// single-producer/single-consumer ring buffers in a POSIX shared
+// memory segment, rather than being copied in and out of the
+// operating system's socket buffers.
+//
+// Both sides keep the socket they first connected over.  Each
+// side waits on its descriptor (so a MessageWaiter still works),
+// a writer sends a single byte down it to wake a reader that's
+// waiting that way, and it closing is how we find out the other
+// process has gone.  A reader (or writer) that's blocked in the
+// middle of a transfer sleeps on a futex instead, which is much
+// cheaper to wake.
+//
+// The client creates the segment and sends its name to the kernel
+// (see RemoteConnection::UseSharedMemory()).  Once the kernel has
+// replied, both sides switch over to it.
+//
+/////////////////////////////////////////////////////////////////
+
+#ifndef SHARED_MEMORY_H
+#define SHARED_MEMORY_H
+
+#ifdef ENABLE_SHARED_MEMORY
+#include <string>
+
+#include "sock_DataSender.h"
+
+namespace sock
+{
+
+    class EXPORT SharedMemory : public DataSender
+    {
+        protected:
+            struct Ring ;
+
+            // The connection we started out on (which we own once it's attached)
+            DataSender* m_pConnection ;
+
+            // The mapped segment
+            void*       m_pMemory ;
+            size_t      m_MemorySize ;
+            std::string m_SegmentName ;
+
+            // The ring we write to and the one we read from
+            Ring*       m_pSendRing ;
+            Ring*       m_pReceiveRing ;
+
+            // Set once the other side has closed its end
+            bool        m_PeerClosed ;
+
+            // Each ring has one producer and one consumer, so we only let one
+            // of our threads write (and one read) at a time.
+            soar_thread::Mutex  m_SendMutex ;
+            soar_thread::Mutex  m_ReceiveMutex ;
+
+            // These objects are created through CreateSegment() or OpenSegment().
+            SharedMemory() ;
+
+            bool        MapSegment(int descriptor, bool create) ;
+
+            // Block until the ring's count of bytes written (or read) moves on from
+            // the value we last saw, or the timeout passes.  Returns true if it moved.
+            bool        WaitForData(Ring* pRing, uint32_t writtenSeen, int millisecondsWait) ;
+            bool        WaitForSpace(Ring* pRing, uint32_t readSeen) ;
+
+            // Wake the other side's reader after we've written to its ring
+            void        WakeReader(Ring* pRing) ;
+
+            // Read (and throw away) any wake up bytes waiting on the socket,
+            // noting if the other side has closed it.
+            void        DrainWakeups() ;
+            
+            // Just check whether the other side has closed the socket
+            void        CheckPeer() ;
+
+        public:
+            // The client side: create a new segment for a connection.
+            // Returns NULL if we couldn't (e.g. because shared memory isn't available).
+            static SharedMemory* CreateSegment() ;
+
+            // The kernel side: open the segment the client created.
+            // Returns NULL if there's no such segment (e.g. because the client is on another machine).
+            static SharedMemory* OpenSegment(char const* pSegmentName) ;
+
+            virtual     ~SharedMemory() ;
+
+            // The name to pass to OpenSegment()
+            char const* GetSegmentName()
+            {
+                return m_SegmentName.c_str() ;
+            }
+
+            // Remove the segment's name, once both sides have it open (or have given up on it),
+            // so it's cleaned up when the connection closes.  The creator should call this.
+            void        UnlinkSegment() ;
+
+            // Take over the connection both sides were using before (we use it for wake ups).
+            void        Attach(DataSender* pConnection) ;
+
+            bool        IsAlive() ;
+
+            // Returns true if data is waiting in the ring (or the other side has closed).
+            // The timeout for waiting for data is secondsWait + millisecondsWait, where millisecondsWait < 1000
+            bool        IsReadDataAvailable(int secondsWait = 0, int millisecondsWait = 0) ;
+
+            // The original connection's descriptor, which we send a byte down when data arrives
+            // for a reader that's waiting on it.
+            int         GetReadDescriptor() ;
+
+            std::string GetName() ;
+
+        protected:
+            // Lower level buffer send and receive calls.
+            virtual bool SendBuffer(char const* pSendBuffer, uint32_t bufferSize) ;
+            virtual bool ReceiveBuffer(char* pRecvBuffer, uint32_t bufferSize) ;
+
+            // Close down our side of the connection
+            virtual void CloseInternal() ;
+    } ;
+
+} // Namespace
+
+#endif // ENABLE_SHARED_MEMORY
+
+#endif // SHARED_MEMORY_H
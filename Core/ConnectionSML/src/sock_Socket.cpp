@@ -32,10 +32,6 @@
 #include <signal.h>
 #include <iostream>
 
-#ifdef NON_BLOCKING
-#include "sml_Utils.h"  // For sml::Sleep
-#endif
-
 using namespace sock ;
 
 //////////////////////////////////////////////////////////////////////
@@ -200,6 +196,25 @@ static bool IsErrorWouldBlock()
     
     return (error == NET_EWOULDBLOCK) ;
 }
+
+/////////////////////////////////////////////////////////////////////
+// Function name  : WaitForSocket
+//
+// Return type    : static void
+//
+// Description    : Blocks until the socket can be written to (or read
+//                  from), after a call on a non-blocking socket has
+//                  reported that it would block.
+//
+/////////////////////////////////////////////////////////////////////
+static void WaitForSocket(SOCKET hSock, bool forWrite)
+{
+    fd_set set ;
+    FD_ZERO(&set) ;
+    FD_SET(hSock, &set) ;
+    
+    select(static_cast<int>(hSock) + 1, forWrite ? NULL : &set, forWrite ? &set : NULL, NULL, NULL) ;
+}
 #endif
 
 /////////////////////////////////////////////////////////////////////
@@ -253,7 +268,7 @@ bool Socket::SendBuffer(char const* pSendBuffer, uint32_t bufferSize)
                     {
                         sml::PrintDebug("Waiting for socket to unblock") ;
                     }
-                    sml::Sleep(0, 0) ;
+                    WaitForSocket(hSock, true) ;
                 }
                 else
 #endif
@@ -355,6 +370,56 @@ bool Socket::IsReadDataAvailable(int secondsWait, int millisecondsWait)
     return bIsSet ;
 }
 
+/////////////////////////////////////////////////////////////////////
+// Function name  : Socket::IsLocalPeer
+//
+// Return type    : bool
+//
+// Description    : Returns true if the other end of this socket is on
+//                  this machine: it's a local socket, or an internet
+//                  socket whose two ends have the same address.
+//
+/////////////////////////////////////////////////////////////////////
+bool Socket::IsLocalPeer()
+{
+#ifdef ENABLE_SHARED_MEMORY
+    if (m_hSocket == NO_CONNECTION)
+    {
+        return false ;
+    }
+    
+    sockaddr_storage peer ;
+    socklen_t peerLength = sizeof(peer) ;
+    
+    if (getpeername(m_hSocket, reinterpret_cast<sockaddr*>(&peer), &peerLength) != 0)
+    {
+        return false ;
+    }
+    
+    if (peer.ss_family == AF_UNIX)
+    {
+        return true ;
+    }
+    
+    if (peer.ss_family != AF_INET)
+    {
+        return false ;
+    }
+    
+    sockaddr_in local ;
+    socklen_t localLength = sizeof(local) ;
+    
+    if (getsockname(m_hSocket, reinterpret_cast<sockaddr*>(&local), &localLength) != 0)
+    {
+        return false ;
+    }
+    
+    return reinterpret_cast<sockaddr_in*>(&peer)->sin_addr.s_addr == local.sin_addr.s_addr ;
+#else
+    return false ;
+#endif
+}
+
 /////////////////////////////////////////////////////////////////////
 // Function name  : ReceiveBuffer
 //
@@ -409,7 +474,7 @@ bool Socket::ReceiveBuffer(char* pRecvBuffer, uint32_t bufferSize)
                 if (IsErrorWouldBlock())
                 {
                     //sml::PrintDebug("Waiting for socket to unblock") ;
-                    sml::Sleep(0, 0) ;  // BADBAD: Should have a proper way to pass control back to the caller while we're blocked.
+                    WaitForSocket(hSock, false) ;
                 }
                 else
 #endif
@@ -52,7 +52,7 @@ namespace sock
     class ListenerSocket ;
     class ClientSocket ;
     
-    class Socket : public DataSender
+    class EXPORT Socket : public DataSender
     {
             // Allow these classes access to our constructor
             friend class ListenerSocket ;
@@ -91,6 +91,15 @@ namespace sock
             // The timeout for waiting for data is secondsWait + millisecondsWait, where millisecondsWait < 1000
             bool        IsReadDataAvailable(int secondsWait = 0, int millisecondsWait = 0) ;
             
+            // The socket's descriptor, to wait on for data
+            int         GetReadDescriptor()
+            {
+                return m_hSocket == NO_CONNECTION ? -1 : static_cast<int>(m_hSocket) ;
+            }
+            
+            // True if the other end of the socket is on this machine
+            bool        IsLocalPeer() ;
+            
         public:
             // Print out debug information about the messages we are sending and receiving.
             // NOTE: We still print out information about start up/shut down, errors etc. without this flag being true.
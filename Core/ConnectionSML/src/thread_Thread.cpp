@@ -66,6 +66,8 @@ void Thread::Stop(bool waitTillStopped)
     // generally not a very safe thing to do.  If you feel you need it, add a "ForceStop" method.
     m_QuitNow = true ;
     
+    Wake() ;
+    
     // If the thread was never started or is already stopped we're done.
     if (!m_Started || IsStopped())
     {
@@ -37,6 +37,10 @@ namespace soar_thread
             // Cause this thread to sleep for a while
             void Sleep(int seconds, int milliseconds) ;
             
+            // Called by Stop() after setting m_QuitNow.  Threads that block waiting
+            // for work override this to wake themselves, so they see the request at once.
+            virtual void Wake() { }
+            
         public:
             Thread() ;
             virtual ~Thread() ;
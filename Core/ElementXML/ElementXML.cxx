@@ -1,5 +1,6 @@
 #include "src/ElementXMLInterface.cpp"
 #include "src/ElementXMLImpl.cpp"
+#include "src/ElementXMLArena.cpp"
 #include "src/ParseXML.cpp"
 #include "src/ParseXMLFile.cpp"
 #include "src/ParseXMLString.cpp"
@@ -0,0 +1,199 @@
+#include "portability.h"
+
+/////////////////////////////////////////////////////////////////
+// ElementXMLArena class
+//
+// The memory for an ElementXML tree (see ElementXMLArena.h).
+//
+/////////////////////////////////////////////////////////////////
+
+#include "ElementXMLArena.h"
+
+#include <new>
+
+using namespace soarxml;
+
+namespace
+{
+    // The smallest first block (enough for a node and a few short strings)
+    const size_t kMinimumFirstBlock = 512 ;
+
+    // Blocks double in size up to this
+    const size_t kMaximumBlockSize = 64 * 1024 ;
+
+    // Anything larger than a quarter of a block gets a block to itself
+    // (so a big string doesn't waste what's left of the current block)
+    const size_t kLargeAllocationFraction = 4 ;
+
+    // The interned name table.  Entries are only ever added, so they can
+    // be read without a lock.
+    const int    kInternTableSize    = 1024 ;       // Must be a power of 2
+    const int    kMaxInternedNames   = kInternTableSize / 2 ;
+    const int    kMaxInternProbes    = 16 ;
+    const size_t kMaxInternedLength  = 64 ;
+
+    std::atomic<char const*> s_InternTable[kInternTableSize] ;
+    std::atomic<int>         s_InternedNames(0) ;
+}
+
+ElementXMLArena::ElementXMLArena()
+{
+    m_RefCount      = 1 ;
+    m_pFree         = NULL ;
+    m_pEnd          = NULL ;
+    m_pBlocks       = NULL ;
+    m_NextBlockSize = kMinimumFirstBlock ;
+}
+
+ElementXMLArena::~ElementXMLArena()
+{
+    Block* pBlock = m_pBlocks ;
+    while (pBlock)
+    {
+        Block* pNext = pBlock->m_pNext ;
+        free(pBlock) ;
+        pBlock = pNext ;
+    }
+}
+
+ElementXMLArena* ElementXMLArena::Create(size_t expectedSize)
+{
+    size_t firstBlock = expectedSize < kMinimumFirstBlock ? kMinimumFirstBlock : expectedSize ;
+
+    // The first block follows the arena in the same allocation
+    void* pMemory = malloc(sizeof(ElementXMLArena) + firstBlock) ;
+    if (!pMemory)
+    {
+        throw std::bad_alloc() ;
+    }
+
+    ElementXMLArena* pArena = new(pMemory) ElementXMLArena() ;
+
+    pArena->m_pFree = reinterpret_cast<char*>(pArena + 1) ;
+    pArena->m_pEnd  = pArena->m_pFree + firstBlock ;
+    pArena->m_NextBlockSize = firstBlock * 2 < kMaximumBlockSize ? firstBlock * 2 : kMaximumBlockSize ;
+
+    return pArena ;
+}
+
+void ElementXMLArena::ReleaseRef()
+{
+    if (m_RefCount.fetch_sub(1) == 1)
+    {
+        this->~ElementXMLArena() ;
+        free(this) ;
+    }
+}
+
+void* ElementXMLArena::AllocateFromNewBlock(size_t size, size_t alignment)
+{
+    bool large = size > m_NextBlockSize / kLargeAllocationFraction ;
+    size_t blockSize = large ? size + alignment : m_NextBlockSize ;
+
+    Block* pBlock = static_cast<Block*>(malloc(sizeof(Block) + blockSize)) ;
+    if (!pBlock)
+    {
+        throw std::bad_alloc() ;
+    }
+
+    pBlock->m_pNext = m_pBlocks ;
+    m_pBlocks = pBlock ;
+
+    char* pData = reinterpret_cast<char*>(pBlock + 1) ;
+    char* pStart = reinterpret_cast<char*>((reinterpret_cast<size_t>(pData) + alignment - 1) & ~(alignment - 1)) ;
+
+    // A large allocation leaves the current block as it is
+    if (!large)
+    {
+        m_pFree = pStart + size ;
+        m_pEnd  = pData + blockSize ;
+
+        if (m_NextBlockSize < kMaximumBlockSize)
+        {
+            m_NextBlockSize *= 2 ;
+        }
+    }
+
+    return pStart ;
+}
+
+char* ElementXMLArena::CopyString(char const* pOriginal)
+{
+    if (pOriginal == NULL)
+    {
+        return NULL ;
+    }
+
+    size_t length = strlen(pOriginal) ;
+    char* pString = static_cast<char*>(Allocate(length + 1, 1)) ;
+    memcpy(pString, pOriginal, length + 1) ;
+
+    return pString ;
+}
+
+char* ElementXMLArena::CopyBuffer(char const* pOriginal, int length)
+{
+    if (pOriginal == NULL)
+    {
+        return NULL ;
+    }
+
+    char* pBuffer = static_cast<char*>(Allocate(length, 1)) ;
+    memcpy(pBuffer, pOriginal, length) ;
+
+    return pBuffer ;
+}
+
+char const* ElementXMLArena::InternName(char const* pName)
+{
+    // FNV-1a hash (giving up on long names as we go)
+    size_t hash = 2166136261u ;
+    size_t length = 0 ;
+    for (char const* p = pName ; *p != 0 ; p++, length++)
+    {
+        if (length == kMaxInternedLength)
+        {
+            return NULL ;
+        }
+
+        hash = (hash ^ static_cast<unsigned char>(*p)) * 16777619u ;
+    }
+
+    char* pCopy = NULL ;
+
+    for (int probe = 0 ; probe < kMaxInternProbes ; probe++)
+    {
+        std::atomic<char const*>& entry = s_InternTable[(hash + probe) & (kInternTableSize - 1)] ;
+        char const* pEntry = entry.load(std::memory_order_acquire) ;
+
+        if (!pEntry)
+        {
+            if (!pCopy)
+            {
+                if (s_InternedNames.load() >= kMaxInternedNames)
+                {
+                    return NULL ;
+                }
+
+                pCopy = static_cast<char*>(malloc(length + 1)) ;
+                memcpy(pCopy, pName, length + 1) ;
+            }
+
+            // Another thread may have filled this entry in since we looked
+            if (entry.compare_exchange_strong(pEntry, pCopy))
+            {
+                s_InternedNames++ ;
+                return pCopy ;
+            }
+        }
+
+        if (strcmp(pEntry, pName) == 0)
+        {
+            free(pCopy) ;
+            return pEntry ;
+        }
+    }
+
+    free(pCopy) ;
+    return NULL ;
+}
@@ -0,0 +1,177 @@
+/////////////////////////////////////////////////////////////////
+// ElementXMLArena class
+//
+// The memory for an ElementXML tree: its nodes, strings, attribute
+// and child lists are carved out of a few large blocks, rather than
+// each being allocated separately, and all freed together when the
+// last node using the arena goes.
+//
+// Each node holds a reference to the arena it uses, so a node that's
+// kept after the rest of its message has been released still works.
+//
+// Tag and attribute names are also interned in a table shared by all
+// arenas (SML uses a small, fixed set of names), so most are never copied.
+//
+/////////////////////////////////////////////////////////////////
+
+#ifndef ELEMENTXML_ARENA_H
+#define ELEMENTXML_ARENA_H
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+namespace soarxml
+{
+
+    class ElementXMLArena
+    {
+        protected:
+            // Blocks after the first, which is allocated with the arena itself
+            struct Block
+            {
+                Block*  m_pNext ;
+            } ;
+
+            std::atomic<long>   m_RefCount ;
+
+            // The free space in the current block
+            char*       m_pFree ;
+            char*       m_pEnd ;
+
+            Block*      m_pBlocks ;
+            size_t      m_NextBlockSize ;
+
+            // These objects are created through Create()
+            ElementXMLArena() ;
+            ~ElementXMLArena() ;
+
+            void*       AllocateFromNewBlock(size_t size, size_t alignment) ;
+
+        public:
+            /*************************************************************
+            * @brief Create an arena, with room for about expectedSize bytes
+            *        before it needs another block.
+            *        The arena starts with one reference.
+            *************************************************************/
+            static ElementXMLArena* Create(size_t expectedSize) ;
+
+            void AddRef()
+            {
+                m_RefCount.fetch_add(1) ;
+            }
+
+            // Frees the arena (and everything allocated from it) when the last reference goes
+            void ReleaseRef() ;
+
+            /*************************************************************
+            * @brief Allocate memory that lives as long as the arena.
+            *************************************************************/
+            void* Allocate(size_t size, size_t alignment)
+            {
+                char* pStart = reinterpret_cast<char*>((reinterpret_cast<size_t>(m_pFree) + alignment - 1) & ~(alignment - 1)) ;
+
+                if (pStart + size > m_pEnd)
+                {
+                    return AllocateFromNewBlock(size, alignment) ;
+                }
+
+                m_pFree = pStart + size ;
+                return pStart ;
+            }
+
+            // A string of length characters (plus the terminating null), which starts out empty
+            char* AllocateString(int length)
+            {
+                char* pString = static_cast<char*>(Allocate(length + 1, 1)) ;
+                pString[0] = 0 ;
+                return pString ;
+            }
+
+            char* CopyString(char const* pOriginal) ;
+            char* CopyBuffer(char const* pOriginal, int length) ;
+
+            /*************************************************************
+            * @brief Returns a copy of the name that lives forever and is
+            *        shared by every element using the same name, or NULL
+            *        if the name isn't one we'll intern (the table is only
+            *        meant for the names SML uses, so it's limited in size).
+            *************************************************************/
+            static char const* InternName(char const* pName) ;
+    } ;
+
+    /////////////////////////////////////////////////////////////////
+    // ArenaVector class
+    //
+    // A list that keeps its first few items inside the object that owns
+    // it and the rest in an arena.  Items must be plain data, as they're
+    // moved with memcpy and never destroyed.
+    //
+    /////////////////////////////////////////////////////////////////
+    template <typename T, int InlineSize>
+    class ArenaVector
+    {
+        protected:
+            T*      m_pItems ;
+            int     m_Size ;
+            int     m_Capacity ;
+            T       m_Inline[InlineSize] ;
+
+            // The items may point into the object, so it can't be copied
+            ArenaVector(ArenaVector const&) ;
+            ArenaVector& operator=(ArenaVector const&) ;
+
+        public:
+            ArenaVector()
+            {
+                m_pItems   = m_Inline ;
+                m_Size     = 0 ;
+                m_Capacity = InlineSize ;
+            }
+
+            int size() const
+            {
+                return m_Size ;
+            }
+
+            bool empty() const
+            {
+                return m_Size == 0 ;
+            }
+
+            // Must call Grow() before adding an item to a full list
+            bool full() const
+            {
+                return m_Size == m_Capacity ;
+            }
+
+            T& operator[](int index)
+            {
+                return m_pItems[index] ;
+            }
+
+            T const& operator[](int index) const
+            {
+                return m_pItems[index] ;
+            }
+
+            void push_back(T const& item)
+            {
+                m_pItems[m_Size++] = item ;
+            }
+
+            void Grow(ElementXMLArena* pArena)
+            {
+                int capacity = m_Capacity * 2 ;
+                T* pItems = static_cast<T*>(pArena->Allocate(sizeof(T) * capacity, sizeof(void*))) ;
+
+                memcpy(pItems, m_pItems, sizeof(T) * m_Size) ;
+
+                m_pItems   = pItems ;
+                m_Capacity = capacity ;
+            }
+    } ;
+
+} // namespace soarxml
+
+#endif // ELEMENTXML_ARENA_H
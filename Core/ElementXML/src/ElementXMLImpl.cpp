@@ -25,7 +25,7 @@
 
 #include "ElementXMLImpl.h"
 
-#include <algorithm>    // For "for_each"
+#include <new>          // For placement new
 
 #ifndef HAVE_ATOMICS
 bool global_locks_initialized = false;
@@ -423,75 +423,103 @@ ElementXMLImpl::ElementXMLImpl(void)
     
     m_TagName = NULL ;
     m_CharacterData = NULL ;
+    m_OwnsCharacterData = false ;
     m_Comment = NULL ;
     m_ErrorCode = 0 ;
     m_pParent = NULL ;
     
+    // The arena is created when we first store a string
+    m_pArena  = NULL ;
+    m_InArena = false ;
+    
     // Creation of the object creates an initial reference.
     m_RefCount = 1 ;
     
-    // Guessing at the approx number of strings we'll store makes adding
-    // attributes substantially faster.
-    m_StringsToDelete.reserve(20) ;
-    
     elementxml_atomic_init();
 }
 
-// Provide a static way to call release ref to get round an STL challenge.
-static inline void StaticReleaseRef(ElementXMLImpl* pXML)
+/*************************************************************
+* @brief Constructor for an element stored in an arena.
+*************************************************************/
+ElementXMLImpl::ElementXMLImpl(ElementXMLArena* pArena)
 {
-    pXML->ReleaseRef() ;
+    m_UseCData = false ;
+    
+    m_DataIsBinary     = false ;
+    m_BinaryDataLength = 0 ;
+    
+    m_TagName = NULL ;
+    m_CharacterData = NULL ;
+    m_OwnsCharacterData = false ;
+    m_Comment = NULL ;
+    m_ErrorCode = 0 ;
+    m_pParent = NULL ;
+    
+    // Each element holds a reference to its arena, so it can outlive the rest of the tree
+    m_pArena  = pArena ;
+    m_InArena = true ;
+    pArena->AddRef() ;
+    
+    m_RefCount = 1 ;
+    
+    elementxml_atomic_init();
 }
 
 /*************************************************************
-* @brief Destructor.
+* @brief Creates a new element, stored in a new arena.
 *************************************************************/
-ElementXMLImpl::~ElementXMLImpl(void)
+ElementXMLImpl* ElementXMLImpl::Create(int expectedSize)
 {
-    // Delete the comment
-    DeleteString(m_Comment) ;
+    ElementXMLArena* pArena = ElementXMLArena::Create(sizeof(ElementXMLImpl) + (expectedSize > 0 ? expectedSize : 0)) ;
+    
+    ElementXMLImpl* pElement = new(pArena->Allocate(sizeof(ElementXMLImpl), alignof(ElementXMLImpl))) ElementXMLImpl(pArena) ;
     
-    // Delete the character data
-    DeleteString(m_CharacterData) ;
+    // The element now holds the only reference to the arena
+    pArena->ReleaseRef() ;
     
-    // Delete all of the strings that we own
-    // (We store these in a separate list because some elements in
-    //  the attribute map may be constants and some strings we need to delete
-    //  so we can't walk it and delete its contents).
+    return pElement ;
+}
+
+/*************************************************************
+* @brief Creates a new element in this element's arena and
+*        adds it as a child.
+*************************************************************/
+ElementXMLImpl* ElementXMLImpl::CreateChild()
+{
+    ElementXMLArena* pArena = GetArena() ;
     
-    // Replacing a simple walking of the list with a faster algorithmic method
-    // for doing the same thing.
-    std::for_each(m_StringsToDelete.begin(), m_StringsToDelete.end(), &ElementXMLImpl::DeleteString) ;
+    ElementXMLImpl* pChild = new(pArena->Allocate(sizeof(ElementXMLImpl), alignof(ElementXMLImpl))) ElementXMLImpl(pArena) ;
     
-    /*
-    xmlStringListIter iter = m_StringsToDelete.begin() ;
+    AddChild(pChild) ;
     
-    while (iter != m_StringsToDelete.end())
+    return pChild ;
+}
+
+/*************************************************************
+* @brief Destructor.
+*
+* The arena is released by ReleaseRef(), as this object may be stored in it.
+*************************************************************/
+ElementXMLImpl::~ElementXMLImpl(void)
+{
+    // Delete the character data, if it was passed to us rather than copied into the arena
+    if (m_OwnsCharacterData)
     {
-        char* str = *iter ;
-        iter++ ;
+        DeleteString(const_cast<char*>(m_CharacterData)) ;
+    }
     
-        DeleteString(str) ;
+    // Delete all of the strings that we were passed
+    // (Most strings are stored in the arena, so this list is usually empty).
+    for (xmlStringListIter iter = m_StringsToDelete.begin() ; iter != m_StringsToDelete.end() ; iter++)
+    {
+        DeleteString(*iter) ;
     }
-    */
     
     // Delete all children
-    
-    // Again, replacing this walking of the list with a faster use of std::for_each.
-    // We'll use a static method and have it call the member function because it's beyond
-    // me how to use std::mem_fun_ref and friends to call directly to the member.
-    std::for_each(m_Children.begin(), m_Children.end(), &StaticReleaseRef) ;
-    /*
-    xmlListIter iterChildren = m_Children.begin() ;
-    
-    while (iterChildren != m_Children.end())
+    for (int i = 0 ; i < m_Children.size() ; i++)
     {
-        ElementXMLImpl* pChild = *iterChildren ;
-        iterChildren++ ;
-    
-        pChild->ReleaseRef() ;
+        m_Children[i]->ReleaseRef() ;
     }
-    */
 }
 
 /*************************************************************
@@ -503,48 +531,61 @@ ElementXMLImpl::~ElementXMLImpl(void)
 *************************************************************/
 ElementXMLImpl* ElementXMLImpl::MakeCopy() const
 {
-    ElementXMLImpl* pCopy = new ElementXMLImpl() ;
+    return MakeCopy(NULL) ;
+}
+
+ElementXMLImpl* ElementXMLImpl::MakeCopy(ElementXMLArena* pArena) const
+{
+    ElementXMLImpl* pCopy = NULL ;
+    
+    if (pArena)
+    {
+        pCopy = new(pArena->Allocate(sizeof(ElementXMLImpl), alignof(ElementXMLImpl))) ElementXMLImpl(pArena) ;
+    }
+    else
+    {
+        pCopy   = Create() ;
+        pArena  = pCopy->m_pArena ;
+    }
     
     pCopy->m_ErrorCode        = m_ErrorCode ;
     pCopy->m_UseCData         = m_UseCData ;
     
-    pCopy->m_RefCount         = 1 ;
-    
-    // Start with a null parent and override this later
-    pCopy->m_pParent          = NULL ;
-    
     // Copy the comment
-    pCopy->SetComment(m_Comment) ;
+    if (m_Comment)
+    {
+        pCopy->SetComment(m_Comment) ;
+    }
     
     // Copy the tag name
-    pCopy->SetTagName(m_TagName) ;
-    
-    // Copy the character data
-    if (m_DataIsBinary)
+    if (m_TagName)
     {
-        pCopy->SetBinaryCharacterData(m_CharacterData, m_BinaryDataLength) ;
+        pCopy->SetTagName(m_TagName) ;
     }
-    else
+    
+    // Copy the character data
+    if (m_CharacterData)
     {
-        pCopy->SetCharacterData(m_CharacterData) ;
+        if (m_DataIsBinary)
+        {
+            pCopy->SetBinaryCharacterDataFast(pArena->CopyBuffer(m_CharacterData, m_BinaryDataLength), m_BinaryDataLength) ;
+        }
+        else
+        {
+            pCopy->SetCharacterDataFast(pArena->CopyString(m_CharacterData)) ;
+        }
     }
     
     // Copy the attributes
-    for (xmlAttributeMapConstIter mapIter = m_AttributeMap.begin() ; mapIter != m_AttributeMap.end() ; mapIter++)
+    for (int i = 0 ; i < m_Attributes.size() ; i++)
     {
-        xmlStringConst att = mapIter->first ;
-        xmlStringConst val = mapIter->second ;
-        
-        pCopy->AddAttribute(att, val) ;
+        pCopy->SetAttribute(pCopy->CopyName(m_Attributes[i].m_Name), pArena->CopyString(m_Attributes[i].m_Value)) ;
     }
     
-    // Copy all of the children, overwriting the parent field for them so that everything connects up correctly.
-    for (xmlListConstIter iterChildren = m_Children.begin() ; iterChildren != m_Children.end() ; iterChildren++)
+    // Copy all of the children (into the same arena), adding them sets their parent field so that everything connects up correctly.
+    for (int i = 0 ; i < m_Children.size() ; i++)
     {
-        ElementXMLImpl* pChild = *iterChildren ;
-        ElementXMLImpl* pChildCopy = pChild->MakeCopy() ;
-        pChildCopy->m_pParent = pCopy ;
-        pCopy->AddChild(pChildCopy) ;
+        pCopy->AddChild(m_Children[i]->MakeCopy(pArena)) ;
     }
     
     return pCopy ;
@@ -561,7 +602,22 @@ int ElementXMLImpl::ReleaseRef()
     
     if (refCount == 0)
     {
-        delete this ;
+        // The arena may hold this object, so release it last
+        ElementXMLArena* pArena = m_pArena ;
+        
+        if (m_InArena)
+        {
+            this->~ElementXMLImpl() ;
+        }
+        else
+        {
+            delete this ;
+        }
+        
+        if (pArena)
+        {
+            pArena->ReleaseRef() ;
+        }
     }
     
     return static_cast<int>(refCount) ;
@@ -608,7 +664,7 @@ bool ElementXMLImpl::SetTagName(char* tagName, bool copyName)
     // Decide if we're taking ownership of this string or not.
     if (copyName)
     {
-        tagName = CopyString(tagName) ;
+        return SetTagNameFast(CopyName(tagName)) ;
     }
     
     // In this version, we take ownership of the name.
@@ -673,6 +729,12 @@ void ElementXMLImpl::AddChild(ElementXMLImpl* pChild)
     }
     
     pChild->m_pParent = this ;
+    
+    if (m_Children.full())
+    {
+        m_Children.Grow(GetArena()) ;
+    }
+    
     this->m_Children.push_back(pChild) ;
 }
 
@@ -681,7 +743,7 @@ void ElementXMLImpl::AddChild(ElementXMLImpl* pChild)
 *************************************************************/
 int ElementXMLImpl::GetNumberChildren() const
 {
-    return static_cast<int>(this->m_Children.size()) ;
+    return this->m_Children.size() ;
 }
 
 /*************************************************************
@@ -694,7 +756,7 @@ int ElementXMLImpl::GetNumberChildren() const
 *************************************************************/
 ElementXMLImpl const* ElementXMLImpl::GetChild(int index) const
 {
-    if (index < 0 || index >= static_cast<int>(m_Children.size()))
+    if (index < 0 || index >= m_Children.size())
     {
         return NULL ;
     }
@@ -739,7 +801,7 @@ bool ElementXMLImpl::AddAttribute(char* attributeName, char* attributeValue, boo
     // Decide if we're taking ownership of this string or not.
     if (copyName)
     {
-        attributeName = CopyString(attributeName) ;
+        return AddAttributeFast(CopyName(attributeName), attributeValue, copyValue) ;
     }
     
     // In this version of the call, we own the attribute as well
@@ -767,11 +829,13 @@ bool ElementXMLImpl::AddAttributeFast(char const* attributeName, char* attribute
     // Decide if we're taking ownership of this string or not.
     if (copyValue)
     {
-        attributeValue = CopyString(attributeValue) ;
+        attributeValue = GetArena()->CopyString(attributeValue) ;
+    }
+    else
+    {
+        // In this version of the call, we only own the value.
+        m_StringsToDelete.push_back(attributeValue) ;
     }
-    
-    // In this version of the call, we only own the value.
-    m_StringsToDelete.push_back(attributeValue) ;
     
 #ifdef DEBUG
     // Run this test after we've added it to list of strings to delete,
@@ -782,7 +846,7 @@ bool ElementXMLImpl::AddAttributeFast(char const* attributeName, char* attribute
     }
 #endif
     
-    m_AttributeMap[attributeName] = attributeValue ;
+    SetAttribute(attributeName, attributeValue) ;
     
     return true ;
 }
@@ -808,7 +872,7 @@ bool ElementXMLImpl::AddAttributeFastFast(char const* attributeName, char const*
     }
 #endif
     
-    m_AttributeMap[attributeName] = attributeValue ;
+    SetAttribute(attributeName, attributeValue) ;
     
     return true ;
 }
@@ -818,7 +882,7 @@ bool ElementXMLImpl::AddAttributeFastFast(char const* attributeName, char const*
 *************************************************************/
 int ElementXMLImpl::GetNumberAttributes() const
 {
-    return static_cast<int>(m_AttributeMap.size()) ;
+    return m_Attributes.size() ;
 }
 
 /*************************************************************
@@ -830,22 +894,12 @@ int ElementXMLImpl::GetNumberAttributes() const
 *************************************************************/
 const char* ElementXMLImpl::GetAttributeName(int index) const
 {
-    xmlAttributeMapConstIter mapIter = m_AttributeMap.begin() ;
-    
-    while (mapIter != m_AttributeMap.end())
+    if (index < 0 || index >= m_Attributes.size())
     {
-        if (index == 0)
-        {
-            xmlStringConst att = mapIter->first ;
-            
-            return att ;
-        }
-        
-        mapIter++ ;
-        index-- ;
+        return NULL ;
     }
     
-    return NULL ;
+    return m_Attributes[index].m_Name ;
 }
 
 /*************************************************************
@@ -855,22 +909,12 @@ const char* ElementXMLImpl::GetAttributeName(int index) const
 *************************************************************/
 const char* ElementXMLImpl::GetAttributeValue(int index) const
 {
-    xmlAttributeMapConstIter mapIter = m_AttributeMap.begin() ;
-    
-    while (mapIter != m_AttributeMap.end())
+    if (index < 0 || index >= m_Attributes.size())
     {
-        if (index == 0)
-        {
-            xmlStringConst val = mapIter->second ;
-            
-            return val ;
-        }
-        
-        mapIter++ ;
-        index-- ;
+        return NULL ;
     }
     
-    return NULL ;
+    return m_Attributes[index].m_Value ;
 }
 
 /*************************************************************
@@ -881,19 +925,64 @@ const char* ElementXMLImpl::GetAttributeValue(int index) const
 *************************************************************/
 const char* ElementXMLImpl::GetAttribute(const char* attName) const
 {
-    // Note: We can't use the apparently simpler "return m_AttributeMap[attName]" for two reasons.
-    // First, this will create an object in the map if one didn't exist before (which we don't want) and
-    // Second, there is no const version of [] so we can't do this anyway (it's not const because of the first behavior...)
+    // Elements only have a few attributes, so a linear search is quickest.
+    // Names are usually interned, so we can often match on the pointer alone.
+    for (int i = 0 ; i < m_Attributes.size() ; i++)
+    {
+        xmlStringConst att = m_Attributes[i].m_Name ;
+        
+        if (att == attName || strcmp(att, attName) == 0)
+        {
+            return m_Attributes[i].m_Value ;
+        }
+    }
     
-    // Use find to locate the object not [].
-    xmlAttributeMapConstIter iter = m_AttributeMap.find(attName) ;
+    return NULL ;
+}
+
+/*************************************************************
+* @brief Sets an attribute, replacing any existing value
+*        (neither string is copied).
+*************************************************************/
+void ElementXMLImpl::SetAttribute(char const* attributeName, char const* attributeValue)
+{
+    for (int i = 0 ; i < m_Attributes.size() ; i++)
+    {
+        xmlStringConst att = m_Attributes[i].m_Name ;
+        
+        if (att == attributeName || strcmp(att, attributeName) == 0)
+        {
+            m_Attributes[i].m_Value = attributeValue ;
+            return ;
+        }
+    }
     
-    if (iter == m_AttributeMap.end())
+    if (m_Attributes.full())
     {
-        return NULL ;
+        m_Attributes.Grow(GetArena()) ;
     }
     
-    return iter->second ;
+    xmlAttribute attribute ;
+    attribute.m_Name  = attributeName ;
+    attribute.m_Value = attributeValue ;
+    
+    m_Attributes.push_back(attribute) ;
+}
+
+/*************************************************************
+* @brief Copies a tag or attribute name, using the shared copy
+*        if the name has been interned.
+*************************************************************/
+char const* ElementXMLImpl::CopyName(char const* name)
+{
+    char const* interned = ElementXMLArena::InternName(name) ;
+    
+    if (interned)
+    {
+        return interned ;
+    }
+    
+    return GetArena()->CopyString(name) ;
 }
 
 /*************************************************************
@@ -910,7 +999,7 @@ const char* ElementXMLImpl::GetAttribute(const char* attName) const
 *************************************************************/
 bool ElementXMLImpl::SetComment(const char* comment)
 {
-    m_Comment = CopyString(comment) ;
+    m_Comment = GetArena()->CopyString(comment) ;
     return true ;
 }
 
@@ -946,15 +1035,13 @@ void ElementXMLImpl::SetCharacterData(char* characterData, bool copyData)
     // Decide if we're taking ownership of this string or not.
     if (copyData)
     {
-        characterData = CopyString(characterData) ;
+        SetCharacterDataInternal(GetArena()->CopyString(characterData), false) ;
     }
-    
-    if (this->m_CharacterData != NULL)
+    else
     {
-        DeleteString(this->m_CharacterData) ;
+        SetCharacterDataInternal(characterData, true) ;
     }
     
-    this->m_CharacterData = characterData ;
     this->m_DataIsBinary = false ;
 }
 
@@ -963,19 +1050,47 @@ void ElementXMLImpl::SetBinaryCharacterData(char* characterData, int length, boo
     // Decide if we're taking ownership of this string or not.
     if (copyData)
     {
-        characterData = CopyBuffer(characterData, length) ;
+        SetCharacterDataInternal(GetArena()->CopyBuffer(characterData, length), false) ;
     }
-    
-    if (this->m_CharacterData != NULL)
+    else
     {
-        DeleteString(this->m_CharacterData) ;
+        SetCharacterDataInternal(characterData, true) ;
     }
     
-    this->m_CharacterData    = characterData ;
     this->m_DataIsBinary     = true ;
     this->m_BinaryDataLength = length ;
 }
 
+/*************************************************************
+* @brief Set the character data for this element, without copying it.
+*************************************************************/
+void ElementXMLImpl::SetCharacterDataFast(char const* characterData)
+{
+    SetCharacterDataInternal(characterData, false) ;
+    
+    this->m_DataIsBinary = false ;
+}
+
+void ElementXMLImpl::SetBinaryCharacterDataFast(char const* characterData, int length)
+{
+    SetCharacterDataInternal(characterData, false) ;
+    
+    this->m_DataIsBinary     = true ;
+    this->m_BinaryDataLength = length ;
+}
+
+void ElementXMLImpl::SetCharacterDataInternal(char const* characterData, bool owned)
+{
+    // Data in the arena is freed with it, so we only delete data we were passed
+    if (this->m_OwnsCharacterData)
+    {
+        DeleteString(const_cast<char*>(this->m_CharacterData)) ;
+    }
+    
+    this->m_CharacterData     = characterData ;
+    this->m_OwnsCharacterData = owned ;
+}
+
 /*************************************************************
 * @brief Get the character data for this element.
 *
@@ -1176,20 +1291,16 @@ int ElementXMLImpl::DetermineXMLStringLength(int depth, bool includeChildren, bo
         }
     }
     
-    xmlAttributeMapConstIter mapIter = m_AttributeMap.begin() ;
-    
-    while (mapIter != m_AttributeMap.end())
+    for (int i = 0 ; i < m_Attributes.size() ; i++)
     {
-        xmlStringConst att = mapIter->first ;
-        xmlStringConst val = mapIter->second ;
+        xmlStringConst att = m_Attributes[i].m_Name ;
+        xmlStringConst val = m_Attributes[i].m_Value ;
         
         // The attribute name is an identifier and can't contain special chars
         len += kLenSpace + static_cast<int>(strlen(att)) + kLenEquals ;
         
         // The value can contain special chars
         len += kLenQuote + CountXMLLength(val) + kLenQuote ;
-        
-        mapIter++ ;
     }
     
     bool addedNewLine = false ;
@@ -1206,14 +1317,10 @@ int ElementXMLImpl::DetermineXMLStringLength(int depth, bool includeChildren, bo
     
     if (includeChildren)
     {
-        xmlListConstIter iter = m_Children.begin() ;
-        
-        while (iter != m_Children.end())
+        for (int i = 0 ; i < m_Children.size() ; i++)
         {
-            ElementXMLImpl const* pChild = *iter ;
+            ElementXMLImpl const* pChild = m_Children[i] ;
             len += pChild->DetermineXMLStringLength(depth + 1, includeChildren, insertNewLines) ;
-            
-            iter++ ;
         }
     }
     
@@ -1280,12 +1387,10 @@ char* ElementXMLImpl::GenerateXMLString(int depth, char* pStart, int maxLength,
     }
     
     // The attributes
-    xmlAttributeMapConstIter mapIter = m_AttributeMap.begin() ;
-    
-    while (mapIter != m_AttributeMap.end())
+    for (int i = 0 ; i < m_Attributes.size() ; i++)
     {
-        xmlStringConst att = mapIter->first ;
-        xmlStringConst val = mapIter->second ;
+        xmlStringConst att = m_Attributes[i].m_Name ;
+        xmlStringConst val = m_Attributes[i].m_Value ;
         
         // The attribute name is an identifier and can't contain special chars
         pStr = AddString(pStr, kSpace) ;
@@ -1296,8 +1401,6 @@ char* ElementXMLImpl::GenerateXMLString(int depth, char* pStart, int maxLength,
         pStr = AddString(pStr, kQuote) ;
         pStr = AddXMLString(pStr, val) ;
         pStr = AddString(pStr, kQuote) ;
-        
-        mapIter++ ;
     }
     
     // We use a special attribute to show this character
@@ -1347,14 +1450,10 @@ char* ElementXMLImpl::GenerateXMLString(int depth, char* pStart, int maxLength,
     
     if (includeChildren)
     {
-        xmlListConstIter iter = m_Children.begin() ;
-        
-        while (iter != m_Children.end())
+        for (int i = 0 ; i < m_Children.size() ; i++)
         {
-            ElementXMLImpl const* pChild = *iter ;
+            ElementXMLImpl const* pChild = m_Children[i] ;
             pStr = pChild->GenerateXMLString(depth + 1, pStr, maxLength, includeChildren, insertNewLines) ;
-            
-            iter++ ;
         }
     }
     
@@ -37,10 +37,9 @@
 #include <cstdlib>
 #include <cstring>
 #include <string>
-#include <list>
 #include <vector>
-#include <map>
 #include "Export.h"
+#include "ElementXMLArena.h"
 
 namespace soarxml
 {
@@ -49,11 +48,6 @@ namespace soarxml
     class ElementXMLImpl ;
     class MessageGenerator ;
     
-// Used to store a list of ElementXMLImpl nodes (use a vector for rapid index access)
-    typedef std::vector<ElementXMLImpl*>    xmlList ;
-    typedef xmlList::iterator           xmlListIter ;
-    typedef xmlList::const_iterator     xmlListConstIter ;
-    
 // I think we'll just use char* internally for strings, but having a typedef means we can
 // change this decision later with less typing.
     typedef char*           xmlString ;
@@ -64,19 +58,18 @@ namespace soarxml
     typedef xmlStringList::iterator         xmlStringListIter ;
     typedef xmlStringList::const_iterator   xmlStringListConstIter ;
     
-// We need a comparator to make the map we're about to define work with char*
-    struct strCompareElementXMLImpl
+// An attribute name and its value
+    struct xmlAttribute
     {
-        inline bool operator()(const char* s1, const char* s2) const
-        {
-            return std::strcmp(s1, s2) < 0;
-        }
+        xmlStringConst  m_Name ;
+        xmlStringConst  m_Value ;
     };
     
-// Used to store a map from attribute name to attribute value
-    typedef std::map<xmlStringConst, xmlStringConst, strCompareElementXMLImpl>  xmlAttributeMap ;
-    typedef xmlAttributeMap::iterator                                       xmlAttributeMapIter ;
-    typedef xmlAttributeMap::const_iterator                                 xmlAttributeMapConstIter ;
+// Used to store the attributes (in the order they were added) and children of an element.
+// Elements rarely have more than a few of either, so they're kept inside the element
+// until there are too many and then in the element's arena.
+    typedef ArenaVector<xmlAttribute, 4>    xmlAttributeList ;
+    typedef ArenaVector<ElementXMLImpl*, 2> xmlList ;
     
     /*************************************************************
     * @brief The ElementXMLImpl class represents an element in an XML stream.
@@ -91,16 +84,20 @@ namespace soarxml
             int             m_ErrorCode ;       // Used to report any errors.
             bool            m_UseCData ;        // If true, should store character data in a CDATA section when encoding as XML.
             xmlStringConst  m_TagName ;         // The tag name (e.g. in <name>...</name> the tag name is "name")
-            xmlString       m_CharacterData ;   // The character data (e.g. in <name>Albert Einstein</name> the char data is "Albert Einstein")
-            xmlAttributeMap m_AttributeMap ;    // Mapping from attribute-name to attribute-value (e.g. in <name first="Albert"> first is an attribute with value "Albert")
+            xmlStringConst  m_CharacterData ;   // The character data (e.g. in <name>Albert Einstein</name> the char data is "Albert Einstein")
+            bool            m_OwnsCharacterData ; // If true, the character data was passed to us (rather than copied into the arena) and we must delete it
+            xmlAttributeList m_Attributes ;     // Attribute names and values (e.g. in <name first="Albert"> first is an attribute with value "Albert")
             xmlList         m_Children ;        // List of children of this element
-            xmlString       m_Comment ;         // Used to attach a comment to this object.  It will appear ahead of the element when stored/retrieved.
+            xmlStringConst  m_Comment ;         // Used to attach a comment to this object.  It will appear ahead of the element when stored/retrieved.
             volatile long   m_RefCount ;        // Reference count.  Set to 1 on initialization.  When reaches 0 the object is deleted.
             bool            m_DataIsBinary ;    // If true, then the character data is treated as a binary buffer (can contain embedded nulls) and the binary length is needed
             int             m_BinaryDataLength ;// Gives the length of the character data buffer, when it's being treated as a binary buffer.  (only valid if m_IsDataBinary is true).
             ElementXMLImpl* m_pParent ;         // The parent of this object (can be NULL)
             
-            xmlStringList   m_StringsToDelete ; // List of strings we now own and should delete when we are destroyed.
+            ElementXMLArena* m_pArena ;         // Where our strings and lists are stored (shared with the rest of the message, and created when first needed)
+            bool            m_InArena ;         // If true, this object itself is stored in m_pArena (rather than allocated with new)
+            
+            xmlStringList   m_StringsToDelete ; // List of strings we were passed (rather than copied) and should delete when we are destroyed.
             
             /*************************************************************
             * @brief Destructor.  This is private so we are forced to
@@ -109,6 +106,31 @@ namespace soarxml
         protected:
             virtual ~ElementXMLImpl(void);
             
+            // Creates an element stored in the given arena
+            ElementXMLImpl(ElementXMLArena* pArena) ;
+            
+            // The arena for our strings, creating it if we're the first to need one
+            ElementXMLArena* GetArena()
+            {
+                if (!m_pArena)
+                {
+                    m_pArena = ElementXMLArena::Create(0) ;
+                }
+                return m_pArena ;
+            }
+            
+            // Copies a tag or attribute name: interned if we can, otherwise into our arena
+            char const* CopyName(char const* name) ;
+            
+            // Sets an attribute without copying either string (replacing any existing value)
+            void SetAttribute(char const* attributeName, char const* attributeValue) ;
+            
+            // Sets character data that isn't copied, noting whether we should delete it
+            void SetCharacterDataInternal(char const* characterData, bool owned) ;
+            
+            // Makes a copy of this element and its children, stored in the given arena (or a new one)
+            ElementXMLImpl* MakeCopy(ElementXMLArena* pArena) const ;
+            
         public:
             /*************************************************************
             * @brief XML ids can only contain letters, numbers, . - and _.
@@ -127,6 +149,32 @@ namespace soarxml
             *************************************************************/
             ElementXMLImpl(void);
             
+            /*************************************************************
+            * @brief Creates a new element, stored in an arena that its
+            *        strings (and any children made with CreateChild())
+            *        will share, so building a message makes few allocations.
+            *
+            * @param expectedSize   About how many bytes the message will need (0 if unknown).
+            *************************************************************/
+            static ElementXMLImpl* Create(int expectedSize = 0) ;
+            
+            /*************************************************************
+            * @brief Creates a new element in this element's arena and adds
+            *        it as a child.  The child belongs to this element
+            *        (as if passed to AddChild()).
+            *************************************************************/
+            ElementXMLImpl* CreateChild() ;
+            
+            /*************************************************************
+            * @brief Allocates a string that lives as long as this element
+            *        (and is freed with it, so don't call DeleteString() on it).
+            *        It can be passed to the Fast methods, which don't copy.
+            *************************************************************/
+            char* AllocateElementString(int length)
+            {
+                return GetArena()->AllocateString(length) ;
+            }
+            
             /*************************************************************
             * @brief Release our reference to this object, possibly
             *        causing it to be deleted.
@@ -190,7 +238,7 @@ namespace soarxml
             *************************************************************/
             bool SetTagName(char const* tagName)
             {
-                return SetTagName(CopyString(tagName), false) ;
+                return SetTagName(const_cast<char*>(tagName), true) ;
             }
             
             /*************************************************************
@@ -274,11 +322,11 @@ namespace soarxml
             *************************************************************/
             bool AddAttribute(char const* attributeName, char* attributeValue)
             {
-                return AddAttribute(CopyString(attributeName), attributeValue, false, true) ;
+                return AddAttribute(const_cast<char*>(attributeName), attributeValue, true, true) ;
             }
             bool AddAttribute(char const* attributeName, char const* attributeValue)
             {
-                return AddAttribute(CopyString(attributeName), CopyString(attributeValue), false, false) ;
+                return AddAttribute(const_cast<char*>(attributeName), const_cast<char*>(attributeValue), true, true) ;
             }
             
             /*************************************************************
@@ -561,6 +609,15 @@ namespace soarxml
             *************************************************************/
             bool SetTagNameFast(char const* tagName) ;
             
+            /*************************************************************
+            * @brief Set the character data for this element, without copying it.
+            *
+            * NOTE: The caller must ensure the data doesn't go out of scope before this
+            *       object is destroyed (e.g. by allocating it with AllocateElementString()).
+            *************************************************************/
+            void SetCharacterDataFast(char const* characterData) ;
+            void SetBinaryCharacterDataFast(char const* characterData, int length) ;
+            
         protected:
             /*************************************************************
             * @brief Converts the XML object to a string.
@@ -51,7 +51,15 @@ inline static ElementXMLImpl* GetElementFromHandle(ElementXML_Handle hXML)
 *************************************************************/
 ElementXML_Handle soarxml_NewElementXML()
 {
-    return reinterpret_cast<ElementXML_Handle>(new ElementXMLImpl()) ;
+    return reinterpret_cast<ElementXML_Handle>(ElementXMLImpl::Create()) ;
+}
+
+/*************************************************************
+* @brief Creates a new element for a message, stored in an arena.
+*************************************************************/
+ElementXML_Handle soarxml_NewMessageElementXML(int expectedSize)
+{
+    return reinterpret_cast<ElementXML_Handle>(ElementXMLImpl::Create(expectedSize)) ;
 }
 
 /*************************************************************
@@ -167,6 +175,14 @@ void soarxml_AddChild(ElementXML_Handle hXML, ElementXML_Handle hChild)
     return GetElementFromHandle(hXML)->AddChild(GetElementFromHandle(hChild)) ;
 }
 
+/*************************************************************
+* @brief Creates a new element in this element's arena and adds it as a child.
+*************************************************************/
+ElementXML_Handle soarxml_AddNewChild(ElementXML_Handle hXML)
+{
+    return reinterpret_cast<ElementXML_Handle>(GetElementFromHandle(hXML)->CreateChild()) ;
+}
+
 /*************************************************************
 * @brief Returns the number of children of this element.
 *************************************************************/
@@ -524,6 +540,27 @@ bool soarxml_SetTagNameFast(ElementXML_Handle hXML, char const* tagName)
     return GetElementFromHandle(hXML)->SetTagNameFast(tagName) ;
 }
 
+/*************************************************************
+* @brief Set the character data for this element, without copying it.
+*************************************************************/
+void soarxml_SetCharacterDataFast(ElementXML_Handle hXML, char const* characterData)
+{
+    GetElementFromHandle(hXML)->SetCharacterDataFast(characterData) ;
+}
+
+void soarxml_SetBinaryCharacterDataFast(ElementXML_Handle hXML, char const* characterData, int length)
+{
+    GetElementFromHandle(hXML)->SetBinaryCharacterDataFast(characterData, length) ;
+}
+
+/*************************************************************
+* @brief Allocates a string that is freed along with this element.
+*************************************************************/
+char* soarxml_AllocateElementString(ElementXML_Handle hXML, int length)
+{
+    return GetElementFromHandle(hXML)->AllocateElementString(length) ;
+}
+
 ////////////////////////////////////////////////////////////////
 //
 // Error reporting functions.
@@ -54,6 +54,15 @@ extern "C" {
 *************************************************************/
 EXPORT ElementXML_Handle soarxml_NewElementXML() ;
 
+/*************************************************************
+* @brief Creates a new element for a message, stored in an arena
+*        that its strings and children (see soarxml_AddNewChild())
+*        will share.
+*
+* @param expectedSize   About how many bytes the message will need (0 if unknown).
+*************************************************************/
+EXPORT ElementXML_Handle soarxml_NewMessageElementXML(int expectedSize) ;
+
 /*************************************************************
 * @brief Release our reference to this object, possibly
 *        causing it to be deleted.
@@ -143,6 +152,12 @@ EXPORT char const* soarxml_GetComment(ElementXML_Handle hXML) ;
 *************************************************************/
 EXPORT void soarxml_AddChild(ElementXML_Handle hXML, ElementXML_Handle hChild) ;
 
+/*************************************************************
+* @brief Creates a new element in this element's arena and adds it as a child.
+*        The caller should *not* call releaseRef() on this child.
+*************************************************************/
+EXPORT ElementXML_Handle soarxml_AddNewChild(ElementXML_Handle hXML) ;
+
 /*************************************************************
 * @brief Returns the number of children of this element.
 *************************************************************/
@@ -423,6 +438,24 @@ EXPORT bool soarxml_AddAttributeFastFast(ElementXML_Handle hXML, char const* att
 *************************************************************/
 EXPORT bool soarxml_SetTagNameFast(ElementXML_Handle hXML, char const* tagName) ;
 
+/*************************************************************
+* @brief Set the character data for this element, without copying it.
+*
+* NOTE: The caller must ensure the data does not go out of scope
+* before this object is destroyed (e.g. by allocating it with soarxml_AllocateElementString()).
+*************************************************************/
+EXPORT void soarxml_SetCharacterDataFast(ElementXML_Handle hXML, char const* characterData) ;
+
+EXPORT void soarxml_SetBinaryCharacterDataFast(ElementXML_Handle hXML, char const* characterData, int length) ;
+
+/*************************************************************
+* @brief Allocates a string that is freed along with this element
+*        (so it should not be passed to soarxml_DeleteString()).
+*
+* @param length     The length of the string (an extra byte is added for the terminating null).
+*************************************************************/
+EXPORT char* soarxml_AllocateElementString(ElementXML_Handle hXML, int length) ;
+
 ////////////////////////////////////////////////////////////////
 //
 // Error reporting functions.
@@ -292,11 +292,14 @@ void ParseXML::GetNextToken()
 * parse its children.
 *
 * @param lex        The lexical analyser for this parse.
+* @param pParent    The element this one is a child of (NULL for the root).
+*                   Children are stored in their parent's arena and are
+*                   added to the parent as they are created.
 *
 * @return The element that has just been read from the input stream.
 *
 *************************************************************************/
-ElementXMLImpl* ParseXML::ParseElement()
+ElementXMLImpl* ParseXML::ParseElement(ElementXMLImpl* pParent)
 {
     // Check if we're starting with a comment
     while (Have(kComment))
@@ -323,7 +326,7 @@ ElementXMLImpl* ParseXML::ParseElement()
     }
     
     // Create the object we'll be returning
-    ElementXMLImpl* pElement = new ElementXMLImpl() ;
+    ElementXMLImpl* pElement = pParent ? pParent->CreateChild() : ElementXMLImpl::Create() ;
     
     // Get the tag name
     ParseString tagName ;
@@ -433,13 +436,8 @@ ElementXMLImpl* ParseXML::ParseElement()
         {
             SetInCharData(false) ;  // Out of the char data now.
             
-            // Read the child element recursively.
-            ElementXMLImpl* pChild = ParseElement() ;
-            
-            if (pChild)
-            {
-                pElement->AddChild(pChild) ;
-            }
+            // Read the child element recursively (this adds it to us).
+            ParseElement(pElement) ;
             
             continue ;
         }
@@ -477,8 +475,11 @@ ElementXMLImpl* ParseXML::ParseElement()
     // The caller should then call in to get the error message.
     if (IsError())
     {
-        // This deletes pElement
-        pElement->ReleaseRef() ;
+        // This deletes pElement (a child is deleted along with the root)
+        if (!pParent)
+        {
+            pElement->ReleaseRef() ;
+        }
         return NULL ;
     }
     
@@ -356,7 +356,7 @@ namespace soarxml
             ParseXML(void);
             virtual ~ParseXML(void);
             
-            ElementXMLImpl* ParseElement() ;
+            ElementXMLImpl* ParseElement(ElementXMLImpl* pParent = NULL) ;
             std::string GetErrorMessage()
             {
                 return m_ErrorMsg ;
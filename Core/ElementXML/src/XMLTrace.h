@@ -118,18 +118,10 @@ namespace soarxml
             *************************************************************/
             void BeginTag(char const* pTagName)
             {
-                ElementXML* pChild = new ElementXML() ;
-                pChild->SetTagNameFast(pTagName) ;
-                
-                ElementXML_Handle hChild = NULL ;
-                
-                // The new tag is created as a child of the current tag (if we have one)
-                // or the root if we don't.  Adding the child deletes the pChild object
-                // normally, so we have to create a second one.  Perhaps we should redesign AddChild?
-                //  if (m_pCurrentTag == NULL)
-                //      hChild = m_XML->AddChild(pChild) ;
-                //  else
-                hChild = m_pCurrentTag->AddChild(pChild) ;
+                // The new tag is created as a child of the current tag, in the same
+                // arena as the rest of the trace (so building a trace makes few allocations).
+                ElementXML_Handle hChild = ::soarxml_AddNewChild(m_pCurrentTag->GetXMLHandle()) ;
+                ::soarxml_SetTagNameFast(hChild, pTagName) ;
                 
                 delete m_pCurrentTag ;
                 m_pCurrentTag = new ElementXML(hChild) ;
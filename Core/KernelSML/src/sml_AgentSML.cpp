@@ -54,6 +54,10 @@ AgentSML::AgentSML(KernelSML* pKernelSML, agent* pAgent)
     m_pCaptureFile = 0;
     getSoarInstance()->Register_Soar_AgentSML(pAgent->name, this);
 
+    // Seeding from the shared generator means seeding it before creating
+    // agents gives each of them a repeatable stream.
+    m_RNG.seed(SoarRandInt());
+
 }
 
 void AgentSML::InitListeners()
@@ -461,6 +465,8 @@ smlRunResult AgentSML::StepInClientThread(smlRunStepSize  stepSize)
 
     m_runState = sml_RUNSTATE_RUNNING;
 
+    SoarThreadRNGScope rngScope(&m_RNG);
+
     // This method does all the work
     return Step(stepSize);
 }
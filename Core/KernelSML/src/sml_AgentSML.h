@@ -20,6 +20,7 @@
 #include "sml_InputListener.h"
 
 #include "callback.h"
+#include "soar_rand.h"
 
 
 // Forward definitions for kernel
@@ -202,6 +203,11 @@ namespace sml
             
             AgentRunCallback*   m_pAgentRunCallback ;
             
+            // Random numbers for this agent.  Each agent draws from its own generator
+            // (whether it is stepped alone or alongside others on worker threads), so
+            // a seeded run gives the same results for any number of run threads.
+            MTRand          m_RNG ;
+            
             WmeMap          m_KernelTimeTagToWmeMap ; // Kernel time tag to kernel wme
             
             void AddWmeToWmeMap(int64_t clientTimeTag, wme* w);
@@ -602,6 +608,10 @@ namespace sml
             {
                 return m_pAgentRunCallback ;
             }
+            MTRand* GetRNG()
+            {
+                return &m_RNG ;
+            }
             
             uint64_t GetRunCounter(smlRunStepSize runStepSize) ;
             
@@ -121,6 +121,7 @@ void ConnectionManager::Shutdown()
     {
         Connection* pConnection = *iter ;
         pConnection->CloseConnection() ;
+        pConnection->RemoveMessageWaiter(&m_MessageWaiter) ;
         
         // Remove any events that this connection is listening to
         KernelSML* pKernelSML = static_cast<KernelSML*>(pConnection->GetUserData());
@@ -161,6 +162,9 @@ void ConnectionManager::AddConnection(Connection* pConnection)
     pConnection->SetStatus(sml_Names::kStatusCreated) ;
     
     m_Connections.push_back(pConnection) ;
+    
+    // Have the receiver thread woken when messages arrive on this connection
+    pConnection->AddMessageWaiter(&m_MessageWaiter) ;
 }
 
 Connection* ConnectionManager::GetConnectionByIndex(int i)
@@ -198,6 +202,8 @@ void ConnectionManager::RemoveConnection(Connection* pConnection)
     
     // Remove the connection from our list
     m_Connections.remove(pConnection) ;
+    
+    pConnection->RemoveMessageWaiter(&m_MessageWaiter) ;
 }
 
 void ConnectionManager::SetAgentStatus(char const* pStatus)
@@ -17,6 +17,7 @@
 #include "thread_Lock.h"
 #include "sock_SocketLib.h"
 #include "sml_Connection.h"
+#include "sml_MessageWaiter.h"
 
 #include <list>
 
@@ -50,6 +51,10 @@ namespace sml
             std::list< Connection* >        m_ClosedConnections ;
             typedef std::list< Connection* >::iterator  ConnectionsIter ;
             
+            // Registered with every connection, so the receiver thread can sleep
+            // until a message arrives on any of them.
+            MessageWaiter               m_MessageWaiter ;
+            
             // If true dump out details about messages sent and received over sockets
             // (and perhaps embedded connections too?)
             bool    m_bTraceCommunications ;
@@ -90,6 +95,19 @@ namespace sml
             // for more messages (and presumably shutdown completely).
             bool ReceiveAllMessages() ;
             
+            // Sleep until a message may have arrived on one of our connections, the receiver thread
+            // is woken or the timeout passes.  Returns false if we timed out.
+            bool WaitForMessages(int secondsWait, int millisecondsWait)
+            {
+                return m_MessageWaiter.Wait(secondsWait, millisecondsWait) ;
+            }
+            
+            // Wake the receiver thread if it's waiting for messages
+            void WakeReceiverThread()
+            {
+                m_MessageWaiter.Signal() ;
+            }
+            
             // Cause the receiver thread to quit.
             void StopReceiverThread() ;
             
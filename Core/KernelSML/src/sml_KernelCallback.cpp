@@ -15,6 +15,9 @@
 
 #include "sml_Utils.h"
 #include "sml_AgentSML.h"
+#include "sml_KernelSML.h"
+#include "sml_RunScheduler.h"
+#include "thread_Lock.h"
 
 #include "io_link.h"
 
@@ -32,6 +35,14 @@ void KernelCallback::KernelCallbackStatic(agent* pAgent, int eventID, void* pDat
     (void)pAgent; // silences warning in release mode
     assert(pThis->m_pCallbackAgentSML->GetSoarAgent() == pAgent) ;
     
+    // Agents stepped in parallel share the clients, so only one may call out at a time.
+    if (RunScheduler::IsParallelStepThread())
+    {
+        soar_thread::Lock lock(pThis->m_pCallbackAgentSML->GetKernelSML()->GetRunScheduler()->GetParallelStepMutex()) ;
+        pThis->OnKernelEvent(eventID, pThis->m_pCallbackAgentSML, pCallData) ;
+        return ;
+    }
+    
     // Make the callback to the non-static method
     pThis->OnKernelEvent(eventID, pThis->m_pCallbackAgentSML, pCallData) ;
 }
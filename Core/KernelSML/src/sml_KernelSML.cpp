@@ -26,6 +26,7 @@
 
 #include "thread_Lock.h"
 #include "thread_Thread.h"
+#include "soar_rand.h"
 #include "symbol.h"
 #include "working_memory.h"
 
@@ -578,6 +579,9 @@ bool KernelSML::ProcessCommand(char const* pCommandName, Connection* pConnection
         }
     }
     
+    // Commands for an agent (e.g. srand, or rand in a command line) use its random number generator
+    SoarThreadRNGScope rngScope(pAgentSML ? pAgentSML->GetRNG() : SoarGetThreadRNG()) ;
+    
     // Call to the handler (this is a pointer to member call so it's a bit odd)
     bool result = (this->*pFunction)(pAgentSML, pCommandName, pConnection, pIncoming, pResponse) ;
     
@@ -611,7 +615,11 @@ soarxml::ElementXML* KernelSML::ProcessIncomingSML(Connection* pConnection, soar
     // This is really just an insurance policy as I don't think we'll ever execute
     // commands on different threads within kernelSML because we
     // only allow one embedded connection to the kernel, but it's nice to be sure.
-    soar_thread::Lock lock(m_pKernelMutex) ;
+    //
+    // Commands issued from inside a callback while agents are stepped in parallel arrive on
+    // a worker thread, while the thread that started the run still holds the kernel mutex.
+    // Those callbacks are already serialized on the scheduler's mutex, so use that instead.
+    soar_thread::Lock lock(RunScheduler::IsParallelStepThread() ? m_pRunScheduler->GetParallelStepMutex() : m_pKernelMutex) ;
     
     // For debugging, it's helpful to be able to look at the incoming message as an XML string.  Enable in kernel.h
     #ifdef DEBUG_INCOMING_SML
@@ -94,6 +94,7 @@ void KernelSML::BuildCommandMap()
     m_CommandMap[sml_Names::kCommand_GetInitialTimeTag] = &sml::KernelSML::HandleGetInitialTimeTag ;
     m_CommandMap[sml_Names::kCommand_ConvertIdentifier] = &sml::KernelSML::HandleConvertIdentifier;
     m_CommandMap[sml_Names::kCommand_GetListenerPort]   = &sml::KernelSML::HandleGetListenerPort;
+    m_CommandMap[sml_Names::kCommand_SharedMemory]      = &sml::KernelSML::HandleSharedMemory ;
     m_CommandMap[sml_Names::kCommand_SVSInput] = &sml::KernelSML::HandleSVSInput;
     m_CommandMap[sml_Names::kCommand_SVSOutput] = &sml::KernelSML::HandleSVSOutput;
     m_CommandMap[sml_Names::kCommand_SVSQuery] = &sml::KernelSML::HandleSVSQuery;
@@ -1174,6 +1175,19 @@ bool KernelSML::HandleGetListenerPort(AgentSML* /*pAgentSML*/, char const* /*pCo
     return this->ReturnIntResult(pConnection, pResponse, this->GetListenerPort());
 }
 
+// A client on this machine asking to move its connection to shared memory
+bool KernelSML::HandleSharedMemory(AgentSML* /*pAgentSML*/, char const* pCommandName, Connection* pConnection, AnalyzeXML* pIncoming, soarxml::ElementXML* pResponse)
+{
+    char const* pSegmentName = pIncoming->GetArgString(sml_Names::kParamName) ;
+    
+    if (!pSegmentName)
+    {
+        return InvalidArg(pConnection, pResponse, pCommandName, "Segment name is missing") ;
+    }
+    
+    return this->ReturnBoolResult(pConnection, pResponse, pConnection->AcceptSharedMemory(pSegmentName)) ;
+}
+
 bool KernelSML::HandleSVSInput(AgentSML* pAgentSML, char const* pCommandName, Connection* pConnection, AnalyzeXML* pIncoming, soarxml::ElementXML* pResponse)
 {
 #ifndef NO_SVS
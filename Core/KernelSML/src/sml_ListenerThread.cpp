@@ -69,6 +69,12 @@ void ListenerThread::Run()
     
     m_Port = m_ListenerSocket.GetPort();
     
+    // Wake when a client connects
+    m_Waiter.Watch(m_ListenerSocket.GetReadDescriptor()) ;
+#ifdef ENABLE_LOCAL_SOCKETS
+    m_Waiter.Watch(m_LocalListenerSocket.GetReadDescriptor()) ;
+#endif
+    
     while (!m_QuitNow)
     {
         //sml::PrintDebug("Check for incoming connection") ;
@@ -108,15 +114,15 @@ void ListenerThread::Run()
         }
 #endif
         
-        // Sleep for a little before checking for a new connection
-        // New connections will come in very infrequently so this doesn't
-        // have to be very rapid.
-        sml::Sleep(0, 50) ;
+        // Sleep until the next client connects (or we're asked to stop)
+        m_Waiter.Wait(1, 0) ;
     }
     
     // Shut down our listener socket
+    m_Waiter.Unwatch(m_ListenerSocket.GetReadDescriptor(), false) ;
     m_ListenerSocket.Close() ;
 #ifdef ENABLE_LOCAL_SOCKETS
+    m_Waiter.Unwatch(m_LocalListenerSocket.GetReadDescriptor(), false) ;
     m_LocalListenerSocket.Close();
     
 // This code shouldn't be necessary since the we unlink existing files on start
@@ -137,6 +143,11 @@ void ListenerThread::Run()
 #endif
 }
 
+void ListenerThread::Wake()
+{
+    m_Waiter.Signal() ;
+}
+
 void ListenerThread::CreateConnection(DataSender* pSender)
 {
     //sml::PrintDebugFormat("Got new connection on %s", pSender->GetName().c_str()) ;
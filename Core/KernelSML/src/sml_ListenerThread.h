@@ -17,6 +17,7 @@
 #include "sock_ListenerSocket.h"
 #include "sock_SocketLib.h"
 #include "sml_Connection.h"
+#include "sml_MessageWaiter.h"
 
 #ifdef ENABLE_NAMED_PIPES
 #include "sock_ListenerNamedPipe.h"
@@ -45,7 +46,11 @@ namespace sml
             
             sml::KernelSML*             m_pKernel;
             
+            // Wakes us when a client connects to one of the listeners
+            MessageWaiter               m_Waiter ;
+            
             void Run() ;
+            void Wake() ;
             
             void CreateConnection(sock::DataSender* pSender);
             
@@ -31,6 +31,9 @@ namespace sml
             // This method is executed in the different thread
             void Run() ;
             
+            // Wakes the thread when it's asked to stop
+            void Wake() ;
+            
         public:
             ReceiverThread(ConnectionManager* pManager)
             {
@@ -14,6 +14,8 @@
 #include "sml_Utils.h"
 #include "sml_AgentSML.h"
 #include "sml_KernelSML.h"
+#include "sml_RunScheduler.h"
+#include "thread_Lock.h"
 
 #include "agent.h"
 #include "mem.h"
@@ -47,7 +49,17 @@ Symbol* RhsFunction::RhsFunctionCallback(agent* thisAgent, cons* args, void* use
     {
         // Actually make the call.  We can do the dynamic cast because we passed in the
         //  symbol factory and thus know how the symbol was created.
-        Symbol* pReturn = rhsFunction->Execute(&symVector);
+        Symbol* pReturn ;
+        if (RunScheduler::IsParallelStepThread())
+        {
+            // Agents stepped in parallel share the clients and the command line, so serialize the call.
+            soar_thread::Lock lock(rhsFunction->m_pAgentSML->GetKernelSML()->GetRunScheduler()->GetParallelStepMutex()) ;
+            pReturn = rhsFunction->Execute(&symVector);
+        }
+        else
+        {
+            pReturn = rhsFunction->Execute(&symVector);
+        }
         
         // Return the result, assuming it is not NIL
         if (rhsFunction->IsValueReturned() == true)
@@ -111,7 +123,7 @@ Symbol* sml::ConcatRhsFunction::Execute(std::vector<Symbol*>* pArguments)
         else ostr.append(pSymbol->to_string());
     }
     
-    return m_pAgentSML->GetSoarAgent()->symbolManager->make_str_constant(ostr.c_str()) ;
+    return m_pAgentSML->GetSoarAgent()->symbolManager->make_str_constant(ostr.c_str(), ostr.length()) ;
 }
 
 Symbol* sml::CmdRhsFunction::Execute(std::vector<Symbol*>* pArguments)
@@ -160,7 +172,7 @@ Symbol* sml::CmdRhsFunction::Execute(std::vector<Symbol*>* pArguments)
     
     std::string result = m_pAgentSML->ExecuteCommandLine(argument) ;
     
-    Symbol* pResult = m_pAgentSML->GetSoarAgent()->symbolManager->make_str_constant(result.c_str()) ;
+    Symbol* pResult = m_pAgentSML->GetSoarAgent()->symbolManager->make_str_constant(result.c_str(), result.length()) ;
     return pResult ;
 }
 
@@ -208,6 +220,6 @@ Symbol* sml::ExecRhsFunction::Execute(std::vector<Symbol*>* pArguments)
         result = std::string("Error: Nobody was registered to implement rhs function ") + function ;
     }
     
-    Symbol* pResult = m_pAgentSML->GetSoarAgent()->symbolManager->make_str_constant(result.c_str()) ;
+    Symbol* pResult = m_pAgentSML->GetSoarAgent()->symbolManager->make_str_constant(result.c_str(), result.length()) ;
     return pResult ;
 }
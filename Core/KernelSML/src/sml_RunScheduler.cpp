@@ -19,16 +19,256 @@
 #include "sml_AgentSML.h"
 #include "sml_Events.h"
 
+#include "thread_Event.h"
+#include "thread_Lock.h"
+#include "thread_Thread.h"
+
+#include "memory_manager.h"
+#include "output_manager.h"
+
 #include <assert.h>
 
 using namespace sml ;
 
+// True while the current thread is stepping an agent on behalf of a parallel run.
+static thread_local bool tParallelStepThread = false ;
+
+namespace sml
+{
+    // A worker sleeps until the scheduler posts a round of agent steps, then
+    // takes steps off the shared list until none are left.
+    class RunWorkerThread : public soar_thread::Thread
+    {
+        protected:
+            RunScheduler*       m_pScheduler ;
+            
+        public:
+            soar_thread::Event  m_WorkReady ;
+            
+            RunWorkerThread(RunScheduler* pScheduler)
+            {
+                m_pScheduler = pScheduler ;
+            }
+            
+            void Run()
+            {
+                while (!m_QuitNow)
+                {
+                    m_WorkReady.WaitForEventForever() ;
+                    
+                    while (!m_QuitNow && m_pScheduler->RunNextParallelStep()) {}
+                }
+            }
+    } ;
+}
+
 RunScheduler::RunScheduler(KernelSML* pKernelSML)
 {
     m_pKernelSML = pKernelSML ;
     m_RunFlags = sml_NONE ;
     m_IsRunning = false ;
     m_StopBeforePhase = sml_APPLY_PHASE ;
+    
+    m_RunThreads = 1 ;
+    m_ParallelStepSize = sml_DECISION ;
+    m_NextParallelStep = 0 ;
+    m_PendingParallelSteps = 0 ;
+    m_SteppingInParallel = false ;
+    m_pParallelStepMutex = new soar_thread::Mutex() ;
+    m_pParallelStepsDone = new soar_thread::Event() ;
+}
+
+RunScheduler::~RunScheduler()
+{
+    StopWorkers() ;
+    
+    delete m_pParallelStepMutex ;
+    delete m_pParallelStepsDone ;
+}
+
+bool RunScheduler::IsParallelStepThread()
+{
+    return tParallelStepThread ;
+}
+
+/*************************************************************
+* @brief    Sets the number of threads used to step agents.
+*           Workers are created lazily by the next parallel run;
+*           lowering the count below the current pool shuts the
+*           pool down so it can be rebuilt at the new size.
+*************************************************************/
+void RunScheduler::SetRunThreads(int threads)
+{
+    if (threads < 1)
+    {
+        threads = 1 ;
+    }
+    
+    if (static_cast<size_t>(threads - 1) < m_Workers.size())
+    {
+        StopWorkers() ;
+    }
+    
+    m_RunThreads = threads ;
+}
+
+void RunScheduler::StopWorkers()
+{
+    for (std::vector<RunWorkerThread*>::iterator iter = m_Workers.begin() ; iter != m_Workers.end() ; iter++)
+    {
+        (*iter)->Stop(false) ;
+        (*iter)->m_WorkReady.TriggerEvent() ;
+    }
+    
+    for (std::vector<RunWorkerThread*>::iterator iter = m_Workers.begin() ; iter != m_Workers.end() ; iter++)
+    {
+        (*iter)->Stop(true) ;
+        delete *iter ;
+    }
+    
+    m_Workers.clear() ;
+}
+
+/*************************************************************
+* @brief    Agents can only be stepped in parallel when each step
+*           ends at a point where the agents do not depend on one
+*           another.  Interleaving by phase or elaboration keeps
+*           the original serial behavior.
+*************************************************************/
+bool RunScheduler::CanStepInParallel(smlRunStepSize interleaveStepSize)
+{
+    if (m_RunThreads <= 1)
+    {
+        return false ;
+    }
+    
+    if ((interleaveStepSize != sml_DECISION) && (interleaveStepSize != sml_UNTIL_OUTPUT))
+    {
+        return false ;
+    }
+    
+    int stepping = 0 ;
+    for (AgentMapIter iter = m_pKernelSML->m_AgentMap.begin() ; iter != m_pKernelSML->m_AgentMap.end() ; iter++)
+    {
+        if (iter->second->IsAgentOnStepList())
+        {
+            stepping++ ;
+        }
+    }
+    
+    return (stepping > 1) ;
+}
+
+/*************************************************************
+* @brief    Takes the next agent off the parallel step list and
+*           steps it.  Returns false once the list is empty.
+*************************************************************/
+bool RunScheduler::RunNextParallelStep()
+{
+    size_t index ;
+    {
+        soar_thread::Lock lock(m_pParallelStepMutex) ;
+        if (m_NextParallelStep >= m_ParallelStepList.size())
+        {
+            return false ;
+        }
+        index = m_NextParallelStep++ ;
+    }
+    
+    AgentSML* pAgentSML = m_ParallelStepList[index] ;
+    
+    tParallelStepThread = true ;
+    
+    m_ParallelStepResults[index] = pAgentSML->StepInClientThread(m_ParallelStepSize) ;
+    
+    tParallelStepThread = false ;
+    
+    bool lastStep ;
+    {
+        soar_thread::Lock lock(m_pParallelStepMutex) ;
+        lastStep = (--m_PendingParallelSteps == 0) ;
+    }
+    
+    if (lastStep)
+    {
+        m_pParallelStepsDone->TriggerEvent() ;
+    }
+    
+    return true ;
+}
+
+/*************************************************************
+* @brief    Steps every agent on the step list once, spreading the
+*           agents over the worker pool, and returns when all of
+*           them have finished.  The results are left in
+*           m_ParallelStepResults in step list order.
+*************************************************************/
+void RunScheduler::StepAgentsInParallel(smlRunStepSize interleaveStepSize)
+{
+    std::vector<AgentSML*> stepList ;
+    for (AgentMapIter iter = m_pKernelSML->m_AgentMap.begin() ; iter != m_pKernelSML->m_AgentMap.end() ; iter++)
+    {
+        if (iter->second->IsAgentOnStepList())
+        {
+            stepList.push_back(iter->second) ;
+        }
+    }
+    
+    // The calling thread takes a share of the work, so we need one less worker than threads.
+    size_t workersNeeded = static_cast<size_t>(m_RunThreads - 1) ;
+    if (workersNeeded > stepList.size() - 1)
+    {
+        workersNeeded = stepList.size() - 1 ;
+    }
+    while (m_Workers.size() < workersNeeded)
+    {
+        RunWorkerThread* pWorker = new RunWorkerThread(this) ;
+        pWorker->Start() ;
+        m_Workers.push_back(pWorker) ;
+    }
+    
+    // The pools have to be thread safe before any step of the new round can be taken.
+    m_SteppingInParallel = true ;
+    Memory_Manager::Get_MPM().set_thread_safe(true) ;
+    Output_Manager::Get_OM().set_thread_safe(true) ;
+    
+    // A worker can wake at any time (its event may still be set from an earlier
+    // round it never got to), so the round is only set up under the lock.
+    {
+        soar_thread::Lock lock(m_pParallelStepMutex) ;
+        m_ParallelStepList.swap(stepList) ;
+        m_ParallelStepResults.assign(m_ParallelStepList.size(), sml_RUN_COMPLETED) ;
+        m_ParallelStepSize = interleaveStepSize ;
+        m_NextParallelStep = 0 ;
+        m_PendingParallelSteps = m_ParallelStepList.size() ;
+    }
+    
+    for (size_t i = 0 ; i < workersNeeded ; i++)
+    {
+        m_Workers[i]->m_WorkReady.TriggerEvent() ;
+    }
+    
+    while (RunNextParallelStep()) {}
+    
+    // Wait for the workers to finish the steps they picked up.  Whichever thread
+    // finishes the last step triggers the event, which stays set until a wait
+    // consumes it, so a trigger left over from an earlier round (when this thread
+    // finished last) just means checking the count once more.
+    while (true)
+    {
+        {
+            soar_thread::Lock lock(m_pParallelStepMutex) ;
+            if (m_PendingParallelSteps == 0)
+            {
+                break ;
+            }
+        }
+        m_pParallelStepsDone->WaitForEventForever() ;
+    }
+    
+    Output_Manager::Get_OM().set_thread_safe(false) ;
+    Memory_Manager::Get_MPM().set_thread_safe(false) ;
+    m_SteppingInParallel = false ;
 }
 
 /*************************************************************
@@ -833,14 +1073,22 @@ smlRunResult RunScheduler::RunScheduledAgents(bool forever, smlRunStepSize runSt
             //    note that there is not a corresponding AFTER_AGENTS_RUN_STEP event...
             m_pKernelSML->FireSystemEvent(smlEVENT_BEFORE_AGENTS_RUN_STEP) ;
             
+            // When allowed, step all of the agents at once and then walk the results below in agent order.
+            bool parallel = CanStepInParallel(interleaveStepSize) ;
+            size_t parallelIndex = 0 ;
+            if (parallel)
+            {
+                StepAgentsInParallel(interleaveStepSize) ;
+            }
+            
             for (AgentMapIter iter = m_pKernelSML->m_AgentMap.begin() ; iter != m_pKernelSML->m_AgentMap.end() ; iter++)
             {
                 AgentSML* pAgentSML = iter->second ;
                 
-                if (pAgentSML->IsAgentOnStepList())
+                if (parallel ? (parallelIndex < m_ParallelStepList.size() && m_ParallelStepList[parallelIndex] == pAgentSML) : pAgentSML->IsAgentOnStepList())
                 {
                     // Run all agents one "interleaveStepSize".
-                    smlRunResult runResult = pAgentSML->StepInClientThread(interleaveStepSize) ;
+                    smlRunResult runResult = parallel ? m_ParallelStepResults[parallelIndex++] : pAgentSML->StepInClientThread(interleaveStepSize) ;
                     // ?? pAgentSML->IncrementLocalStepCounter();
                     
                     // halted and running agents will return an error from StepInClientThread
@@ -13,15 +13,26 @@
 
 #include "sml_Events.h"
 
+#include <vector>
+
+namespace soar_thread
+{
+    class Mutex ;
+    class Event ;
+}
+
 namespace sml
 {
 
 // Forward declarations
     class KernelSML ;
     class AgentSML ;
+    class RunWorkerThread ;
     
     class RunScheduler
     {
+            friend class RunWorkerThread ;
+            
         protected:
             KernelSML*  m_pKernelSML ;
             smlRunFlags m_RunFlags ;
@@ -34,8 +45,24 @@ namespace sml
             // When running multiple agents, we synchronize them to this agent (same phase) before starting the real run.
             AgentSML*   m_pSynchAgentSML ;
             
+            // Parallel stepping.  When more than one thread is allowed and agents are interleaved
+            // by decision or output, each round of steps is handed out to a pool of worker threads
+            // (plus the thread that issued the run) and the scheduler waits for all of them to finish
+            // before doing the usual bookkeeping in agent order.
+            int                             m_RunThreads ;
+            std::vector<RunWorkerThread*>   m_Workers ;
+            std::vector<AgentSML*>          m_ParallelStepList ;
+            std::vector<smlRunResult>       m_ParallelStepResults ;
+            smlRunStepSize                  m_ParallelStepSize ;
+            size_t                          m_NextParallelStep ;
+            size_t                          m_PendingParallelSteps ;
+            bool                            m_SteppingInParallel ;
+            soar_thread::Mutex*             m_pParallelStepMutex ;
+            soar_thread::Event*             m_pParallelStepsDone ;
+            
         public:
             RunScheduler(KernelSML* pKernelSML) ;
+            ~RunScheduler() ;
             
             /********************************************************************
             * @brief    This is a method for getting the default value
@@ -114,6 +141,37 @@ namespace sml
                 return m_StopBeforePhase ;
             }
             
+            /*********************************************************************
+            * @brief    Sets how many threads may be used to step agents.  With more
+            *           than one, agents interleaved by decision or output are stepped
+            *           in parallel (one agent per thread at a time).
+            **********************************************************************/
+            void SetRunThreads(int threads) ;
+            int GetRunThreads()
+            {
+                return m_RunThreads ;
+            }
+            
+            /*********************************************************************
+            * @brief    Returns true while agents are being stepped in parallel.
+            *           Callbacks out of the kernel are serialized on the mutex
+            *           returned by GetParallelStepMutex() during this time.
+            **********************************************************************/
+            bool IsSteppingInParallel()
+            {
+                return m_SteppingInParallel ;
+            }
+            soar_thread::Mutex* GetParallelStepMutex()
+            {
+                return m_pParallelStepMutex ;
+            }
+            
+            /*********************************************************************
+            * @brief    Returns true if the calling thread is currently stepping an
+            *           agent as part of a parallel run.
+            **********************************************************************/
+            static bool IsParallelStepThread() ;
+            
         protected:
             bool            AgentsStillStepping() ;
             bool            AreAgentsSynchronized(AgentSML* pSynchAgent) ;
@@ -133,6 +191,11 @@ namespace sml
             bool            TestIfAllFinished(bool forever, smlRunStepSize runStepSize, uint64_t count) ;
             
             AgentSML*       GetAgentToSynchronizeWith() ;
+            
+            bool            CanStepInParallel(smlRunStepSize interleaveStepSize) ;
+            void            StepAgentsInParallel(smlRunStepSize interleaveStepSize) ;
+            bool            RunNextParallelStep() ;
+            void            StopWorkers() ;
     } ;
     
 } // namespace
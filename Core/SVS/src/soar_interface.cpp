@@ -53,7 +53,7 @@ void soar_interface::del_sym(Symbol* s)
 
 wme* soar_interface::make_id_wme(Symbol* id, const string& attr)
 {
-    Symbol* attrsym = thisAgent->symbolManager->make_str_constant(attr.c_str());
+    Symbol* attrsym = thisAgent->symbolManager->make_str_constant(attr.c_str(), attr.length());
     Symbol* valsym = thisAgent->symbolManager->make_new_identifier(attr[0], id->id->level);
     wme* w = soar_module::add_module_wme(thisAgent, id, attrsym, valsym);
     thisAgent->symbolManager->symbol_remove_ref(&attrsym);
@@ -96,7 +96,7 @@ inline tc_number soar_interface::new_tc_num()
 
 inline Symbol* soar_interface::make_sym(const std::string& val)
 {
-    return thisAgent->symbolManager->make_str_constant(val.c_str());
+    return thisAgent->symbolManager->make_str_constant(val.c_str(), val.length());
 }
 
 inline Symbol* soar_interface::make_sym(int val)
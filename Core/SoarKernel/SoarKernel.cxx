@@ -28,6 +28,7 @@
 #include <ebc_variablize.cpp>
 #include <ebc.cpp>
 #include <episodic_memory.cpp>
+#include <epmem_interval_index.cpp>
 #include <explain_print.cpp>
 #include <explanation_memory.cpp>
 #include <explanation_settings.cpp>
@@ -62,10 +63,14 @@
 #include <smem_activation.cpp>
 #include <smem_cli_commands.cpp>
 #include <smem_db.cpp>
+#include <smem_graph.cpp>
+#include <smem_import.cpp>
 #include <smem_instance.cpp>
+#include <smem_lti_cache.cpp>
 #include <smem_print.cpp>
 #include <smem_query.cpp>
 #include <smem_settings.cpp>
+#include <smem_shared_store.cpp>
 #include <smem_store.cpp>
 #include <smem_timers.cpp>
 #include <soar_db.cpp>
@@ -75,6 +80,7 @@
 #include <soar_to_string.cpp>
 #include <stats.cpp>
 #include <symbol_manager.cpp>
+#include <symbol_table.cpp>
 #include <symbol.cpp>
 #include <test.cpp>
 #include <trace.cpp>
@@ -110,7 +110,7 @@ void decider_param_container::print_status(agent* thisAgent)
     outputManager->printa_sf(thisAgent, "\nUse 'soar ?' for a command overview or 'help soar' for the manual page.");
 }
 
-void decider_param_container::print_settings(agent* thisAgent)
+void decider_param_container::print_settings(agent* thisAgent, int run_threads)
 {
     std::string tempString;
     Output_Manager* outputManager = thisAgent->outputManager;
@@ -133,6 +133,7 @@ void decider_param_container::print_settings(agent* thisAgent)
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("max-dc-time", max_dc_time->get_string(), 47).c_str(), "Interrupt decision after this much time");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("max-memory-usage", max_memory_usage->get_string(), 47).c_str(), "Threshold for memory warning (see help)");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("max-gp", max_gp->get_string(), 47).c_str(), "Maximum rules gp can generate");
+    outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("run-threads", std::to_string(run_threads).c_str(), 47).c_str(), "Threads used to run agents in parallel");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("stop-phase", stop_phase->get_string(), 47).c_str(), "Phase before which Soar will stop");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("tcl", tcl_enabled->get_string(), 47).c_str(), "Allow Tcl code in commands");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("timers", timers_enabled->get_string(), 47).c_str(), "Profile where Soar spends its time");
@@ -40,7 +40,8 @@ class decider_param_container: public soar_module::param_container
         decider_param_container(agent* new_agent, uint64_t pDecider_settings[]);
 
         void print_status(agent* thisAgent);
-        void print_settings(agent* thisAgent);
+        // run_threads is the kernel's run scheduler setting, which isn't an agent param
+        void print_settings(agent* thisAgent, int run_threads);
 };
 
 
@@ -26,9 +26,18 @@
 #include "working_memory.h"
 #include "xml.h"
 
+#include <algorithm>
 #include <assert.h>
+#include <iomanip>
 #include <sstream>
 #include <stdlib.h>
+#include <unordered_map>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 /*************************************************************************
  *
@@ -440,19 +449,29 @@ inline void new_left_token(token* New, rete_node* current_node,
             Structures and Declarations:  Memory Hash Tables
 
    Tokens and alpha memory entries (right memory's) as stored in two
-   global hash tables.  Unlike most hash tables in Soar, these two tables
-   are not dynamically resized -- their size is fixed at compile-time.
+   global hash tables.  Like the hash tables in mem.cpp, these two tables
+   are resized as their number of entries changes, doubling when there are
+   two entries per bucket and halving when there is less than one entry in
+   every two buckets.  Since the match routines walk bucket chains while
+   they add new tokens, a table is never resized in the middle of a match.
+   Instead, resize_memory_hash_tables_if_needed() is called when a WME or
+   a production first enters the rete, when no bucket is being walked.
 ---------------------------------------------------------------------- */
 
 /* --- Hash table sizes (actual sizes are powers of 2) --- */
-#define LOG2_LEFT_HT_SIZE 14
-#define LOG2_RIGHT_HT_SIZE 14
+#define MIN_LOG2_LEFT_HT_SIZE 10
+#define MIN_LOG2_RIGHT_HT_SIZE 10
+#define MAX_LOG2_MEMORY_HT_SIZE 28
 
-#define LEFT_HT_SIZE (1 << LOG2_LEFT_HT_SIZE)
-#define RIGHT_HT_SIZE (1 << LOG2_RIGHT_HT_SIZE)
+inline uint32_t left_ht_mask(agent* thisAgent)
+{
+    return (static_cast<uint32_t>(1) << thisAgent->left_ht_log2size) - 1;
+}
 
-#define LEFT_HT_MASK (LEFT_HT_SIZE - 1)
-#define RIGHT_HT_MASK (RIGHT_HT_SIZE - 1)
+inline uint32_t right_ht_mask(agent* thisAgent)
+{
+    return (static_cast<uint32_t>(1) << thisAgent->right_ht_log2size) - 1;
+}
 
 
 /* --- Given the hash value (hv), get contents of bucket header cell ---
@@ -466,12 +485,12 @@ inline void new_left_token(token* New, rete_node* current_node,
    hence the call by reference, */
 inline token*& left_ht_bucket(agent* thisAgent, uint32_t hv)
 {
-    return * (reinterpret_cast<token**>(thisAgent->left_ht) + (hv & LEFT_HT_MASK));
+    return * (reinterpret_cast<token**>(thisAgent->left_ht) + (hv & left_ht_mask(thisAgent)));
 }
 
 inline right_mem* right_ht_bucket(agent* thisAgent, uint32_t hv)
 {
-    return * (reinterpret_cast<right_mem**>(thisAgent->right_ht) + (hv & RIGHT_HT_MASK));
+    return * (reinterpret_cast<right_mem**>(thisAgent->right_ht) + (hv & right_ht_mask(thisAgent)));
 }
 
 /*#define insert_token_into_left_ht(tok,hv) { \
@@ -482,9 +501,10 @@ inline right_mem* right_ht_bucket(agent* thisAgent, uint32_t hv)
 inline void insert_token_into_left_ht(agent* thisAgent, token* tok, uint32_t hv)
 {
     token** header_zy37;
-    header_zy37 = reinterpret_cast<token**>(thisAgent->left_ht) + (hv & LEFT_HT_MASK);
+    header_zy37 = reinterpret_cast<token**>(thisAgent->left_ht) + (hv & left_ht_mask(thisAgent));
     insert_at_head_of_dll(*header_zy37, tok,
                           a.ht.next_in_bucket, a.ht.prev_in_bucket);
+    thisAgent->left_ht_count++;
 }
 
 /*#define remove_token_from_left_ht(tok,hv) { \
@@ -494,6 +514,124 @@ inline void remove_token_from_left_ht(agent* thisAgent, token* tok, uint32_t hv)
 {
     fast_remove_from_dll(left_ht_bucket(thisAgent, hv), tok, token,
                          a.ht.next_in_bucket, a.ht.prev_in_bucket);
+    thisAgent->left_ht_count--;
+}
+
+/* --- Recomputes the hash value a token was stored under.  CN tokens are
+   hashed on their parent token and wme; all others on their referent --- */
+inline uint32_t left_ht_hash_value_for_token(token* tok)
+{
+    if (tok->node->node_type == CN_BNODE)
+    {
+        return tok->node->node_id ^ cast_and_possibly_truncate<uint32_t>(tok->parent) ^
+               cast_and_possibly_truncate<uint32_t>(tok->w);
+    }
+    return tok->node->node_id ^ (tok->a.ht.referent ? tok->a.ht.referent->hash_id : 0);
+}
+
+/* --- Moves every entry into a newly allocated bucket array.  Each old chain
+   is walked from its tail, so entries that share a hash value keep their
+   relative order and matches are still found in the same order --- */
+void resize_left_ht(agent* thisAgent, uint32_t new_log2size)
+{
+    token** old_buckets, **new_buckets;
+    token* tok, *prev;
+    uint32_t i, old_size, new_mask;
+
+    old_buckets = reinterpret_cast<token**>(thisAgent->left_ht);
+    old_size = static_cast<uint32_t>(1) << thisAgent->left_ht_log2size;
+    new_mask = (static_cast<uint32_t>(1) << new_log2size) - 1;
+    new_buckets = static_cast<token**>(thisAgent->memoryManager->allocate_memory_and_zerofill(sizeof(char*) * (new_mask + 1), HASH_TABLE_MEM_USAGE));
+
+    for (i = 0; i < old_size; i++)
+    {
+        tok = old_buckets[i];
+        if (!tok)
+        {
+            continue;
+        }
+        while (tok->a.ht.next_in_bucket)
+        {
+            tok = tok->a.ht.next_in_bucket;
+        }
+        for (; tok != NIL; tok = prev)
+        {
+            prev = tok->a.ht.prev_in_bucket;
+            insert_at_head_of_dll(new_buckets[left_ht_hash_value_for_token(tok) & new_mask], tok,
+                                  a.ht.next_in_bucket, a.ht.prev_in_bucket);
+        }
+    }
+
+    thisAgent->memoryManager->free_memory(old_buckets, HASH_TABLE_MEM_USAGE);
+    thisAgent->left_ht = new_buckets;
+    thisAgent->left_ht_log2size = new_log2size;
+}
+
+void resize_right_ht(agent* thisAgent, uint32_t new_log2size)
+{
+    right_mem** old_buckets, **new_buckets;
+    right_mem* rm, *prev;
+    uint32_t i, old_size, new_mask;
+
+    old_buckets = reinterpret_cast<right_mem**>(thisAgent->right_ht);
+    old_size = static_cast<uint32_t>(1) << thisAgent->right_ht_log2size;
+    new_mask = (static_cast<uint32_t>(1) << new_log2size) - 1;
+    new_buckets = static_cast<right_mem**>(thisAgent->memoryManager->allocate_memory_and_zerofill(sizeof(char*) * (new_mask + 1), HASH_TABLE_MEM_USAGE));
+
+    for (i = 0; i < old_size; i++)
+    {
+        rm = old_buckets[i];
+        if (!rm)
+        {
+            continue;
+        }
+        while (rm->next_in_bucket)
+        {
+            rm = rm->next_in_bucket;
+        }
+        for (; rm != NIL; rm = prev)
+        {
+            prev = rm->prev_in_bucket;
+            insert_at_head_of_dll(new_buckets[(rm->am->am_id ^ rm->w->id->hash_id) & new_mask], rm,
+                                  next_in_bucket, prev_in_bucket);
+        }
+    }
+
+    thisAgent->memoryManager->free_memory(old_buckets, HASH_TABLE_MEM_USAGE);
+    thisAgent->right_ht = new_buckets;
+    thisAgent->right_ht_log2size = new_log2size;
+}
+
+/* --- Returns the log2 size a memory hash table with the given number of
+   entries should have, or its current log2 size if it's within bounds --- */
+inline uint32_t memory_ht_log2size_for_count(uint64_t count, uint32_t log2size, uint32_t min_log2size)
+{
+    while ((count >= (static_cast<uint64_t>(2) << log2size)) && (log2size < MAX_LOG2_MEMORY_HT_SIZE))
+    {
+        log2size++;
+    }
+    while ((count < (static_cast<uint64_t>(1) << (log2size - 1))) && (log2size > min_log2size))
+    {
+        log2size--;
+    }
+    return log2size;
+}
+
+/* --- Must only be called when no bucket chain is being walked --- */
+inline void resize_memory_hash_tables_if_needed(agent* thisAgent)
+{
+    uint32_t new_log2size;
+
+    new_log2size = memory_ht_log2size_for_count(thisAgent->left_ht_count, thisAgent->left_ht_log2size, MIN_LOG2_LEFT_HT_SIZE);
+    if (new_log2size != thisAgent->left_ht_log2size)
+    {
+        resize_left_ht(thisAgent, new_log2size);
+    }
+    new_log2size = memory_ht_log2size_for_count(thisAgent->right_ht_count, thisAgent->right_ht_log2size, MIN_LOG2_RIGHT_HT_SIZE);
+    if (new_log2size != thisAgent->right_ht_log2size)
+    {
+        resize_right_ht(thisAgent, new_log2size);
+    }
 }
 
 /* ----------------------------------------------------------------------
@@ -707,6 +845,106 @@ void adjust_sharing_factors_from_here_to_top(rete_node* node, int delta)
 
 #endif
 
+/* ----------------------------------------------------------------------
+
+              Structures and Declarations:  Match Profiler
+
+   When thisAgent->rete_profiling is on, every left and right addition
+   on a beta node counts the activation (and whether it was a null
+   activation, i.e., the opposite memory was empty), the tokens the node
+   creates, and the time spent in the node itself.  Counters live in
+   thisAgent->rete_node_profiles, a side table keyed by node, so nodes
+   carry nothing extra when the profiler is unused.  A node's entry is
+   made the first time the profiler sees it and dropped with the node.  Time is
+   exclusive:  whatever a node's children spend is subtracted from the
+   node's own total, using thisAgent->rete_profile_child_time as the
+   running total for the activation in progress.
+
+   When the profiler is off, the only cost is the flag test in the
+   rete_profile_scope constructor and destructor and in token_added(),
+   plus an emptiness test on the side table when a node is destroyed.
+---------------------------------------------------------------------- */
+
+inline rete_node_profile* rete_node_profile_for(agent* thisAgent, rete_node* node)
+{
+    /* --- a new entry is value-initialized, i.e., all zeros --- */
+    return &((*thisAgent->rete_node_profiles)[node]);
+}
+
+inline void deallocate_rete_node_profile(agent* thisAgent, rete_node* node)
+{
+    if (!thisAgent->rete_node_profiles->empty())
+    {
+        thisAgent->rete_node_profiles->erase(node);
+    }
+}
+
+class rete_profile_scope
+{
+    public:
+        rete_profile_scope(agent* thisAgent, rete_node* node, bool left)
+        {
+            if (!thisAgent->rete_profiling)
+            {
+                profile = NIL;
+                return;
+            }
+            myAgent = thisAgent;
+            profile = rete_node_profile_for(thisAgent, node);
+            if (left)
+            {
+                profile->left_activations++;
+                switch (node->node_type)
+                {
+                    case POSITIVE_BNODE:
+                    case UNHASHED_POSITIVE_BNODE:
+                    case MP_BNODE:
+                    case UNHASHED_MP_BNODE:
+                    case NEGATIVE_BNODE:
+                    case UNHASHED_NEGATIVE_BNODE:
+                        if (node->b.posneg.alpha_mem_->right_mems == NIL)
+                        {
+                            profile->null_left_activations++;
+                        }
+                        break;
+                }
+            }
+            else
+            {
+                /* --- unmerged pos. nodes keep their tokens in the parent Mem node --- */
+                rete_node* mem_node = bnode_is_bottom_of_split_mp(node->node_type) ? node->parent : node;
+                profile->right_activations++;
+                if (mem_node->a.np.tokens == NIL)
+                {
+                    profile->null_right_activations++;
+                }
+            }
+            saved_child_time = thisAgent->rete_profile_child_time;
+            thisAgent->rete_profile_child_time = 0;
+            start_time = get_raw_time();
+        }
+
+        ~rete_profile_scope()
+        {
+            if (!profile)
+            {
+                return;
+            }
+            uint64_t elapsed = get_raw_time() - start_time;
+            profile->raw_time += elapsed - myAgent->rete_profile_child_time;
+            myAgent->rete_profile_child_time = saved_child_time + elapsed;
+        }
+
+    private:
+        agent* myAgent;
+        rete_node_profile* profile;
+        uint64_t start_time;
+        uint64_t saved_child_time;
+
+        rete_profile_scope(const rete_profile_scope&);
+        rete_profile_scope& operator=(const rete_profile_scope&);
+};
+
 /* ----------------------------------------------------------------------
 
            Structures and Declarations:  (Extra) Rete Statistics
@@ -724,20 +962,22 @@ inline uint64_t real_sharing_factor(rete_node* node)
     return ((node)->sharing_factor ? (node)->sharing_factor : 1);
 }
 
+#endif
+
 /*#define token_added(node) { \
   thisAgent->token_additions++; \
   thisAgent->token_additions_without_sharing += real_sharing_factor(node);}*/
-inline void token_added(rete_node* node)
+inline void token_added(agent* thisAgent, rete_node* node)
 {
+#ifdef TOKEN_SHARING_STATS
     thisAgent->token_additions++;
     thisAgent->token_additions_without_sharing += real_sharing_factor(node);
-}
-
-#else
-
-#define token_added(node) {}
-
 #endif
+    if (thisAgent->rete_profiling)
+    {
+        rete_node_profile_for(thisAgent, node)->tokens_created++;
+    }
+}
 
 /* --- Invoked on every right activation; add=true means right addition --- */
 /* NOT invoked on removals unless DO_ACTIVATION_STATS_ON_REMOVALS is set */
@@ -778,6 +1018,7 @@ inline void init_new_rete_node_with_type(agent* thisAgent, rete_node* node, byte
 inline void update_stats_for_destroying_node(agent* thisAgent, rete_node* node)
 {
     set_sharing_factor(node, 0);
+    deallocate_rete_node_profile(thisAgent, node);
     thisAgent->rete_node_counts[(node)->node_type]--;
 }
 
@@ -1256,8 +1497,9 @@ void add_wme_to_alpha_mem(agent* thisAgent, wme* w, alpha_mem* am)
 
     /* --- add it to dll's for the hash bucket, alpha mem, and wme --- */
     hv = am->am_id ^ w->id->hash_id;
-    header = reinterpret_cast<right_mem**>(thisAgent->right_ht) + (hv & RIGHT_HT_MASK);
+    header = reinterpret_cast<right_mem**>(thisAgent->right_ht) + (hv & right_ht_mask(thisAgent));
     insert_at_head_of_dll(*header, rm, next_in_bucket, prev_in_bucket);
+    thisAgent->right_ht_count++;
     insert_at_head_of_dll(am->right_mems, rm, next_in_am, prev_in_am);
     insert_at_head_of_dll(w->right_mems, rm, next_from_wme, prev_from_wme);
 }
@@ -1276,8 +1518,9 @@ void remove_wme_from_alpha_mem(agent* thisAgent, right_mem* rm)
 
     /* --- remove it from dll's for the hash bucket, alpha mem, and wme --- */
     hv = am->am_id ^ w->id->hash_id;
-    header = reinterpret_cast<right_mem**>(thisAgent->right_ht) + (hv & RIGHT_HT_MASK);
+    header = reinterpret_cast<right_mem**>(thisAgent->right_ht) + (hv & right_ht_mask(thisAgent));
     remove_from_dll(*header, rm, next_in_bucket, prev_in_bucket);
+    thisAgent->right_ht_count--;
     remove_from_dll(am->right_mems, rm, next_in_am, prev_in_am);
     remove_from_dll(w->right_mems, rm, next_from_wme, prev_from_wme);
 
@@ -1424,6 +1667,8 @@ void add_wme_to_rete(agent* thisAgent, wme* w)
 {
     uint32_t hi, ha, hv;
 
+    resize_memory_hash_tables_if_needed(thisAgent);
+
     /* --- add w to all_wmes_in_rete --- */
     insert_at_head_of_dll(thisAgent->all_wmes_in_rete, w, rete_next, rete_prev);
     thisAgent->num_wmes_in_rete++;
@@ -1624,6 +1869,8 @@ void remove_wme_from_rete(agent* thisAgent, wme* w)
     rete_node* node, *next, *child;
     token* tok, *left;
 
+    resize_memory_hash_tables_if_needed(thisAgent);
+
     {
         if (thisAgent->EpMem->epmem_db->get_status() == soar_module::connected)
         {
@@ -1920,6 +2167,93 @@ rete_node* nearest_ancestor_with_same_am(rete_node* node, alpha_mem* am)
     return NIL;
 }
 
+/* --------------------------------------------------------------------
+                           Bulk Loading
+
+   Between begin_rete_bulk_load() and end_rete_bulk_load(), productions
+   are merged into the net as usual, sharing whatever nodes they can, but
+   new nodes are not filled in with matches from above as they are made.
+   Each new node that has a memory is instead recorded along with the
+   order it was made in.  When the batch ends, only the new nodes with no
+   new ancestor are filled in, in that order.  Their matches flow down
+   through the rest of the new nodes by the ordinary left activations,
+   so the current working memory is pushed through each new part of the
+   net once for the whole batch instead of once per production.
+
+   Nothing but production additions and excisions may happen while a
+   batch is open, since the new nodes don't have their tokens yet.
+-------------------------------------------------------------------- */
+
+inline void fill_new_node_with_matches(agent* thisAgent, rete_node* node)
+{
+    if (thisAgent->rete_bulk_load_depth)
+    {
+        (*thisAgent->rete_bulk_load_nodes)[node] = thisAgent->rete_bulk_load_count++;
+        return;
+    }
+    update_node_with_matches_from_above(thisAgent, node);
+}
+
+/* New nodes can be merged, split or excised before their batch ends, so
+   the batch has to follow them; pass NIL as new_node if the node is gone */
+inline void replace_bulk_load_node(agent* thisAgent, rete_node* old_node, rete_node* new_node)
+{
+    if (!thisAgent->rete_bulk_load_depth)
+    {
+        return;
+    }
+
+    std::unordered_map< rete_node*, uint64_t >::iterator it = thisAgent->rete_bulk_load_nodes->find(old_node);
+    if (it == thisAgent->rete_bulk_load_nodes->end())
+    {
+        return;
+    }
+    uint64_t order = it->second;
+    thisAgent->rete_bulk_load_nodes->erase(it);
+    if (new_node)
+    {
+        (*thisAgent->rete_bulk_load_nodes)[new_node] = order;
+    }
+}
+
+void begin_rete_bulk_load(agent* thisAgent)
+{
+    thisAgent->rete_bulk_load_depth++;
+}
+
+void end_rete_bulk_load(agent* thisAgent)
+{
+    if (!thisAgent->rete_bulk_load_depth || --thisAgent->rete_bulk_load_depth)
+    {
+        return;
+    }
+
+    std::unordered_map< rete_node*, uint64_t > new_nodes;
+    new_nodes.swap(*thisAgent->rete_bulk_load_nodes);
+    thisAgent->rete_bulk_load_count = 0;
+
+    std::vector< std::pair< uint64_t, rete_node* > > top_nodes;
+    for (std::unordered_map< rete_node*, uint64_t >::iterator it = new_nodes.begin(); it != new_nodes.end(); ++it)
+    {
+        rete_node* ancestor = it->first->parent;
+        while (ancestor && !new_nodes.count(ancestor))
+        {
+            ancestor = ancestor->parent;
+        }
+        if (!ancestor)
+        {
+            top_nodes.push_back(std::make_pair(it->second, it->first));
+        }
+    }
+    std::sort(top_nodes.begin(), top_nodes.end());
+
+    for (size_t i = 0; i < top_nodes.size(); i++)
+    {
+        resize_memory_hash_tables_if_needed(thisAgent);
+        update_node_with_matches_from_above(thisAgent, top_nodes[i].second);
+    }
+}
+
 /* --------------------------------------------------------------------
                          Make New Mem Node
 
@@ -1949,7 +2283,7 @@ rete_node* make_new_mem_node(agent* thisAgent,
     node->a.np.tokens = NIL;
 
     /* --- call new node's add_left routine with all the parent's tokens --- */
-    update_node_with_matches_from_above(thisAgent, node);
+    fill_new_node_with_matches(thisAgent, node);
 
     return node;
 }
@@ -2057,6 +2391,7 @@ rete_node* split_mp_node(agent* thisAgent, rete_node* mp_node)
     {
         t->node = mem_node;
     }
+    replace_bulk_load_node(thisAgent, mp_node, mem_node);
 
     /* --- transmogrify the old MP node into the new Pos node --- */
     init_new_rete_node_with_type(thisAgent, pos_node, node_type);
@@ -2131,6 +2466,7 @@ rete_node* merge_into_mp_node(agent* thisAgent, rete_node* mem_node)
     mp_node->left_hash_loc_field_num = mem_node->left_hash_loc_field_num;
     mp_node->left_hash_loc_levels_up = mem_node->left_hash_loc_levels_up;
     mp_node->node_id = mem_node->node_id;
+    replace_bulk_load_node(thisAgent, mem_node, mp_node);
 
     /* --- replace the Mem node with the new MP node --- */
     mp_node->parent = parent;
@@ -2213,7 +2549,7 @@ rete_node* make_new_negative_node(agent* thisAgent,
     node->node_id = get_next_beta_node_id(thisAgent);
 
     /* --- call new node's add_left routine with all the parent's tokens --- */
-    update_node_with_matches_from_above(thisAgent, node);
+    fill_new_node_with_matches(thisAgent, node);
 
     /* --- if no tokens arrived from parent, unlink the node --- */
     if (! node->a.np.tokens)
@@ -2269,9 +2605,9 @@ rete_node* make_new_cn_node(agent* thisAgent,
     partner->b.cn.partner = node;
 
     /* --- call partner's add_left routine with all the parent's tokens --- */
-    update_node_with_matches_from_above(thisAgent, partner);
+    fill_new_node_with_matches(thisAgent, partner);
     /* --- call new node's add_left routine with all the parent's tokens --- */
-    update_node_with_matches_from_above(thisAgent, node);
+    fill_new_node_with_matches(thisAgent, node);
 
     return node;
 }
@@ -2414,6 +2750,7 @@ void deallocate_rete_node(agent* thisAgent, rete_node* node)
     }
 
     update_stats_for_destroying_node(thisAgent, node);   /* clean up rete stats stuff */
+    replace_bulk_load_node(thisAgent, node, NIL);
     thisAgent->memoryManager->free_with_pool(MP_rete_node, node);
 
     /* --- if parent has no other children, deallocate it, and recurse  --- */
@@ -3741,6 +4078,8 @@ byte add_production_to_rete(agent* thisAgent, production* p, condition* lhs_top,
     action* a;
     byte production_addition_result;
 
+    resize_memory_hash_tables_if_needed(thisAgent);
+
     /* --- build the network for all the conditions --- */
     build_network_for_condition_list(thisAgent, lhs_top, 1, thisAgent->dummy_top_node,
                                      &bottom_node, &bottom_depth, &vars_bound);
@@ -3891,7 +4230,14 @@ byte add_production_to_rete(agent* thisAgent, production* p, condition* lhs_top,
     }
 
     /* --- call new node's add_left routine with all the parent's tokens --- */
-    update_node_with_matches_from_above(thisAgent, p_node);
+    if (refracted_inst)
+    {
+        update_node_with_matches_from_above(thisAgent, p_node);
+    }
+    else
+    {
+        fill_new_node_with_matches(thisAgent, p_node);
+    }
 
     /* --- store result indicator --- */
     if (! refracted_inst)
@@ -3985,6 +4331,7 @@ void excise_production_from_rete(agent* thisAgent, production* pProd)
     /* --- finally, excise the p_node --- */
     remove_node_from_parents_list_of_children(p_node);
     update_stats_for_destroying_node(thisAgent, p_node);    /* clean up rete stats stuff */
+    replace_bulk_load_node(thisAgent, p_node, NIL);
     thisAgent->memoryManager->free_with_pool(MP_rete_node, p_node);
 
     /* --- update sharing factors on the path from here to the top node --- */
@@ -4382,13 +4729,6 @@ bool((*(rete_test_routines[256]))
     ertr, ertr, ertr, ertr, ertr, ertr, ertr, ertr, ertr, ertr, ertr, ertr, ertr, ertr, ertr, ertr
 };
 
-inline bool match_left_and_right(agent* thisAgent, rete_test* _rete_test,
-                                 token* left, wme* w)
-{
-    return ((*(rete_test_routines[(_rete_test)->type])) \
-            (thisAgent, (_rete_test), (left), (w)));
-}
-
 /* Note:  "=" and "<>" tests always return false when one argument is
    an integer and the other is a floating point number */
 
@@ -4449,6 +4789,102 @@ inline int64_t compare_symbols(Symbol* s1, Symbol* s2)
     }
 }
 
+/* ----------------------------------------------------------------------
+                      Specialized Join Test Evaluation
+
+   Nearly all of the tests at join nodes are equality tests on the id or
+   attribute of the wme (variable bindings) or equality tests against a
+   constant.  match_left_and_right() evaluates those, along with the
+   constant relational tests and the goal test, inline here, so the
+   join loops in the positive/negative/mp node activation routines don't
+   pay for an indirect call on every <token,wme> pair.  The templates
+   below are instantiated once per test kind; everything else (and any
+   new test type) goes through rete_test_routines[] as before.
+---------------------------------------------------------------------- */
+
+/* --- finds the wme a variable test refers to, levels_up tokens up from
+   the one being joined (levels_up==0 means the wme being joined) --- */
+inline wme* variable_test_referent_wme(rete_test* rt, token* left, wme* w)
+{
+    rete_node_level i = rt->data.variable_referent.levels_up;
+
+    if (i == 0)
+    {
+        return w;
+    }
+    while (--i != 0)
+    {
+        left = left->parent;
+    }
+    return left->w;
+}
+
+template <byte relation>
+inline bool symbols_satisfy_relation(Symbol* s1, Symbol* s2)
+{
+    switch (relation)
+    {
+        case RELATIONAL_EQUAL_RETE_TEST:
+            return (s1 == s2);
+        case RELATIONAL_NOT_EQUAL_RETE_TEST:
+            return (s1 != s2);
+        case RELATIONAL_LESS_RETE_TEST:
+            return (compare_symbols(s1, s2) < 0);
+        case RELATIONAL_GREATER_RETE_TEST:
+            return (compare_symbols(s1, s2) > 0);
+        case RELATIONAL_LESS_OR_EQUAL_RETE_TEST:
+            return (compare_symbols(s1, s2) <= 0);
+        case RELATIONAL_GREATER_OR_EQUAL_RETE_TEST:
+            return (compare_symbols(s1, s2) >= 0);
+        default:
+            return false;
+    }
+}
+
+template <byte relation>
+inline bool constant_relational_join_test(rete_test* rt, wme* w)
+{
+    return symbols_satisfy_relation<relation>(field_from_wme(w, rt->right_field_num),
+            rt->data.constant_referent);
+}
+
+template <byte relation>
+inline bool variable_relational_join_test(rete_test* rt, token* left, wme* w)
+{
+    return symbols_satisfy_relation<relation>(field_from_wme(w, rt->right_field_num),
+            field_from_wme(variable_test_referent_wme(rt, left, w),
+                           rt->data.variable_referent.field_num));
+}
+
+inline bool match_left_and_right(agent* thisAgent, rete_test* _rete_test,
+                                 token* left, wme* w)
+{
+    switch (_rete_test->type)
+    {
+        case VARIABLE_RELATIONAL_RETE_TEST + RELATIONAL_EQUAL_RETE_TEST:
+            return variable_relational_join_test<RELATIONAL_EQUAL_RETE_TEST>(_rete_test, left, w);
+        case VARIABLE_RELATIONAL_RETE_TEST + RELATIONAL_NOT_EQUAL_RETE_TEST:
+            return variable_relational_join_test<RELATIONAL_NOT_EQUAL_RETE_TEST>(_rete_test, left, w);
+        case CONSTANT_RELATIONAL_RETE_TEST + RELATIONAL_EQUAL_RETE_TEST:
+            return constant_relational_join_test<RELATIONAL_EQUAL_RETE_TEST>(_rete_test, w);
+        case CONSTANT_RELATIONAL_RETE_TEST + RELATIONAL_NOT_EQUAL_RETE_TEST:
+            return constant_relational_join_test<RELATIONAL_NOT_EQUAL_RETE_TEST>(_rete_test, w);
+        case CONSTANT_RELATIONAL_RETE_TEST + RELATIONAL_LESS_RETE_TEST:
+            return constant_relational_join_test<RELATIONAL_LESS_RETE_TEST>(_rete_test, w);
+        case CONSTANT_RELATIONAL_RETE_TEST + RELATIONAL_GREATER_RETE_TEST:
+            return constant_relational_join_test<RELATIONAL_GREATER_RETE_TEST>(_rete_test, w);
+        case CONSTANT_RELATIONAL_RETE_TEST + RELATIONAL_LESS_OR_EQUAL_RETE_TEST:
+            return constant_relational_join_test<RELATIONAL_LESS_OR_EQUAL_RETE_TEST>(_rete_test, w);
+        case CONSTANT_RELATIONAL_RETE_TEST + RELATIONAL_GREATER_OR_EQUAL_RETE_TEST:
+            return constant_relational_join_test<RELATIONAL_GREATER_OR_EQUAL_RETE_TEST>(_rete_test, w);
+        case ID_IS_GOAL_RETE_TEST:
+            return w->id->id->isa_goal;
+        default:
+            return ((*(rete_test_routines[(_rete_test)->type]))
+                    (thisAgent, (_rete_test), (left), (w)));
+    }
+}
+
 bool error_rete_test_routine(agent* thisAgent, rete_test* /*rt*/, token* /*left*/, wme* /*w*/)
 {
     char msg[BUFFER_MSG_SIZE];
@@ -4835,6 +5271,7 @@ void beta_memory_node_left_addition(agent* thisAgent, rete_node* node,
 
     activation_entry_sanity_check();
     left_node_activation(node, true);
+    rete_profile_scope profile_scope(thisAgent, node, true);
 
     {
         int levels_up;
@@ -4858,7 +5295,7 @@ void beta_memory_node_left_addition(agent* thisAgent, rete_node* node,
     hv = node->node_id ^ referent->hash_id;
 
     /* --- build new left token, add it to the hash table --- */
-    token_added(node);
+    token_added(thisAgent, node);
     thisAgent->memoryManager->allocate_with_pool(MP_token, &New);
     new_left_token(New, node, tok, w);
     insert_token_into_left_ht(thisAgent, New, hv);
@@ -4883,11 +5320,12 @@ void unhashed_beta_memory_node_left_addition(agent* thisAgent,
 
     activation_entry_sanity_check();
     left_node_activation(node, true);
+    rete_profile_scope profile_scope(thisAgent, node, true);
 
     hv = node->node_id;
 
     /* --- build new left token, add it to the hash table --- */
-    token_added(node);
+    token_added(thisAgent, node);
     thisAgent->memoryManager->allocate_with_pool(MP_token, &New);
     new_left_token(New, node, tok, w);
     insert_token_into_left_ht(thisAgent, New, hv);
@@ -4915,6 +5353,7 @@ void positive_node_left_addition(agent* thisAgent,
 
     activation_entry_sanity_check();
     left_node_activation(node, true);
+    rete_profile_scope profile_scope(thisAgent, node, true);
 
     am = node->b.posneg.alpha_mem_;
 
@@ -4971,6 +5410,7 @@ void unhashed_positive_node_left_addition(agent* thisAgent, rete_node* node, tok
 
     activation_entry_sanity_check();
     left_node_activation(node, true);
+    rete_profile_scope profile_scope(thisAgent, node, true);
 
     if (node_is_right_unlinked(node))
     {
@@ -5022,6 +5462,7 @@ void mp_node_left_addition(agent* thisAgent, rete_node* node, token* tok, wme* w
 
     activation_entry_sanity_check();
     left_node_activation(node, true);
+    rete_profile_scope profile_scope(thisAgent, node, true);
 
     {
         int levels_up;
@@ -5045,7 +5486,7 @@ void mp_node_left_addition(agent* thisAgent, rete_node* node, token* tok, wme* w
     hv = node->node_id ^ referent->hash_id;
 
     /* --- build new left token, add it to the hash table --- */
-    token_added(node);
+    token_added(thisAgent, node);
     thisAgent->memoryManager->allocate_with_pool(MP_token, &New);
     new_left_token(New, node, tok, w);
     insert_token_into_left_ht(thisAgent, New, hv);
@@ -5118,11 +5559,12 @@ void unhashed_mp_node_left_addition(agent* thisAgent, rete_node* node,
 
     activation_entry_sanity_check();
     left_node_activation(node, true);
+    rete_profile_scope profile_scope(thisAgent, node, true);
 
     hv = node->node_id;
 
     /* --- build new left token, add it to the hash table --- */
-    token_added(node);
+    token_added(thisAgent, node);
     thisAgent->memoryManager->allocate_with_pool(MP_token, &New);
     new_left_token(New, node, tok, w);
     insert_token_into_left_ht(thisAgent, New, hv);
@@ -5180,6 +5622,7 @@ void positive_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
 
     activation_entry_sanity_check();
     right_node_activation(node, true);
+    rete_profile_scope profile_scope(thisAgent, node, false);
 
     if (node_is_left_unlinked(node))
     {
@@ -5236,6 +5679,7 @@ void unhashed_positive_node_right_addition(agent* thisAgent, rete_node* node, wm
 
     activation_entry_sanity_check();
     right_node_activation(node, true);
+    rete_profile_scope profile_scope(thisAgent, node, false);
 
     if (node_is_left_unlinked(node))
     {
@@ -5288,6 +5732,7 @@ void mp_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
 
     activation_entry_sanity_check();
     right_node_activation(node, true);
+    rete_profile_scope profile_scope(thisAgent, node, false);
 
     if (mp_bnode_is_left_unlinked(node))
     {
@@ -5346,6 +5791,7 @@ void unhashed_mp_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
 
     activation_entry_sanity_check();
     right_node_activation(node, true);
+    rete_profile_scope profile_scope(thisAgent, node, false);
 
     if (mp_bnode_is_left_unlinked(node))
     {
@@ -5407,6 +5853,7 @@ void negative_node_left_addition(agent* thisAgent, rete_node* node,
 
     activation_entry_sanity_check();
     left_node_activation(node, true);
+    rete_profile_scope profile_scope(thisAgent, node, true);
 
     if (node_is_right_unlinked(node))
     {
@@ -5435,7 +5882,7 @@ void negative_node_left_addition(agent* thisAgent, rete_node* node,
     hv = node->node_id ^ referent->hash_id;
 
     /* --- build new token, add it to the hash table --- */
-    token_added(node);
+    token_added(thisAgent, node);
     thisAgent->memoryManager->allocate_with_pool(MP_token, &New);
     new_left_token(New, node, tok, w);
     insert_token_into_left_ht(thisAgent, New, hv);
@@ -5504,6 +5951,7 @@ void unhashed_negative_node_left_addition(agent* thisAgent, rete_node* node,
 
     activation_entry_sanity_check();
     left_node_activation(node, true);
+    rete_profile_scope profile_scope(thisAgent, node, true);
 
     if (node_is_right_unlinked(node))
     {
@@ -5513,7 +5961,7 @@ void unhashed_negative_node_left_addition(agent* thisAgent, rete_node* node,
     hv = node->node_id;
 
     /* --- build new token, add it to the hash table --- */
-    token_added(node);
+    token_added(thisAgent, node);
     thisAgent->memoryManager->allocate_with_pool(MP_token, &New);
     new_left_token(New, node, tok, w);
     insert_token_into_left_ht(thisAgent, New, hv);
@@ -5570,6 +6018,7 @@ void negative_node_right_addition(agent* thisAgent, rete_node* node, wme* w)
 
     activation_entry_sanity_check();
     right_node_activation(node, true);
+    rete_profile_scope profile_scope(thisAgent, node, false);
 
     referent = w->id;
     hv = node->node_id ^ referent->hash_id;
@@ -5626,6 +6075,7 @@ void unhashed_negative_node_right_addition(agent* thisAgent, rete_node* node, wm
 
     activation_entry_sanity_check();
     right_node_activation(node, true);
+    rete_profile_scope profile_scope(thisAgent, node, false);
 
     hv = node->node_id;
 
@@ -5685,6 +6135,7 @@ void cn_node_left_addition(agent* thisAgent, rete_node* node, token* tok, wme* w
 
     activation_entry_sanity_check();
     left_node_activation(node, true);
+    rete_profile_scope profile_scope(thisAgent, node, true);
 
     hv = node->node_id ^ cast_and_possibly_truncate<uint32_t>(tok) ^ cast_and_possibly_truncate<uint32_t>(w);
 
@@ -5698,7 +6149,7 @@ void cn_node_left_addition(agent* thisAgent, rete_node* node, token* tok, wme* w
         }
 
     /* --- build left token, add it to the hash table --- */
-    token_added(node);
+    token_added(thisAgent, node);
     thisAgent->memoryManager->allocate_with_pool(MP_token, &New);
     new_left_token(New, node, tok, w);
     insert_token_into_left_ht(thisAgent, New, hv);
@@ -5722,11 +6173,12 @@ void cn_partner_node_left_addition(agent* thisAgent, rete_node* node,
 
     activation_entry_sanity_check();
     left_node_activation(node, true);
+    rete_profile_scope profile_scope(thisAgent, node, true);
 
     partner = node->b.cn.partner;
 
     /* --- build new negrm token --- */
-    token_added(node);
+    token_added(thisAgent, node);
     thisAgent->memoryManager->allocate_with_pool(MP_token, &negrm_tok);
     new_left_token(negrm_tok, node, tok, w);
 
@@ -5750,7 +6202,7 @@ void cn_partner_node_left_addition(agent* thisAgent, rete_node* node,
     /* --- if not found, create a new left token --- */
     if (!left)
     {
-        token_added(partner);
+        token_added(thisAgent, partner);
         thisAgent->memoryManager->allocate_with_pool(MP_token, &left);
         new_left_token(left, partner, tok, w);
         insert_token_into_left_ht(thisAgent, left, hv);
@@ -5819,9 +6271,10 @@ void p_node_left_addition(agent* thisAgent, rete_node* node, token* tok, wme* w)
 
     activation_entry_sanity_check();
     left_node_activation(node, true);
+    rete_profile_scope profile_scope(thisAgent, node, true);
 
     /* --- build new left token (used only for tree-based remove) --- */
-    token_added(node);
+    token_added(thisAgent, node);
     thisAgent->memoryManager->allocate_with_pool(MP_token, &New);
     new_left_token(New, node, tok, w);
 
@@ -6557,12 +7010,20 @@ void remove_token_and_subtree(agent* thisAgent, token* root)
    when we reload the net, the whole NCC subnetwork and CN/CNP stuff gets
    reloaded and reconstructed *before* any nodes underneath the CN node.
 
-   File format (version 3):
-     [Note: all 16-bit or 32-bit words are written LSB first]
+   File format (version 5):
+     [Note: all 16-bit, 32-bit or 64-bit words are written LSB first]
 
      magic number sequence: "SoarCompactReteNet\n"
      1 byte: 0 (null termination for the above string)
-     1 byte: format version number (current version is version 3)
+     1 byte: format version number (current version is version 5, or
+             version 6 when saved with 4-byte words)
+     8 bytes: length of the rest of the file
+     8 bytes: FNV-1a checksum of the rest of the file
+
+     The rest of the file is laid out as below.  In version 5 every 4-byte
+     count and index is written as 8 bytes; version 6 keeps them at 4.
+     Versions 3 (4-byte words) and 4 (8-byte words) have the same layout
+     with no length or checksum, and can still be loaded.
 
      4 bytes: number of str_constants
      4 bytes: number of variables
@@ -6608,32 +7069,52 @@ void remove_token_and_subtree(agent* thisAgent, token* root)
     4 bytes: number of children
     node records for each child
 
+  The net is never read or written a byte at a time through the FILE.
+  It is saved into a memory buffer that is written out with one fwrite
+  once it's complete and its checksum is known.  To load, the whole file
+  is mapped into memory (or read into it, where mapping isn't possible),
+  its header and checksum are checked before anything in the agent is
+  touched, and the net is then rebuilt in a single pass over the bytes.
+
   EXTERNAL INTERFACE:
   Save_rete_net() and load_rete_net() save and load everything to and
   from the given (already open) files.  They return true if successful,
   false if any error occurred.
 ********************************************************************** */
 
-FILE* rete_fs_file;  /* File handle we're using -- "fs" for "fast-save" */
-bool rete_net_64; // used by reteload_eight_bytes, retesave_eight_bytes, BADBAD global, fix with rete_fs_file above
+#define RETE_FS_MAGIC "SoarCompactReteNet\n"
+#define RETE_FS_VERSION 5      /* 8-byte words, with length and checksum */
+#define RETE_FS_VERSION_32 6   /* 4-byte words, with length and checksum */
+
+std::vector<uint8_t> rete_fs_save_buffer; /* Bytes of the net being saved -- "fs" for "fast-save" */
+const uint8_t* rete_fs_load_pos;           /* Next byte of the net being loaded */
+const uint8_t* rete_fs_load_end;           /* One past the last byte of the net being loaded */
+bool rete_net_64; // used by reteload_eight_bytes, retesave_eight_bytes, BADBAD global, fix with rete_fs_save_buffer above
 
 /* ----------------------------------------------------------------------
                 Save/Load Bytes, Short and Long Integers
 
-   These are the lowest-level routines for accessing the FS file.  Note
+   These are the lowest-level routines for accessing the FS buffers.  Note
    that all 16-bit or 32-bit words are written LSB first.  We do this
    carefully, so that fastsave files will be portable across machine
-   types (big-endian vs. little-endian).
+   types (big-endian vs. little-endian).  Reading past the end of the
+   buffer just returns zeros; version 5 and 6 files have their length
+   checked before they're read, so only damaged old files can run past
+   the end.
 ---------------------------------------------------------------------- */
 
 void retesave_one_byte(uint8_t b, FILE* /*f*/)
 {
-    fputc(b, rete_fs_file);
+    rete_fs_save_buffer.push_back(b);
 }
 
-uint8_t reteload_one_byte(FILE* f)
+uint8_t reteload_one_byte(FILE* /*f*/)
 {
-    return static_cast<uint8_t>(fgetc(f));
+    if (rete_fs_load_pos >= rete_fs_load_end)
+    {
+        return 0;
+    }
+    return *(rete_fs_load_pos++);
 }
 
 void retesave_two_bytes(uint16_t w, FILE* f)
@@ -6642,12 +7123,32 @@ void retesave_two_bytes(uint16_t w, FILE* f)
     retesave_one_byte(static_cast<uint8_t>((w >> 8) & 0xFF), f);
 }
 
+/* --- Reads an n-byte LSB-first word straight from the load buffer when
+   all of it is there, and a byte at a time (padding with zeros) when it
+   runs past the end --- */
+inline uint64_t reteload_word(int n, FILE* f)
+{
+    uint64_t w = 0;
+
+    if (rete_fs_load_end - rete_fs_load_pos >= n)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            w |= static_cast<uint64_t>(rete_fs_load_pos[i]) << (8 * i);
+        }
+        rete_fs_load_pos += n;
+        return w;
+    }
+    for (int i = 0; i < n; i++)
+    {
+        w |= static_cast<uint64_t>(reteload_one_byte(f)) << (8 * i);
+    }
+    return w;
+}
+
 uint16_t reteload_two_bytes(FILE* f)
 {
-    uint16_t i;
-    i = reteload_one_byte(f);
-    i += (reteload_one_byte(f) << 8);
-    return i;
+    return static_cast<uint16_t>(reteload_word(2, f));
 }
 
 void retesave_four_bytes(uint32_t w, FILE* f)
@@ -6660,12 +7161,7 @@ void retesave_four_bytes(uint32_t w, FILE* f)
 
 uint32_t reteload_four_bytes(FILE* f)
 {
-    uint32_t i;
-    i = reteload_one_byte(f);
-    i += (reteload_one_byte(f) << 8);
-    i += (reteload_one_byte(f) << 16);
-    i += (reteload_one_byte(f) << 24);
-    return i;
+    return static_cast<uint32_t>(reteload_word(4, f));
 }
 
 void retesave_eight_bytes(uint64_t w, FILE* f)
@@ -6687,29 +7183,7 @@ void retesave_eight_bytes(uint64_t w, FILE* f)
 
 uint64_t reteload_eight_bytes(FILE* f)
 {
-    if (!rete_net_64)
-    {
-        return reteload_four_bytes(f);
-    }
-
-    uint64_t i;
-    uint64_t tmp;
-    i = reteload_one_byte(f);
-    tmp = reteload_one_byte(f);
-    i += (tmp << 8);
-    tmp = reteload_one_byte(f);
-    i += (tmp << 16);
-    tmp = reteload_one_byte(f);
-    i += (tmp << 24);
-    tmp = reteload_one_byte(f);
-    i += (tmp << 32);
-    tmp = reteload_one_byte(f);
-    i += (tmp << 40);
-    tmp = reteload_one_byte(f);
-    i += (tmp << 48);
-    tmp = reteload_one_byte(f);
-    i += (tmp << 56);
-    return i;
+    return reteload_word(rete_net_64 ? 8 : 4, f);
 }
 
 /* ----------------------------------------------------------------------
@@ -6735,13 +7209,27 @@ void retesave_string(const char* s, FILE* f)
 void reteload_string(FILE* f)
 {
     int i, ch;
+
+    /* --- the usual case: the whole string is in the buffer and fits --- */
+    const uint8_t* nul = rete_fs_load_pos ? static_cast<const uint8_t*>(memchr(rete_fs_load_pos, 0, rete_fs_load_end - rete_fs_load_pos)) : NIL;
+    if (nul && (nul - rete_fs_load_pos < static_cast<ptrdiff_t>(sizeof(reteload_string_buf))))
+    {
+        memcpy(reteload_string_buf, rete_fs_load_pos, nul - rete_fs_load_pos + 1);
+        rete_fs_load_pos = nul + 1;
+        return;
+    }
+
     i = 0;
     do
     {
         ch = reteload_one_byte(f);
-        reteload_string_buf[i++] = static_cast<char>(ch);
+        if (i < static_cast<int>(sizeof(reteload_string_buf)) - 1)
+        {
+            reteload_string_buf[i++] = static_cast<char>(ch);
+        }
     }
     while (ch);
+    reteload_string_buf[i] = 0;
 }
 
 /* ----------------------------------------------------------------------
@@ -7828,8 +8316,105 @@ void reteload_node_and_children(agent* thisAgent, rete_node* parent, FILE* f)
   false if any error occurred.
 ---------------------------------------------------------------------- */
 
+/* ----------------------------------------------------------------------
+                        Whole-File Buffers and Checksums
+
+   Retesave_checksum() is a 64-bit FNV-1a hash of the bytes after the
+   version 5 or 6 header.  Reteload_map_file() makes the rest of an open file
+   available as one block of memory, mapping it on systems that support
+   that and reading it into a buffer elsewhere.  Reteload_unmap_file()
+   releases whichever was used.
+---------------------------------------------------------------------- */
+
+uint64_t retesave_checksum(const uint8_t* bytes, size_t size)
+{
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+typedef struct rete_fs_image_struct
+{
+    const uint8_t* bytes;
+    size_t size;
+    void* mapping;                   /* start of the mapped file, if it was mapped */
+    size_t mapping_size;
+    std::vector<uint8_t> buffer;     /* the file's bytes, if it couldn't be mapped */
+} rete_fs_image;
+
+bool reteload_map_file(FILE* f, rete_fs_image* image)
+{
+    long offset;
+
+    image->bytes = NIL;
+    image->size = 0;
+    image->mapping = NIL;
+    image->mapping_size = 0;
+
+    offset = ftell(f);
+    if (offset < 0)
+    {
+        offset = 0;
+    }
+
+#ifndef _WIN32
+    struct stat st;
+    if ((fstat(fileno(f), &st) == 0) && S_ISREG(st.st_mode) && (st.st_size > offset))
+    {
+        void* mapping = mmap(NIL, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fileno(f), 0);
+        if (mapping != MAP_FAILED)
+        {
+            image->mapping = mapping;
+            image->mapping_size = static_cast<size_t>(st.st_size);
+            image->bytes = static_cast<const uint8_t*>(mapping) + offset;
+            image->size = image->mapping_size - offset;
+            return true;
+        }
+    }
+#endif
+
+    /* --- can't map it, so read the rest of it in --- */
+    uint8_t chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0)
+    {
+        image->buffer.insert(image->buffer.end(), chunk, chunk + n);
+    }
+    if (ferror(f))
+    {
+        return false;
+    }
+    image->bytes = image->buffer.empty() ? NIL : &(image->buffer[0]);
+    image->size = image->buffer.size();
+    return true;
+}
+
+void reteload_unmap_file(rete_fs_image* image)
+{
+#ifndef _WIN32
+    if (image->mapping)
+    {
+        munmap(image->mapping, image->mapping_size);
+    }
+#endif
+    image->mapping = NIL;
+    std::vector<uint8_t>().swap(image->buffer);
+    rete_fs_load_pos = rete_fs_load_end = NIL;
+}
+
+/* ----------------------------------------------------------------------
+                        Save/Load The Whole Net
+---------------------------------------------------------------------- */
+
 bool save_rete_net(agent* thisAgent, FILE* dest_file, bool use_rete_net_64)
 {
+    std::vector<uint8_t> body;
+    bool written;
 
     /* --- make sure there are no justifications present --- */
     if (thisAgent->all_productions_of_type[JUSTIFICATION_PRODUCTION_TYPE])
@@ -7838,49 +8423,45 @@ bool save_rete_net(agent* thisAgent, FILE* dest_file, bool use_rete_net_64)
         return false;
     }
 
-    rete_fs_file = dest_file;
     rete_net_64 = use_rete_net_64;
-    uint8_t version = use_rete_net_64 ? 4 : 3;
 
-    retesave_string("SoarCompactReteNet\n", dest_file);
-    retesave_one_byte(version, dest_file);  /* format version number */
+    /* --- build the body first, since the header holds its length and checksum --- */
+    rete_fs_save_buffer.clear();
     retesave_symbol_table(thisAgent, dest_file);
     retesave_alpha_memories(thisAgent, dest_file);
     retesave_children_of_node(thisAgent, thisAgent->dummy_top_node, dest_file);
-    return true;
-}
-
-bool load_rete_net(agent* thisAgent, FILE* source_file)
-{
-    int format_version_num;
-    uint64_t i, count;
-
-    /* RDF: 20020814 RDF Cleaning up the agent working memory and production
-       memory to avoid unnecessary errors in this function. */
-    reinitialize_soar(thisAgent);
-    excise_all_productions(thisAgent, true);
+    body.swap(rete_fs_save_buffer);
+
+    /* --- the length and checksum are 8 bytes whatever the word size --- */
+    retesave_string(RETE_FS_MAGIC, dest_file);
+    retesave_one_byte(use_rete_net_64 ? RETE_FS_VERSION : RETE_FS_VERSION_32, dest_file);  /* format version number */
+    rete_net_64 = true;
+    retesave_eight_bytes(body.size(), dest_file);
+    retesave_eight_bytes(retesave_checksum(body.empty() ? NIL : &(body[0]), body.size()), dest_file);
+    rete_net_64 = use_rete_net_64;
 
-    /* DONE clearing old productions */
+    written = (fwrite(&(rete_fs_save_buffer[0]), 1, rete_fs_save_buffer.size(), dest_file) == rete_fs_save_buffer.size());
+    written = written && (body.empty() || (fwrite(&(body[0]), 1, body.size(), dest_file) == body.size()));
+    written = written && (fflush(dest_file) == 0);
+    std::vector<uint8_t>().swap(rete_fs_save_buffer);
 
-    /* --- check for empty system --- */
-    if (thisAgent->all_wmes_in_rete)
+    if (!written)
     {
-        thisAgent->outputManager->printa_sf(thisAgent, "Internal error: load_rete_net() called with nonempty WM.\n");
+        thisAgent->outputManager->printa_sf(thisAgent, "Error writing the rete net to its file.\n");
         return false;
     }
-    for (i = 0; i < NUM_PRODUCTION_TYPES; i++)
-        if (thisAgent->num_productions_of_type[i])
-        {
-            thisAgent->outputManager->printa_sf(thisAgent, "Internal error: load_rete_net() called with nonempty PM.\n");
-            return false;
-        }
+    return true;
+}
 
-    // BADBAD: this is global, used in retesave_one_byte
-    rete_fs_file = source_file;
+/* --- Reads and checks the file header, leaving the load position at the
+   start of the symbol table.  Nothing in the agent is changed. --- */
+bool reteload_check_header(agent* thisAgent, FILE* source_file)
+{
+    int format_version_num;
+    uint64_t length, checksum;
 
-    /* --- read file header, make sure it's a valid file --- */
     reteload_string(source_file);
-    if (strcmp(reteload_string_buf, "SoarCompactReteNet\n"))
+    if (strcmp(reteload_string_buf, RETE_FS_MAGIC))
     {
         thisAgent->outputManager->printa_sf(thisAgent, "This file isn't a Soar fastsave file.\n");
         return false;
@@ -7896,10 +8477,71 @@ bool load_rete_net(agent* thisAgent, FILE* source_file)
             // Since there's already a global, I'm putting the 32- or 64-bit switch out there globally
             rete_net_64 = true; // used by reteload_eight_bytes
             break;
+        case RETE_FS_VERSION:
+        case RETE_FS_VERSION_32:
+            rete_net_64 = true;  /* the length and checksum are always 8 bytes */
+            length = reteload_eight_bytes(source_file);
+            checksum = reteload_eight_bytes(source_file);
+            rete_net_64 = (format_version_num == RETE_FS_VERSION);
+            if (length != static_cast<uint64_t>(rete_fs_load_end - rete_fs_load_pos))
+            {
+                thisAgent->outputManager->printa_sf(thisAgent, "This fastsave file is truncated or has extra data at its end.\n");
+                return false;
+            }
+            if (checksum != retesave_checksum(rete_fs_load_pos, static_cast<size_t>(length)))
+            {
+                thisAgent->outputManager->printa_sf(thisAgent, "This fastsave file is damaged (its checksum doesn't match).\n");
+                return false;
+            }
+            break;
         default:
             thisAgent->outputManager->printa_sf(thisAgent, "This file is in a format (version %d) I don't understand.\n", format_version_num);
             return false;
     }
+    return true;
+}
+
+bool load_rete_net(agent* thisAgent, FILE* source_file)
+{
+    uint64_t i, count;
+    rete_fs_image image;
+
+    /* --- bring in the whole file and make sure it's a valid one before
+       throwing away the agent's current productions --- */
+    if (!reteload_map_file(source_file, &image))
+    {
+        thisAgent->outputManager->printa_sf(thisAgent, "Error reading the rete net from its file.\n");
+        return false;
+    }
+    rete_fs_load_pos = image.bytes;
+    rete_fs_load_end = image.bytes + image.size;
+    if (!reteload_check_header(thisAgent, source_file))
+    {
+        reteload_unmap_file(&image);
+        return false;
+    }
+
+    /* RDF: 20020814 RDF Cleaning up the agent working memory and production
+       memory to avoid unnecessary errors in this function. */
+    reinitialize_soar(thisAgent);
+    excise_all_productions(thisAgent, true);
+
+    /* DONE clearing old productions */
+
+    /* --- check for empty system --- */
+    if (thisAgent->all_wmes_in_rete)
+    {
+        thisAgent->outputManager->printa_sf(thisAgent, "Internal error: load_rete_net() called with nonempty WM.\n");
+        reteload_unmap_file(&image);
+        return false;
+    }
+    for (i = 0; i < NUM_PRODUCTION_TYPES; i++)
+        if (thisAgent->num_productions_of_type[i])
+        {
+            thisAgent->outputManager->printa_sf(thisAgent, "Internal error: load_rete_net() called with nonempty PM.\n");
+            reteload_unmap_file(&image);
+            return false;
+        }
 
     reteload_all_symbols(thisAgent, source_file);
     reteload_alpha_memories(thisAgent, source_file);
@@ -7912,6 +8554,7 @@ bool load_rete_net(agent* thisAgent, FILE* source_file)
     /* --- clean up auxilliary tables --- */
     reteload_free_am_table(thisAgent);
     reteload_free_symbol_table(thisAgent);
+    reteload_unmap_file(&image);
 
     /* RDF: 20020814 Now adding the top state and io symbols and wmes */
     init_agent_memory(thisAgent);
@@ -8076,6 +8719,135 @@ void get_all_node_count_stats(agent* thisAgent)
     thisAgent->if_no_sharing[UNHASHED_MP_BNODE] = 0;
 }
 
+/* --- Walks every bucket of the left (token) and right (right_mem) hash
+   tables to report how full they are and how long their chains get --- */
+void get_memory_hash_table_stats(agent* thisAgent, rete_ht_stats* left_stats, rete_ht_stats* right_stats)
+{
+    uint32_t i, size;
+    uint64_t chain;
+    token* tok;
+    right_mem* rm;
+
+    size = static_cast<uint32_t>(1) << thisAgent->left_ht_log2size;
+    left_stats->buckets = size;
+    left_stats->entries = thisAgent->left_ht_count;
+    left_stats->used_buckets = 0;
+    left_stats->longest_chain = 0;
+    for (i = 0; i < size; i++)
+    {
+        chain = 0;
+        for (tok = reinterpret_cast<token**>(thisAgent->left_ht)[i]; tok != NIL; tok = tok->a.ht.next_in_bucket)
+        {
+            chain++;
+        }
+        if (chain)
+        {
+            left_stats->used_buckets++;
+        }
+        if (chain > left_stats->longest_chain)
+        {
+            left_stats->longest_chain = chain;
+        }
+    }
+
+    size = static_cast<uint32_t>(1) << thisAgent->right_ht_log2size;
+    right_stats->buckets = size;
+    right_stats->entries = thisAgent->right_ht_count;
+    right_stats->used_buckets = 0;
+    right_stats->longest_chain = 0;
+    for (i = 0; i < size; i++)
+    {
+        chain = 0;
+        for (rm = reinterpret_cast<right_mem**>(thisAgent->right_ht)[i]; rm != NIL; rm = rm->next_in_bucket)
+        {
+            chain++;
+        }
+        if (chain)
+        {
+            right_stats->used_buckets++;
+        }
+        if (chain > right_stats->longest_chain)
+        {
+            right_stats->longest_chain = chain;
+        }
+    }
+}
+
+/* ----------------------------------------------------------------------
+                         Match Profile Reporting
+
+   Set_rete_profiling() turns the match profiler on or off; counters
+   gathered so far are kept either way, so they can be reported after a
+   run.  Reset_rete_profile() zeroes every node's counters.
+
+   Get_rete_profile_for_production() sums the counters over every node
+   the production uses, from its p-node up to the top node, including
+   the nodes in any NCC subnetworks.  Beta nodes shared by several
+   productions are charged in full to each of them, so the totals say
+   how much match work a production takes part in, not how much would
+   go away if it were excised.  If nodes is given, it also gets each of
+   those nodes' own counters, starting at the p-node, paired with the
+   node's type name.
+---------------------------------------------------------------------- */
+
+inline rete_node* next_rete_node_toward_top(rete_node* node)
+{
+    return (node->node_type == CN_BNODE) ? node->b.cn.partner : node->parent;
+}
+
+void set_rete_profiling(agent* thisAgent, bool enabled)
+{
+    thisAgent->rete_profiling = enabled;
+    thisAgent->rete_profile_child_time = 0;
+}
+
+void reset_rete_profile(agent* thisAgent)
+{
+    thisAgent->rete_node_profiles->clear();
+    thisAgent->rete_profile_child_time = 0;
+}
+
+void get_rete_profile_for_production(agent* thisAgent, production* prod, rete_node_profile* totals,
+                                     std::vector< std::pair< const char*, rete_node_profile > >* nodes)
+{
+    rete_node* node;
+    rete_node_profile p;
+    std::unordered_map< rete_node*, rete_node_profile >::iterator it;
+
+    memset(totals, 0, sizeof(rete_node_profile));
+    if (nodes)
+    {
+        init_bnode_type_names(thisAgent);
+        nodes->clear();
+    }
+    if (! prod->p_node)
+    {
+        return;
+    }
+    for (node = prod->p_node; node != thisAgent->dummy_top_node; node = next_rete_node_toward_top(node))
+    {
+        it = thisAgent->rete_node_profiles->find(node);
+        if (it != thisAgent->rete_node_profiles->end())
+        {
+            p = it->second;
+        }
+        else
+        {
+            memset(&p, 0, sizeof(rete_node_profile));
+        }
+        totals->left_activations += p.left_activations;
+        totals->right_activations += p.right_activations;
+        totals->null_left_activations += p.null_left_activations;
+        totals->null_right_activations += p.null_right_activations;
+        totals->tokens_created += p.tokens_created;
+        totals->raw_time += p.raw_time;
+        if (nodes)
+        {
+            nodes->push_back(std::make_pair(bnode_type_names[node->node_type], p));
+        }
+    }
+}
+
 /* Returns 0 if result invalid, 1 if result valid */
 int get_node_count_statistic(agent* thisAgent,
                              char* node_type_name,
@@ -9465,6 +10237,9 @@ void init_rete(agent* thisAgent)
     thisAgent->memoryManager->init_memory_pool(MP_node_varnames, sizeof(node_varnames),
                      "node varnames");
     thisAgent->memoryManager->init_memory_pool(MP_token, sizeof(token), "token");
+    thisAgent->rete_bulk_load_depth = 0;
+    thisAgent->rete_bulk_load_count = 0;
+    thisAgent->rete_bulk_load_nodes = new std::unordered_map< rete_node*, uint64_t >();
     thisAgent->memoryManager->init_memory_pool(MP_right_mem, sizeof(right_mem),
                      "right mem");
     thisAgent->memoryManager->init_memory_pool(MP_ms_change, sizeof(ms_change),
@@ -9475,8 +10250,15 @@ void init_rete(agent* thisAgent)
         thisAgent->alpha_hash_tables[i] = make_hash_table(thisAgent, 0, hash_alpha_mem);
     }
 
-    thisAgent->left_ht = thisAgent->memoryManager->allocate_memory_and_zerofill(sizeof(char*) * LEFT_HT_SIZE, HASH_TABLE_MEM_USAGE);
-    thisAgent->right_ht = thisAgent->memoryManager->allocate_memory_and_zerofill(sizeof(char*) * RIGHT_HT_SIZE, HASH_TABLE_MEM_USAGE);
+    thisAgent->left_ht_log2size = MIN_LOG2_LEFT_HT_SIZE;
+    thisAgent->right_ht_log2size = MIN_LOG2_RIGHT_HT_SIZE;
+    thisAgent->left_ht_count = 0;
+    thisAgent->right_ht_count = 0;
+    thisAgent->rete_profiling = false;
+    thisAgent->rete_profile_child_time = 0;
+    thisAgent->rete_node_profiles = new std::unordered_map< rete_node*, rete_node_profile >();
+    thisAgent->left_ht = thisAgent->memoryManager->allocate_memory_and_zerofill(sizeof(char*) << MIN_LOG2_LEFT_HT_SIZE, HASH_TABLE_MEM_USAGE);
+    thisAgent->right_ht = thisAgent->memoryManager->allocate_memory_and_zerofill(sizeof(char*) << MIN_LOG2_RIGHT_HT_SIZE, HASH_TABLE_MEM_USAGE);
 
     init_dummy_top_node(thisAgent);
 
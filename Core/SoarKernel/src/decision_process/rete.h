@@ -57,6 +57,10 @@
 #include <stdio.h>  // Needed for FILE token below
 #include "kernel.h"
 
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 extern void abort_with_fatal_error_noagent(const char* msg);
 
 inline varnames* one_var_to_varnames(Symbol* x)
@@ -365,6 +369,29 @@ typedef struct ms_change_struct
     struct ms_change_struct* next_in_level; /* dll for goal level */
     struct ms_change_struct* prev_in_level;
 } ms_change;
+
+/* --- size and bucket chain statistics for one memory hash table --- */
+typedef struct rete_ht_stats_struct
+{
+    uint64_t buckets;
+    uint64_t entries;
+    uint64_t used_buckets;
+    uint64_t longest_chain;
+} rete_ht_stats;
+
+/* --- match cost counters for one beta node, gathered while the match
+   profiler is on.  Time is exclusive of the node's children and kept in
+   get_raw_time() ticks --- */
+typedef struct rete_node_profile_struct
+{
+    uint64_t left_activations;
+    uint64_t right_activations;
+    uint64_t null_left_activations;
+    uint64_t null_right_activations;
+    uint64_t tokens_created;
+    uint64_t raw_time;
+} rete_node_profile;
+
 extern void init_rete(agent* thisAgent);
 
 extern bool any_assertions_or_retractions_ready(agent* thisAgent);
@@ -385,6 +412,8 @@ extern byte add_production_to_rete(agent* thisAgent, production* p, condition* l
                                    instantiation* refracted_inst,
                                    bool warn_on_duplicates, production* &duplicate_rule, bool ignore_rhs = false);
 extern void excise_production_from_rete(agent* thisAgent, production* p);
+extern void begin_rete_bulk_load(agent* thisAgent);
+extern void end_rete_bulk_load(agent* thisAgent);
 
 extern void add_wme_to_rete(agent* thisAgent, wme* w);
 extern void remove_wme_from_rete(agent* thisAgent, wme* w);
@@ -412,10 +441,16 @@ extern void xml_partial_match_information(agent* thisAgent, rete_node* p_node, w
 extern void print_match_set(agent* thisAgent, wme_trace_type wtt, ms_trace_type  mst);
 extern void xml_match_set(agent* thisAgent, wme_trace_type wtt, ms_trace_type  mst);
 extern void get_all_node_count_stats(agent* thisAgent);
+extern void get_memory_hash_table_stats(agent* thisAgent, rete_ht_stats* left_stats, rete_ht_stats* right_stats);
 extern int get_node_count_statistic(agent* thisAgent, char* node_type_name,
                                     char* column_name,
                                     uint64_t* result);
 
+extern void set_rete_profiling(agent* thisAgent, bool enabled);
+extern void reset_rete_profile(agent* thisAgent);
+extern void get_rete_profile_for_production(agent* thisAgent, production* prod, rete_node_profile* totals,
+        std::vector< std::pair< const char*, rete_node_profile > >* nodes = NIL);
+
 extern bool save_rete_net(agent* thisAgent, FILE* dest_file, bool use_rete_net_64);
 extern bool load_rete_net(agent* thisAgent, FILE* source_file);
 
@@ -31,6 +31,7 @@
 #include "production.h"
 #include "instantiation.h"
 #include "io_link.h"
+#include "memory_manager.h"
 #include "reinforcement_learning.h"
 #include "rete.h"
 #include "semantic_memory.h"
@@ -394,6 +395,8 @@ void reinitialize_soar(agent* thisAgent)
     delete thisAgent->stats_db;
     thisAgent->stats_db = new soar_module::sqlite_database();
 
+    /* Working memory and the goal stack are gone, so give back any pool blocks they emptied */
+    thisAgent->memoryManager->release_unused_blocks();
 }
 
 /* ===================================================================
@@ -428,6 +431,9 @@ void do_one_top_level_phase(agent* thisAgent)
 {
     //  Symbol *iterate_goal_sym;  kjc commented /* RCHONG: end 10.11 */
 
+    /* Containers created while this agent runs draw from its own pools */
+    Memory_Manager::thread_scope lMemoryScope(thisAgent->memoryManager);
+
     if (thisAgent->system_halted)
     {
         thisAgent->outputManager->printa_sf(thisAgent,
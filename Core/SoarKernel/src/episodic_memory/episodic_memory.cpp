@@ -22,6 +22,7 @@
 #include <fstream>
 #include <set>
 #include <climits>
+#include <random>
 
 
 //////////////////////////////////////////////////////////
@@ -37,6 +38,8 @@
 
 // wme-related                  epmem::wmes
 
+// background storage           epmem::writer
+
 // variable abstraction         epmem::var
 
 // relational interval tree     epmem::rit
@@ -118,6 +121,32 @@ epmem_param_container::epmem_param_container(agent* new_agent): soar_module::par
     lazy_commit = new soar_module::boolean_param("lazy-commit", on, new epmem_db_predicate<boolean>(thisAgent));
     add(lazy_commit);
 
+    // background writer
+    storage_thread = new soar_module::boolean_param("storage-thread", off, new epmem_db_predicate<boolean>(thisAgent));
+    add(storage_thread);
+
+    // group commit (optimization = wal)
+    commit_interval = new soar_module::integer_param("commit-interval", 100, new soar_module::gt_predicate<int64_t>(0, true), new epmem_db_predicate<int64_t>(thisAgent));
+    add(commit_interval);
+
+    commit_interval_ms = new soar_module::integer_param("commit-interval-ms", 1000, new soar_module::gt_predicate<int64_t>(0, true), new epmem_db_predicate<int64_t>(thisAgent));
+    add(commit_interval_ms);
+
+    checkpoint_thread = new soar_module::boolean_param("checkpoint-thread", off, new epmem_db_predicate<boolean>(thisAgent));
+    add(checkpoint_thread);
+
+    // in-memory interval index for cue-based queries
+    interval_index = new soar_module::boolean_param("interval-index", off, new epmem_db_predicate<boolean>(thisAgent));
+    add(interval_index);
+
+    // keep only the most recent episodes (0 keeps them all)
+    retention = new soar_module::integer_param("retention", 0, new soar_module::gt_predicate<int64_t>(0, true), new epmem_db_predicate<int64_t>(thisAgent));
+    add(retention);
+
+    // rows expired per decision cycle
+    retention_batch = new soar_module::integer_param("retention-batch", 500, new soar_module::gt_predicate<int64_t>(1, true), new soar_module::f_predicate<int64_t>());
+    add(retention_batch);
+
     ////////////////////
     // Retrieval
     ////////////////////
@@ -162,6 +191,7 @@ epmem_param_container::epmem_param_container(agent* new_agent): soar_module::par
     opt = new soar_module::constant_param<opt_choices>("optimization", epmem_param_container::opt_speed, new epmem_db_predicate<opt_choices>(thisAgent));
     opt->add_mapping(epmem_param_container::opt_safety, "safety");
     opt->add_mapping(epmem_param_container::opt_speed, "performance");
+    opt->add_mapping(epmem_param_container::opt_wal, "wal");
     add(opt);
 
 
@@ -409,7 +439,7 @@ inline Symbol* epmem_reverse_hash(agent* thisAgent, epmem_hash_id s_id_lookup, b
     {
         case STR_CONSTANT_SYMBOL_TYPE:
             epmem_reverse_hash_str(thisAgent, s_id_lookup, dest);
-            return_val = thisAgent->symbolManager->make_str_constant(const_cast<char*>(dest.c_str()));
+            return_val = thisAgent->symbolManager->make_str_constant(dest.c_str(), dest.length());
             break;
 
         case INT_CONSTANT_SYMBOL_TYPE:
@@ -558,6 +588,13 @@ epmem_stat_container::epmem_stat_container(agent* new_agent): soar_module::stat_
     mem_high = new epmem_mem_high_stat(thisAgent, "mem-high", 0, new soar_module::predicate<int64_t>());
     add(mem_high);
 
+    // commits / checkpoints made by commit-interval since the database was opened
+    commits = new epmem_group_commit_stat(thisAgent, "commits", false, new soar_module::predicate<int64_t>());
+    add(commits);
+
+    checkpoints = new epmem_group_commit_stat(thisAgent, "checkpoints", true, new soar_module::predicate<int64_t>());
+    add(checkpoints);
+
     // non-cue-based-retrievals
     ncbr = new soar_module::integer_stat("retrievals", 0, new soar_module::f_predicate<int64_t>());
     add(ncbr);
@@ -602,6 +639,10 @@ epmem_stat_container::epmem_stat_container(agent* new_agent): soar_module::stat_
     next_id = new epmem_node_id_stat("next-id", 0, new epmem_db_predicate<epmem_node_id>(thisAgent));
     add(next_id);
 
+    // retention-floor
+    retention_floor = new epmem_time_id_stat("retention-floor", 0, new epmem_db_predicate<epmem_time_id>(thisAgent));
+    add(retention_floor);
+
     // rit-offset-1
     rit_offset_1 = new soar_module::integer_stat("rit-offset-1", 0, new epmem_db_predicate<int64_t>(thisAgent));
     add(rit_offset_1);
@@ -686,6 +727,20 @@ int64_t epmem_mem_high_stat::get_value()
     return thisAgent->EpMem->epmem_db->memory_highwater();
 }
 
+//
+
+epmem_group_commit_stat::epmem_group_commit_stat(agent* new_agent, const char* new_name, bool new_count_checkpoints, soar_module::predicate<int64_t>* new_prot_pred): soar_module::integer_stat(new_name, 0, new_prot_pred), thisAgent(new_agent), count_checkpoints(new_count_checkpoints) {}
+
+int64_t epmem_group_commit_stat::get_value()
+{
+    soar_module::sqlite_group_commit* group_commit = thisAgent->EpMem->epmem_group_commit;
+    if (!group_commit)
+    {
+        return 0;
+    }
+    return static_cast<int64_t>(count_checkpoints ? group_commit->get_checkpoints() : group_commit->get_commits());
+}
+
 
 //////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////
@@ -1156,6 +1211,49 @@ epmem_graph_statement_container::epmem_graph_statement_container(agent* new_agen
     update_epmem_wmes_identifier_last_episode_id = new soar_module::sqlite_statement(new_db, "UPDATE epmem_wmes_identifier SET last_episode_id=? WHERE wi_id=?");
     add(update_epmem_wmes_identifier_last_episode_id);
 
+    // retention: expired rows are found a batch at a time, then removed or clipped one by one
+    if (new_agent->EpMem->epmem_params->retention->get_value() > 0)
+    {
+        add_structure("CREATE INDEX IF NOT EXISTS epmem_wmes_constant_range_start ON epmem_wmes_constant_range (start_episode_id)");
+        add_structure("CREATE INDEX IF NOT EXISTS epmem_wmes_identifier_range_start ON epmem_wmes_identifier_range (start_episode_id)");
+    }
+
+    prune_find_episodes = new soar_module::sqlite_statement(new_db, "SELECT episode_id FROM epmem_episodes WHERE episode_id<? LIMIT ?");
+    add(prune_find_episodes);
+
+    prune_delete_episode = new soar_module::sqlite_statement(new_db, "DELETE FROM epmem_episodes WHERE episode_id=?");
+    add(prune_delete_episode);
+
+    {
+        const char* find_points[] = { "SELECT wc_id, episode_id, 0 FROM epmem_wmes_constant_point WHERE episode_id<? LIMIT ?", "SELECT wi_id, episode_id, lti_id FROM epmem_wmes_identifier_point WHERE episode_id<? LIMIT ?" };
+        const char* delete_point[] = { "DELETE FROM epmem_wmes_constant_point WHERE wc_id=? AND episode_id=?", "DELETE FROM epmem_wmes_identifier_point WHERE wi_id=? AND episode_id=?" };
+        const char* find_now[] = { "SELECT wc_id, start_episode_id, 0 FROM epmem_wmes_constant_now WHERE start_episode_id<? LIMIT ?", "SELECT wi_id, start_episode_id, lti_id FROM epmem_wmes_identifier_now WHERE start_episode_id<? LIMIT ?" };
+        const char* update_now[] = { "UPDATE epmem_wmes_constant_now SET start_episode_id=? WHERE wc_id=?", "UPDATE epmem_wmes_identifier_now SET start_episode_id=? WHERE wi_id=?" };
+        const char* find_ranges[] = { "SELECT wc_id, start_episode_id, end_episode_id, 0 FROM epmem_wmes_constant_range WHERE start_episode_id<? LIMIT ?", "SELECT wi_id, start_episode_id, end_episode_id, lti_id FROM epmem_wmes_identifier_range WHERE start_episode_id<? LIMIT ?" };
+        const char* delete_range[] = { "DELETE FROM epmem_wmes_constant_range WHERE wc_id=? AND start_episode_id=?", "DELETE FROM epmem_wmes_identifier_range WHERE wi_id=? AND start_episode_id=?" };
+
+        for (int i = EPMEM_RIT_STATE_NODE; i <= EPMEM_RIT_STATE_EDGE; i++)
+        {
+            prune_find_points[i] = new soar_module::sqlite_statement(new_db, find_points[i]);
+            add(prune_find_points[i]);
+
+            prune_delete_point[i] = new soar_module::sqlite_statement(new_db, delete_point[i]);
+            add(prune_delete_point[i]);
+
+            prune_find_now[i] = new soar_module::sqlite_statement(new_db, find_now[i]);
+            add(prune_find_now[i]);
+
+            prune_update_now[i] = new soar_module::sqlite_statement(new_db, update_now[i]);
+            add(prune_update_now[i]);
+
+            prune_find_ranges[i] = new soar_module::sqlite_statement(new_db, find_ranges[i]);
+            add(prune_find_ranges[i]);
+
+            prune_delete_range[i] = new soar_module::sqlite_statement(new_db, delete_range[i]);
+            add(prune_delete_range[i]);
+        }
+    }
+
     // init statement pools
     {
         int j, k, m;
@@ -1380,6 +1478,160 @@ inline void epmem_buffer_add_wme(agent* thisAgent, symbol_triple_list& my_list,
 }
 
 
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Background Storage Functions (epmem::writer)
+//
+// When storage-thread is on, the writes that record
+// an episode's intervals are collected into a batch
+// while the episode is being stored and are applied
+// to the database by a separate writer thread.
+//
+// The walk of working memory still runs on the agent
+// thread, since it assigns node ids from the database
+// as it goes.
+//
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+// most episodes the writer may fall behind by before
+// storage blocks the agent
+#define EPMEM_STORAGE_MAX_PENDING 256
+
+epmem_storage_writer::epmem_storage_writer(soar_module::sqlite_statement* new_begin, soar_module::sqlite_statement* new_commit, bool new_own_transactions):
+    begin(new_begin), commit(new_commit), own_transactions(new_own_transactions), written(EPMEM_MEMID_NONE), stopping(false)
+{
+    worker = std::thread(&epmem_storage_writer::run, this);
+}
+
+epmem_storage_writer::~epmem_storage_writer()
+{
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        stopping = true;
+    }
+    work_ready.notify_one();
+    worker.join();
+}
+
+void epmem_storage_writer::submit(epmem_storage_batch* batch)
+{
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        work_done.wait(lock, [this] { return pending.size() < EPMEM_STORAGE_MAX_PENDING; });
+        pending.push_back(batch);
+    }
+    work_ready.notify_one();
+}
+
+void epmem_storage_writer::wait_for(epmem_time_id through)
+{
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    work_done.wait(lock, [this, through] { return pending.empty() || (written >= through); });
+}
+
+void epmem_storage_writer::wait_for_all()
+{
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    work_done.wait(lock, [this] { return pending.empty(); });
+}
+
+void epmem_storage_writer::run()
+{
+    epmem_storage_batch* batch;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            work_ready.wait(lock, [this] { return stopping || !pending.empty(); });
+            if (pending.empty())
+            {
+                return;
+            }
+            batch = pending.front();
+        }
+
+        {
+            std::lock_guard<std::mutex> db_lock(db_mutex);
+
+            if (own_transactions)
+            {
+                begin->execute(soar_module::op_reinit);
+            }
+
+            for (std::vector<epmem_storage_op>::iterator op = batch->ops.begin(); op != batch->ops.end(); op++)
+            {
+                for (int i = 0; i < op->num_args; i++)
+                {
+                    op->stmt->bind_int(i + 1, op->args[i]);
+                }
+                op->stmt->execute(soar_module::op_reinit);
+            }
+
+            if (own_transactions)
+            {
+                commit->execute(soar_module::op_reinit);
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            pending.pop_front();
+            written = batch->time;
+        }
+        work_done.notify_all();
+
+        delete batch;
+    }
+}
+
+/***************************************************************************
+ * Function     : epmem_storage_exec
+ * Notes        : Executes one of the storage statements, or appends it
+ *                to the current episode's batch when a writer thread
+ *                is running
+ **************************************************************************/
+void epmem_storage_exec(agent* thisAgent, soar_module::sqlite_statement* stmt, int num_args, int64_t a1 = 0, int64_t a2 = 0, int64_t a3 = 0, int64_t a4 = 0, int64_t a5 = 0)
+{
+    int64_t args[5] = { a1, a2, a3, a4, a5 };
+
+    if (thisAgent->EpMem->epmem_batch)
+    {
+        epmem_storage_op op;
+
+        op.stmt = stmt;
+        op.num_args = num_args;
+        for (int i = 0; i < 5; i++)
+        {
+            op.args[i] = args[i];
+        }
+        thisAgent->EpMem->epmem_batch->ops.push_back(op);
+    }
+    else
+    {
+        for (int i = 0; i < num_args; i++)
+        {
+            stmt->bind_int(i + 1, args[i]);
+        }
+        stmt->execute(soar_module::op_reinit);
+    }
+}
+
+/***************************************************************************
+ * Function     : epmem_wait_for_storage
+ * Notes        : Blocks until every stored episode has been written
+ *                to the database
+ **************************************************************************/
+void epmem_wait_for_storage(agent* thisAgent)
+{
+    if (thisAgent->EpMem->epmem_writer)
+    {
+        thisAgent->EpMem->epmem_writer->wait_for_all();
+    }
+}
+
+
 //////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////
 // Variable Functions (epmem::var)
@@ -1421,12 +1673,7 @@ bool epmem_get_variable(agent* thisAgent, epmem_variable_key variable_id, int64_
  **************************************************************************/
 void epmem_set_variable(agent* thisAgent, epmem_variable_key variable_id, int64_t variable_value)
 {
-    soar_module::sqlite_statement* var_set = thisAgent->EpMem->epmem_stmts_common->var_set;
-
-    var_set->bind_int(1, variable_id);
-    var_set->bind_int(2, variable_value);
-
-    var_set->execute(soar_module::op_reinit);
+    epmem_storage_exec(thisAgent, thisAgent->EpMem->epmem_stmts_common->var_set, 2, variable_id, variable_value);
 }
 
 //////////////////////////////////////////////////////////
@@ -1705,18 +1952,10 @@ void epmem_rit_insert_interval(agent* thisAgent, int64_t lower, int64_t upper, e
     std::string temp2 = temp.str();
     thisAgent->outputManager->print(temp2.c_str());*/
 
-    rit_state->add_query->bind_int(1, node);
-    rit_state->add_query->bind_int(2, lower);
-    rit_state->add_query->bind_int(3, upper);
-    rit_state->add_query->bind_int(4, id);
-    //if (lti_id)
     //A horrible error was occuring where instead of defaulting to null in the absense of a given
     //lti_id, another value was used, which ended up effectively assigning lti status to absurd things
     //when they were recorded into the history for episodic memory.
-    {
-        rit_state->add_query->bind_int(5, (lti_id));
-    }
-    rit_state->add_query->execute(soar_module::op_reinit);
+    epmem_storage_exec(thisAgent, rit_state->add_query, 5, node, lower, upper, id, lti_id);
 }
 
 
@@ -1795,6 +2034,40 @@ void epmem_close(agent* thisAgent)
     if (thisAgent->EpMem->epmem_db->get_status() == soar_module::connected)
     {
         print_sysparam_trace(thisAgent, TRACE_EPMEM_SYSPARAM, "Closing episodic memory database %s.\n", thisAgent->EpMem->epmem_params->path->get_value());
+
+        // finish any episodes still waiting to be written
+        if (thisAgent->EpMem->epmem_writer)
+        {
+            delete thisAgent->EpMem->epmem_writer;
+            thisAgent->EpMem->epmem_writer = NULL;
+        }
+
+        if (thisAgent->EpMem->epmem_group_commit)
+        {
+            delete thisAgent->EpMem->epmem_group_commit;
+            thisAgent->EpMem->epmem_group_commit = NULL;
+        }
+
+        // keep the interval index with an on-disk database, stamped so that
+        // the next open can tell whether the database is still the one the
+        // index was saved from
+        if (thisAgent->EpMem->epmem_index)
+        {
+            if (thisAgent->EpMem->epmem_params->database->get_value() == epmem_param_container::file)
+            {
+                std::random_device rd;
+                int64_t stamp = ((static_cast<int64_t>(rd() & 0x3fffffff) << 32) | rd() | 1);
+                std::string index_path(thisAgent->EpMem->epmem_params->path->get_value());
+                index_path.append("-index");
+                if (thisAgent->EpMem->epmem_index->save(index_path, thisAgent->EpMem->epmem_stats->time->get_value(), static_cast<uint64_t>(stamp)))
+                {
+                    epmem_set_variable(thisAgent, var_index_stamp, stamp);
+                }
+            }
+            delete thisAgent->EpMem->epmem_index;
+            thisAgent->EpMem->epmem_index = NULL;
+        }
+
         // if lazy, commit
         if (thisAgent->EpMem->epmem_params->lazy_commit->get_value() == on)
         {
@@ -1921,6 +2194,78 @@ void epmem_switch_db_mode(agent* thisAgent, std::string& buf, bool readonly)
 //////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////
 
+/***************************************************************************
+ * Function     : epmem_init_index
+ * Notes        : Fills the in-memory interval index for a database that
+ *                has just been opened.  For an on-disk database the
+ *                index saved by epmem_close is used when its stamp is
+ *                the one stored in the database; otherwise the index is
+ *                rebuilt from the tables.  Must run after open
+ *                intervals are closed.
+ **************************************************************************/
+void epmem_init_index(agent* thisAgent, bool readonly, epmem_time_id time_max)
+{
+    epmem_interval_index* index = thisAgent->EpMem->epmem_index;
+    bool on_disk = (thisAgent->EpMem->epmem_params->database->get_value() == epmem_param_container::file);
+    std::string index_path(thisAgent->EpMem->epmem_params->path->get_value());
+    index_path.append("-index");
+    int64_t stamp = 0;
+
+    if (on_disk && epmem_get_variable(thisAgent, var_index_stamp, &stamp) &&
+            index->load(index_path, time_max, static_cast<uint64_t>(stamp), thisAgent->EpMem->epmem_node_mins->size(), thisAgent->EpMem->epmem_edge_mins->size()))
+    {
+        if (!readonly)
+        {
+            index->close_now(time_max - 1);
+        }
+        print_sysparam_trace(thisAgent, TRACE_EPMEM_SYSPARAM, "...loaded episodic memory interval index from %s\n", index_path.c_str());
+        return;
+    }
+
+    soar_module::sqlite_statement* temp_q;
+    const char* edge_select[] = { "SELECT wc_id, parent_n_id, attribute_s_id, value_s_id, 0 FROM epmem_wmes_constant", "SELECT wi_id, parent_n_id, attribute_s_id, child_n_id, last_episode_id FROM epmem_wmes_identifier" };
+    const char* now_select[] = { "SELECT wc_id, start_episode_id FROM epmem_wmes_constant_now ORDER BY wc_id, start_episode_id", "SELECT wi_id, start_episode_id FROM epmem_wmes_identifier_now ORDER BY wi_id, start_episode_id" };
+    const char* point_select[] = { "SELECT wc_id, episode_id FROM epmem_wmes_constant_point ORDER BY wc_id, episode_id", "SELECT wi_id, episode_id FROM epmem_wmes_identifier_point ORDER BY wi_id, episode_id" };
+    const char* range_select[] = { "SELECT wc_id, start_episode_id, end_episode_id FROM epmem_wmes_constant_range ORDER BY wc_id, start_episode_id", "SELECT wi_id, start_episode_id, end_episode_id FROM epmem_wmes_identifier_range ORDER BY wi_id, start_episode_id" };
+
+    index->clear();
+    for (int i = EPMEM_RIT_STATE_NODE; i <= EPMEM_RIT_STATE_EDGE; i++)
+    {
+        temp_q = new soar_module::sqlite_statement(thisAgent->EpMem->epmem_db, edge_select[i]);
+        temp_q->prepare();
+        while (temp_q->execute() == soar_module::row)
+        {
+            index->add_edge(i, temp_q->column_int(0), temp_q->column_int(1), temp_q->column_int(2), temp_q->column_int(3), temp_q->column_int(4));
+        }
+        delete temp_q;
+
+        temp_q = new soar_module::sqlite_statement(thisAgent->EpMem->epmem_db, now_select[i]);
+        temp_q->prepare();
+        while (temp_q->execute() == soar_module::row)
+        {
+            index->add_now(i, temp_q->column_int(0), temp_q->column_int(1));
+        }
+        delete temp_q;
+
+        temp_q = new soar_module::sqlite_statement(thisAgent->EpMem->epmem_db, point_select[i]);
+        temp_q->prepare();
+        while (temp_q->execute() == soar_module::row)
+        {
+            index->add_point(i, temp_q->column_int(0), temp_q->column_int(1));
+        }
+        delete temp_q;
+
+        temp_q = new soar_module::sqlite_statement(thisAgent->EpMem->epmem_db, range_select[i]);
+        temp_q->prepare();
+        while (temp_q->execute() == soar_module::row)
+        {
+            index->add_range(i, temp_q->column_int(0), temp_q->column_int(1), temp_q->column_int(2));
+        }
+        delete temp_q;
+    }
+    print_sysparam_trace(thisAgent, TRACE_EPMEM_SYSPARAM, "...built episodic memory interval index from database.\n");
+}
+
 /***************************************************************************
  * Function     : epmem_init_db
  * Author       : Nate Derbinsky
@@ -2086,6 +2431,12 @@ void epmem_init_db(agent* thisAgent, bool readonly)
                 thisAgent->EpMem->epmem_db->sql_execute(cache_sql.c_str());
             }
 
+            // auto_vacuum - let retention hand expired pages back a few at a time (only takes effect on a new database)
+            if (thisAgent->EpMem->epmem_params->retention->get_value() > 0)
+            {
+                thisAgent->EpMem->epmem_db->sql_execute("PRAGMA auto_vacuum = INCREMENTAL");
+            }
+
             // optimization
             if (thisAgent->EpMem->epmem_params->opt->get_value() == epmem_param_container::opt_speed)
             {
@@ -2098,6 +2449,21 @@ void epmem_init_db(agent* thisAgent, bool readonly)
                 // locking_mode - no one else can view the database after our first write
                 thisAgent->EpMem->epmem_db->sql_execute("PRAGMA locking_mode = EXCLUSIVE");
             }
+            else if (thisAgent->EpMem->epmem_params->opt->get_value() == epmem_param_container::opt_wal)
+            {
+                // journal_mode - write-ahead log, so a crash can only lose changes that were never committed
+                thisAgent->EpMem->epmem_db->sql_execute("PRAGMA journal_mode = WAL");
+
+                // synchronous - with a write-ahead log, only checkpoints need to wait for the disk
+                thisAgent->EpMem->epmem_db->sql_execute("PRAGMA synchronous = NORMAL");
+
+                // wal_autocheckpoint - leave checkpoints to the checkpoint thread
+                if ((thisAgent->EpMem->epmem_params->checkpoint_thread->get_value() == on) &&
+                        (thisAgent->EpMem->epmem_params->database->get_value() == epmem_param_container::file))
+                {
+                    thisAgent->EpMem->epmem_db->sql_execute("PRAGMA wal_autocheckpoint = 0");
+                }
+            }
         }
 
         // point stuff
@@ -2145,6 +2511,19 @@ void epmem_init_db(agent* thisAgent, bool readonly)
             // initialize time
             thisAgent->EpMem->epmem_stats->time->set_value(1);
 
+            // expiry resumes from the stored floor, finishing the pass that
+            // set it in case it was cut short
+            thisAgent->EpMem->epmem_stats->retention_floor->set_value(EPMEM_MEMID_NONE);
+            thisAgent->EpMem->epmem_retention_step = epmem_retention_idle;
+            {
+                int64_t stored_floor = NIL;
+                if (epmem_get_variable(thisAgent, var_retention_floor, &stored_floor) && (stored_floor != EPMEM_MEMID_NONE))
+                {
+                    thisAgent->EpMem->epmem_stats->retention_floor->set_value(stored_floor);
+                    thisAgent->EpMem->epmem_retention_step = epmem_retention_episodes;
+                }
+            }
+
             // initialize next_id
             thisAgent->EpMem->epmem_stats->next_id->set_value(1);
             {
@@ -2362,6 +2741,28 @@ void epmem_init_db(agent* thisAgent, bool readonly)
                 temp_q = NULL;
             }
 
+            // set up the interval index; a saved index left by an earlier
+            // run without one no longer matches the database
+            if (thisAgent->EpMem->epmem_params->interval_index->get_value() == on)
+            {
+                thisAgent->EpMem->epmem_index = new epmem_interval_index;
+                epmem_init_index(thisAgent, readonly, time_max);
+            }
+            else if (thisAgent->EpMem->epmem_params->database->get_value() == epmem_param_container::file)
+            {
+                std::string index_path(thisAgent->EpMem->epmem_params->path->get_value());
+                index_path.append("-index");
+                remove(index_path.c_str());
+            }
+
+            // whatever this session stores makes a saved index stale, even
+            // if it ends without closing the database; a new stamp is only
+            // stored when the index is saved again
+            if (!readonly)
+            {
+                epmem_set_variable(thisAgent, var_index_stamp, 0);
+            }
+
             // at init, top-state is considered the only known identifier
             thisAgent->top_goal->id->epmem_id = EPMEM_NODEID_ROOT;
             thisAgent->top_goal->id->epmem_valid = thisAgent->EpMem->epmem_validation;
@@ -2379,6 +2780,27 @@ void epmem_init_db(agent* thisAgent, bool readonly)
         {
             thisAgent->EpMem->epmem_stmts_common->begin->execute(soar_module::op_reinit);
         }
+
+        // with a write-ahead log, that transaction is committed in groups instead
+        if ((thisAgent->EpMem->epmem_params->lazy_commit->get_value() == on) &&
+                (thisAgent->EpMem->epmem_params->opt->get_value() == epmem_param_container::opt_wal))
+        {
+            thisAgent->EpMem->epmem_group_commit = new soar_module::sqlite_group_commit(thisAgent->EpMem->epmem_stmts_common->begin, thisAgent->EpMem->epmem_stmts_common->commit,
+                    thisAgent->EpMem->epmem_params->commit_interval->get_value(), thisAgent->EpMem->epmem_params->commit_interval_ms->get_value(), thisAgent->d_cycle_count);
+
+            if ((thisAgent->EpMem->epmem_params->checkpoint_thread->get_value() == on) &&
+                    (thisAgent->EpMem->epmem_params->database->get_value() == epmem_param_container::file))
+            {
+                thisAgent->EpMem->epmem_group_commit->start_checkpointer(thisAgent->EpMem->epmem_params->path->get_value());
+            }
+        }
+
+        // otherwise the writer commits each episode as a single transaction
+        if (!readonly && (thisAgent->EpMem->epmem_params->storage_thread->get_value() == on))
+        {
+            thisAgent->EpMem->epmem_writer = new epmem_storage_writer(thisAgent->EpMem->epmem_stmts_common->begin, thisAgent->EpMem->epmem_stmts_common->commit,
+                    (thisAgent->EpMem->epmem_params->lazy_commit->get_value() == off));
+        }
     }
 
     ////////////////////////////////////////////////////////////////////////////
@@ -2788,6 +3210,10 @@ inline void _epmem_store_level(agent* thisAgent,
 #ifdef DEBUG_EPMEM_WME_ADD
                 fprintf(stderr, "   Incrementing and setting wme id to %d\n", (unsigned int)(*w_p)->epmem_id);
 #endif
+                if (thisAgent->EpMem->epmem_index)
+                {
+                    thisAgent->EpMem->epmem_index->add_edge(EPMEM_RIT_STATE_EDGE, (*w_p)->epmem_id, parent_id, my_hash, (*w_p)->value->id->epmem_id, LLONG_MAX);
+                }
                 // replace the epmem_id and wme id in the right place
                 (*thisAgent->EpMem->epmem_id_replacement)[(*w_p)->epmem_id ] = my_id_repo2;
 
@@ -2894,6 +3320,10 @@ inline void _epmem_store_level(agent* thisAgent,
                     thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_constant->execute(soar_module::op_reinit);
 
                     (*w_p)->epmem_id = (epmem_node_id) thisAgent->EpMem->epmem_db->last_insert_rowid();
+                    if (thisAgent->EpMem->epmem_index)
+                    {
+                        thisAgent->EpMem->epmem_index->add_edge(EPMEM_RIT_STATE_NODE, (*w_p)->epmem_id, parent_id, my_hash, my_hash2, 0);
+                    }
 #ifdef DEBUG_EPMEM_WME_ADD
                     fprintf(stderr, "   Setting wme id from last row to %d\n", (unsigned int)(*w_p)->epmem_id);
 #endif
@@ -2943,6 +3373,18 @@ void epmem_new_episode(agent* thisAgent)
     // provide trace output
     print_sysparam_trace(thisAgent, TRACE_EPMEM_SYSPARAM,  "New episodic memory recorded for time %u.\n", static_cast<long int>(time_counter));
 
+    // with a writer thread, this episode's writes are collected into a batch;
+    // the walk still reads the database, so it runs under the writer's db lock
+    epmem_storage_writer* writer = thisAgent->EpMem->epmem_writer;
+    epmem_interval_index* index = thisAgent->EpMem->epmem_index;
+    std::unique_lock<std::mutex> db_lock;
+    if (writer)
+    {
+        thisAgent->EpMem->epmem_batch = new epmem_storage_batch;
+        thisAgent->EpMem->epmem_batch->time = time_counter;
+        db_lock = std::unique_lock<std::mutex>(writer->db_mutex);
+    }
+
     // perform storage
     {
         // seen nodes (non-identifiers) and edges (identifiers)
@@ -2993,6 +3435,11 @@ void epmem_new_episode(agent* thisAgent)
             }
         }
 
+        if (db_lock.owns_lock())
+        {
+            db_lock.unlock();
+        }
+
         // all inserts
         {
             epmem_node_id* temp_node;
@@ -3005,9 +3452,11 @@ void epmem_new_episode(agent* thisAgent)
 
                 // add NOW entry
                 // id = ?, start_episode_id = ?
-                thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_constant_now->bind_int(1, (*temp_node));
-                thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_constant_now->bind_int(2, time_counter);
-                thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_constant_now->execute(soar_module::op_reinit);
+                epmem_storage_exec(thisAgent, thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_constant_now, 2, (*temp_node), time_counter);
+                if (index)
+                {
+                    index->add_now(EPMEM_RIT_STATE_NODE, (*temp_node), time_counter);
+                }
 
                 // update min
                 (*thisAgent->EpMem->epmem_node_mins)[static_cast<size_t>((*temp_node) - 1)] = time_counter;
@@ -3026,17 +3475,17 @@ void epmem_new_episode(agent* thisAgent)
 
                 // add NOW entry
                 // id = ?, start_episode_id = ?
-                thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_identifier_now->bind_int(1, (*temp_node));
-                thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_identifier_now->bind_int(2, time_counter);
-                thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_identifier_now->bind_int(3, (*lti_id));
-                thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_identifier_now->execute(soar_module::op_reinit);
+                epmem_storage_exec(thisAgent, thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_identifier_now, 3, (*temp_node), time_counter, (*lti_id));
 
                 // update min
                 (*thisAgent->EpMem->epmem_edge_mins)[static_cast<size_t>((*temp_node) - 1)] = time_counter;
 
-                thisAgent->EpMem->epmem_stmts_graph->update_epmem_wmes_identifier_last_episode_id->bind_int(1, LLONG_MAX);
-                thisAgent->EpMem->epmem_stmts_graph->update_epmem_wmes_identifier_last_episode_id->bind_int(2, *temp_node);
-                thisAgent->EpMem->epmem_stmts_graph->update_epmem_wmes_identifier_last_episode_id->execute(soar_module::op_reinit);
+                epmem_storage_exec(thisAgent, thisAgent->EpMem->epmem_stmts_graph->update_epmem_wmes_identifier_last_episode_id, 2, LLONG_MAX, (*temp_node));
+                if (index)
+                {
+                    index->add_now(EPMEM_RIT_STATE_EDGE, (*temp_node), time_counter);
+                    index->set_last_episode((*temp_node), LLONG_MAX);
+                }
 
                 epmem_edge.pop();
             }
@@ -3059,8 +3508,7 @@ void epmem_new_episode(agent* thisAgent)
 
                         // remove NOW entry
                         // id = ?
-                        thisAgent->EpMem->epmem_stmts_graph->delete_epmem_wmes_constant_now->bind_int(1, r->first);
-                        thisAgent->EpMem->epmem_stmts_graph->delete_epmem_wmes_constant_now->execute(soar_module::op_reinit);
+                        epmem_storage_exec(thisAgent, thisAgent->EpMem->epmem_stmts_graph->delete_epmem_wmes_constant_now, 1, r->first);
 
                         range_start = (*thisAgent->EpMem->epmem_node_mins)[static_cast<size_t>(r->first - 1)];
                         range_end = (time_counter - 1);
@@ -3068,9 +3516,7 @@ void epmem_new_episode(agent* thisAgent)
                         // point (id, start_episode_id)
                         if (range_start == range_end)
                         {
-                            thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_constant_point->bind_int(1, r->first);
-                            thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_constant_point->bind_int(2, range_start);
-                            thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_constant_point->execute(soar_module::op_reinit);
+                            epmem_storage_exec(thisAgent, thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_constant_point, 2, r->first, range_start);
                         }
                         // node
                         else
@@ -3078,6 +3524,19 @@ void epmem_new_episode(agent* thisAgent)
                             epmem_rit_insert_interval(thisAgent, range_start, range_end, r->first, &(thisAgent->EpMem->epmem_rit_state_graph[ EPMEM_RIT_STATE_NODE ]));
                         }
 
+                        if (index)
+                        {
+                            index->remove_now(EPMEM_RIT_STATE_NODE, r->first);
+                            if (range_start == range_end)
+                            {
+                                index->add_point(EPMEM_RIT_STATE_NODE, r->first, range_start);
+                            }
+                            else
+                            {
+                                index->add_range(EPMEM_RIT_STATE_NODE, r->first, range_start, range_end);
+                            }
+                        }
+
                         // update max
                         (*thisAgent->EpMem->epmem_node_maxes)[static_cast<size_t>(r->first - 1)] = true;
                     }
@@ -3095,22 +3554,16 @@ void epmem_new_episode(agent* thisAgent)
                 {
                     // remove NOW entry
                     // id = ?
-                    thisAgent->EpMem->epmem_stmts_graph->delete_epmem_wmes_identifier_now->bind_int(1, r->first.first);
-                    thisAgent->EpMem->epmem_stmts_graph->delete_epmem_wmes_identifier_now->execute(soar_module::op_reinit);
+                    epmem_storage_exec(thisAgent, thisAgent->EpMem->epmem_stmts_graph->delete_epmem_wmes_identifier_now, 1, r->first.first);
 
                     range_start = (*thisAgent->EpMem->epmem_edge_mins)[static_cast<size_t>(r->first.first - 1)];
                     range_end = (time_counter - 1);
 
-                    thisAgent->EpMem->epmem_stmts_graph->update_epmem_wmes_identifier_last_episode_id->bind_int(1, range_end);
-                    thisAgent->EpMem->epmem_stmts_graph->update_epmem_wmes_identifier_last_episode_id->bind_int(2, r->first.first);
-                    thisAgent->EpMem->epmem_stmts_graph->update_epmem_wmes_identifier_last_episode_id->execute(soar_module::op_reinit);
+                    epmem_storage_exec(thisAgent, thisAgent->EpMem->epmem_stmts_graph->update_epmem_wmes_identifier_last_episode_id, 2, range_end, r->first.first);
                     // point (id, start_episode_id)
                     if (range_start == range_end)
                     {
-                        thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_identifier_point->bind_int(1, r->first.first);
-                        thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_identifier_point->bind_int(2, range_start);
-                        thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_identifier_point->bind_int(3, r->first.second);
-                        thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_identifier_point->execute(soar_module::op_reinit);
+                        epmem_storage_exec(thisAgent, thisAgent->EpMem->epmem_stmts_graph->add_epmem_wmes_identifier_point, 3, r->first.first, range_start, r->first.second);
                     }
                     // node
                     else
@@ -3118,6 +3571,20 @@ void epmem_new_episode(agent* thisAgent)
                         epmem_rit_insert_interval(thisAgent, range_start, range_end, r->first.first, &(thisAgent->EpMem->epmem_rit_state_graph[ EPMEM_RIT_STATE_EDGE ]), r->first.second);
                     }
 
+                    if (index)
+                    {
+                        index->remove_now(EPMEM_RIT_STATE_EDGE, r->first.first);
+                        index->set_last_episode(r->first.first, range_end);
+                        if (range_start == range_end)
+                        {
+                            index->add_point(EPMEM_RIT_STATE_EDGE, r->first.first, range_start);
+                        }
+                        else
+                        {
+                            index->add_range(EPMEM_RIT_STATE_EDGE, r->first.first, range_start, range_end);
+                        }
+                    }
+
                     // update max
                     (*thisAgent->EpMem->epmem_edge_maxes)[static_cast<size_t>(r->first.first - 1)] = true;
                 }
@@ -3128,8 +3595,14 @@ void epmem_new_episode(agent* thisAgent)
         }
 
         // add the time id to the epmem_episodes table
-        thisAgent->EpMem->epmem_stmts_graph->add_time->bind_int(1, time_counter);
-        thisAgent->EpMem->epmem_stmts_graph->add_time->execute(soar_module::op_reinit);
+        epmem_storage_exec(thisAgent, thisAgent->EpMem->epmem_stmts_graph->add_time, 1, time_counter);
+
+        // hand the episode to the writer
+        if (writer)
+        {
+            writer->submit(thisAgent->EpMem->epmem_batch);
+            thisAgent->EpMem->epmem_batch = NULL;
+        }
 
         thisAgent->EpMem->epmem_stats->time->set_value(time_counter + 1);
 
@@ -3164,6 +3637,228 @@ void epmem_new_episode(agent* thisAgent)
     ////////////////////////////////////////////////////////////////////////////
 }
 
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+// Retention Functions (epmem::retention)
+//
+// With retention set to N, only the N most recent
+// episodes are kept.  Older ones are expired by passes
+// that each work toward a fixed cutoff episode, a batch
+// of rows per decision cycle: episodes and points before
+// the cutoff are deleted, as are ranges that end before
+// it, while ranges and now intervals that merely start
+// before it are clipped to start at it.
+//
+//////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////
+
+// one row found by a pass
+typedef struct epmem_expired_row_struct
+{
+    epmem_node_id id;
+    epmem_time_id start;
+    epmem_time_id end;
+    int64_t lti_id;
+} epmem_expired_row;
+
+/***************************************************************************
+ * Function     : epmem_expire_rows
+ * Notes        : Expires at most limit rows of the table the current
+ *                pass is working on.  Returns the number of rows
+ *                found; fewer than limit means the table is done.
+ **************************************************************************/
+int64_t epmem_expire_rows(agent* thisAgent, epmem_retention_phase phase, epmem_time_id cutoff, int64_t limit)
+{
+    epmem_graph_statement_container* stmts = thisAgent->EpMem->epmem_stmts_graph;
+    epmem_interval_index* index = thisAgent->EpMem->epmem_index;
+    int value_is_id = (((phase == epmem_retention_identifier_points) || (phase == epmem_retention_identifier_now) || (phase == epmem_retention_identifier_ranges)) ? (EPMEM_RIT_STATE_EDGE) : (EPMEM_RIT_STATE_NODE));
+    soar_module::sqlite_statement* find;
+    std::vector<epmem_expired_row> rows;
+    epmem_expired_row row;
+
+    switch (phase)
+    {
+        case epmem_retention_episodes:
+            find = stmts->prune_find_episodes;
+            break;
+
+        case epmem_retention_constant_points:
+        case epmem_retention_identifier_points:
+            find = stmts->prune_find_points[ value_is_id ];
+            break;
+
+        case epmem_retention_constant_now:
+        case epmem_retention_identifier_now:
+            find = stmts->prune_find_now[ value_is_id ];
+            break;
+
+        default:
+            find = stmts->prune_find_ranges[ value_is_id ];
+            break;
+    }
+
+    // read the whole batch before changing the table under it
+    find->bind_int(1, cutoff);
+    find->bind_int(2, limit);
+    while (find->execute() == soar_module::row)
+    {
+        row.id = find->column_int(0);
+        row.start = row.end = EPMEM_MEMID_NONE;
+        row.lti_id = 0;
+        if ((phase == epmem_retention_constant_ranges) || (phase == epmem_retention_identifier_ranges))
+        {
+            row.start = find->column_int(1);
+            row.end = find->column_int(2);
+            row.lti_id = find->column_int(3);
+        }
+        else if (phase != epmem_retention_episodes)
+        {
+            row.start = row.end = find->column_int(1);
+            row.lti_id = find->column_int(2);
+        }
+        rows.push_back(row);
+    }
+    find->reinitialize();
+
+    for (std::vector<epmem_expired_row>::iterator r = rows.begin(); r != rows.end(); r++)
+    {
+        switch (phase)
+        {
+            case epmem_retention_episodes:
+                epmem_storage_exec(thisAgent, stmts->prune_delete_episode, 1, r->id);
+                break;
+
+            case epmem_retention_constant_points:
+            case epmem_retention_identifier_points:
+                epmem_storage_exec(thisAgent, stmts->prune_delete_point[ value_is_id ], 2, r->id, r->start);
+                break;
+
+            case epmem_retention_constant_now:
+            case epmem_retention_identifier_now:
+            {
+                epmem_storage_exec(thisAgent, stmts->prune_update_now[ value_is_id ], 2, cutoff, r->id);
+
+                // the interval will be closed from its new start
+                std::vector<epmem_time_id>* mins = ((value_is_id == EPMEM_RIT_STATE_NODE) ? (thisAgent->EpMem->epmem_node_mins) : (thisAgent->EpMem->epmem_edge_mins));
+                if ((static_cast<size_t>(r->id) <= mins->size()) && ((*mins)[ static_cast<size_t>(r->id - 1) ] < cutoff))
+                {
+                    (*mins)[ static_cast<size_t>(r->id - 1) ] = cutoff;
+                }
+                break;
+            }
+
+            default:
+                epmem_storage_exec(thisAgent, stmts->prune_delete_range[ value_is_id ], 2, r->id, r->start);
+
+                // what is left of the range goes back in at its new fork node,
+                // or becomes a point if only the cutoff episode remains
+                if (r->end > cutoff)
+                {
+                    epmem_rit_insert_interval(thisAgent, cutoff, r->end, r->id, &(thisAgent->EpMem->epmem_rit_state_graph[ value_is_id ]), r->lti_id);
+                }
+                else if (r->end == cutoff)
+                {
+                    if (value_is_id == EPMEM_RIT_STATE_NODE)
+                    {
+                        epmem_storage_exec(thisAgent, stmts->add_epmem_wmes_constant_point, 2, r->id, cutoff);
+                    }
+                    else
+                    {
+                        epmem_storage_exec(thisAgent, stmts->add_epmem_wmes_identifier_point, 3, r->id, cutoff, r->lti_id);
+                    }
+                }
+                break;
+        }
+
+        if (index && (phase != epmem_retention_episodes))
+        {
+            index->truncate(value_is_id, r->id, cutoff);
+        }
+    }
+
+    return static_cast<int64_t>(rows.size());
+}
+
+/***************************************************************************
+ * Function     : epmem_expire_episodes
+ * Notes        : Advances episode retention by at most retention-batch
+ *                rows.  A pass starts whenever episodes have fallen
+ *                out of the window and none is under way; its cutoff
+ *                becomes the new floor below which queries will not
+ *                look.  Once the tables are done, the pass hands some
+ *                of the freed pages back to the file system.
+ **************************************************************************/
+void epmem_expire_episodes(agent* thisAgent)
+{
+    int64_t retention = thisAgent->EpMem->epmem_params->retention->get_value();
+    if ((retention == 0) || (thisAgent->EpMem->epmem_db->get_status() != soar_module::connected))
+    {
+        return;
+    }
+
+    bool new_pass = false;
+    if (thisAgent->EpMem->epmem_retention_step == epmem_retention_idle)
+    {
+        epmem_time_id time_counter = thisAgent->EpMem->epmem_stats->time->get_value();
+        if ((time_counter <= static_cast<epmem_time_id>(retention)) || ((time_counter - retention) <= thisAgent->EpMem->epmem_stats->retention_floor->get_value()))
+        {
+            return;
+        }
+
+        thisAgent->EpMem->epmem_stats->retention_floor->set_value(time_counter - retention);
+        thisAgent->EpMem->epmem_retention_step = epmem_retention_episodes;
+        new_pass = true;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    thisAgent->EpMem->epmem_timers->storage->start();
+    ////////////////////////////////////////////////////////////////////////////
+
+    // the writer must be idle: queued episodes may still close intervals
+    // that start before the cutoff, and the RIT state and interval minimums
+    // the sweep changes are the ones the next episode is built from
+    epmem_wait_for_storage(thisAgent);
+
+    epmem_time_id cutoff = thisAgent->EpMem->epmem_stats->retention_floor->get_value();
+    int64_t budget = thisAgent->EpMem->epmem_params->retention_batch->get_value();
+
+    // a reloaded store must not offer what was expired before
+    if (new_pass)
+    {
+        epmem_set_variable(thisAgent, var_retention_floor, cutoff);
+    }
+
+    while ((budget > 0) && (thisAgent->EpMem->epmem_retention_step != epmem_retention_idle))
+    {
+        if (thisAgent->EpMem->epmem_retention_step == epmem_retention_vacuum)
+        {
+            // a no-op unless the database was created with auto_vacuum on
+            std::string vacuum_sql("PRAGMA incremental_vacuum(");
+            vacuum_sql.append(std::to_string(budget));
+            vacuum_sql.append(")");
+
+            soar_module::sqlite_statement* vacuum = new soar_module::sqlite_statement(thisAgent->EpMem->epmem_db, vacuum_sql.c_str());
+            vacuum->prepare();
+            while (vacuum->execute() == soar_module::row) {}
+            delete vacuum;
+
+            thisAgent->EpMem->epmem_retention_step = epmem_retention_idle;
+            break;
+        }
+
+        int64_t found = epmem_expire_rows(thisAgent, thisAgent->EpMem->epmem_retention_step, cutoff, budget);
+        if (found < budget)
+        {
+            thisAgent->EpMem->epmem_retention_step = static_cast<epmem_retention_phase>(thisAgent->EpMem->epmem_retention_step + 1);
+        }
+        budget -= found;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    thisAgent->EpMem->epmem_timers->storage->stop();
+    ////////////////////////////////////////////////////////////////////////////
+}
+
 //////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////
 // Non-Cue-Based Retrieval Functions (epmem::ncb)
@@ -3929,6 +4624,63 @@ epmem_literal* epmem_build_dnf(wme* cue_wme, epmem_wme_literal_map& literal_cach
     return literal;
 }
 
+// Partial edges and intervals each read a stream of rows, either from
+// a pooled SQL statement or, with interval-index on, from a cursor
+// into the in-memory index.  These advance a stream to its next row;
+// once it runs dry its statement is released and false returned.
+inline bool epmem_pedge_next(epmem_pedge* pedge)
+{
+    if (pedge->cursor)
+    {
+        epmem_index_edge_row row;
+        if (pedge->cursor->next(row))
+        {
+            pedge->edge_id = row.edge_id;
+            pedge->value_id = row.value_id;
+            pedge->time = row.time;
+            return true;
+        }
+        delete pedge->cursor;
+        pedge->cursor = NULL;
+    }
+    else if (pedge->sql)
+    {
+        if (pedge->sql->execute() == soar_module::row)
+        {
+            pedge->edge_id = pedge->sql->column_int(0);
+            pedge->value_id = pedge->sql->column_int(1);
+            pedge->time = pedge->sql->column_int(2);
+            return true;
+        }
+        pedge->sql->get_pool()->release(pedge->sql);
+        pedge->sql = NULL;
+    }
+    return false;
+}
+
+inline bool epmem_interval_next(agent* thisAgent, epmem_interval* interval)
+{
+    if (interval->indexed)
+    {
+        if (thisAgent->EpMem->epmem_index->next_interval(interval->cursor, interval->time))
+        {
+            return true;
+        }
+        interval->indexed = false;
+    }
+    else if (interval->sql)
+    {
+        if (interval->sql->execute() == soar_module::row)
+        {
+            interval->time = interval->sql->column_int(0);
+            return true;
+        }
+        interval->sql->get_pool()->release(interval->sql);
+        interval->sql = NULL;
+    }
+    return false;
+}
+
 bool epmem_register_pedges(epmem_node_id parent, epmem_literal* literal, epmem_pedge_pq& pedge_pq, epmem_time_id after, epmem_triple_pedge_map pedge_caches[], epmem_triple_uedge_map uedge_caches[], agent* thisAgent)
 {
     // we don't need to keep track of visited literals/nodes because the literals are guaranteed to be acyclic
@@ -3947,39 +4699,47 @@ bool epmem_register_pedges(epmem_node_id parent, epmem_literal* literal, epmem_p
     epmem_pedge* child_pedge = NULL;
     if (pedge_iter == pedge_cache->end() || (*pedge_iter).second == NULL)
     {
-        int has_value = (literal->child_n_id != EPMEM_NODEID_BAD ? 1 : 0);
-        soar_module::pooled_sqlite_statement* pedge_sql = thisAgent->EpMem->epmem_stmts_graph->pool_find_edge_queries[is_edge][has_value]->request(thisAgent->EpMem->epmem_timers->query_sql_edge);
-        int bind_pos = 1;
-        if (!is_edge)
-        {
-            pedge_sql->bind_int(bind_pos++, LLONG_MAX);
-        }
-        pedge_sql->bind_int(bind_pos++, triple.parent_n_id);
-        pedge_sql->bind_int(bind_pos++, triple.attribute_s_id);
-        if (has_value)
+        thisAgent->memoryManager->allocate_with_pool(MP_epmem_pedge, &child_pedge);
+        child_pedge->triple = triple;
+        child_pedge->value_is_id = literal->value_is_id;
+        child_pedge->sql = NULL;
+        child_pedge->cursor = NULL;
+        if (thisAgent->EpMem->epmem_index)
         {
-            pedge_sql->bind_int(bind_pos++, triple.child_n_id);
+            child_pedge->cursor = thisAgent->EpMem->epmem_index->find_edges(is_edge, triple.parent_n_id, triple.attribute_s_id, triple.child_n_id, after);
         }
-        if (is_edge)
+        else
         {
-            pedge_sql->bind_int(bind_pos++, after);
+            int has_value = (literal->child_n_id != EPMEM_NODEID_BAD ? 1 : 0);
+            soar_module::pooled_sqlite_statement* pedge_sql = thisAgent->EpMem->epmem_stmts_graph->pool_find_edge_queries[is_edge][has_value]->request(thisAgent->EpMem->epmem_timers->query_sql_edge);
+            int bind_pos = 1;
+            if (!is_edge)
+            {
+                pedge_sql->bind_int(bind_pos++, LLONG_MAX);
+            }
+            pedge_sql->bind_int(bind_pos++, triple.parent_n_id);
+            pedge_sql->bind_int(bind_pos++, triple.attribute_s_id);
+            if (has_value)
+            {
+                pedge_sql->bind_int(bind_pos++, triple.child_n_id);
+            }
+            if (is_edge)
+            {
+                pedge_sql->bind_int(bind_pos++, after);
+            }
+            child_pedge->sql = pedge_sql;
         }
-        if (pedge_sql->execute() == soar_module::row)
+        if (epmem_pedge_next(child_pedge))
         {
-            thisAgent->memoryManager->allocate_with_pool(MP_epmem_pedge, &child_pedge);
-            child_pedge->triple = triple;
-            child_pedge->value_is_id = literal->value_is_id;
-            child_pedge->sql = pedge_sql;
             new(&(child_pedge->literals)) epmem_literal_set();
             child_pedge->literals.insert(literal);
-            child_pedge->time = child_pedge->sql->column_int(2);
             pedge_pq.push(child_pedge);
             (*pedge_cache)[triple] = child_pedge;
             return true;
         }
         else
         {
-            pedge_sql->get_pool()->release(pedge_sql);
+            thisAgent->memoryManager->free_with_pool(MP_epmem_pedge, child_pedge);
             return false;
         }
     }
@@ -4523,6 +5283,11 @@ void epmem_process_query(agent* thisAgent, Symbol* state, Symbol* pos_query, Sym
         {
             after = EPMEM_MEMID_NONE;
         }
+        // nothing below the retention floor is kept
+        if (thisAgent->EpMem->epmem_stats->retention_floor->get_value() > (after + 1))
+        {
+            after = (thisAgent->EpMem->epmem_stats->retention_floor->get_value() - 1);
+        }
         epmem_time_id current_episode = before;
         epmem_time_id next_episode;
 
@@ -4541,6 +5306,9 @@ void epmem_process_query(agent* thisAgent, Symbol* state, Symbol* pos_query, Sym
             root_pedge->sql->prepare();
             root_pedge->sql->bind_int(1, LLONG_MAX);
             root_pedge->sql->execute(soar_module::op_reinit);
+            root_pedge->cursor = NULL;
+            root_pedge->edge_id = 0;
+            root_pedge->value_id = EPMEM_NODEID_ROOT;
             root_pedge->time = LLONG_MAX;
             pedge_pq.push(root_pedge);
             pedge_caches[EPMEM_RIT_STATE_EDGE][triple] = root_pedge;
@@ -4563,6 +5331,7 @@ void epmem_process_query(agent* thisAgent, Symbol* state, Symbol* pos_query, Sym
             root_interval->sql->prepare();
             root_interval->sql->bind_int(1, before);
             root_interval->sql->execute(soar_module::op_reinit);
+            root_interval->indexed = false;
             root_interval->time = before;
             interval_pq.push(root_interval);
             interval_cleanup.insert(root_interval);
@@ -4591,7 +5360,7 @@ void epmem_process_query(agent* thisAgent, Symbol* state, Symbol* pos_query, Sym
                 epmem_pedge* pedge = pedge_pq.top();
                 pedge_pq.pop();
                 epmem_triple triple = pedge->triple;
-                triple.child_n_id = pedge->sql->column_int(1);
+                triple.child_n_id = pedge->value_id;
 
                 if (QUERY_DEBUG >= 1)
                 {
@@ -4631,71 +5400,72 @@ void epmem_process_query(agent* thisAgent, Symbol* state, Symbol* pos_query, Sym
                     uedge->activated = false;
                     // create interval queries for this partial edge
                     bool created = false;
-                    int64_t edge_id = pedge->sql->column_int(0);
+                    int64_t edge_id = pedge->edge_id;
                     for (int interval_type = EPMEM_RANGE_EP; interval_type <= EPMEM_RANGE_POINT; interval_type++)
                     {
                         for (int point_type = EPMEM_RANGE_START; point_type <= EPMEM_RANGE_END; point_type++)
                         {
-                            // pick a timer (any timer)
-                            soar_module::timer* sql_timer = NULL;
-                            switch (interval_type)
+                            epmem_interval* interval;
+                            thisAgent->memoryManager->allocate_with_pool(MP_epmem_interval, &interval);
+                            interval->is_end_point = point_type;
+                            interval->uedge = uedge;
+                            interval->sql = NULL;
+                            interval->indexed = false;
+                            if (thisAgent->EpMem->epmem_index)
                             {
-                                case EPMEM_RANGE_EP:
-                                    if (point_type == EPMEM_RANGE_START)
-                                    {
-                                        sql_timer = thisAgent->EpMem->epmem_timers->query_sql_start_ep;
-                                    }
-                                    else
-                                    {
-                                        sql_timer = thisAgent->EpMem->epmem_timers->query_sql_end_ep;
-                                    }
-                                    break;
-                                case EPMEM_RANGE_NOW:
-                                    if (point_type == EPMEM_RANGE_START)
-                                    {
-                                        sql_timer = thisAgent->EpMem->epmem_timers->query_sql_start_now;
-                                    }
-                                    else
-                                    {
-                                        sql_timer = thisAgent->EpMem->epmem_timers->query_sql_end_now;
-                                    }
-                                    break;
-                                case EPMEM_RANGE_POINT:
-                                    if (point_type == EPMEM_RANGE_START)
-                                    {
-                                        sql_timer = thisAgent->EpMem->epmem_timers->query_sql_start_point;
-                                    }
-                                    else
-                                    {
-                                        sql_timer = thisAgent->EpMem->epmem_timers->query_sql_end_point;
-                                    }
-                                    break;
+                                interval->indexed = thisAgent->EpMem->epmem_index->find_intervals(interval->cursor, pedge->value_is_id, point_type, interval_type, edge_id, current_episode, interval->time);
                             }
-                            // create the SQL query and bind it
-                            // try to find an existing query first; if none exist, allocate a new one from the memory pools
-                            soar_module::pooled_sqlite_statement* interval_sql = NULL;
-                            interval_sql = thisAgent->EpMem->epmem_stmts_graph->pool_find_interval_queries[pedge->value_is_id][point_type][interval_type]->request(sql_timer);
-                            int bind_pos = 1;
-                            if (point_type == EPMEM_RANGE_END && interval_type == EPMEM_RANGE_NOW)
+                            else
                             {
-                                interval_sql->bind_int(bind_pos++, current_episode);
+                                // pick a timer (any timer)
+                                soar_module::timer* sql_timer = NULL;
+                                switch (interval_type)
+                                {
+                                    case EPMEM_RANGE_EP:
+                                        if (point_type == EPMEM_RANGE_START)
+                                        {
+                                            sql_timer = thisAgent->EpMem->epmem_timers->query_sql_start_ep;
+                                        }
+                                        else
+                                        {
+                                            sql_timer = thisAgent->EpMem->epmem_timers->query_sql_end_ep;
+                                        }
+                                        break;
+                                    case EPMEM_RANGE_NOW:
+                                        if (point_type == EPMEM_RANGE_START)
+                                        {
+                                            sql_timer = thisAgent->EpMem->epmem_timers->query_sql_start_now;
+                                        }
+                                        else
+                                        {
+                                            sql_timer = thisAgent->EpMem->epmem_timers->query_sql_end_now;
+                                        }
+                                        break;
+                                    case EPMEM_RANGE_POINT:
+                                        if (point_type == EPMEM_RANGE_START)
+                                        {
+                                            sql_timer = thisAgent->EpMem->epmem_timers->query_sql_start_point;
+                                        }
+                                        else
+                                        {
+                                            sql_timer = thisAgent->EpMem->epmem_timers->query_sql_end_point;
+                                        }
+                                        break;
+                                }
+                                // create the SQL query and bind it
+                                // try to find an existing query first; if none exist, allocate a new one from the memory pools
+                                interval->sql = thisAgent->EpMem->epmem_stmts_graph->pool_find_interval_queries[pedge->value_is_id][point_type][interval_type]->request(sql_timer);
+                                int bind_pos = 1;
+                                if (point_type == EPMEM_RANGE_END && interval_type == EPMEM_RANGE_NOW)
+                                {
+                                    interval->sql->bind_int(bind_pos++, current_episode);
+                                }
+                                interval->sql->bind_int(bind_pos++, edge_id);
+                                interval->sql->bind_int(bind_pos++, current_episode);
+                                epmem_interval_next(thisAgent, interval);
                             }
-                            interval_sql->bind_int(bind_pos++, edge_id);
-                            interval_sql->bind_int(bind_pos++, current_episode);
-                            if (interval_sql->execute() == soar_module::row)
+                            if (interval->indexed || interval->sql)
                             {
-                                epmem_interval* interval;
-                                thisAgent->memoryManager->allocate_with_pool(MP_epmem_interval, &interval);
-                                interval->is_end_point = point_type;
-                                interval->uedge = uedge;
-                                // If it's an start point of a range (ie. not a point) and it's before the promo time
-                                // (this is possible if a the promotion is in the middle of a range)
-                                // trim it to the promo time.
-                                // This will only happen if the LTI is promoted in the last interval it appeared in
-                                // (since otherwise the start point would not be before its promotion).
-                                // We don't care about the remaining results of the query
-                                interval->time = interval_sql->column_int(0);
-                                interval->sql = interval_sql;
                                 interval_pq.push(interval);
                                 interval_cleanup.insert(interval);
                                 uedge->intervals++;
@@ -4703,7 +5473,7 @@ void epmem_process_query(agent* thisAgent, Symbol* state, Symbol* pos_query, Sym
                             }
                             else
                             {
-                                interval_sql->get_pool()->release(interval_sql);
+                                thisAgent->memoryManager->free_with_pool(MP_epmem_interval, interval);
                             }
                         }
                     }
@@ -4734,16 +5504,10 @@ void epmem_process_query(agent* thisAgent, Symbol* state, Symbol* pos_query, Sym
 
                 // put the partial edge query back into the queue if there's more
                 // otherwise, reinitialize the query and put it in a pool
-                if (pedge->sql && pedge->sql->execute() == soar_module::row)
+                if (epmem_pedge_next(pedge))
                 {
-                    pedge->time = pedge->sql->column_int(2);
                     pedge_pq.push(pedge);
                 }
-                else if (pedge->sql)
-                {
-                    pedge->sql->get_pool()->release(pedge->sql);
-                    pedge->sql = NULL;
-                }
             }
             next_edge = (pedge_pq.empty() ? after : pedge_pq.top()->time);
             thisAgent->EpMem->epmem_timers->query_walk_edge->stop();
@@ -4799,15 +5563,12 @@ void epmem_process_query(agent* thisAgent, Symbol* state, Symbol* pos_query, Sym
                     }
                     // put the interval query back into the queue if there's more and some literal cares
                     // otherwise, reinitialize the query and put it in a pool
-                    if (interval->sql && interval->sql->execute() == soar_module::row)
+                    if (epmem_interval_next(thisAgent, interval))
                     {
-                        interval->time = interval->sql->column_int(0);
                         interval_pq.push(interval);
                     }
-                    else if (interval->sql)
+                    else
                     {
-                        interval->sql->get_pool()->release(interval->sql);
-                        interval->sql = NULL;
                         uedge->intervals--;
                         if (uedge->intervals)
                         {
@@ -5028,6 +5789,7 @@ void epmem_process_query(agent* thisAgent, Symbol* state, Symbol* pos_query, Sym
             {
                 pedge->sql->get_pool()->release(pedge->sql);
             }
+            delete pedge->cursor;
             pedge->literals.~epmem_literal_set();
             thisAgent->memoryManager->free_with_pool(MP_epmem_pedge, pedge);
         }
@@ -5074,6 +5836,7 @@ inline std::string _epmem_print_sti(epmem_node_id id)
 void epmem_print_episode(agent* thisAgent, epmem_time_id memory_id, std::string* buf)
 {
     epmem_attach(thisAgent);
+    epmem_wait_for_storage(thisAgent);
 
     // if bad memory, bail
     buf->clear();
@@ -5204,6 +5967,7 @@ void epmem_print_episode(agent* thisAgent, epmem_time_id memory_id, std::string*
 void epmem_visualize_episode(agent* thisAgent, epmem_time_id memory_id, std::string* buf)
 {
     epmem_attach(thisAgent);
+    epmem_wait_for_storage(thisAgent);
 
     // if bad memory, bail
     buf->clear();
@@ -5789,6 +6553,25 @@ void epmem_respond_to_cmd(agent* thisAgent)
             // process command
             if (good_cue)
             {
+                // wait only for the episodes this command can see
+                std::unique_lock<std::mutex> db_lock;
+                if (thisAgent->EpMem->epmem_writer)
+                {
+                    if (path == 1)
+                    {
+                        thisAgent->EpMem->epmem_writer->wait_for(retrieve);
+                    }
+                    else if (path == 2)
+                    {
+                        thisAgent->EpMem->epmem_writer->wait_for((next) ? (state->id->epmem_info->last_memory + 1) : (state->id->epmem_info->last_memory));
+                    }
+                    else
+                    {
+                        thisAgent->EpMem->epmem_writer->wait_for_all();
+                    }
+                    db_lock = std::unique_lock<std::mutex>(thisAgent->EpMem->epmem_writer->db_mutex);
+                }
+
                 thisAgent->explanationBasedChunker->clear_symbol_identity_map();
 
                 // retrieve
@@ -5926,7 +6709,19 @@ void epmem_go(agent* thisAgent, bool allow_store)
         epmem_consider_new_episode(thisAgent);
     }
     epmem_respond_to_cmd(thisAgent);
+    epmem_expire_episodes(thisAgent);
 
+    // commit the current group of episodes
+    soar_module::sqlite_group_commit* group_commit = thisAgent->EpMem->epmem_group_commit;
+    if (group_commit && group_commit->due(thisAgent->d_cycle_count))
+    {
+        std::unique_lock<std::mutex> db_lock;
+        if (thisAgent->EpMem->epmem_writer)
+        {
+            db_lock = std::unique_lock<std::mutex>(thisAgent->EpMem->epmem_writer->db_mutex);
+        }
+        group_commit->commit(thisAgent->d_cycle_count);
+    }
 
     thisAgent->EpMem->epmem_timers->total->stop();
 
@@ -5938,6 +6733,8 @@ bool epmem_backup_db(agent* thisAgent, const char* file_name, std::string* err)
 
     if (thisAgent->EpMem->epmem_db->get_status() == soar_module::connected)
     {
+        epmem_wait_for_storage(thisAgent);
+
         if (thisAgent->EpMem->epmem_params->lazy_commit->get_value() == on)
         {
             thisAgent->EpMem->epmem_stmts_common->commit->execute(soar_module::op_reinit);
@@ -5996,6 +6793,13 @@ EpMem_Manager::EpMem_Manager(agent* myAgent)
 
      epmem_validation = 0;
 
+    epmem_writer = NULL;
+    epmem_batch = NULL;
+    epmem_group_commit = NULL;
+    epmem_index = NULL;
+
+    epmem_retention_step = epmem_retention_idle;
+
 };
 
 void EpMem_Manager::clean_up_for_agent_deletion()
@@ -17,12 +17,17 @@
 
 #include "soar_module.h"
 #include "soar_db.h"
+#include "epmem_interval_index.h"
 
 #include <map>
 #include <list>
 #include <stack>
 #include <set>
 #include <queue>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 //////////////////////////////////////////////////////////
 // EpMem Parameters
@@ -44,7 +49,7 @@ class epmem_param_container: public soar_module::param_container
 
         // performance
         enum page_choices { page_1k, page_2k, page_4k, page_8k, page_16k, page_32k, page_64k };
-        enum opt_choices { opt_safety, opt_speed };
+        enum opt_choices { opt_safety, opt_speed, opt_wal };
 
         // experimental
         enum gm_ordering_choices { gm_order_undefined, gm_order_dfs, gm_order_mcv };
@@ -66,6 +71,13 @@ class epmem_param_container: public soar_module::param_container
         epmem_path_param* path;
         soar_module::boolean_param* lazy_commit;
         soar_module::boolean_param* append_db;
+        soar_module::boolean_param* storage_thread;
+        soar_module::integer_param* commit_interval;
+        soar_module::integer_param* commit_interval_ms;
+        soar_module::boolean_param* checkpoint_thread;
+        soar_module::boolean_param* interval_index;
+        soar_module::integer_param* retention;
+        soar_module::integer_param* retention_batch;
 
         // retrieval
         soar_module::boolean_param* graph_match;
@@ -116,6 +128,7 @@ typedef soar_module::primitive_stat<epmem_node_id> epmem_node_id_stat;
 class epmem_db_lib_version_stat;
 class epmem_mem_usage_stat;
 class epmem_mem_high_stat;
+class epmem_group_commit_stat;
 
 class epmem_stat_container: public soar_module::stat_container
 {
@@ -124,6 +137,8 @@ class epmem_stat_container: public soar_module::stat_container
         epmem_db_lib_version_stat* db_lib_version;
         epmem_mem_usage_stat* mem_usage;
         epmem_mem_high_stat* mem_high;
+        epmem_group_commit_stat* commits;
+        epmem_group_commit_stat* checkpoints;
         soar_module::integer_stat* ncbr;
         soar_module::integer_stat* cbr;
         soar_module::integer_stat* nexts;
@@ -137,6 +152,7 @@ class epmem_stat_container: public soar_module::stat_container
         soar_module::integer_stat* qry_lits;
 
         epmem_node_id_stat* next_id;
+        epmem_time_id_stat* retention_floor;
 
         soar_module::integer_stat* rit_offset_1;
         soar_module::integer_stat* rit_left_root_1;
@@ -187,6 +203,19 @@ class epmem_mem_high_stat: public soar_module::integer_stat
         int64_t get_value();
 };
 
+//
+
+class epmem_group_commit_stat: public soar_module::integer_stat
+{
+    protected:
+        agent* thisAgent;
+        bool count_checkpoints;
+
+    public:
+        epmem_group_commit_stat(agent* new_agent, const char* new_name, bool new_count_checkpoints, soar_module::predicate<int64_t>* new_prot_pred);
+        int64_t get_value();
+};
+
 
 //////////////////////////////////////////////////////////
 // EpMem Timers
@@ -334,6 +363,17 @@ class epmem_graph_statement_container: public soar_module::sqlite_statement_cont
 
         //
 
+        soar_module::sqlite_statement* prune_find_episodes;
+        soar_module::sqlite_statement* prune_delete_episode;
+        soar_module::sqlite_statement* prune_find_points[2];
+        soar_module::sqlite_statement* prune_delete_point[2];
+        soar_module::sqlite_statement* prune_find_now[2];
+        soar_module::sqlite_statement* prune_update_now[2];
+        soar_module::sqlite_statement* prune_find_ranges[2];
+        soar_module::sqlite_statement* prune_delete_range[2];
+
+        //
+
         soar_module::sqlite_statement_pool* pool_find_edge_queries[2][2];
         soar_module::sqlite_statement_pool* pool_find_interval_queries[2][2][3];
 //        soar_module::sqlite_statement_pool* pool_find_lti_queries[2][3];
@@ -452,6 +492,60 @@ typedef struct epmem_edge_struct
 
 } epmem_edge;
 
+//////////////////////////////////////////////////////////
+// Background Storage
+//////////////////////////////////////////////////////////
+
+// one deferred write: a storage statement and the integer
+// values to bind to it
+typedef struct epmem_storage_op_struct
+{
+    soar_module::sqlite_statement* stmt;
+    int64_t args[5];
+    int num_args;
+} epmem_storage_op;
+
+// all of the deferred writes for a single episode
+typedef struct epmem_storage_batch_struct
+{
+    epmem_time_id time;
+    std::vector<epmem_storage_op> ops;
+} epmem_storage_batch;
+
+/* Applies episode batches to the database on its own thread, in the order
+ * they were submitted.  Anything on the agent thread that touches the
+ * database while the writer is running must hold db_mutex; the writer
+ * holds it for the duration of each batch, so a reader always sees the
+ * database as of some whole episode. */
+class epmem_storage_writer
+{
+    public:
+        epmem_storage_writer(soar_module::sqlite_statement* new_begin, soar_module::sqlite_statement* new_commit, bool new_own_transactions);
+        ~epmem_storage_writer();
+
+        void submit(epmem_storage_batch* batch);
+        void wait_for(epmem_time_id through);
+        void wait_for_all();
+
+        std::mutex db_mutex;
+
+    private:
+        void run();
+
+        soar_module::sqlite_statement* begin;
+        soar_module::sqlite_statement* commit;
+        bool own_transactions;
+
+        std::mutex queue_mutex;
+        std::condition_variable work_ready;
+        std::condition_variable work_done;
+        std::deque<epmem_storage_batch*> pending;
+        epmem_time_id written;
+        bool stopping;
+
+        std::thread worker;
+};
+
 //////////////////////////////////////////////////////////
 // Parameter Functions (see cpp for comments)
 //////////////////////////////////////////////////////////
@@ -471,6 +565,7 @@ extern void epmem_reinit(agent* thisAgent);
 extern void epmem_reinit_cmd(agent* thisAgent);
 
 extern void epmem_clear_transient_structures(agent* thisAgent);
+extern void epmem_wait_for_storage(agent* thisAgent);
 
 // perform epmem actions
 extern void epmem_go(agent* thisAgent, bool allow_store = true);
@@ -570,6 +665,9 @@ struct epmem_pedge_struct
     int value_is_id;
     epmem_literal_set literals;
     soar_module::pooled_sqlite_statement* sql;
+    epmem_edge_cursor* cursor;
+    epmem_node_id edge_id;
+    epmem_node_id value_id;
     epmem_time_id time;
 };
 
@@ -588,6 +686,8 @@ struct epmem_interval_struct
     epmem_uedge* uedge;
     int is_end_point;
     soar_module::pooled_sqlite_statement* sql;
+    epmem_interval_cursor cursor;
+    bool indexed;
     epmem_time_id time;
 };
 
@@ -629,6 +729,24 @@ struct epmem_interval_comparator
 
 typedef std::priority_queue<epmem_interval*, std::vector<epmem_interval*>, epmem_interval_comparator> epmem_interval_pq;
 
+//////////////////////////////////////////////////////////
+// Retention
+//////////////////////////////////////////////////////////
+
+// the tables an expiry pass works through, in order
+enum epmem_retention_phase
+{
+    epmem_retention_idle,
+    epmem_retention_episodes,
+    epmem_retention_constant_points,
+    epmem_retention_identifier_points,
+    epmem_retention_constant_now,
+    epmem_retention_identifier_now,
+    epmem_retention_constant_ranges,
+    epmem_retention_identifier_ranges,
+    epmem_retention_vacuum
+};
+
 class EpMem_Manager
 {
     public:
@@ -663,6 +781,15 @@ class EpMem_Manager
 
         epmem_rit_state epmem_rit_state_graph[2];
 
+        epmem_storage_writer* epmem_writer;
+        epmem_storage_batch* epmem_batch;
+
+        soar_module::sqlite_group_commit* epmem_group_commit;
+
+        epmem_interval_index* epmem_index;
+
+        epmem_retention_phase epmem_retention_step;
+
         uint64_t epmem_validation;
 
     private:
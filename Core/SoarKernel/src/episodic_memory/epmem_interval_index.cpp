@@ -0,0 +1,476 @@
+#include "epmem_interval_index.h"
+
+#include "constants.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <fstream>
+
+// identifies the file format; bump the version if the layout changes
+#define EPMEM_INDEX_MAGIC "EPMEMIDX"
+#define EPMEM_INDEX_VERSION 2
+
+void epmem_interval_index::clear()
+{
+    for (int i = EPMEM_RIT_STATE_NODE; i <= EPMEM_RIT_STATE_EDGE; i++)
+    {
+        entries[i].clear();
+        lookup[i].clear();
+    }
+}
+
+epmem_index_entry& epmem_interval_index::get_entry(int value_is_id, epmem_node_id edge_id)
+{
+    std::vector<epmem_index_entry>& my_entries = entries[value_is_id];
+    if (static_cast<uint64_t>(edge_id) > my_entries.size())
+    {
+        epmem_index_entry blank;
+        blank.parent_n_id = EPMEM_NODEID_BAD;
+        blank.attribute_s_id = EPMEM_NODEID_BAD;
+        blank.value_id = EPMEM_NODEID_BAD;
+        blank.last_episode_id = EPMEM_MEMID_NONE;
+        my_entries.resize(static_cast<size_t>(edge_id), blank);
+    }
+    return my_entries[static_cast<size_t>(edge_id - 1)];
+}
+
+void epmem_interval_index::add_edge(int value_is_id, epmem_node_id edge_id, epmem_node_id parent_n_id, epmem_node_id attribute_s_id, epmem_node_id value_id, epmem_time_id last_episode_id)
+{
+    epmem_index_entry& entry = get_entry(value_is_id, edge_id);
+    entry.parent_n_id = parent_n_id;
+    entry.attribute_s_id = attribute_s_id;
+    entry.value_id = value_id;
+    entry.last_episode_id = last_episode_id;
+    lookup[value_is_id][edge_key(parent_n_id, attribute_s_id, value_id)] = edge_id;
+}
+
+void epmem_interval_index::set_last_episode(epmem_node_id edge_id, epmem_time_id last_episode_id)
+{
+    get_entry(EPMEM_RIT_STATE_EDGE, edge_id).last_episode_id = last_episode_id;
+}
+
+void epmem_interval_index::add_now(int value_is_id, epmem_node_id edge_id, epmem_time_id start)
+{
+    std::vector<epmem_time_id>& now = get_entry(value_is_id, edge_id).now;
+    now.insert(std::upper_bound(now.begin(), now.end(), start), start);
+}
+
+void epmem_interval_index::remove_now(int value_is_id, epmem_node_id edge_id)
+{
+    get_entry(value_is_id, edge_id).now.clear();
+}
+
+void epmem_interval_index::add_point(int value_is_id, epmem_node_id edge_id, epmem_time_id episode)
+{
+    std::vector<epmem_time_id>& points = get_entry(value_is_id, edge_id).points;
+    points.insert(std::upper_bound(points.begin(), points.end(), episode), episode);
+}
+
+static bool epmem_index_range_start_less(const epmem_index_range& a, const epmem_index_range& b)
+{
+    return (a.start < b.start);
+}
+
+void epmem_interval_index::add_range(int value_is_id, epmem_node_id edge_id, epmem_time_id start, epmem_time_id end)
+{
+    std::vector<epmem_index_range>& ranges = get_entry(value_is_id, edge_id).ranges;
+    epmem_index_range range = { start, end };
+    ranges.insert(std::upper_bound(ranges.begin(), ranges.end(), range, epmem_index_range_start_less), range);
+}
+
+/* --- Mirrors what epmem_init_db does to the tables when a database is
+ *     reopened: every open interval is closed at time_last. --- */
+void epmem_interval_index::close_now(epmem_time_id time_last)
+{
+    for (int i = EPMEM_RIT_STATE_NODE; i <= EPMEM_RIT_STATE_EDGE; i++)
+    {
+        for (size_t j = 0; j < entries[i].size(); j++)
+        {
+            epmem_index_entry& entry = entries[i][j];
+            if (entry.now.empty())
+            {
+                continue;
+            }
+            for (std::vector<epmem_time_id>::iterator p = entry.now.begin(); p != entry.now.end(); p++)
+            {
+                if ((*p) == time_last)
+                {
+                    add_point(i, static_cast<epmem_node_id>(j + 1), time_last);
+                }
+                else
+                {
+                    add_range(i, static_cast<epmem_node_id>(j + 1), (*p), time_last);
+                }
+            }
+            entry.now.clear();
+            if (i == EPMEM_RIT_STATE_EDGE)
+            {
+                entry.last_episode_id = time_last;
+            }
+        }
+    }
+}
+
+/* --- Mirrors what retention does to an edge's rows: points and ranges
+ *     before the cutoff are dropped, and intervals that only start
+ *     before it are clipped to start at it. --- */
+void epmem_interval_index::truncate(int value_is_id, epmem_node_id edge_id, epmem_time_id cutoff)
+{
+    if (static_cast<uint64_t>(edge_id) > entries[value_is_id].size())
+    {
+        return;
+    }
+    epmem_index_entry& entry = entries[value_is_id][static_cast<size_t>(edge_id - 1)];
+
+    for (std::vector<epmem_time_id>::iterator p = entry.now.begin(); p != entry.now.end() && (*p) < cutoff; p++)
+    {
+        (*p) = cutoff;
+    }
+
+    entry.points.erase(entry.points.begin(), std::lower_bound(entry.points.begin(), entry.points.end(), cutoff));
+
+    // ranges don't overlap, so their ends are in order too
+    std::vector<epmem_index_range>::iterator r = entry.ranges.begin();
+    while ((r != entry.ranges.end()) && (r->end < cutoff))
+    {
+        r++;
+    }
+    entry.ranges.erase(entry.ranges.begin(), r);
+    if (!entry.ranges.empty() && (entry.ranges.front().start < cutoff))
+    {
+        if (entry.ranges.front().end == cutoff)
+        {
+            entry.ranges.erase(entry.ranges.begin());
+            add_point(value_is_id, edge_id, cutoff);
+        }
+        else
+        {
+            entry.ranges.front().start = cutoff;
+        }
+    }
+}
+
+/* --- Rows of pool_find_edge_queries[value_is_id][has_value]: constants
+ *     are always current (time LLONG_MAX) and come out in value order;
+ *     identifiers are limited to those last seen after "after" and come
+ *     out most recent first. --- */
+epmem_edge_cursor* epmem_interval_index::find_edges(int value_is_id, epmem_node_id parent_n_id, epmem_node_id attribute_s_id, epmem_node_id value_id, epmem_time_id after) const
+{
+    epmem_edge_cursor* cursor = new epmem_edge_cursor;
+    const std::map<edge_key, epmem_node_id>& my_lookup = lookup[value_is_id];
+    std::map<edge_key, epmem_node_id>::const_iterator p, p_end;
+
+    if (value_id != EPMEM_NODEID_BAD)
+    {
+        p = my_lookup.find(edge_key(parent_n_id, attribute_s_id, value_id));
+        p_end = p;
+        if (p != my_lookup.end())
+        {
+            p_end++;
+        }
+    }
+    else
+    {
+        p = my_lookup.lower_bound(edge_key(parent_n_id, attribute_s_id, EPMEM_NODEID_BAD));
+        p_end = my_lookup.lower_bound(edge_key(parent_n_id, attribute_s_id + 1, EPMEM_NODEID_BAD));
+    }
+
+    for (; p != p_end; p++)
+    {
+        epmem_index_edge_row row;
+        row.edge_id = p->second;
+        row.value_id = std::get<2>(p->first);
+        if (value_is_id)
+        {
+            row.time = entries[value_is_id][static_cast<size_t>(row.edge_id - 1)].last_episode_id;
+            if (row.time <= after)
+            {
+                continue;
+            }
+        }
+        else
+        {
+            row.time = LLONG_MAX;
+        }
+        cursor->rows.push_back(row);
+    }
+
+    if (value_is_id && (cursor->rows.size() > 1))
+    {
+        std::sort(cursor->rows.begin(), cursor->rows.end(), [](const epmem_index_edge_row& a, const epmem_index_edge_row& b)
+        {
+            return (a.time != b.time) ? (a.time > b.time) : (a.edge_id > b.edge_id);
+        });
+    }
+
+    return cursor;
+}
+
+/* --- Rows of pool_find_interval_queries[value_is_id][point_type][interval_type]
+ *     for one edge, bounded above by "bound" (the current episode of the
+ *     walk).  As in the SQL, start points are reported one episode early
+ *     and the end of an open interval is the bound itself. --- */
+bool epmem_interval_index::find_intervals(epmem_interval_cursor& cursor, int value_is_id, int point_type, int interval_type, epmem_node_id edge_id, epmem_time_id bound, epmem_time_id& time) const
+{
+    cursor.value_is_id = value_is_id;
+    cursor.point_type = point_type;
+    cursor.interval_type = interval_type;
+    cursor.edge_id = edge_id;
+    cursor.bound = bound;
+    cursor.pos = 0;
+
+    if ((edge_id < 1) || (static_cast<uint64_t>(edge_id) > entries[value_is_id].size()))
+    {
+        return false;
+    }
+
+    const epmem_index_entry& entry = entries[value_is_id][static_cast<size_t>(edge_id - 1)];
+    switch (interval_type)
+    {
+        case EPMEM_RANGE_EP:
+        {
+            epmem_index_range range = { bound, bound };
+            cursor.pos = std::upper_bound(entry.ranges.begin(), entry.ranges.end(), range, epmem_index_range_start_less) - entry.ranges.begin();
+            break;
+        }
+        case EPMEM_RANGE_NOW:
+            cursor.pos = std::upper_bound(entry.now.begin(), entry.now.end(), bound) - entry.now.begin();
+            break;
+        case EPMEM_RANGE_POINT:
+            cursor.pos = std::upper_bound(entry.points.begin(), entry.points.end(), bound) - entry.points.begin();
+            break;
+    }
+
+    return next_interval(cursor, time);
+}
+
+bool epmem_interval_index::next_interval(epmem_interval_cursor& cursor, epmem_time_id& time) const
+{
+    const epmem_index_entry& entry = entries[cursor.value_is_id][static_cast<size_t>(cursor.edge_id - 1)];
+    while (cursor.pos > 0)
+    {
+        cursor.pos--;
+        switch (cursor.interval_type)
+        {
+            case EPMEM_RANGE_EP:
+                if (cursor.point_type == EPMEM_RANGE_START)
+                {
+                    time = entry.ranges[cursor.pos].start - 1;
+                    return true;
+                }
+                else if (entry.ranges[cursor.pos].end > 0)
+                {
+                    time = entry.ranges[cursor.pos].end;
+                    return true;
+                }
+                break;
+            case EPMEM_RANGE_NOW:
+                time = (cursor.point_type == EPMEM_RANGE_START) ? (entry.now[cursor.pos] - 1) : cursor.bound;
+                return true;
+            case EPMEM_RANGE_POINT:
+                time = (cursor.point_type == EPMEM_RANGE_START) ? (entry.points[cursor.pos] - 1) : entry.points[cursor.pos];
+                return true;
+        }
+    }
+    return false;
+}
+
+/***************************************************************************
+ * The index file is a header (magic, version, episode clock, entry counts)
+ * followed by each entry's triple and interval arrays.  All numbers are
+ * unsigned LEB128 varints and sorted episode lists are delta-coded, which
+ * keeps most values to a single byte.
+ **************************************************************************/
+
+static void epmem_index_write(std::ostream& out, uint64_t val)
+{
+    while (val >= 0x80)
+    {
+        out.put(static_cast<char>((val & 0x7f) | 0x80));
+        val >>= 7;
+    }
+    out.put(static_cast<char>(val));
+}
+
+static bool epmem_index_read(std::istream& in, uint64_t& val)
+{
+    val = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        int c = in.get();
+        if (c == EOF)
+        {
+            return false;
+        }
+        val |= static_cast<uint64_t>(c & 0x7f) << shift;
+        if (!(c & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool epmem_interval_index::save(const std::string& file_name, epmem_time_id time, uint64_t stamp) const
+{
+    std::ofstream out(file_name.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        return false;
+    }
+
+    out.write(EPMEM_INDEX_MAGIC, 8);
+    epmem_index_write(out, EPMEM_INDEX_VERSION);
+    epmem_index_write(out, stamp);
+    epmem_index_write(out, time);
+    for (int i = EPMEM_RIT_STATE_NODE; i <= EPMEM_RIT_STATE_EDGE; i++)
+    {
+        epmem_index_write(out, entries[i].size());
+    }
+
+    for (int i = EPMEM_RIT_STATE_NODE; i <= EPMEM_RIT_STATE_EDGE; i++)
+    {
+        for (std::vector<epmem_index_entry>::const_iterator e = entries[i].begin(); e != entries[i].end(); e++)
+        {
+            // ids without a row are written with parent 0
+            epmem_index_write(out, static_cast<uint64_t>(e->parent_n_id + 1));
+            if (e->parent_n_id == EPMEM_NODEID_BAD)
+            {
+                continue;
+            }
+            epmem_index_write(out, static_cast<uint64_t>(e->attribute_s_id));
+            epmem_index_write(out, static_cast<uint64_t>(e->value_id));
+            if (i == EPMEM_RIT_STATE_EDGE)
+            {
+                epmem_index_write(out, e->last_episode_id);
+            }
+
+            epmem_time_id prev = 0;
+            epmem_index_write(out, e->now.size());
+            for (std::vector<epmem_time_id>::const_iterator p = e->now.begin(); p != e->now.end(); p++)
+            {
+                epmem_index_write(out, (*p) - prev);
+                prev = (*p);
+            }
+
+            prev = 0;
+            epmem_index_write(out, e->points.size());
+            for (std::vector<epmem_time_id>::const_iterator p = e->points.begin(); p != e->points.end(); p++)
+            {
+                epmem_index_write(out, (*p) - prev);
+                prev = (*p);
+            }
+
+            prev = 0;
+            epmem_index_write(out, e->ranges.size());
+            for (std::vector<epmem_index_range>::const_iterator r = e->ranges.begin(); r != e->ranges.end(); r++)
+            {
+                epmem_index_write(out, r->start - prev);
+                epmem_index_write(out, r->end - r->start);
+                prev = r->end;
+            }
+        }
+    }
+
+    out.close();
+    return !out.fail();
+}
+
+/* --- Replaces the contents of the index with those of the file, provided
+ *     the file carries the given (non-zero) stamp, was written at the
+ *     given episode clock and has exactly the given number of entries.
+ *     On failure the index is left empty. --- */
+bool epmem_interval_index::load(const std::string& file_name, epmem_time_id time, uint64_t stamp, uint64_t num_constants, uint64_t num_identifiers)
+{
+    clear();
+
+    std::ifstream in(file_name.c_str(), std::ios::in | std::ios::binary);
+    if (!stamp || !in)
+    {
+        return false;
+    }
+
+    char magic[8];
+    uint64_t val, count;
+    uint64_t num_entries[2] = { num_constants, num_identifiers };
+    in.read(magic, 8);
+    if (!in || std::string(magic, 8) != EPMEM_INDEX_MAGIC ||
+            !epmem_index_read(in, val) || (val != EPMEM_INDEX_VERSION) ||
+            !epmem_index_read(in, val) || (val != stamp) ||
+            !epmem_index_read(in, val) || (val != time))
+    {
+        return false;
+    }
+    for (int i = EPMEM_RIT_STATE_NODE; i <= EPMEM_RIT_STATE_EDGE; i++)
+    {
+        if (!epmem_index_read(in, val) || (val != num_entries[i]))
+        {
+            return false;
+        }
+    }
+
+    bool ok = true;
+    for (int i = EPMEM_RIT_STATE_NODE; ok && (i <= EPMEM_RIT_STATE_EDGE); i++)
+    {
+        if (num_entries[i])
+        {
+            get_entry(i, static_cast<epmem_node_id>(num_entries[i]));
+        }
+        for (uint64_t j = 0; ok && (j < num_entries[i]); j++)
+        {
+            epmem_index_entry& e = entries[i][static_cast<size_t>(j)];
+            uint64_t parent, attribute, value, last = EPMEM_MEMID_NONE;
+
+            ok = epmem_index_read(in, parent);
+            if (!ok || !parent)
+            {
+                continue;
+            }
+            ok = epmem_index_read(in, attribute) && epmem_index_read(in, value) &&
+                 ((i != EPMEM_RIT_STATE_EDGE) || epmem_index_read(in, last));
+            if (!ok)
+            {
+                break;
+            }
+            add_edge(i, static_cast<epmem_node_id>(j + 1), static_cast<epmem_node_id>(parent - 1), static_cast<epmem_node_id>(attribute), static_cast<epmem_node_id>(value), last);
+
+            epmem_time_id prev = 0;
+            ok = epmem_index_read(in, count);
+            for (uint64_t k = 0; ok && (k < count); k++)
+            {
+                ok = epmem_index_read(in, val);
+                prev += val;
+                e.now.push_back(prev);
+            }
+
+            prev = 0;
+            ok = ok && epmem_index_read(in, count);
+            for (uint64_t k = 0; ok && (k < count); k++)
+            {
+                ok = epmem_index_read(in, val);
+                prev += val;
+                e.points.push_back(prev);
+            }
+
+            prev = 0;
+            ok = ok && epmem_index_read(in, count);
+            for (uint64_t k = 0; ok && (k < count); k++)
+            {
+                epmem_index_range range;
+                ok = epmem_index_read(in, val);
+                range.start = prev + val;
+                ok = ok && epmem_index_read(in, val);
+                range.end = range.start + val;
+                prev = range.end;
+                e.ranges.push_back(range);
+            }
+        }
+    }
+
+    if (!ok)
+    {
+        clear();
+    }
+    return ok;
+}
@@ -0,0 +1,140 @@
+/*************************************************************************
+ * PLEASE SEE THE FILE "COPYING" (INCLUDED WITH THIS SOFTWARE PACKAGE)
+ * FOR LICENSE AND COPYRIGHT INFORMATION.
+ *************************************************************************/
+
+/*************************************************************************
+ *
+ *  file:  epmem_interval_index.h
+ *
+ * =======================================================================
+ *
+ * An in-memory copy of the interval data in the episodic store, used by
+ * cue-based queries in place of the SQL range scans over the
+ * epmem_wmes_*_range, _point and _now tables.
+ *
+ * Each wc_id/wi_id has an entry holding its (parent, attribute, value)
+ * triple and sorted arrays of the episodes at which it was present:
+ * open (now) intervals, single-episode points and closed ranges.  The
+ * query walk reads them through cursors that produce the same rows, in
+ * the same order, as the statements in pool_find_edge_queries and
+ * pool_find_interval_queries.
+ *
+ * The database remains the store of record.  The index is rebuilt from
+ * it when the database is opened, or read back from the compact file
+ * written next to an on-disk database when that file is current: the
+ * file carries a random stamp that is also stored in the database when
+ * it is closed, and cleared from the database as soon as it is opened
+ * again, so a database changed by any later session no longer matches.
+ *
+ * =======================================================================
+ */
+
+#ifndef EPMEM_INTERVAL_INDEX_H
+#define EPMEM_INTERVAL_INDEX_H
+
+#include "kernel.h"
+
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+typedef struct epmem_index_range_struct
+{
+    epmem_time_id start;
+    epmem_time_id end;
+} epmem_index_range;
+
+typedef struct epmem_index_entry_struct
+{
+    epmem_node_id parent_n_id;
+    epmem_node_id attribute_s_id;
+    epmem_node_id value_id;                 // value_s_id or child_n_id
+    epmem_time_id last_episode_id;          // identifiers only
+    std::vector<epmem_time_id> now;         // start episodes, ascending
+    std::vector<epmem_time_id> points;      // ascending
+    std::vector<epmem_index_range> ranges;  // ascending, non-overlapping
+} epmem_index_entry;
+
+// one row of an edge stream: (wc_id/wi_id, value, last episode)
+typedef struct epmem_index_edge_row_struct
+{
+    epmem_node_id edge_id;
+    epmem_node_id value_id;
+    epmem_time_id time;
+} epmem_index_edge_row;
+
+class epmem_edge_cursor
+{
+    public:
+        epmem_edge_cursor(): pos(0) {}
+
+        bool next(epmem_index_edge_row& row)
+        {
+            if (pos < rows.size())
+            {
+                row = rows[pos++];
+                return true;
+            }
+            return false;
+        }
+
+    private:
+        friend class epmem_interval_index;
+
+        std::vector<epmem_index_edge_row> rows;
+        size_t pos;
+};
+
+// position in one of an entry's interval arrays; rows are produced
+// from pos - 1 down to 0
+typedef struct epmem_interval_cursor_struct
+{
+    int value_is_id;
+    int point_type;
+    int interval_type;
+    epmem_node_id edge_id;
+    epmem_time_id bound;
+    size_t pos;
+} epmem_interval_cursor;
+
+class epmem_interval_index
+{
+    public:
+        epmem_interval_index() {}
+
+        void clear();
+        uint64_t size(int value_is_id) const { return entries[value_is_id].size(); }
+
+        // dictionary (epmem_wmes_constant / epmem_wmes_identifier)
+        void add_edge(int value_is_id, epmem_node_id edge_id, epmem_node_id parent_n_id, epmem_node_id attribute_s_id, epmem_node_id value_id, epmem_time_id last_episode_id);
+        void set_last_episode(epmem_node_id edge_id, epmem_time_id last_episode_id);
+
+        // intervals
+        void add_now(int value_is_id, epmem_node_id edge_id, epmem_time_id start);
+        void remove_now(int value_is_id, epmem_node_id edge_id);
+        void add_point(int value_is_id, epmem_node_id edge_id, epmem_time_id episode);
+        void add_range(int value_is_id, epmem_node_id edge_id, epmem_time_id start, epmem_time_id end);
+        void close_now(epmem_time_id time_last);
+        void truncate(int value_is_id, epmem_node_id edge_id, epmem_time_id cutoff);
+
+        // streams
+        epmem_edge_cursor* find_edges(int value_is_id, epmem_node_id parent_n_id, epmem_node_id attribute_s_id, epmem_node_id value_id, epmem_time_id after) const;
+        bool find_intervals(epmem_interval_cursor& cursor, int value_is_id, int point_type, int interval_type, epmem_node_id edge_id, epmem_time_id bound, epmem_time_id& time) const;
+        bool next_interval(epmem_interval_cursor& cursor, epmem_time_id& time) const;
+
+        // persistence
+        bool save(const std::string& file_name, epmem_time_id time, uint64_t stamp) const;
+        bool load(const std::string& file_name, epmem_time_id time, uint64_t stamp, uint64_t num_constants, uint64_t num_identifiers);
+
+    private:
+        typedef std::tuple<epmem_node_id, epmem_node_id, epmem_node_id> edge_key;
+
+        std::vector<epmem_index_entry> entries[2];
+        std::map<edge_key, epmem_node_id> lookup[2];
+
+        epmem_index_entry& get_entry(int value_is_id, epmem_node_id edge_id);
+};
+
+#endif // EPMEM_INTERVAL_INDEX_H
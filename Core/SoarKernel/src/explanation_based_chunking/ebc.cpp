@@ -231,7 +231,7 @@ Symbol* Explanation_Based_Chunker::generate_name_for_new_rule()
     new_rule_name += '-';
     new_rule_name += std::to_string(rule_number);
 
-    if (thisAgent->symbolManager->find_str_constant(new_rule_name.c_str()))
+    if (thisAgent->symbolManager->find_str_constant(new_rule_name.c_str(), new_rule_name.length()))
     {
         uint64_t dummy_counter = 2;
         return thisAgent->symbolManager->generate_new_str_constant(new_rule_name.c_str(), &dummy_counter);
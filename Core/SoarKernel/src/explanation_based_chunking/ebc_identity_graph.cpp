@@ -164,7 +164,7 @@ void Explanation_Based_Chunker::join_identities(Identity* lFromJoinSet, Identity
             lPreviouslyJoinedIdentity->joined_identity = lToJoinSet;
             if (lPreviouslyJoinedIdentity->literalized()) lToJoinSet->literalize();
         }
-        lToJoinSet->merged_identities->splice(lToJoinSet->merged_identities->begin(), (*lFromJoinSet->merged_identities));
+        soar_module::splice_all(*lToJoinSet->merged_identities, lToJoinSet->merged_identities->begin(), *lFromJoinSet->merged_identities);
         delete lFromJoinSet->merged_identities;
         lFromJoinSet->merged_identities = NULL;
     }
@@ -105,6 +105,7 @@ void Output_Manager::print_output_modes(trace_mode_info mode_info_to_print[num_t
 Output_Manager::Output_Manager()
 {
     m_defaultAgent = NIL;
+    m_thread_safe = false;
     m_params = new OM_Parameters(NULL, settings);
     m_pre_string = strdup("          ");
     m_post_string = NULL;
@@ -141,6 +142,7 @@ Output_Manager::~Output_Manager()
 
 int Output_Manager::get_printer_output_column(agent* pSoarAgent)
 {
+    output_lock lock(this);
     if (pSoarAgent)
     {
         return pSoarAgent->output_settings->printer_output_column;
@@ -153,6 +155,7 @@ int Output_Manager::get_printer_output_column(agent* pSoarAgent)
 
 void Output_Manager::set_printer_output_column(agent* thisAgent, int pOutputColumn)
 {
+    output_lock lock(this);
     if (thisAgent)
     {
         thisAgent->output_settings->printer_output_column = pOutputColumn;
@@ -165,6 +168,7 @@ void Output_Manager::set_printer_output_column(agent* thisAgent, int pOutputColu
 
 void Output_Manager::start_fresh_line(agent* pSoarAgent)
 {
+    output_lock lock(this);
     if (!pSoarAgent)
     {
         pSoarAgent = m_defaultAgent;
@@ -17,6 +17,7 @@
 
 #include <string>
 #include <list>
+#include <mutex>
 #include <stdlib.h>
 
 #define MAX_COLUMNS 10
@@ -95,6 +96,26 @@ class Output_Manager
 
         /* -- The following tracks column of the next character to print if Soar is writing to cout --*/
         int     global_printer_output_column;
+
+        bool                    m_thread_safe;
+        std::recursive_mutex    m_output_mutex;
+
+        /* Holds m_output_mutex for the life of the object, but only if thread-safe
+         * mode was on when it was created */
+        class output_lock
+        {
+            public:
+                output_lock(Output_Manager* pOM) : m_mutex(pOM->m_thread_safe ? &pOM->m_output_mutex : NULL)
+                {
+                    if (m_mutex) m_mutex->lock();
+                }
+                ~output_lock()
+                {
+                    if (m_mutex) m_mutex->unlock();
+                }
+            private:
+                std::recursive_mutex* m_mutex;
+        };
         void    update_printer_columns(agent* pSoarAgent, const char* msg);
 
         void action_to_string(agent* thisAgent, action* a, std::string &destString);
@@ -138,6 +159,12 @@ class Output_Manager
         void set_printing_to_stdout(bool pEnabled) { stdout_mode = pEnabled; };
 
         void set_default_agent(agent* pSoarAgent) { m_defaultAgent = pSoarAgent; };
+
+        /* While the run scheduler is stepping agents on several threads at once,
+         * it turns on thread-safe mode so that printing, the print format settings
+         * and the shared output column are serialized.  Like the MPM's, it costs
+         * one well-predicted branch when off. */
+        void set_thread_safe(bool pEnabled) { m_thread_safe = pEnabled; }
         void clear_default_agent() { m_defaultAgent = NULL; }
         agent* get_default_agent() { return m_defaultAgent; }
 
@@ -181,6 +208,7 @@ class Output_Manager
 
         void set_print_indents(const char* pPre = NULL, const char* pPost = NULL)
         {
+            output_lock lock(this);
             if (pPre) {
                 if (m_pre_string) free(m_pre_string);
                 if (strlen(pPre) > 0) {
@@ -206,17 +234,20 @@ class Output_Manager
 
         void set_print_test_format(bool pActual, bool pPrintIdentity)
         {
+            output_lock lock(this);
             m_print_actual_effective = pActual;
             m_print_identity_effective = pPrintIdentity;
         }
         void clear_print_test_format()
         {
+            output_lock lock(this);
             m_print_actual_effective = m_print_actual;
             m_print_identity_effective = m_print_identity;
         }
         void clear_print_indents() { set_print_indents(); }
 
         void set_column_indent(int pColumnIndex, int pColumnNum) {
+            output_lock lock(this);
             if (pColumnIndex >= MAX_COLUMNS) return;
             m_column_indent[pColumnIndex] = pColumnNum; }
 
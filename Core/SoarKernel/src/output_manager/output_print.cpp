@@ -40,6 +40,7 @@ void Output_Manager::printa_sf(agent* pSoarAgent, const char* format, ...)
 }
 void Output_Manager::printa(agent* pSoarAgent, const char* msg)
 {
+    output_lock lock(this);
     if (pSoarAgent)
     {
 //        xml_generate_message(pSoarAgent, const_cast<char*>(msg));
@@ -243,6 +244,7 @@ void Output_Manager::debug_print_header(TraceMode mode, Print_Header_Type whichH
 
 void Output_Manager::buffer_start_fresh_line(agent* thisAgent, std::string &destString)
 {
+    output_lock lock(this);
     if (!thisAgent)
     {
         std::cout << std::endl;
@@ -265,6 +267,7 @@ void Output_Manager::buffer_start_fresh_line(agent* thisAgent, std::string &dest
 
 void Output_Manager::vsnprint_sf(agent* thisAgent, std::string &destString, const char* format, va_list pargs)
 {
+    output_lock lock(this);
     Symbol* sym;
     test t, ct;
     char ch = 0;
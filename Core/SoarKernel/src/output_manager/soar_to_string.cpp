@@ -24,6 +24,7 @@
 #include "rhs.h"
 #include "soar_instance.h"
 #include "symbol_manager.h"
+#include "symbol_table.h"
 #include "symbol.h"
 #include "test.h"
 #include "working_memory.h"
@@ -47,6 +48,7 @@ bool Output_Manager::wme_to_string(agent* thisAgent, wme* w, std::string &destSt
 
 void Output_Manager::WM_to_string(agent* thisAgent, std::string &destString)
 {
+    output_lock lock(this);
     destString += "--------------------------- WMEs --------------------------\n";
     for (wme* w = m_defaultAgent->all_wmes_in_rete; w != NIL; w = w->rete_next)
     {
@@ -208,6 +210,7 @@ void Output_Manager::test_to_string(test t, std::string &destString, bool show_e
 
 void Output_Manager::condition_cons_to_string(agent* thisAgent, cons* c, std::string &destString)
 {
+    output_lock lock(this);
     while (c)
     {
         sprinta_sf(thisAgent, destString, "%s: %l\n", m_pre_string, static_cast<condition_struct*>(c->first));
@@ -218,6 +221,7 @@ void Output_Manager::condition_cons_to_string(agent* thisAgent, cons* c, std::st
 
 void Output_Manager::condition_to_string(agent* thisAgent, condition* cond, std::string &destString)
 {
+    output_lock lock(this);
     if (cond->type != CONJUNCTIVE_NEGATION_CONDITION)
     {
         if (m_print_actual_effective)
@@ -244,6 +248,7 @@ void Output_Manager::condition_to_string(agent* thisAgent, condition* cond, std:
 
 void Output_Manager::condition_list_to_string(agent* thisAgent, condition* top_cond, std::string &destString)
 {
+    output_lock lock(this);
 
     condition* cond;
     int64_t count = 0;
@@ -270,6 +275,7 @@ void Output_Manager::rhs_value_to_cstring(rhs_value rv, char* dest, size_t dest_
 
 void Output_Manager::rhs_value_to_string(rhs_value rv, std::string &destString, bool rereadable, struct token_struct* tok, wme* w, bool pEmptyStringForNullIdentity)
 {
+    output_lock lock(this);
     rhs_symbol rsym = NIL;
     Symbol* sym = NIL;
     cons* c;
@@ -379,6 +385,7 @@ void Output_Manager::rhs_value_to_string(rhs_value rv, std::string &destString,
 
 void Output_Manager::action_to_string(agent* thisAgent, action* a, std::string &destString)
 {
+    output_lock lock(this);
     if (a->type == FUNCALL_ACTION)
     {
         if (m_pre_string) destString += m_pre_string;
@@ -432,6 +439,7 @@ void Output_Manager::identity_to_string(agent* thisAgent, uint64_t pID, const Id
 
 void Output_Manager::pref_to_string(agent* thisAgent, preference* pref, std::string &destString)
 {
+    output_lock lock(this);
     if (m_print_actual_effective)
     {
         sprinta_sf(thisAgent, destString, "(%y ^%y %y) %c", pref->id, pref->attr, pref->value, preference_to_char(pref->type));
@@ -477,6 +485,7 @@ void Output_Manager::pref_to_string(agent* thisAgent, preference* pref, std::str
 
 void Output_Manager::preflist_inst_to_string(agent* thisAgent, preference* top_pref, std::string &destString)
 {
+    output_lock lock(this);
     for (preference* pref = top_pref; pref != NIL;)
     {
         sprinta_sf(thisAgent, destString, "%s%p\n", m_pre_string, pref);
@@ -486,6 +495,7 @@ void Output_Manager::preflist_inst_to_string(agent* thisAgent, preference* top_p
 
 void Output_Manager::preflist_result_to_string(agent* thisAgent, preference* top_pref, std::string &destString)
 {
+    output_lock lock(this);
     for (preference* pref = top_pref; pref != NIL;)
     {
         sprinta_sf(thisAgent, destString, "%s%p\n", m_pre_string, pref);
@@ -495,6 +505,7 @@ void Output_Manager::preflist_result_to_string(agent* thisAgent, preference* top
 
 void Output_Manager::cond_prefs_to_string(agent* thisAgent, condition* top_cond, preference* top_pref, std::string &destString)
 {
+    output_lock lock(this);
     if (m_print_actual)
     {
         if (m_print_identity)
@@ -525,6 +536,7 @@ void Output_Manager::cond_prefs_to_string(agent* thisAgent, condition* top_cond,
 
 void Output_Manager::cond_results_to_string(agent* thisAgent, condition* top_cond, preference* top_pref, std::string &destString)
 {
+    output_lock lock(this);
     if (m_print_actual)
     {
         if (m_print_identity)
@@ -555,6 +567,7 @@ void Output_Manager::cond_results_to_string(agent* thisAgent, condition* top_con
 
 void Output_Manager::cond_actions_to_string(agent* thisAgent, condition* top_cond, action* top_action, std::string &destString)
 {
+    output_lock lock(this);
     if (m_print_actual)
     {
         if (m_print_identity)
@@ -583,6 +596,7 @@ void Output_Manager::cond_actions_to_string(agent* thisAgent, condition* top_con
 
 void Output_Manager::instantiation_to_string(agent* thisAgent, instantiation* inst, std::string &destString)
 {
+    output_lock lock(this);
     sprinta_sf(thisAgent, destString, "%sInstantiation (i %u) matched %y in state %y (level %d)\n",
         m_pre_string, inst->i_id, inst->prod_name, inst->match_goal, inst->match_goal_level);
     cond_prefs_to_string(thisAgent, inst->top_of_instantiated_conditions, inst->preferences_generated, destString);
@@ -820,7 +834,7 @@ void Output_Manager::print_identifiers(TraceMode mode)
     if (!m_defaultAgent) return;
 
     print("--- Identifiers: ---\n");
-    do_for_all_items_in_hash_table(m_defaultAgent, m_defaultAgent->symbolManager->identifier_hash_table, om_print_sym, &mode);
+    m_defaultAgent->symbolManager->identifier_hash_table->do_for_all_items(om_print_sym, &mode);
 }
 
 void Output_Manager::print_variables(TraceMode mode)
@@ -830,7 +844,7 @@ void Output_Manager::print_variables(TraceMode mode)
     if (!m_defaultAgent) return;
 
     print("--- Variables: ---\n");
-    do_for_all_items_in_hash_table(m_defaultAgent, m_defaultAgent->symbolManager->variable_hash_table, om_print_sym, &mode);
+    m_defaultAgent->symbolManager->variable_hash_table->do_for_all_items(om_print_sym, &mode);
 }
 
 
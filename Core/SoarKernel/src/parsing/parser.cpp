@@ -300,7 +300,7 @@ Symbol* make_symbol_for_lexeme(agent* thisAgent, Lexeme* lexeme, bool allow_lti)
     {
         case STR_CONSTANT_LEXEME:
         {
-            newSymbol = thisAgent->symbolManager->make_str_constant(lexeme->string());
+            newSymbol = thisAgent->symbolManager->make_str_constant(lexeme->string(), lexeme->length());
             return newSymbol;
         }
         case VARIABLE_LEXEME:
@@ -2265,7 +2265,7 @@ production* parse_production(agent* thisAgent, const char* prod_string, unsigned
         thisAgent->outputManager->printa_sf(thisAgent,  "Expected symbol for production name\n");
         return NIL;
     }
-    name = thisAgent->symbolManager->make_str_constant(lexer.current_lexeme.string());
+    name = thisAgent->symbolManager->make_str_constant(lexer.current_lexeme.string(), lexer.current_lexeme.length());
     if (!lexer.get_lexeme())
     {
         abort_parse_production(thisAgent, name);
@@ -588,8 +588,8 @@ Symbol* rl_build_template_instantiation(agent* thisAgent, instantiation* my_temp
             to_string(new_id, temp_id);
             new_name = ("rl*" + empty_string + my_template->name->sc->name + "*" + temp_id);
         }
-        while (thisAgent->symbolManager->find_str_constant(new_name.c_str()) != NIL);
-        new_name_symbol = thisAgent->symbolManager->make_str_constant(new_name.c_str());
+        while (thisAgent->symbolManager->find_str_constant(new_name.c_str(), new_name.length()) != NIL);
+        new_name_symbol = thisAgent->symbolManager->make_str_constant(new_name.c_str(), new_name.length());
 
         copy_condition_list(thisAgent, my_template_instance->top_of_instantiated_conditions, &cond_top, &cond_bottom, false, false, true);
 
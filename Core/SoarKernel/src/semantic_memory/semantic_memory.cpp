@@ -96,6 +96,21 @@ void SMem_Manager::go(bool store_only)
 
     respond_to_cmd(store_only);
 
+    // without lazy commit, changes are committed as they are made, so
+    // cached activation changes are written back every cycle
+    if (settings->lazy_commit->get_value() == off)
+    {
+        flush_lti_cache();
+    }
+
+    // commit the current group of changes
+    if (group_commit && group_commit->due(thisAgent->d_cycle_count))
+    {
+        flush_lti_cache();
+        store_globals_in_db();
+        group_commit->commit(thisAgent->d_cycle_count);
+    }
+
 #else // SMEM_EXPERIMENT
 
 #endif // SMEM_EXPERIMENT
@@ -719,6 +734,13 @@ SMem_Manager::SMem_Manager(agent* myAgent)
     timers = new smem_timer_container(thisAgent);
 
     DB = new soar_module::sqlite_database();
+    group_commit = NULL;
+    lti_cache = new smem_lti_cache();
+    lti_graph = new smem_lti_graph();
+    import_state = NULL;
+    base_pow_decay = 0.0;
+    base_level_inhibition = false;
+    base_level_epoch = 0;
 
     smem_validation = 0;
 
@@ -744,6 +766,8 @@ void SMem_Manager::clean_up_for_agent_deletion()
     delete statistics;
     delete timers;
     delete DB;
+    delete lti_cache;
+    delete lti_graph;
     delete smem_in_wmem;
     delete smem_wmas;
     delete smem_spreaded_to;
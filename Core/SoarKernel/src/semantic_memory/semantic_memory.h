@@ -17,6 +17,8 @@
 
 #include "stl_typedefs.h"
 #include "smem_structs.h"
+#include "smem_graph.h"
+#include "smem_lti_cache.h"
 #include "smem_settings.h"
 #include "smem_stats.h"
 
@@ -33,6 +35,8 @@ class SMem_Manager
         friend smem_db_lib_version_stat;
         friend smem_mem_usage_stat;
         friend smem_mem_high_stat;
+        friend smem_overlay_size_stat;
+        friend smem_group_commit_stat;
         friend smem_timer_level_predicate;
         friend smem_db_predicate<int64_t>;
         friend smem_db_predicate<smem_param_container::page_choices>;
@@ -66,6 +70,7 @@ class SMem_Manager
         /* Methods for smem CLI commands*/
         uint64_t    lti_exists(uint64_t pLTI_ID);
         bool        CLI_add(const char* str_to_LTMs, std::string** err_msg);
+        bool        CLI_import(const char* file_name, std::string** err_msg, std::string** result_message);
         bool        CLI_query(const char* ltms, std::string** err_msg, std::string** result_message, uint64_t number_to_retrieve);
         bool        CLI_remove(const char* ltms, std::string** err_msg, std::string** result_message, bool force = false);
 
@@ -121,6 +126,19 @@ class SMem_Manager
         smem_param_container*           settings;
         smem_stat_container*            statistics;
         soar_module::sqlite_database*   DB;
+        soar_module::sqlite_group_commit* group_commit;
+        smem_lti_cache*                 lti_cache;
+        smem_lti_graph*                 lti_graph;
+        smem_import_state*              import_state;
+
+        /* Pow cache and scratch space for base-level activation */
+        std::vector<double>             base_pow_cache;
+        double                          base_pow_decay;
+        bool                            base_level_inhibition;
+        uint64_t                        base_level_epoch;
+        std::vector<smem_lti_history>   base_level_histories;
+        std::vector<uint64_t>           base_level_pending;
+        std::vector<double>             base_level_terms;
 
         /* Temporary maps used when creating an instance of an LTM */
         id_to_sym_map                   lti_to_sti_map;
@@ -159,8 +177,31 @@ class SMem_Manager
         uint64_t        get_max_lti_id();
         double          lti_activate(uint64_t pLTI_ID, bool add_access, uint64_t num_edges = SMEM_ACT_MAX, double touches = 1, bool increment_timer = true);
         double          lti_calc_base(uint64_t pLTI_ID, int64_t time_now, uint64_t n = 0, uint64_t activations_first = 0);
+        void            lti_calc_base_batch(smem_base_level_query* queries, uint64_t count);
+        void            lti_activate_batch(const std::vector<uint64_t>& ltis);
+        double          lti_set_activation(uint64_t pLTI_ID, double new_activation, uint64_t num_edges);
+        double          clean_prohibited_access(uint64_t pLTI_ID);
+        inline double   base_pow(int64_t age);
         id_set          print_LTM(uint64_t pLTI_ID, double lti_act, std::string* return_val, std::list<uint64_t>* history = NIL);
 
+        /* Methods for per-LTI rows, read and written through the LTI cache */
+        void            get_lti_access(uint64_t pLTI_ID, double& activations_total, uint64_t& activations_last, uint64_t& activations_first);
+        void            set_lti_access(uint64_t pLTI_ID, double activations_total, uint64_t activations_last, uint64_t activations_first);
+        void            get_lti_history(uint64_t pLTI_ID, smem_lti_history& history);
+        void            push_lti_history(uint64_t pLTI_ID, int64_t time_now, double touches);
+        void            add_lti_history(uint64_t pLTI_ID, int64_t time_now, double touches);
+        void            pop_lti_history(uint64_t pLTI_ID);
+        uint64_t        get_lti_child_ct(uint64_t pLTI_ID);
+        void            set_lti_child_ct(uint64_t pLTI_ID, uint64_t child_ct);
+        void            get_lti_augmentations(uint64_t pLTI_ID, smem_cached_aug_list& augs);
+        void            invalidate_lti_augmentations(uint64_t pLTI_ID);
+        void            flush_lti_cache();
+        smem_cached_lti* cache_lti(uint64_t pLTI_ID);
+        smem_cached_lti* cache_lti_history(uint64_t pLTI_ID);
+        bool            read_lti_history(uint64_t pLTI_ID, smem_lti_history& history);
+        void            write_back_lti(smem_cached_lti* entry);
+        void            count_lti_cache_lookup(bool hit);
+
         /* Methods for retrieving an LTM structure to be installed in STM */
         void            add_triple_to_recall_buffer(symbol_triple_list& my_list, Symbol* id, Symbol* attr, Symbol* value);
         void            install_buffered_triple_list(Symbol* state, wme_set& cue_wmes, symbol_triple_list& my_list, bool meta, bool stripLTILinks = false);
@@ -180,6 +221,13 @@ class SMem_Manager
         void            STM_to_LTM(Symbol* pSTI, smem_storage_type store_type, bool pCreateNewLTM, bool pOverwriteOldLinkToLTM, tc_number tc = NIL);
         void            LTM_to_DB(uint64_t pLTI_ID, ltm_slot_map* children, bool remove_old_children, bool activate, smem_storage_type store_type = store_level);
 
+        /* Methods for bulk import */
+        void            begin_import();
+        void            end_import();
+        void            import_LTM(uint64_t pLTI_ID, ltm_slot_map* children);
+        void            import_augmentation(uint64_t pLTI_ID, smem_hash_id attr_hash, smem_hash_id value_hash, uint64_t value_lti, double edge_weight);
+        bool            import_csv(std::istream& in, std::string** err_msg);
+
         /* Methods for creating an instance of a LTM using STIs */
         uint64_t        get_current_LTI_for_iSTI(Symbol* pSTI, bool useLookupTable, bool pOverwriteOldLinkToLTM);
 
@@ -195,6 +243,10 @@ class SMem_Manager
         /* Methods for supporting spreading activation */
         void child_spread(uint64_t lti_id, std::map<uint64_t, std::list<std::pair<uint64_t,double>>*>& lti_trajectories, int depth);
         void trajectory_construction(uint64_t lti_id, std::map<uint64_t, std::list<std::pair<uint64_t, double>>*>& lti_trajectories, int depth, bool initial);
+        void update_child_edge_weights(uint64_t lti_id);
+        void graph_trajectory_construction(uint64_t lti_id, bool initial);
+        smem_graph_node load_lti_graph_row(uint64_t lti_id);
+        void invalidate_lti_graph_row(uint64_t lti_id);
         //void calc_likelihoods_for_trajectories(uint64_t lti_id);
         inline soar_module::sqlite_statement* setup_manual_web_crawl(smem_weighted_cue_element* el, uint64_t lti_id);
         //void calc_spread(std::set<uint64_t>* current_candidates, bool do_manual_crawl, smem_weighted_cue_list::iterator* cand_set=NULL);
@@ -14,81 +14,203 @@
 #include "working_memory_activation.h"
 #include "working_memory.h"
 
+// Ages below this get their (age)^-d from base_pow_cache
+#define SMEM_BASE_POW_CACHE_SIZE 65536
+
+inline double SMem_Manager::base_pow(int64_t age)
+{
+    if ((age > 0) && (age < SMEM_BASE_POW_CACHE_SIZE))
+    {
+        if (static_cast<uint64_t>(age) >= base_pow_cache.size())
+        {
+            // grown as older ages come up; zero marks a power not yet computed
+            base_pow_cache.resize(std::min<uint64_t>(std::max<uint64_t>(2 * age, 1024), SMEM_BASE_POW_CACHE_SIZE), 0.0);
+        }
+        double& cached = base_pow_cache[age];
+        if (cached == 0.0)
+        {
+            cached = pow(static_cast<double>(age), -base_pow_decay);
+        }
+        return cached;
+    }
+    return pow(static_cast<double>(age), -base_pow_decay);
+}
+
 double SMem_Manager::lti_calc_base(uint64_t pLTI_ID, int64_t time_now, uint64_t n, uint64_t activations_first)
 {
-    double sum = 0.0;
-    double d = settings->base_decay->get_value();
-    uint64_t t_k;
-    uint64_t t_n = (time_now - activations_first);
-    unsigned int available_history = 0;
+    smem_base_level_query query;
+    query.lti_id = pLTI_ID;
+    query.time_now = time_now;
+    query.n = n;
+    query.activations_first = activations_first;
 
-    if (n == 0)
-    {
-        SQL->lti_access_get->bind_int(1, pLTI_ID);
-        SQL->lti_access_get->execute();
+    lti_calc_base_batch(&query, 1);
 
-        n = SQL->lti_access_get->column_double(0);
-        activations_first = SQL->lti_access_get->column_int(2);
+    return query.activation;
+}
 
-        SQL->lti_access_get->reinitialize();
+/*
+ * Computes the base-level activation of each query from its LTI's
+ * access history.  With base-batch on, values still cached from an
+ * earlier computation with the same inputs are reused; the value decays
+ * with time_now, so only one computed for the same time can be.  The per-access terms of the rest are laid
+ * out in one flat array, so that the products vectorize, and the powers
+ * of small ages come from base_pow_cache; the sums are then taken in the
+ * same order as always, so results do not change.
+ */
+void SMem_Manager::lti_calc_base_batch(smem_base_level_query* queries, uint64_t count)
+{
+    double d = settings->base_decay->get_value();
+    bool inhibition = (settings->base_inhibition->get_value() == on);
+    bool reuse = (lti_cache->enabled() && (settings->base_batch->get_value() == on));
+
+    // cached powers and values are only good for the settings they were computed with
+    if ((d != base_pow_decay) || (inhibition != base_level_inhibition))
+    {
+        base_pow_cache.clear();
+        base_pow_decay = d;
+        base_level_inhibition = inhibition;
+        base_level_epoch++;
     }
 
-    // get all history
-    SQL->history_get->bind_int(1, pLTI_ID);
-    SQL->history_get->execute();
-    bool prohibited = false;
-    //int recent = 0;
-    int64_t recent_time = 0;
+    base_level_pending.clear();
+    base_level_histories.clear();
 
-    double small_n = 0;
+    for (uint64_t q = 0; q < count; q++)
     {
-        while (SQL->history_get->column_int(available_history) != 0)
+        smem_base_level_query& query = queries[q];
+
+        if (query.n == 0)
         {
-            available_history++;
+            double activations_total;
+            uint64_t activations_last;
+
+            get_lti_access(query.lti_id, activations_total, activations_last, query.activations_first);
+            query.n = activations_total;
         }
-        t_k = static_cast<uint64_t>(time_now - SQL->history_get->column_int(available_history - 1));
 
-        for (int i = 0; i < available_history; i++)
+        if (lti_cache->enabled())
         {
-            small_n+=SQL->history_get->column_double(i+10);
-            int64_t time_diff = (time_now - SQL->history_get->column_int(i));
-            if (i == 0 && n > 0)
+            smem_cached_lti* entry = cache_lti_history(query.lti_id);
+            if (reuse && entry->base_level_valid && (entry->base_level_epoch == base_level_epoch) && (entry->base_level_time == query.time_now) &&
+                    (entry->base_level_n == query.n) && (entry->base_level_first == query.activations_first))
             {
-                recent_time = time_diff;
+                query.activation = entry->base_level;
+                continue;
             }
-            /*if (time_diff < 3)
-            {
-                recent = time_diff;
-            }*/
-            sum += SQL->history_get->column_double(i+10)*pow(static_cast<double>(time_now - SQL->history_get->column_int(i)),
-                       static_cast<double>(-d));
+            base_level_histories.push_back(entry->history);
         }
+        else
+        {
+            base_level_histories.push_back(smem_lti_history());
+            read_lti_history(query.lti_id, base_level_histories.back());
+        }
+        base_level_pending.push_back(q);
     }
-    SQL->history_get->reinitialize();
 
-    // if available history was insufficient, approximate rest
-    if (n > small_n && available_history == SMEM_ACT_HISTORY_ENTRIES)
+    // touches * (time_now - t)^-d for every filled history slot
+    uint64_t pending = base_level_pending.size();
+    base_level_terms.assign(pending * SMEM_ACT_HISTORY_ENTRIES, 0.0);
     {
-        if (t_n != t_k)
+        double* terms = base_level_terms.data();
+        for (uint64_t p = 0; p < pending; p++)
         {
-            double apx_numerator = (static_cast<double>(n - SMEM_ACT_HISTORY_ENTRIES) * (pow(static_cast<double>(t_n), 1.0 - d) - pow(static_cast<double>(t_k), 1.0 - d)));
-            double apx_denominator = ((1.0 - d) * static_cast<double>(t_n - t_k));
-            sum += (apx_numerator / apx_denominator);
+            const smem_lti_history& history = base_level_histories[p];
+            int64_t time_now = queries[base_level_pending[p]].time_now;
+            for (int i = 0; (i < SMEM_ACT_HISTORY_ENTRIES) && (history.t[i] != 0); i++)
+            {
+                terms[(p * SMEM_ACT_HISTORY_ENTRIES) + i] = base_pow(time_now - history.t[i]);
+            }
         }
-        else
+        for (uint64_t p = 0; p < pending; p++)
         {
-            sum += (n - small_n)*pow(static_cast<double>(t_n),static_cast<double>(-d));
+            const double* touches = base_level_histories[p].touches;
+            double* row = terms + (p * SMEM_ACT_HISTORY_ENTRIES);
+            for (int i = 0; i < SMEM_ACT_HISTORY_ENTRIES; i++)
+            {
+                row[i] *= touches[i];
+            }
         }
     }
-    //return ((sum > 0) ? (log(sum/(1+sum))) : (SMEM_ACT_LOW));
-    //return (!recent ? ((sum > 0) ? (log(sum/(1+sum))) : (SMEM_ACT_LOW)) : recent-3);//doing log prob instead of log odds.//hack attempt at short-term inhibitory effects
-    double inhibition_odds = 0;
-    if (recent_time != 0 && settings->base_inhibition->get_value() == on )// && smem_in_wmem->find(pLTI_ID) != smem_in_wmem->end())
+
+    for (uint64_t p = 0; p < pending; p++)
     {
-        inhibition_odds = pow(1+pow(recent_time/10.0,-1.0),-1.0);
-        return ((sum > 0) ? (log(sum/(1+sum)) + log(inhibition_odds/(1+inhibition_odds))) : (SMEM_ACT_LOW));
+        smem_base_level_query& query = queries[base_level_pending[p]];
+        const smem_lti_history& history = base_level_histories[p];
+        const double* terms = base_level_terms.data() + (p * SMEM_ACT_HISTORY_ENTRIES);
+        int64_t time_now = query.time_now;
+        uint64_t n = query.n;
+
+        double sum = 0.0;
+        uint64_t t_k;
+        uint64_t t_n = (time_now - query.activations_first);
+        unsigned int available_history = 0;
+        int64_t recent_time = 0;
+        double small_n = 0;
+
+        // when all of the times are filled, the column-by-column scan this
+        // replaces ran on into the touch counts, which left out the
+        // approximation below unless the latest count was under one
+        bool history_overrun;
+        {
+            while (available_history < SMEM_ACT_HISTORY_ENTRIES && history.t[available_history] != 0)
+            {
+                available_history++;
+            }
+            history_overrun = ((available_history == SMEM_ACT_HISTORY_ENTRIES) && (static_cast<int64_t>(history.touches[0]) != 0));
+            t_k = static_cast<uint64_t>(time_now - ((available_history > 0) ? history.t[available_history - 1] : 0));
+
+            if (available_history > 0 && n > 0)
+            {
+                recent_time = (time_now - history.t[0]);
+            }
+            for (unsigned int i = 0; i < available_history; i++)
+            {
+                small_n += history.touches[i];
+                sum += terms[i];
+            }
+        }
+
+        // if available history was insufficient, approximate rest
+        if (n > small_n && available_history == SMEM_ACT_HISTORY_ENTRIES && !history_overrun)
+        {
+            if (t_n != t_k)
+            {
+                double apx_numerator = (static_cast<double>(n - SMEM_ACT_HISTORY_ENTRIES) * (pow(static_cast<double>(t_n), 1.0 - d) - pow(static_cast<double>(t_k), 1.0 - d)));
+                double apx_denominator = ((1.0 - d) * static_cast<double>(t_n - t_k));
+                sum += (apx_numerator / apx_denominator);
+            }
+            else
+            {
+                sum += (n - small_n)*pow(static_cast<double>(t_n),static_cast<double>(-d));
+            }
+        }
+        //return ((sum > 0) ? (log(sum/(1+sum))) : (SMEM_ACT_LOW));
+        //return (!recent ? ((sum > 0) ? (log(sum/(1+sum))) : (SMEM_ACT_LOW)) : recent-3);//doing log prob instead of log odds.//hack attempt at short-term inhibitory effects
+        if (recent_time != 0 && inhibition)// && smem_in_wmem->find(pLTI_ID) != smem_in_wmem->end())
+        {
+            double inhibition_odds = pow(1+pow(recent_time/10.0,-1.0),-1.0);
+            query.activation = ((sum > 0) ? (log(sum/(1+sum)) + log(inhibition_odds/(1+inhibition_odds))) : (SMEM_ACT_LOW));
+        }
+        else
+        {
+            query.activation = ((sum > 0) ? (log(sum/(1+sum))) : (SMEM_ACT_LOW));//doing log prob instead of log odds.
+        }
+
+        if (lti_cache->enabled())
+        {
+            smem_cached_lti* entry = lti_cache->find(query.lti_id);
+            if (entry)
+            {
+                entry->base_level_valid = true;
+                entry->base_level_epoch = base_level_epoch;
+                entry->base_level_time = query.time_now;
+                entry->base_level_n = query.n;
+                entry->base_level_first = query.activations_first;
+                entry->base_level = query.activation;
+            }
+        }
     }
-    return ((sum > 0) ? (log(sum/(1+sum))) : (SMEM_ACT_LOW));//doing log prob instead of log odds.
 }
 
 // activates a new or existing long-term identifier
@@ -109,12 +231,7 @@ double SMem_Manager::lti_activate(uint64_t pLTI_ID, bool add_access, uint64_t nu
     double prev_access_n = 0;
     uint64_t prev_access_t = 0;
     uint64_t prev_access_1 = 0;
-    SQL->lti_access_get->bind_int(1,pLTI_ID);
-    SQL->lti_access_get->execute();
-    prev_access_n = SQL->lti_access_get->column_double(0);
-    prev_access_t = SQL->lti_access_get->column_int(1);
-    prev_access_1 = SQL->lti_access_get->column_int(2);
-    SQL->lti_access_get->reinitialize();
+    get_lti_access(pLTI_ID, prev_access_n, prev_access_t, prev_access_1);
 
     if (add_access)
     {
@@ -146,12 +263,10 @@ double SMem_Manager::lti_activate(uint64_t pLTI_ID, bool add_access, uint64_t nu
             //Find the number of touches from the most recent activation and remove that much touching.
             if (dirty)
             {
-                SQL->history_get->bind_int(1,pLTI_ID);
-                SQL->history_get->execute();
-                prev_access_n-=SQL->history_get->column_double(10);
-                SQL->history_get->reinitialize();
-                SQL->history_remove->bind_int(1,pLTI_ID);
-                SQL->history_remove->execute(soar_module::op_reinit);
+                smem_lti_history history;
+                get_lti_history(pLTI_ID, history);
+                prev_access_n-=history.touches[0];
+                pop_lti_history(pLTI_ID);
             }
             SQL->prohibit_reset->bind_int(1,pLTI_ID);
             SQL->prohibit_reset->execute(soar_module::op_reinit);
@@ -162,6 +277,11 @@ double SMem_Manager::lti_activate(uint64_t pLTI_ID, bool add_access, uint64_t nu
         {
             int64_t time_diff;
 
+            // an LTI last accessed at the age of more than one threshold
+            // is only recomputed once
+            std::set< uint64_t > to_update;
+            bool flushed = false;
+
             for (std::set< int64_t >::iterator b = settings->base_incremental_threshes->set_begin(); b != settings->base_incremental_threshes->set_end(); b++)
             {
                 if (*b > 0)
@@ -170,22 +290,27 @@ double SMem_Manager::lti_activate(uint64_t pLTI_ID, bool add_access, uint64_t nu
 
                     if (time_diff > 0)
                     {
-                        std::list< uint64_t > to_update;
+                        // activations_last is read from the table
+                        if (!flushed)
+                        {
+                            flush_lti_cache();
+                            flushed = true;
+                        }
 
                         SQL->lti_get_t->bind_int(1, time_diff);
                         while (SQL->lti_get_t->execute() == soar_module::row)
                         {
-                            to_update.push_back(static_cast< uint64_t >(SQL->lti_get_t->column_int(0)));
+                            to_update.insert(static_cast< uint64_t >(SQL->lti_get_t->column_int(0)));
                         }
                         SQL->lti_get_t->reinitialize();
-
-                        for (std::list< uint64_t >::iterator it = to_update.begin(); it != to_update.end(); it++)
-                        {
-                            lti_activate((*it), false);
-                        }
                     }
                 }
             }
+
+            if (!to_update.empty())
+            {
+                lti_activate_batch(std::vector< uint64_t >(to_update.begin(), to_update.end()));
+            }
         }
         statistics->act_updates->set_value(statistics->act_updates->get_value() + 1);
     }
@@ -195,36 +320,12 @@ double SMem_Manager::lti_activate(uint64_t pLTI_ID, bool add_access, uint64_t nu
          * If we are not adding an access, we need to remove the old history so that recalculation takes into account the prohibit having occurred.
          * The big difference is that we'll have to leave it prohibited, just not dirty. Only an access removes the prohibit.
          * */
-        SQL->prohibit_check->bind_int(1,pLTI_ID);
-        prohibited = SQL->prohibit_check->execute()==soar_module::row;
-        bool dirty = false;
-        if (prohibited)
-        {
-            dirty = SQL->prohibit_check->column_int(1)==1;
-        }
-        SQL->prohibit_check->reinitialize();
-        if (prohibited && dirty)
-        {
-            //remove the touches from that prohibited access.
-            SQL->history_get->bind_int(1, pLTI_ID);
-            SQL->history_get->execute();
-            prev_access_n-=SQL->history_get->column_double(10);
-            SQL->history_get->reinitialize();
-            //And remove the history entry as well.
-            SQL->history_remove->bind_int(1,pLTI_ID);
-            SQL->history_remove->execute(soar_module::op_reinit);
-            SQL->prohibit_clean->bind_int(1,pLTI_ID);
-            SQL->prohibit_clean->execute(soar_module::op_reinit);
-        }
+        prev_access_n -= clean_prohibited_access(pLTI_ID);
         time_now = smem_max_cycle;
         statistics->act_updates->set_value(statistics->act_updates->get_value() + 1);
     }
     {//Whether or not we added an access and whether or not we had previous accesses determines what updated form we give our access history.
-        SQL->lti_access_set->bind_double(1, (prev_access_n + (add_access ? touches : 0.0)));
-        SQL->lti_access_set->bind_int(2, add_access ? time_now : prev_access_t);
-        SQL->lti_access_set->bind_int(3, prev_access_n == 0 ? (add_access ? time_now : 0) : prev_access_1);
-        SQL->lti_access_set->bind_int(4, pLTI_ID);
-        SQL->lti_access_set->execute(soar_module::op_reinit);
+        set_lti_access(pLTI_ID, (prev_access_n + (add_access ? touches : 0.0)), add_access ? time_now : prev_access_t, prev_access_n == 0 ? (add_access ? time_now : 0) : prev_access_1);
     }
 
     // get new activation value (depends upon bias)
@@ -246,17 +347,11 @@ double SMem_Manager::lti_activate(uint64_t pLTI_ID, bool add_access, uint64_t nu
             {
                 if (prohibited)
                 {
-                    SQL->history_push->bind_int(1,time_now);
-                    SQL->history_push->bind_double(2,touches);
-                    SQL->history_push->bind_int(3,pLTI_ID);
-                    SQL->history_push->execute(soar_module::op_reinit);
+                    push_lti_history(pLTI_ID, time_now, touches);
                 }
                 else
                 {
-                    SQL->history_add->bind_int(1,pLTI_ID);
-                    SQL->history_add->bind_int(2,time_now);
-                    SQL->history_add->bind_double(3,touches);
-                    SQL->history_add->execute(soar_module::op_reinit);
+                    add_lti_history(pLTI_ID, time_now, touches);
                 }
             }
             new_activation = lti_calc_base(pLTI_ID, time_now + ((add_access) ? (1) : (0)), prev_access_n + ((add_access) ? (touches) : (0)), prev_access_1);
@@ -265,24 +360,109 @@ double SMem_Manager::lti_activate(uint64_t pLTI_ID, bool add_access, uint64_t nu
         {
             if (add_access)
             {
-                SQL->history_push->bind_int(1, time_now);
-                SQL->history_push->bind_double(2, touches);
-                SQL->history_push->bind_int(3, pLTI_ID);
-                SQL->history_push->execute(soar_module::op_reinit);
+                push_lti_history(pLTI_ID, time_now, touches);
             }
 
             new_activation = lti_calc_base(pLTI_ID, time_now + ((add_access) ? (1) : (0)), prev_access_n + (add_access ? touches : 0), prev_access_1);
         }
     }
-    // get number of augmentations (if not supplied)
-    if (num_edges == SMEM_ACT_MAX)
+    double result = lti_set_activation(pLTI_ID, new_activation, num_edges);
+
+    ////////////////////////////////////////////////////////////////////////////
+    timers->act->stop();
+    ////////////////////////////////////////////////////////////////////////////
+
+    return result;
+}
+
+/*
+ * Recomputes the activation of each LTI without adding an access, as
+ * lti_activate(lti, false) would, but computes the base-level values
+ * together (see lti_calc_base_batch).  With base-batch off it just calls
+ * lti_activate for each one.
+ */
+void SMem_Manager::lti_activate_batch(const std::vector<uint64_t>& ltis)
+{
+    if ((settings->activation_mode->get_value() != smem_param_container::act_base) || (settings->base_batch->get_value() == off))
+    {
+        for (std::vector<uint64_t>::const_iterator it = ltis.begin(); it != ltis.end(); it++)
+        {
+            lti_activate((*it), false);
+        }
+        return;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    timers->act->start();
+    ////////////////////////////////////////////////////////////////////////////
+
+    std::vector<smem_base_level_query> queries(ltis.size());
+    for (uint64_t i = 0; i < ltis.size(); i++)
+    {
+        double prev_access_n = 0;
+        uint64_t prev_access_t = 0;
+        uint64_t prev_access_1 = 0;
+        get_lti_access(ltis[i], prev_access_n, prev_access_t, prev_access_1);
+
+        prev_access_n -= clean_prohibited_access(ltis[i]);
+        statistics->act_updates->set_value(statistics->act_updates->get_value() + 1);
+        set_lti_access(ltis[i], prev_access_n, prev_access_t, prev_access_n == 0 ? 0 : prev_access_1);
+
+        queries[i].lti_id = ltis[i];
+        queries[i].time_now = smem_max_cycle;
+        queries[i].n = prev_access_n;
+        queries[i].activations_first = prev_access_1;
+    }
+
+    lti_calc_base_batch(queries.data(), queries.size());
+
+    for (uint64_t i = 0; i < ltis.size(); i++)
     {
-        SQL->act_lti_child_ct_get->bind_int(1, pLTI_ID);
-        SQL->act_lti_child_ct_get->execute();
+        lti_set_activation(ltis[i], queries[i].activation, SMEM_ACT_MAX);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    timers->act->stop();
+    ////////////////////////////////////////////////////////////////////////////
+}
 
-        num_edges = SQL->act_lti_child_ct_get->column_int(0);
+// If the latest access to an LTI was prohibited since its activation was
+// last computed, drops that access from its history and returns its touches.
+double SMem_Manager::clean_prohibited_access(uint64_t pLTI_ID)
+{
+    double removed = 0.0;
 
-        SQL->act_lti_child_ct_get->reinitialize();
+    SQL->prohibit_check->bind_int(1,pLTI_ID);
+    bool prohibited = SQL->prohibit_check->execute()==soar_module::row;
+    bool dirty = false;
+    if (prohibited)
+    {
+        dirty = SQL->prohibit_check->column_int(1)==1;
+    }
+    SQL->prohibit_check->reinitialize();
+    if (prohibited && dirty)
+    {
+        //remove the touches from that prohibited access.
+        smem_lti_history history;
+        get_lti_history(pLTI_ID, history);
+        removed = history.touches[0];
+        //And remove the history entry as well.
+        pop_lti_history(pLTI_ID);
+        SQL->prohibit_clean->bind_int(1,pLTI_ID);
+        SQL->prohibit_clean->execute(soar_module::op_reinit);
+    }
+
+    return removed;
+}
+
+// Stores a newly computed activation for an LTI, combined with any spread
+// it has, and returns the combined value.
+double SMem_Manager::lti_set_activation(uint64_t pLTI_ID, double new_activation, uint64_t num_edges)
+{
+    // get number of augmentations (if not supplied)
+    if (num_edges == SMEM_ACT_MAX)
+    {
+        num_edges = get_lti_child_ct(pLTI_ID);
     }
 
     //need a denominator for spreading:
@@ -361,144 +541,148 @@ double SMem_Manager::lti_activate(uint64_t pLTI_ID, bool add_access, uint64_t nu
         //SQL->act_set->execute(soar_module::op_reinit);
     }
 
-    ////////////////////////////////////////////////////////////////////////////
-    timers->act->stop();
-    ////////////////////////////////////////////////////////////////////////////
-
     return new_base+modified_spread;
 }
 
-void SMem_Manager::child_spread(uint64_t lti_id, std::map<uint64_t, std::list<std::pair<uint64_t,double>>*>& lti_trajectories, int depth = 10)
+// Applies the edge weight updates queued by working memory activation to lti_id's children.
+void SMem_Manager::update_child_edge_weights(uint64_t lti_id)
 {
-    if (lti_trajectories.find(lti_id) == lti_trajectories.end())
-    {//If we don't already have the children and their edge weights, we need to get them.
-        soar_module::sqlite_statement* children_q = SQL->web_val_child;
-        std::list<uint64_t> children;
+    soar_module::sqlite_statement* children_q = SQL->web_val_child;
+    bool first_time = true;// The first set of weights comes from the db store.
 
-        //First, we don't bother changing edge weights unless we have changes with which to update the edge weights.
-        if (smem_edges_to_update->find(lti_id) != smem_edges_to_update->end())
-        {
-            bool first_time = true;// The first set of weights comes from the db store.
-
-            std::map<uint64_t, double> old_edge_weight_map_for_children;
-            std::map<uint64_t, double> edge_weight_update_map_for_children;
-            std::list<smem_edge_update*>* edge_updates = &(smem_edges_to_update->find(lti_id)->second);
-            uint64_t time;
-            uint64_t previous_time;
-            double total_touches = 0;
-            std::list<smem_edge_update*>::iterator edge_begin_it = edge_updates->begin();
-            std::list<smem_edge_update*>::iterator edge_it;
-            bool prohibited = false;
-            double edge_update_decay = thisAgent->SMem->settings->spreading_edge_update_factor->get_value();//.99;
-            for (edge_it = edge_begin_it; edge_it != edge_updates->end(); ++edge_it)
-            {
-                time = (*edge_it)->update_time;
-                if (time != previous_time && !first_time)
-                {//We need to compile the edge weight changes for the previous timestep before moving on to the next timestep.
-                    std::map<uint64_t,double>::iterator updates_begin = old_edge_weight_map_for_children.begin();
-                    std::map<uint64_t,double>::iterator updates_it;
-                    double normalizing_sum = 0;
-                    for (updates_it = updates_begin; updates_it != old_edge_weight_map_for_children.end(); ++updates_it)
-                    {//We are looping through the update map and inserting those updates into the old edge weight map.
-                        if (edge_weight_update_map_for_children.find(updates_it->first) == edge_weight_update_map_for_children.end())
-                        {//If we don't have an update for that edge, we just decrease it.
-                            old_edge_weight_map_for_children[updates_it->first] = pow(edge_update_decay,total_touches)*old_edge_weight_map_for_children[updates_it->first];
-                            normalizing_sum += old_edge_weight_map_for_children[updates_it->first];
-                        }
-                        else
-                        {//If we do have an update, we adjust.
-                            old_edge_weight_map_for_children[updates_it->first] = old_edge_weight_map_for_children[updates_it->first] + edge_weight_update_map_for_children[updates_it->first];
-                            normalizing_sum += old_edge_weight_map_for_children[updates_it->first];
-                        }
-                    }
-                    for (updates_it = updates_begin; updates_it != old_edge_weight_map_for_children.end(); ++updates_it)
-                    {
-                        old_edge_weight_map_for_children[updates_it->first] = old_edge_weight_map_for_children[updates_it->first]/normalizing_sum;
-                    }
-                    edge_weight_update_map_for_children.clear();
-                    total_touches = 0;
-                }
-                if (first_time)
-                {//this is where we extract the old edge weights from the database store.
-                    first_time = false;
-                    children_q->bind_int(1, lti_id);
-                    //children_q->bind_int(2, lti_id);
-                    while (children_q->execute() == soar_module::row)
-                    {
-                        /*if (settings->spreading_loop_avoidance->get_value() == on && children_q->column_int(0) == lti_id)
-                        {
-                            continue;
-                        }*///We actually do want the edge weight to a self-edge to adjust even if we don't use it.
-                        old_edge_weight_map_for_children[(uint64_t)(children_q->column_int(0))] = children_q->column_double(1);
-                        edge_weight_update_map_for_children[(uint64_t)(children_q->column_int(0))] = 0;
-                    }
-                    children_q->reinitialize();
-                }
-                uint64_t child = (*edge_it)->lti_edge_id;
-                double touches = (*edge_it)->num_touches;
-                total_touches+=touches;
-                /*SQL->prohibit_check->bind_int(1, child);
-                prohibited = SQL->prohibit_check->execute()==soar_module::row;
-                bool dirty = false;
-                if (prohibited)
-                {
-                    dirty = SQL->prohibit_check->column_int(1)==1;
-                }
-                SQL->prohibit_check->reinitialize();*/
-                //This is where the updates are actually collected for touches from working memory.
-                for (int touch_ct = 1; touch_ct <= touches; ++touch_ct)
-                {
-                    if (edge_weight_update_map_for_children.find(child) != edge_weight_update_map_for_children.end())
-                    {
-                        edge_weight_update_map_for_children[child] = edge_weight_update_map_for_children[child] + (1.0-old_edge_weight_map_for_children[child])*(1.0-edge_update_decay)*pow(edge_update_decay,touch_ct-1.0);
-                    }
-                    else
-                    {
-                        edge_weight_update_map_for_children[child] = 0.0 + (1.0 - old_edge_weight_map_for_children[child])*(1.0-edge_update_decay);
-                    }
-                }
-                previous_time = time;
-            }
-            std::map<uint64_t,double>::iterator final_updates_begin = old_edge_weight_map_for_children.begin();
-            std::map<uint64_t,double>::iterator final_updates_it;
+    std::map<uint64_t, double> old_edge_weight_map_for_children;
+    std::map<uint64_t, double> edge_weight_update_map_for_children;
+    std::list<smem_edge_update*>* edge_updates = &(smem_edges_to_update->find(lti_id)->second);
+    uint64_t time;
+    uint64_t previous_time;
+    double total_touches = 0;
+    std::list<smem_edge_update*>::iterator edge_begin_it = edge_updates->begin();
+    std::list<smem_edge_update*>::iterator edge_it;
+    bool prohibited = false;
+    double edge_update_decay = thisAgent->SMem->settings->spreading_edge_update_factor->get_value();//.99;
+    for (edge_it = edge_begin_it; edge_it != edge_updates->end(); ++edge_it)
+    {
+        time = (*edge_it)->update_time;
+        if (time != previous_time && !first_time)
+        {//We need to compile the edge weight changes for the previous timestep before moving on to the next timestep.
+            std::map<uint64_t,double>::iterator updates_begin = old_edge_weight_map_for_children.begin();
+            std::map<uint64_t,double>::iterator updates_it;
             double normalizing_sum = 0;
-            for (final_updates_it = final_updates_begin; final_updates_it != old_edge_weight_map_for_children.end(); ++final_updates_it)
+            for (updates_it = updates_begin; updates_it != old_edge_weight_map_for_children.end(); ++updates_it)
             {//We are looping through the update map and inserting those updates into the old edge weight map.
-                if (edge_weight_update_map_for_children.find(final_updates_it->first) == edge_weight_update_map_for_children.end())
+                if (edge_weight_update_map_for_children.find(updates_it->first) == edge_weight_update_map_for_children.end())
                 {//If we don't have an update for that edge, we just decrease it.
-                    old_edge_weight_map_for_children[final_updates_it->first] = pow(edge_update_decay,total_touches)*old_edge_weight_map_for_children[final_updates_it->first];
-                    normalizing_sum += old_edge_weight_map_for_children[final_updates_it->first];
+                    old_edge_weight_map_for_children[updates_it->first] = pow(edge_update_decay,total_touches)*old_edge_weight_map_for_children[updates_it->first];
+                    normalizing_sum += old_edge_weight_map_for_children[updates_it->first];
                 }
                 else
                 {//If we do have an update, we adjust.
-                    old_edge_weight_map_for_children[final_updates_it->first] = old_edge_weight_map_for_children[final_updates_it->first] + edge_weight_update_map_for_children[final_updates_it->first];
-                    normalizing_sum += old_edge_weight_map_for_children[final_updates_it->first];
+                    old_edge_weight_map_for_children[updates_it->first] = old_edge_weight_map_for_children[updates_it->first] + edge_weight_update_map_for_children[updates_it->first];
+                    normalizing_sum += old_edge_weight_map_for_children[updates_it->first];
                 }
             }
-            for (final_updates_it = final_updates_begin; final_updates_it != old_edge_weight_map_for_children.end(); ++final_updates_it)
+            for (updates_it = updates_begin; updates_it != old_edge_weight_map_for_children.end(); ++updates_it)
             {
-                old_edge_weight_map_for_children[final_updates_it->first] = old_edge_weight_map_for_children[final_updates_it->first]/normalizing_sum;
+                old_edge_weight_map_for_children[updates_it->first] = old_edge_weight_map_for_children[updates_it->first]/normalizing_sum;
             }
             edge_weight_update_map_for_children.clear();
-            //This is the point at which the final timestamp's updates should be applied and then we should write those to the db and then we should clear out the malloc'd (new) updates.
-            //We use a new sqlite command that updates an existing edge with a new value for the edge weight. We loop over all edges in the old edge weight map for children for the vals.
-            //After the loop of commits to the table, we then loop over thge original updates map attached to the agent to do the deletions (frees).
-            std::map<uint64_t,double>::iterator updates_begin = old_edge_weight_map_for_children.begin();
-            std::map<uint64_t,double>::iterator updates_it;
-            double update_sum = 0;
-            soar_module::sqlite_statement* update_edge = SQL->web_update_child_edge;
-            for (updates_it = updates_begin; updates_it != old_edge_weight_map_for_children.end(); ++updates_it)
-            {// args are edge weight, parent lti it, child lti id.
-                update_edge->bind_double(1, updates_it->second);
-                update_edge->bind_int(2, lti_id);
-                update_edge->bind_int(3, updates_it->first);
-                update_edge->execute(soar_module::op_reinit);
+            total_touches = 0;
+        }
+        if (first_time)
+        {//this is where we extract the old edge weights from the database store.
+            first_time = false;
+            children_q->bind_int(1, lti_id);
+            //children_q->bind_int(2, lti_id);
+            while (children_q->execute() == soar_module::row)
+            {
+                /*if (settings->spreading_loop_avoidance->get_value() == on && children_q->column_int(0) == lti_id)
+                {
+                    continue;
+                }*///We actually do want the edge weight to a self-edge to adjust even if we don't use it.
+                old_edge_weight_map_for_children[(uint64_t)(children_q->column_int(0))] = children_q->column_double(1);
+                edge_weight_update_map_for_children[(uint64_t)(children_q->column_int(0))] = 0;
             }
-            for (edge_it = edge_begin_it; edge_it != edge_updates->end(); ++edge_it)
+            children_q->reinitialize();
+        }
+        uint64_t child = (*edge_it)->lti_edge_id;
+        double touches = (*edge_it)->num_touches;
+        total_touches+=touches;
+        /*SQL->prohibit_check->bind_int(1, child);
+        prohibited = SQL->prohibit_check->execute()==soar_module::row;
+        bool dirty = false;
+        if (prohibited)
+        {
+            dirty = SQL->prohibit_check->column_int(1)==1;
+        }
+        SQL->prohibit_check->reinitialize();*/
+        //This is where the updates are actually collected for touches from working memory.
+        for (int touch_ct = 1; touch_ct <= touches; ++touch_ct)
+        {
+            if (edge_weight_update_map_for_children.find(child) != edge_weight_update_map_for_children.end())
+            {
+                edge_weight_update_map_for_children[child] = edge_weight_update_map_for_children[child] + (1.0-old_edge_weight_map_for_children[child])*(1.0-edge_update_decay)*pow(edge_update_decay,touch_ct-1.0);
+            }
+            else
             {
-                delete (*edge_it);
+                edge_weight_update_map_for_children[child] = 0.0 + (1.0 - old_edge_weight_map_for_children[child])*(1.0-edge_update_decay);
             }
-            smem_edges_to_update->erase(lti_id);
+        }
+        previous_time = time;
+    }
+    std::map<uint64_t,double>::iterator final_updates_begin = old_edge_weight_map_for_children.begin();
+    std::map<uint64_t,double>::iterator final_updates_it;
+    double normalizing_sum = 0;
+    for (final_updates_it = final_updates_begin; final_updates_it != old_edge_weight_map_for_children.end(); ++final_updates_it)
+    {//We are looping through the update map and inserting those updates into the old edge weight map.
+        if (edge_weight_update_map_for_children.find(final_updates_it->first) == edge_weight_update_map_for_children.end())
+        {//If we don't have an update for that edge, we just decrease it.
+            old_edge_weight_map_for_children[final_updates_it->first] = pow(edge_update_decay,total_touches)*old_edge_weight_map_for_children[final_updates_it->first];
+            normalizing_sum += old_edge_weight_map_for_children[final_updates_it->first];
+        }
+        else
+        {//If we do have an update, we adjust.
+            old_edge_weight_map_for_children[final_updates_it->first] = old_edge_weight_map_for_children[final_updates_it->first] + edge_weight_update_map_for_children[final_updates_it->first];
+            normalizing_sum += old_edge_weight_map_for_children[final_updates_it->first];
+        }
+    }
+    for (final_updates_it = final_updates_begin; final_updates_it != old_edge_weight_map_for_children.end(); ++final_updates_it)
+    {
+        old_edge_weight_map_for_children[final_updates_it->first] = old_edge_weight_map_for_children[final_updates_it->first]/normalizing_sum;
+    }
+    edge_weight_update_map_for_children.clear();
+    //This is the point at which the final timestamp's updates should be applied and then we should write those to the db and then we should clear out the malloc'd (new) updates.
+    //We use a new sqlite command that updates an existing edge with a new value for the edge weight. We loop over all edges in the old edge weight map for children for the vals.
+    //After the loop of commits to the table, we then loop over thge original updates map attached to the agent to do the deletions (frees).
+    std::map<uint64_t,double>::iterator updates_begin = old_edge_weight_map_for_children.begin();
+    std::map<uint64_t,double>::iterator updates_it;
+    double update_sum = 0;
+    soar_module::sqlite_statement* update_edge = SQL->web_update_child_edge;
+    for (updates_it = updates_begin; updates_it != old_edge_weight_map_for_children.end(); ++updates_it)
+    {// args are edge weight, parent lti it, child lti id.
+        update_edge->bind_double(1, updates_it->second);
+        update_edge->bind_int(2, lti_id);
+        update_edge->bind_int(3, updates_it->first);
+        update_edge->execute(soar_module::op_reinit);
+    }
+    for (edge_it = edge_begin_it; edge_it != edge_updates->end(); ++edge_it)
+    {
+        delete (*edge_it);
+    }
+    smem_edges_to_update->erase(lti_id);
+    invalidate_lti_graph_row(lti_id);
+}
+
+void SMem_Manager::child_spread(uint64_t lti_id, std::map<uint64_t, std::list<std::pair<uint64_t,double>>*>& lti_trajectories, int depth = 10)
+{
+    if (lti_trajectories.find(lti_id) == lti_trajectories.end())
+    {//If we don't already have the children and their edge weights, we need to get them.
+        soar_module::sqlite_statement* children_q = SQL->web_val_child;
+        std::list<uint64_t> children;
+
+        //First, we don't bother changing edge weights unless we have changes with which to update the edge weights.
+        if (smem_edges_to_update->find(lti_id) != smem_edges_to_update->end())
+        {
+            update_child_edge_weights(lti_id);
         }
         children_q->bind_int(1, lti_id);
         //children_q->bind_int(2, lti_id);
@@ -525,6 +709,11 @@ void SMem_Manager::child_spread(uint64_t lti_id, std::map<uint64_t, std::list<st
 
 void SMem_Manager::trajectory_construction(uint64_t lti_id, std::map<uint64_t, std::list<std::pair<uint64_t, double>>*>& lti_trajectories, int depth = 0, bool initial = false)
 {
+    if (settings->spreading_graph->get_value() == on)
+    {
+        graph_trajectory_construction(lti_id, initial);
+        return;
+    }
     //If this isn't the initial formation of the trajectories for this lti, we should get rid of the old trajectory
     if (!initial)
     {
@@ -1206,11 +1395,7 @@ void SMem_Manager::calc_spread(std::set<uint64_t>* current_candidates, bool do_m
                 ////////////////////////////////////////////////////////////////////////////
                 timers->spreading_7_2_6->start();
                 ////////////////////////////////////////////////////////////////////////////
-                SQL->act_lti_child_ct_get->bind_int(1, *candidate);
-                SQL->act_lti_child_ct_get->execute();
-                uint64_t num_edges = SQL->act_lti_child_ct_get->column_int(0);
-
-                SQL->act_lti_child_ct_get->reinitialize();
+                uint64_t num_edges = get_lti_child_ct(*candidate);
                 double modified_spread = (log(spread)-log(offset));
                 double new_base;
                 if (static_cast<double>(prev_base)==static_cast<double>(SMEM_ACT_LOW) || static_cast<double>(prev_base) == 0)
@@ -1310,12 +1495,7 @@ void SMem_Manager::calc_spread(std::set<uint64_t>* current_candidates, bool do_m
                 SQL->delete_commit_of_negative_fingerprint->bind_int(2,calc_current_spread->column_int(4));
                 SQL->delete_commit_of_negative_fingerprint->execute(soar_module::op_reinit);
                 spread-=raw_prob;//additional;//Now, we've adjusted the activation according to this new addition.
-                SQL->act_lti_child_ct_get->bind_int(1, *candidate);
-                SQL->act_lti_child_ct_get->execute();
-
-                uint64_t num_edges = SQL->act_lti_child_ct_get->column_int(0);
-
-                SQL->act_lti_child_ct_get->reinitialize();
+                uint64_t num_edges = get_lti_child_ct(*candidate);
                 double modified_spread = ((spread < offset) || (spread < 0)) ? (0) : (log(spread)-log(offset));
                 spread = (spread < offset) ? (0) : (spread);
                 //This is the same sort of activation updating one would have to do with base-level.
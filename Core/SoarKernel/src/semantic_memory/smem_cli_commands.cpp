@@ -79,7 +79,14 @@ bool SMem_Manager::CLI_add(const char* ltms_str, std::string** err_msg)
                     /* Third parameter determines whether smem will update LTM based on LTI_ID in an STI.
                      * For that to be useful here, parser must be changed to also accepts STIs for smem -add.
                      * May want to change to false until that is possible */
-                   LTM_to_DB((*c_new)->lti_id, (*c_new)->slots, false, false);
+                    if (import_state)
+                    {
+                        import_LTM((*c_new)->lti_id, (*c_new)->slots);
+                    }
+                    else
+                    {
+                        LTM_to_DB((*c_new)->lti_id, (*c_new)->slots, false, false);
+                    }
                 }
             }
 
@@ -9,6 +9,7 @@
 #include "smem_db.h"
 #include "smem_timers.h"
 #include "smem_settings.h"
+#include "smem_shared_store.h"
 #include "smem_stats.h"
 
 #include "agent.h"
@@ -74,20 +75,34 @@ void smem_statement_container::create_tables()
     }
 }
 
+/*
+ * The secondary indices on smem_augmentations and the frequency tables,
+ * which every insert has to maintain.  A bulk import (smem_import.cpp)
+ * drops these while loading and rebuilds them once at the end.
+ */
+const smem_bulk_index smem_bulk_indices[] =
+{
+    { "smem_augmentations_parent_attr_val_lti", "CREATE INDEX smem_augmentations_parent_attr_val_lti ON smem_augmentations (lti_id, attribute_s_id, value_constant_s_id, value_lti_id, edge_weight)" },
+    { "smem_augmentations_attr_val_lti_cycle", "CREATE INDEX smem_augmentations_attr_val_lti_cycle ON smem_augmentations (attribute_s_id, value_constant_s_id, value_lti_id, activation_value)" },
+    { "smem_augmentations_attr_cycle", "CREATE INDEX smem_augmentations_attr_cycle ON smem_augmentations (attribute_s_id, activation_value)" },
+    { "smem_wmes_constant_frequency_attr_val", "CREATE UNIQUE INDEX smem_wmes_constant_frequency_attr_val ON smem_wmes_constant_frequency (attribute_s_id, value_constant_s_id)" },
+    { "smem_ct_lti_attr_val", "CREATE UNIQUE INDEX smem_ct_lti_attr_val ON smem_wmes_lti_frequency (attribute_s_id, value_lti_id)" },
+    /* The index below is for spreading; it is used for forward spread. */
+    { "smem_augmentations_parent_val_lti", "CREATE INDEX smem_augmentations_parent_val_lti ON smem_augmentations (lti_id, value_constant_s_id, value_lti_id, edge_weight)" }
+};
+const size_t smem_num_bulk_indices = sizeof(smem_bulk_indices) / sizeof(smem_bulk_indices[0]);
+
 void smem_statement_container::create_indices()
 {
     add_structure("CREATE UNIQUE INDEX smem_symbols_int_const ON smem_symbols_integer (symbol_value)");
     add_structure("CREATE UNIQUE INDEX smem_symbols_float_const ON smem_symbols_float (symbol_value)");
     add_structure("CREATE UNIQUE INDEX smem_symbols_str_const ON smem_symbols_string (symbol_value)");
     add_structure("CREATE INDEX smem_lti_t ON smem_lti (activations_last)");
-    add_structure("CREATE INDEX smem_augmentations_parent_attr_val_lti ON smem_augmentations (lti_id, attribute_s_id, value_constant_s_id, value_lti_id, edge_weight)");
-    add_structure("CREATE INDEX smem_augmentations_attr_val_lti_cycle ON smem_augmentations (attribute_s_id, value_constant_s_id, value_lti_id, activation_value)");
-    add_structure("CREATE INDEX smem_augmentations_attr_cycle ON smem_augmentations (attribute_s_id, activation_value)");
-    add_structure("CREATE UNIQUE INDEX smem_wmes_constant_frequency_attr_val ON smem_wmes_constant_frequency (attribute_s_id, value_constant_s_id)");
-    add_structure("CREATE UNIQUE INDEX smem_ct_lti_attr_val ON smem_wmes_lti_frequency (attribute_s_id, value_lti_id)");
+    for (size_t i = 0; i < smem_num_bulk_indices; i++)
+    {
+        add_structure(smem_bulk_indices[i].definition);
+    }
     /* The indexes below are for spreading. */
-    //the index below is used for forward spread.
-    add_structure("CREATE INDEX smem_augmentations_parent_val_lti ON smem_augmentations (lti_id, value_constant_s_id, value_lti_id, edge_weight)");
     //scijones - I'm not sure, but the below index is for backwards spread, which is no longer supported.
     //add_structure("CREATE INDEX smem_augmentations_backlink ON smem_augmentations (value_lti_id, value_constant_s_id, lti_id)");
     add_structure("CREATE INDEX trajectory_lti ON smem_likelihood_trajectories (lti_id, valid_bit)");
@@ -396,6 +411,9 @@ smem_statement_container::smem_statement_container(agent* new_agent): soar_modul
     history_add = new soar_module::sqlite_statement(new_db, "INSERT INTO smem_activation_history (lti_id,t1,t2,t3,t4,t5,t6,t7,t8,t9,t10,touch1,touch2,touch3,touch4,touch5,touch6,touch7,touch8,touch9,touch10) VALUES (?,?,0,0,0,0,0,0,0,0,0,?,0,0,0,0,0,0,0,0,0)");
     add(history_add);
 
+    history_set = new soar_module::sqlite_statement(new_db, "INSERT OR REPLACE INTO smem_activation_history (lti_id,t1,t2,t3,t4,t5,t6,t7,t8,t9,t10,touch1,touch2,touch3,touch4,touch5,touch6,touch7,touch8,touch9,touch10) VALUES (?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?)");
+    add(history_set);
+
     // Adding statements needed to support prohibits.
 
     prohibit_set = new soar_module::sqlite_statement(new_db, "UPDATE smem_prohibited SET prohibited=1,dirty=1 WHERE lti_id=?");
@@ -813,7 +831,7 @@ void SMem_Manager::rhash__str(smem_hash_id hash_value, std::string& dest)
     {
         case STR_CONSTANT_SYMBOL_TYPE:
             rhash__str(hash_value, dest);
-            return_val = thisAgent->symbolManager->make_str_constant(const_cast<char*>(dest.c_str()));
+            return_val = thisAgent->symbolManager->make_str_constant(dest.c_str(), dest.length());
             break;
 
         case INT_CONSTANT_SYMBOL_TYPE:
@@ -850,6 +868,11 @@ void SMem_Manager::init_db()
         tabula_rasa = true;
         print_sysparam_trace(thisAgent, TRACE_SMEM_SYSPARAM, "Initializing semantic memory database in cpu memory.\n");
     }
+    else if (settings->database->get_value() == smem_param_container::shared)
+    {
+        db_path = settings->path->get_value();
+        print_sysparam_trace(thisAgent, TRACE_SMEM_SYSPARAM, "Initializing semantic memory over shared database at %s\n", db_path);
+    }
     else
     {
         db_path = settings->path->get_value();
@@ -857,9 +880,40 @@ void SMem_Manager::init_db()
     }
 
     // attempt connection
-    DB->connect(db_path);
+    if (settings->database->get_value() == smem_param_container::shared)
+    {
+        // the knowledge base is mapped once for every agent that shares it;
+        // this agent's changes stay in memory, so journal there as well
+        DB->connect(db_path, SQLITE_OPEN_READWRITE, smem_shared_store_vfs());
+        if (DB->get_status() == soar_module::connected)
+        {
+            DB->sql_execute("PRAGMA journal_mode = MEMORY");
+        }
+    }
+    else
+    {
+        DB->connect(db_path);
+    }
 
-    if (DB->get_status() == soar_module::problem)
+    if ((DB->get_status() == soar_module::problem) && (settings->database->get_value() == smem_param_container::shared))
+    {
+        // a knowledge base that can't be shared leaves this agent with its own
+        // memory database rather than none at all
+        std::string shared_error_message("...Error: Cannot share semantic memory knowledge base at ");
+        shared_error_message.append(db_path);
+        shared_error_message.append(": ");
+        shared_error_message.append(DB->get_errmsg());
+        shared_error_message.append(".\n");
+        if (smem_shared_store_has_wal_frames(db_path))
+        {
+            shared_error_message.append("...The knowledge base has WAL frames that are not checkpointed into it.\n"
+                                        "...Open it once with database set to file to checkpoint it.\n");
+        }
+        shared_error_message.append("...Switching to memory-based database.\n");
+        switch_to_memory_db(shared_error_message);
+        return;
+    }
+    else if (DB->get_status() == soar_module::problem)
     {
         print_sysparam_trace(thisAgent, 0, "Semantic memory database Error: %s\n", DB->get_errmsg());
     }
@@ -1050,6 +1104,20 @@ void SMem_Manager::init_db()
                 // locking_mode - no one else can view the database after our first write
                 DB->sql_execute("PRAGMA locking_mode = EXCLUSIVE");
             }
+            else if (settings->opt->get_value() == smem_param_container::opt_wal)
+            {
+                // journal_mode - write-ahead log, so a crash can only lose changes that were never committed
+                DB->sql_execute("PRAGMA journal_mode = WAL");
+
+                // synchronous - with a write-ahead log, only checkpoints need to wait for the disk
+                DB->sql_execute("PRAGMA synchronous = NORMAL");
+
+                // wal_autocheckpoint - leave checkpoints to the checkpoint thread
+                if ((settings->checkpoint_thread->get_value() == on) && (settings->database->get_value() == smem_param_container::file))
+                {
+                    DB->sql_execute("PRAGMA wal_autocheckpoint = 0");
+                }
+            }
         }
 
         // update validation count
@@ -1066,6 +1134,9 @@ void SMem_Manager::init_db()
         // initialize queries given database structure
         SQL->prepare();
 
+        // per-LTI rows are cached from here on
+        lti_cache->set_capacity(static_cast<uint64_t>(settings->lti_cache_size->get_value()));
+
         // initialize persistent variables
         if (tabula_rasa || (settings->append_db->get_value() == off))
         {
@@ -1121,6 +1192,17 @@ void SMem_Manager::init_db()
         if (settings->lazy_commit->get_value() == on)
         {
             SQL->begin->execute(soar_module::op_reinit);
+
+            // with a write-ahead log, that transaction is committed in groups instead
+            if (settings->opt->get_value() == smem_param_container::opt_wal)
+            {
+                group_commit = new soar_module::sqlite_group_commit(SQL->begin, SQL->commit, settings->commit_interval->get_value(), settings->commit_interval_ms->get_value(), thisAgent->d_cycle_count);
+
+                if ((settings->checkpoint_thread->get_value() == on) && (settings->database->get_value() == smem_param_container::file))
+                {
+                    group_commit->start_checkpointer(settings->path->get_value());
+                }
+            }
         }
     }
 
@@ -1185,8 +1267,17 @@ void SMem_Manager::close()
 {
     if (connected())
     {
+        flush_lti_cache();
+        lti_cache->clear();
+        lti_graph->clear();
         store_globals_in_db();
 
+        if (group_commit)
+        {
+            delete group_commit;
+            group_commit = NULL;
+        }
+
         // if lazy, commit
         if (settings->lazy_commit->get_value() == on)
         {
@@ -1217,6 +1308,7 @@ bool SMem_Manager::backup_db(const char* file_name, std::string* err)
 
     if (connected())
     {
+        flush_lti_cache();
         store_globals_in_db();
 
         if (settings->lazy_commit->get_value() == on)
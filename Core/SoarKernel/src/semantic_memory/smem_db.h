@@ -14,6 +14,15 @@
 #include "soar_module.h"
 #include "soar_db.h"
 
+struct smem_bulk_index
+{
+    const char* name;
+    const char* definition;
+};
+
+extern const smem_bulk_index smem_bulk_indices[];
+extern const size_t smem_num_bulk_indices;
+
 class smem_statement_container: public soar_module::sqlite_statement_container
 {
     public:
@@ -107,6 +116,7 @@ class smem_statement_container: public soar_module::sqlite_statement_container
         soar_module::sqlite_statement* history_get;
         soar_module::sqlite_statement* history_push;
         soar_module::sqlite_statement* history_add;
+        soar_module::sqlite_statement* history_set;
         soar_module::sqlite_statement* prohibit_set;
         soar_module::sqlite_statement* prohibit_add;
         soar_module::sqlite_statement* prohibit_check;
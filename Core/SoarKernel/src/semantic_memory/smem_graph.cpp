@@ -0,0 +1,306 @@
+#include "smem_graph.h"
+
+#include "semantic_memory.h"
+#include "smem_db.h"
+#include "smem_settings.h"
+#include "smem_stats.h"
+
+#include <algorithm>
+#include <queue>
+
+const uint64_t smem_lti_graph::NO_ROW;
+
+smem_graph_node smem_lti_graph::node(uint64_t lti_id)
+{
+    std::unordered_map<uint64_t, smem_graph_node>::iterator p = lti_node.find(lti_id);
+    if (p != lti_node.end())
+    {
+        return p->second;
+    }
+
+    smem_graph_node n = static_cast<smem_graph_node>(node_lti.size());
+    lti_node[lti_id] = n;
+    node_lti.push_back(lti_id);
+    row_begin.push_back(NO_ROW);
+    row_size.push_back(0);
+    spread.push_back(0.0);
+    spread_touched.push_back(false);
+    return n;
+}
+
+void smem_lti_graph::invalidate(uint64_t lti_id)
+{
+    std::unordered_map<uint64_t, smem_graph_node>::iterator p = lti_node.find(lti_id);
+    if ((p != lti_node.end()) && row_loaded(p->second))
+    {
+        live_edges -= row_size[p->second];
+        row_begin[p->second] = NO_ROW;
+        row_size[p->second] = 0;
+    }
+}
+
+void smem_lti_graph::begin_row(smem_graph_node n)
+{
+    if (row_loaded(n))
+    {
+        live_edges -= row_size[n];
+    }
+
+    // stale rows are left behind in the edge arrays until they dominate
+    uint64_t stale_edges = edge_child.size() - live_edges;
+    if ((stale_edges > live_edges) && (stale_edges > 1024))
+    {
+        row_begin[n] = NO_ROW;
+        compact();
+    }
+
+    open_row = n;
+    row_begin[n] = edge_child.size();
+    row_size[n] = 0;
+}
+
+void smem_lti_graph::add_edge(uint64_t child_lti_id, double weight)
+{
+    // node() may grow the per-node arrays, so look the child up first
+    smem_graph_node c = node(child_lti_id);
+    edge_child.push_back(c);
+    edge_weight.push_back(weight);
+    row_size[open_row]++;
+    live_edges++;
+}
+
+void smem_lti_graph::compact()
+{
+    std::vector<smem_graph_node> new_child;
+    std::vector<double> new_weight;
+    new_child.reserve(live_edges);
+    new_weight.reserve(live_edges);
+
+    for (smem_graph_node n = 0; n < node_lti.size(); n++)
+    {
+        if (row_loaded(n))
+        {
+            uint64_t old_begin = row_begin[n];
+            row_begin[n] = new_child.size();
+            new_child.insert(new_child.end(), edge_child.begin() + old_begin, edge_child.begin() + old_begin + row_size[n]);
+            new_weight.insert(new_weight.end(), edge_weight.begin() + old_begin, edge_weight.begin() + old_begin + row_size[n]);
+        }
+    }
+
+    edge_child.swap(new_child);
+    edge_weight.swap(new_weight);
+}
+
+void smem_lti_graph::add_spread(smem_graph_node n, double amount)
+{
+    if (spread_touched[n])
+    {
+        spread[n] += amount;
+    }
+    else
+    {
+        spread_touched[n] = true;
+        spread[n] = amount;
+        spread_recipients.push_back(n);
+    }
+}
+
+void smem_lti_graph::take_spread(std::vector<std::pair<uint64_t, double>>& recipients)
+{
+    recipients.clear();
+    recipients.reserve(spread_recipients.size());
+    for (std::vector<smem_graph_node>::iterator r = spread_recipients.begin(); r != spread_recipients.end(); r++)
+    {
+        recipients.push_back(std::make_pair(node_lti[*r], spread[*r]));
+        spread_touched[*r] = false;
+        spread[*r] = 0.0;
+    }
+    spread_recipients.clear();
+
+    // same order as the std::map the SQL traversal accumulates into
+    std::sort(recipients.begin(), recipients.end());
+}
+
+void smem_lti_graph::clear()
+{
+    lti_node.clear();
+    node_lti.clear();
+    row_begin.clear();
+    row_size.clear();
+    edge_child.clear();
+    edge_weight.clear();
+    live_edges = 0;
+    spread.clear();
+    spread_touched.clear();
+    spread_recipients.clear();
+}
+
+//////////////////////////////////////////////////////////
+// SMem_Manager spreading over the graph
+//////////////////////////////////////////////////////////
+
+smem_graph_node SMem_Manager::load_lti_graph_row(uint64_t lti_id)
+{
+    // pending edge weight updates rewrite the row first
+    if (smem_edges_to_update->find(lti_id) != smem_edges_to_update->end())
+    {
+        update_child_edge_weights(lti_id);
+    }
+
+    smem_graph_node n = lti_graph->node(lti_id);
+    if (!lti_graph->row_loaded(n))
+    {
+        soar_module::sqlite_statement* children_q = SQL->web_val_child;
+
+        lti_graph->begin_row(n);
+        children_q->bind_int(1, lti_id);
+        while (children_q->execute() == soar_module::row)
+        {
+            lti_graph->add_edge(static_cast<uint64_t>(children_q->column_int(0)), children_q->column_double(1));
+        }
+        children_q->reinitialize();
+    }
+
+    return n;
+}
+
+void SMem_Manager::invalidate_lti_graph_row(uint64_t lti_id)
+{
+    lti_graph->invalidate(lti_id);
+}
+
+/*
+ * Computes the same trajectories and spread as trajectory_construction,
+ * visiting paths in the same order, but reads children from the graph and
+ * keeps each path as a back-pointer into a flat array rather than copying
+ * a list per step.
+ */
+void SMem_Manager::graph_trajectory_construction(uint64_t lti_id, bool initial)
+{
+    if (!initial)
+    {
+        SQL->trajectory_remove_lti->bind_int(1, lti_id);
+        SQL->trajectory_remove_lti->execute(soar_module::op_reinit);
+    }
+
+    struct path_step
+    {
+        smem_graph_node node;
+        double          weight;
+        uint64_t        prev;
+        uint64_t        length;
+    };
+    const uint64_t no_prev = static_cast<uint64_t>(-1);
+
+    uint64_t depth_limit = settings->spreading_depth_limit->get_value();
+    uint64_t limit = settings->spreading_limit->get_value();
+    double decay_prob = settings->spreading_continue_probability->get_value();
+    double baseline_prob = settings->spreading_baseline->get_value();
+    bool loop_avoidance = (settings->spreading_loop_avoidance->get_value() == on);
+
+    std::vector<path_step> paths;
+    std::vector<uint64_t> path_ltis;
+    paths.reserve(limit + 1);
+
+    // ordered on activation alone, like smem_prioritized_lti_traversal_queue,
+    // so that ties are broken the same way
+    typedef std::pair<double, uint64_t> queued_path;
+    struct compare_queued_path
+    {
+        bool operator()(const queued_path& a, const queued_path& b) const { return (b.first > a.first); }
+    };
+    std::priority_queue<queued_path, std::vector<queued_path>, compare_queued_path> traversal_queue;
+
+    path_step source = { lti_graph->node(lti_id), 1.0, no_prev, 1 };
+    paths.push_back(source);
+    traversal_queue.emplace(1.0, 0);
+
+    uint64_t count = 0;
+    bool ever_added = false;
+    while (!traversal_queue.empty() && count < limit)
+    {
+        uint64_t current = traversal_queue.top().second;
+        smem_graph_node current_node = load_lti_graph_row(lti_graph->lti(paths[current].node));
+        double initial_activation = decay_prob * traversal_queue.top().first;
+        traversal_queue.pop();
+
+        uint64_t e_end = lti_graph->row_end(current_node);
+        for (uint64_t e = lti_graph->row_start(current_node); e != e_end && count < limit && initial_activation > baseline_prob; ++e)
+        {
+            smem_graph_node child = lti_graph->child(e);
+            double weight = lti_graph->weight(e);
+            uint64_t child_lti = lti_graph->lti(child);
+
+            bool good_lti = !(child_lti == 0 || weight < baseline_prob);
+            if (loop_avoidance)
+            {
+                // as in trajectory_construction, a step is a repeat if the same
+                // (lti, edge weight) pair is already on the path
+                good_lti = true;
+                for (uint64_t p = current; p != no_prev; p = paths[p].prev)
+                {
+                    if (paths[p].node == child && paths[p].weight == weight)
+                    {
+                        good_lti = false;
+                        break;
+                    }
+                }
+            }
+            statistics->trajectories_total->set_value(statistics->trajectories_total->get_value() + 1);
+            if (!good_lti)
+            {
+                continue;
+            }
+
+            lti_graph->add_spread(child, initial_activation * weight);
+
+            path_step step = { child, weight, current, paths[current].length + 1 };
+            uint64_t added = paths.size();
+            paths.push_back(step);
+
+            // record the path, source first, padded with zeros
+            path_ltis.clear();
+            for (uint64_t p = added; p != no_prev; p = paths[p].prev)
+            {
+                path_ltis.push_back(lti_graph->lti(paths[p].node));
+            }
+            int depth = 0;
+            for (std::vector<uint64_t>::reverse_iterator l = path_ltis.rbegin(); l != path_ltis.rend() && depth < static_cast<int>(depth_limit + 2); ++l)
+            {
+                SQL->trajectory_add->bind_int(++depth, *l);
+            }
+            while (depth < 11)
+            {
+                SQL->trajectory_add->bind_int(++depth, 0);
+            }
+            SQL->trajectory_add->execute(soar_module::op_reinit);
+
+            ever_added = true;
+            ++count;
+            if (step.length < depth_limit + 1 && count < limit && decay_prob * initial_activation * weight > baseline_prob)
+            {
+                traversal_queue.emplace(initial_activation * weight, added);
+            }
+        }
+    }
+
+    std::vector<std::pair<uint64_t, double>> recipients;
+    lti_graph->take_spread(recipients);
+    for (std::vector<std::pair<uint64_t, double>>::iterator r = recipients.begin(); r != recipients.end(); ++r)
+    {
+        SQL->likelihood_cond_count_insert->bind_int(1, lti_id);
+        SQL->likelihood_cond_count_insert->bind_int(2, r->first);
+        SQL->likelihood_cond_count_insert->bind_double(3, r->second);
+        SQL->likelihood_cond_count_insert->execute(soar_module::op_reinit);
+    }
+
+    if (!ever_added)
+    {
+        SQL->trajectory_add->bind_int(1, lti_id);
+        for (int i = 2; i <= 11; i++)
+        {
+            SQL->trajectory_add->bind_int(i, 0);
+        }
+        SQL->trajectory_add->execute(soar_module::op_reinit);
+    }
+}
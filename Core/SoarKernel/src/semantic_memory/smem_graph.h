@@ -0,0 +1,96 @@
+/*************************************************************************
+ * PLEASE SEE THE FILE "COPYING" (INCLUDED WITH THIS SOFTWARE PACKAGE)
+ * FOR LICENSE AND COPYRIGHT INFORMATION.
+ *************************************************************************/
+
+/*************************************************************************
+ *
+ *  file:  smem_graph.h
+ *
+ * =======================================================================
+ *
+ * An in-memory copy of the LTI-to-LTI edges of semantic memory (the
+ * rows web_val_child returns), used by spreading activation in place of
+ * one SQL query per expanded LTI per source.
+ *
+ * LTIs are mapped to dense node indices as they are first seen, and the
+ * edges are kept in compressed sparse row form: each node's children and
+ * edge weights are contiguous, in the order web_val_child returns them.
+ * Rows are loaded lazily.  When LTM_to_DB, disconnect_ltm or an edge
+ * weight update rewrites an LTI's edges, its row is marked stale and is
+ * read again (and appended to the end of the edge arrays) on next use;
+ * the arrays are compacted once stale edges outnumber live ones.
+ *
+ * The graph also holds a sparse accumulator, indexed by node, in which
+ * the spreading kernel sums the spread each recipient gets from a source.
+ *
+ * =======================================================================
+ */
+
+#ifndef SMEM_GRAPH_H
+#define SMEM_GRAPH_H
+
+#include "kernel.h"
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+typedef uint32_t smem_graph_node;
+
+class smem_lti_graph
+{
+    public:
+        smem_lti_graph(): live_edges(0) {}
+
+        // node index of an LTI, assigned on first use
+        smem_graph_node node(uint64_t lti_id);
+        uint64_t lti(smem_graph_node n) const { return node_lti[n]; }
+
+        uint64_t num_nodes() const { return node_lti.size(); }
+        uint64_t num_edges() const { return live_edges; }
+
+        // rows
+        bool row_loaded(smem_graph_node n) const { return (row_begin[n] != NO_ROW); }
+        void invalidate(uint64_t lti_id);
+        void begin_row(smem_graph_node n);
+        void add_edge(uint64_t child_lti_id, double weight);
+
+        // edges of a loaded row are [row_start(n), row_end(n))
+        uint64_t row_start(smem_graph_node n) const { return row_begin[n]; }
+        uint64_t row_end(smem_graph_node n) const { return row_begin[n] + row_size[n]; }
+        smem_graph_node child(uint64_t e) const { return edge_child[e]; }
+        double weight(uint64_t e) const { return edge_weight[e]; }
+
+        // sparse accumulator
+        void add_spread(smem_graph_node n, double amount);
+        void take_spread(std::vector<std::pair<uint64_t, double>>& recipients);
+
+        void clear();
+
+    private:
+        static const uint64_t NO_ROW = static_cast<uint64_t>(-1);
+
+        void compact();
+
+        std::unordered_map<uint64_t, smem_graph_node> lti_node;
+        std::vector<uint64_t>           node_lti;
+
+        // per node
+        std::vector<uint64_t>           row_begin;
+        std::vector<uint32_t>           row_size;
+
+        // per edge
+        std::vector<smem_graph_node>    edge_child;
+        std::vector<double>             edge_weight;
+        uint64_t                        live_edges;
+
+        // row being filled by add_edge
+        smem_graph_node                 open_row;
+
+        std::vector<double>             spread;
+        std::vector<bool>               spread_touched;
+        std::vector<smem_graph_node>    spread_recipients;
+};
+
+#endif // SMEM_GRAPH_H
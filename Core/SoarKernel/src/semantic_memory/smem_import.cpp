@@ -0,0 +1,419 @@
+/*
+ * smem_import.cpp
+ *
+ * Bulk loading of semantic memory from a file (smem --import).
+ *
+ * LTM_to_DB keeps augmentation counts, fan edge weights, the frequency
+ * tables and every index up to date as each LTM is stored, which is what
+ * makes loading a large knowledge base through smem --add slow.  An import
+ * instead drops the secondary indices, appends augmentations in large
+ * transactions and then rebuilds everything derived from
+ * smem_augmentations once, at the end.
+ */
+#include "semantic_memory.h"
+#include "smem_db.h"
+#include "smem_settings.h"
+#include "smem_stats.h"
+
+#include "agent.h"
+#include "misc.h"
+#include "output_manager.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+// augmentations inserted per transaction
+#define SMEM_IMPORT_BATCH_SIZE 100000
+
+bool SMem_Manager::CLI_import(const char* file_name, std::string** err_msg, std::string** result_message)
+{
+    // imported augmentations do not invalidate spreading trajectories
+    if (settings->spreading->get_value() == on)
+    {
+        (*err_msg)->append("Cannot import while spreading is on.  Use smem --add instead.");
+        return false;
+    }
+
+    std::ifstream in(file_name, std::ios::in | std::ios::binary);
+    if (!in)
+    {
+        (*err_msg)->append("Could not open file ");
+        (*err_msg)->append(file_name);
+        return false;
+    }
+
+    attach();
+    begin_import();
+
+    bool return_val;
+    std::string name(file_name);
+    if ((name.size() > 4) && (name.compare(name.size() - 4, 4, ".csv") == 0))
+    {
+        return_val = import_csv(in, err_msg);
+    }
+    else
+    {
+        std::stringstream contents;
+        contents << in.rdbuf();
+        std::string ltms = contents.str();
+
+        // accept the output of smem --export, which wraps the clauses in smem --add { ... }
+        size_t start = ltms.find_first_not_of(" \t\r\n");
+        if ((start != std::string::npos) && (ltms[start] != '('))
+        {
+            size_t open_brace = ltms.find('{');
+            size_t close_brace = ltms.rfind('}');
+            if ((open_brace != std::string::npos) && (close_brace != std::string::npos) && (open_brace < close_brace))
+            {
+                ltms = ltms.substr(open_brace + 1, close_brace - open_brace - 1);
+            }
+        }
+
+        // CLI_add hands each parsed LTM to import_LTM while an import is open
+        return_val = CLI_add(ltms.c_str(), err_msg);
+    }
+
+    uint64_t augmentations = import_state->augmentations;
+    uint64_t ltis = import_state->ltis.size();
+    end_import();
+
+    std::string num;
+    (*result_message)->append("Imported ");
+    to_string(augmentations, num);
+    (*result_message)->append(num);
+    (*result_message)->append(" augmentations of ");
+    to_string(ltis, num);
+    (*result_message)->append(num);
+    (*result_message)->append(" LTIs into semantic memory.");
+
+    return return_val;
+}
+
+void SMem_Manager::begin_import()
+{
+    // the rebuild rewrites per-LTI rows and edge weights behind the caches' backs
+    flush_lti_cache();
+    lti_cache->clear();
+    lti_graph->clear();
+
+    // with lazy commit, the agent's transaction is already open
+    if (settings->lazy_commit->get_value() == on)
+    {
+        SQL->commit->execute(soar_module::op_reinit);
+    }
+
+    for (size_t i = 0; i < smem_num_bulk_indices; i++)
+    {
+        std::string drop("DROP INDEX IF EXISTS ");
+        drop.append(smem_bulk_indices[i].name);
+        DB->sql_execute(drop.c_str());
+    }
+
+    SQL->begin->execute(soar_module::op_reinit);
+
+    import_state = new smem_import_state();
+    import_state->augmentations = 0;
+}
+
+void SMem_Manager::import_augmentation(uint64_t pLTI_ID, smem_hash_id attr_hash, smem_hash_id value_hash, uint64_t value_lti, double edge_weight)
+{
+    // lti_id, attribute_s_id, val_const, value_lti_id, activation_value, edge_weight
+    SQL->web_add->bind_int(1, pLTI_ID);
+    SQL->web_add->bind_int(2, attr_hash);
+    SQL->web_add->bind_int(3, value_hash);
+    SQL->web_add->bind_int(4, value_lti);
+    SQL->web_add->bind_double(5, static_cast<double>(SMEM_ACT_LOW));
+    SQL->web_add->bind_double(6, edge_weight);
+    SQL->web_add->execute(soar_module::op_reinit);
+
+    if ((++import_state->augmentations % SMEM_IMPORT_BATCH_SIZE) == 0)
+    {
+        SQL->commit->execute(soar_module::op_reinit);
+        SQL->begin->execute(soar_module::op_reinit);
+
+        thisAgent->outputManager->printa_sf(thisAgent, "Imported %u augmentations...\n", import_state->augmentations);
+    }
+}
+
+void SMem_Manager::import_LTM(uint64_t pLTI_ID, ltm_slot_map* children)
+{
+    smem_import_lti& imported = import_state->ltis[pLTI_ID];
+
+    for (ltm_slot_map::iterator s = children->begin(); s != children->end(); s++)
+    {
+        smem_hash_id attr_hash = hash(s->first);
+
+        for (ltm_slot::iterator v = s->second->begin(); v != s->second->end(); v++)
+        {
+            if ((*v)->val_const.val_type == value_const_t)
+            {
+                import_augmentation(pLTI_ID, attr_hash, hash((*v)->val_const.val_value), SMEM_AUGMENTATIONS_NULL, 0.0);
+            }
+            else
+            {
+                // as in LTM_to_DB, an edge weight of zero means none was given;
+                // those are set to the fan when the import ends
+                double edge_weight = (*v)->val_lti.edge_weight;
+                if (edge_weight != 0.0)
+                {
+                    imported.edge_weights = true;
+                }
+                else
+                {
+                    edge_weight = -1.0;
+                }
+                imported.lti_edges = true;
+
+                import_augmentation(pLTI_ID, attr_hash, SMEM_AUGMENTATIONS_NULL, (*v)->val_lti.val_value->lti_id, edge_weight);
+            }
+        }
+    }
+}
+
+/*
+ * Reads an edge list, one augmentation per line:
+ *
+ *   lti,attribute,value[,edge weight]
+ *
+ * LTIs are written @N or N.  A value of the form @N is an LTI; otherwise
+ * values and attributes are integers or floats if they parse as such and
+ * strings if not (|...| forces a string).  Blank lines and lines starting
+ * with # are skipped.
+ */
+bool SMem_Manager::import_csv(std::istream& in, std::string** err_msg)
+{
+    std::unordered_map<std::string, smem_hash_id> constants;
+    id_set known_ltis;
+    std::string line;
+    uint64_t line_count = 0;
+
+    while (std::getline(in, line))
+    {
+        line_count++;
+
+        std::vector<std::string> fields;
+        {
+            std::string field;
+            std::istringstream row(line);
+            while (std::getline(row, field, ','))
+            {
+                size_t first = field.find_first_not_of(" \t\r");
+                size_t last = field.find_last_not_of(" \t\r");
+                fields.push_back((first == std::string::npos) ? std::string() : field.substr(first, last - first + 1));
+            }
+        }
+
+        if (fields.empty() || ((fields.size() == 1) && fields[0].empty()) || (!fields[0].empty() && (fields[0][0] == '#')))
+        {
+            continue;
+        }
+
+        bool good_line = ((fields.size() == 3) || (fields.size() == 4));
+
+        // identifier and (LTI) value
+        uint64_t ltis[2] = { 0, 0 };
+        for (int i = 0; good_line && (i < 3); i += 2)
+        {
+            const std::string& text = fields[i];
+            if ((i == 2) && ((text.size() < 2) || (text[0] != '@')))
+            {
+                break;
+            }
+
+            const char* digits = text.c_str() + ((!text.empty() && (text[0] == '@')) ? 1 : 0);
+            char* end;
+            ltis[i / 2] = static_cast<uint64_t>(strtoull(digits, &end, 10));
+            good_line = ((*digits != '\0') && (*end == '\0') && (ltis[i / 2] != 0));
+
+            if (good_line && (known_ltis.find(ltis[i / 2]) == known_ltis.end()))
+            {
+                if (!lti_exists(ltis[i / 2]))
+                {
+                    add_specific_LTI(ltis[i / 2]);
+                }
+                known_ltis.insert(ltis[i / 2]);
+            }
+        }
+
+        double edge_weight = 0.0;
+        if (good_line && (fields.size() == 4))
+        {
+            char* end;
+            edge_weight = strtod(fields[3].c_str(), &end);
+            good_line = (!fields[3].empty() && (*end == '\0'));
+        }
+
+        // attribute and (constant) value
+        smem_hash_id hashes[2] = { 0, 0 };
+        for (int i = 1; good_line && (i < 3); i++)
+        {
+            if ((i == 2) && ltis[1])
+            {
+                break;
+            }
+
+            const std::string& text = fields[i];
+            std::unordered_map<std::string, smem_hash_id>::iterator cached = constants.find(text);
+            if (cached != constants.end())
+            {
+                hashes[i - 1] = cached->second;
+                continue;
+            }
+
+            good_line = !text.empty();
+            if (good_line)
+            {
+                char* end;
+                int64_t int_val = strtoll(text.c_str(), &end, 10);
+                if (*end == '\0')
+                {
+                    hashes[i - 1] = hash_int(int_val);
+                }
+                else
+                {
+                    double float_val = strtod(text.c_str(), &end);
+                    if (*end == '\0')
+                    {
+                        hashes[i - 1] = hash_float(float_val);
+                    }
+                    else
+                    {
+                        std::string str_val(text);
+                        if ((str_val.size() >= 2) && (str_val[0] == '|') && (str_val[str_val.size() - 1] == '|'))
+                        {
+                            str_val = str_val.substr(1, str_val.size() - 2);
+                        }
+                        hashes[i - 1] = hash_str(const_cast<char*>(str_val.c_str()));
+                    }
+                }
+                constants[text] = hashes[i - 1];
+            }
+        }
+
+        if (!good_line)
+        {
+            std::string num;
+            to_string(line_count, num);
+
+            (*err_msg)->append("Error parsing line #");
+            (*err_msg)->append(num);
+            return false;
+        }
+
+        smem_import_lti& imported = import_state->ltis[ltis[0]];
+        if (ltis[1])
+        {
+            if (edge_weight != 0.0)
+            {
+                imported.edge_weights = true;
+            }
+            else
+            {
+                edge_weight = -1.0;
+            }
+            imported.lti_edges = true;
+
+            import_augmentation(ltis[0], hashes[0], SMEM_AUGMENTATIONS_NULL, ltis[1], edge_weight);
+        }
+        else
+        {
+            import_augmentation(ltis[0], hashes[0], hashes[1], SMEM_AUGMENTATIONS_NULL, 0.0);
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Rebuilds, in one pass over the tables, what LTM_to_DB would have kept up
+ * to date: duplicate augmentations, the indices, per-LTI augmentation
+ * counts, fan edge weights, thresholded activation values, the frequency
+ * tables and the prohibit tracking rows.
+ */
+void SMem_Manager::end_import()
+{
+    SQL->commit->execute(soar_module::op_reinit);
+    SQL->begin->execute(soar_module::op_reinit);
+
+    if (import_state->augmentations >= SMEM_IMPORT_BATCH_SIZE)
+    {
+        thisAgent->outputManager->printa_sf(thisAgent, "Rebuilding indices...\n");
+    }
+
+    DB->sql_execute("CREATE TEMP TABLE IF NOT EXISTS smem_imported_ltis (lti_id INTEGER PRIMARY KEY, reset_fan INTEGER)");
+    DB->sql_execute("DELETE FROM smem_imported_ltis");
+    {
+        soar_module::sqlite_statement* imported_add = new soar_module::sqlite_statement(DB, "INSERT INTO smem_imported_ltis (lti_id, reset_fan) VALUES (?,?)");
+        imported_add->prepare();
+        for (std::unordered_map<uint64_t, smem_import_lti>::iterator l = import_state->ltis.begin(); l != import_state->ltis.end(); l++)
+        {
+            // as in LTM_to_DB, explicit edge weights keep the others from being reset to the fan
+            imported_add->bind_int(1, l->first);
+            imported_add->bind_int(2, (l->second.lti_edges && !l->second.edge_weights) ? 1 : 0);
+            imported_add->execute(soar_module::op_reinit);
+        }
+        delete imported_add;
+    }
+
+    // storing an augmentation an LTI already has is a no-op
+    DB->sql_execute("DELETE FROM smem_augmentations WHERE lti_id IN (SELECT lti_id FROM smem_imported_ltis) AND rowid NOT IN "
+                    "(SELECT MIN(rowid) FROM smem_augmentations WHERE lti_id IN (SELECT lti_id FROM smem_imported_ltis) GROUP BY lti_id, attribute_s_id, value_constant_s_id, value_lti_id)");
+
+    DB->sql_execute("DELETE FROM smem_attribute_frequency");
+    DB->sql_execute("INSERT INTO smem_attribute_frequency (attribute_s_id, edge_frequency) SELECT attribute_s_id, COUNT(DISTINCT lti_id) FROM smem_augmentations GROUP BY attribute_s_id");
+    DB->sql_execute("DELETE FROM smem_wmes_constant_frequency");
+    DB->sql_execute("INSERT INTO smem_wmes_constant_frequency (attribute_s_id, value_constant_s_id, edge_frequency) SELECT attribute_s_id, value_constant_s_id, COUNT(*) FROM smem_augmentations WHERE value_lti_id=" SMEM_AUGMENTATIONS_NULL_STR " GROUP BY attribute_s_id, value_constant_s_id");
+    DB->sql_execute("DELETE FROM smem_wmes_lti_frequency");
+    DB->sql_execute("INSERT INTO smem_wmes_lti_frequency (attribute_s_id, value_lti_id, edge_frequency) SELECT attribute_s_id, value_lti_id, COUNT(*) FROM smem_augmentations WHERE value_constant_s_id=" SMEM_AUGMENTATIONS_NULL_STR " GROUP BY attribute_s_id, value_lti_id");
+
+    for (size_t i = 0; i < smem_num_bulk_indices; i++)
+    {
+        DB->sql_execute(smem_bulk_indices[i].definition);
+    }
+
+    DB->sql_execute("UPDATE smem_lti SET "
+                    "total_augmentations=(SELECT COUNT(*) FROM smem_augmentations a WHERE a.lti_id=smem_lti.lti_id), "
+                    "lti_augmentations=(SELECT COUNT(*) FROM smem_augmentations a WHERE a.lti_id=smem_lti.lti_id AND a.value_constant_s_id=" SMEM_AUGMENTATIONS_NULL_STR ") "
+                    "WHERE lti_id IN (SELECT lti_id FROM smem_imported_ltis)");
+
+    DB->sql_execute("UPDATE smem_augmentations SET edge_weight=1.0/(SELECT lti_augmentations FROM smem_lti l WHERE l.lti_id=smem_augmentations.lti_id) "
+                    "WHERE lti_id IN (SELECT lti_id FROM smem_imported_ltis) AND value_constant_s_id=" SMEM_AUGMENTATIONS_NULL_STR " "
+                    "AND (edge_weight<0 OR lti_id IN (SELECT lti_id FROM smem_imported_ltis WHERE reset_fan=1))");
+
+    // LTIs at or above the threshold are not activated through smem_augmentations
+    {
+        soar_module::sqlite_statement* act_set_above = new soar_module::sqlite_statement(DB,
+                "UPDATE smem_augmentations SET activation_value=? WHERE lti_id IN (SELECT l.lti_id FROM smem_lti l, smem_imported_ltis i WHERE l.lti_id=i.lti_id AND l.total_augmentations>=?)");
+        act_set_above->prepare();
+        act_set_above->bind_double(1, static_cast<double>(SMEM_ACT_LOW));
+        act_set_above->bind_int(2, settings->thresh->get_value());
+        act_set_above->execute(soar_module::op_reinit);
+        delete act_set_above;
+    }
+
+    DB->sql_execute("INSERT OR IGNORE INTO smem_prohibited (lti_id,prohibited,dirty) SELECT lti_id,0,0 FROM smem_imported_ltis");
+    DB->sql_execute("DROP TABLE smem_imported_ltis");
+
+    {
+        soar_module::sqlite_statement* edge_count = new soar_module::sqlite_statement(DB, "SELECT COUNT(*) FROM smem_augmentations");
+        edge_count->prepare();
+        if (edge_count->execute() == soar_module::row)
+        {
+            statistics->edges->set_value(edge_count->column_int(0));
+        }
+        delete edge_count;
+    }
+
+    SQL->commit->execute(soar_module::op_reinit);
+    if (settings->lazy_commit->get_value() == on)
+    {
+        SQL->begin->execute(soar_module::op_reinit);
+    }
+
+    lti_cache->clear();
+    lti_graph->clear();
+
+    delete import_state;
+    import_state = NULL;
+}
@@ -272,24 +272,24 @@ void SMem_Manager::install_memory(Symbol* state, uint64_t pLTI_ID, Symbol* sti,
             visited = new std::set<uint64_t>;
         }
 
-        soar_module::sqlite_statement* expand_q = SQL->web_expand;
+        smem_cached_aug_list augs;
         Symbol* attr_sym;
         Symbol* value_sym;
 
-        // get direct children: attr_type, attr_hash, value_type, value_hash, value_letter, value_num, value_lti
-        expand_q->bind_int(1, pLTI_ID);
+        // get direct children: attr_type, attr_hash, value_type, value_hash, value_lti
+        get_lti_augmentations(pLTI_ID, augs);
 
         std::set<Symbol*> children;
 
-        while (expand_q->execute() == soar_module::row)
+        for (smem_cached_aug_list::iterator aug = augs.begin(); aug != augs.end(); aug++)
         {
             // make the identifier symbol irrespective of value type
-            attr_sym = rhash_(static_cast<byte>(expand_q->column_int(0)), static_cast<smem_hash_id>(expand_q->column_int(1)));
+            attr_sym = rhash_(aug->attr_type, aug->attr_hash);
 
             // identifier vs. constant
-            if (expand_q->column_int(4) != SMEM_AUGMENTATIONS_NULL)
+            if (aug->value_lti != SMEM_AUGMENTATIONS_NULL)
             {
-                value_sym = get_current_iSTI_for_LTI(static_cast<uint64_t>(expand_q->column_int(4)), sti->id->level, 'L');
+                value_sym = get_current_iSTI_for_LTI(aug->value_lti, sti->id->level, 'L');
                 if (depth > 1)
                 {
                     children.insert(value_sym);
@@ -297,7 +297,7 @@ void SMem_Manager::install_memory(Symbol* state, uint64_t pLTI_ID, Symbol* sti,
             }
             else
             {
-                value_sym = rhash_(static_cast<byte>(expand_q->column_int(2)), static_cast<smem_hash_id>(expand_q->column_int(3)));
+                value_sym = rhash_(aug->value_type, aug->value_hash);
             }
 
             // add wme
@@ -312,7 +312,6 @@ void SMem_Manager::install_memory(Symbol* state, uint64_t pLTI_ID, Symbol* sti,
             thisAgent->symbolManager->symbol_remove_ref(&attr_sym);
             thisAgent->symbolManager->symbol_remove_ref(&value_sym);
         }
-        expand_q->reinitialize();
 
         //Attempt to find children for the case of depth.
         std::set<Symbol*>::iterator iterator;
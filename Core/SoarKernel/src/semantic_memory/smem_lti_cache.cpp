@@ -0,0 +1,413 @@
+#include "smem_lti_cache.h"
+
+#include "semantic_memory.h"
+#include "smem_db.h"
+#include "smem_settings.h"
+#include "smem_stats.h"
+
+#include <cstring>
+
+smem_cached_lti* smem_lti_cache::find(uint64_t lti_id)
+{
+    std::unordered_map<uint64_t, std::list<smem_cached_lti>::iterator>::iterator p = lookup.find(lti_id);
+    if (p == lookup.end())
+    {
+        return NULL;
+    }
+    if (p->second != entries.begin())
+    {
+        entries.splice(entries.begin(), entries, p->second);
+    }
+    return &(*(p->second));
+}
+
+smem_cached_lti* smem_lti_cache::get(uint64_t lti_id)
+{
+    smem_cached_lti* entry = find(lti_id);
+    if (!entry)
+    {
+        entries.push_front(smem_cached_lti());
+        entry = &(entries.front());
+        entry->lti_id = lti_id;
+        entry->access_loaded = false;
+        entry->access_dirty = false;
+        entry->activations_total = 0;
+        entry->activations_last = 0;
+        entry->activations_first = 0;
+        entry->history_loaded = false;
+        entry->history_dirty = false;
+        entry->has_history = false;
+        memset(&(entry->history), 0, sizeof(smem_lti_history));
+        entry->child_ct_loaded = false;
+        entry->child_ct = 0;
+        entry->augs_loaded = false;
+        entry->base_level_valid = false;
+        lookup[lti_id] = entries.begin();
+    }
+    return entry;
+}
+
+smem_cached_lti* smem_lti_cache::over_capacity()
+{
+    return ((entries.size() > capacity) ? &(entries.back()) : NULL);
+}
+
+void smem_lti_cache::pop_oldest()
+{
+    lookup.erase(entries.back().lti_id);
+    entries.pop_back();
+}
+
+void smem_lti_cache::clear()
+{
+    entries.clear();
+    lookup.clear();
+    dirty = false;
+}
+
+//////////////////////////////////////////////////////////
+// SMem_Manager access through the cache
+//////////////////////////////////////////////////////////
+
+void SMem_Manager::count_lti_cache_lookup(bool hit)
+{
+    if (hit)
+    {
+        statistics->lti_cache_hits->set_value(statistics->lti_cache_hits->get_value() + 1);
+    }
+    else
+    {
+        statistics->lti_cache_misses->set_value(statistics->lti_cache_misses->get_value() + 1);
+    }
+}
+
+// finds or adds the LTI's entry, writing back whatever falls out the end
+smem_cached_lti* SMem_Manager::cache_lti(uint64_t pLTI_ID)
+{
+    smem_cached_lti* entry = lti_cache->get(pLTI_ID);
+    smem_cached_lti* oldest;
+
+    while ((oldest = lti_cache->over_capacity()) != NULL)
+    {
+        write_back_lti(oldest);
+        lti_cache->pop_oldest();
+    }
+
+    return entry;
+}
+
+void SMem_Manager::write_back_lti(smem_cached_lti* entry)
+{
+    if (entry->access_dirty)
+    {
+        SQL->lti_access_set->bind_double(1, entry->activations_total);
+        SQL->lti_access_set->bind_int(2, entry->activations_last);
+        SQL->lti_access_set->bind_int(3, entry->activations_first);
+        SQL->lti_access_set->bind_int(4, entry->lti_id);
+        SQL->lti_access_set->execute(soar_module::op_reinit);
+
+        entry->access_dirty = false;
+    }
+
+    if (entry->history_dirty)
+    {
+        if (entry->has_history)
+        {
+            SQL->history_set->bind_int(1, entry->lti_id);
+            for (int i = 0; i < SMEM_ACT_HISTORY_ENTRIES; i++)
+            {
+                SQL->history_set->bind_int(i + 2, entry->history.t[i]);
+                SQL->history_set->bind_double(i + 2 + SMEM_ACT_HISTORY_ENTRIES, entry->history.touches[i]);
+            }
+            SQL->history_set->execute(soar_module::op_reinit);
+        }
+
+        entry->history_dirty = false;
+    }
+}
+
+// writes every dirty entry back to the database
+void SMem_Manager::flush_lti_cache()
+{
+    if (!lti_cache->is_dirty())
+    {
+        return;
+    }
+
+    for (std::list<smem_cached_lti>::iterator p = lti_cache->begin(); p != lti_cache->end(); p++)
+    {
+        write_back_lti(&(*p));
+    }
+    lti_cache->set_dirty(false);
+}
+
+void SMem_Manager::get_lti_access(uint64_t pLTI_ID, double& activations_total, uint64_t& activations_last, uint64_t& activations_first)
+{
+    smem_cached_lti* entry = NULL;
+
+    if (lti_cache->enabled())
+    {
+        entry = cache_lti(pLTI_ID);
+        count_lti_cache_lookup(entry->access_loaded);
+        if (entry->access_loaded)
+        {
+            activations_total = entry->activations_total;
+            activations_last = entry->activations_last;
+            activations_first = entry->activations_first;
+            return;
+        }
+    }
+
+    SQL->lti_access_get->bind_int(1, pLTI_ID);
+    SQL->lti_access_get->execute();
+    activations_total = SQL->lti_access_get->column_double(0);
+    activations_last = SQL->lti_access_get->column_int(1);
+    activations_first = SQL->lti_access_get->column_int(2);
+    SQL->lti_access_get->reinitialize();
+
+    if (entry)
+    {
+        entry->access_loaded = true;
+        entry->activations_total = activations_total;
+        entry->activations_last = activations_last;
+        entry->activations_first = activations_first;
+    }
+}
+
+void SMem_Manager::set_lti_access(uint64_t pLTI_ID, double activations_total, uint64_t activations_last, uint64_t activations_first)
+{
+    if (lti_cache->enabled())
+    {
+        smem_cached_lti* entry = cache_lti(pLTI_ID);
+        entry->access_loaded = true;
+        entry->access_dirty = true;
+        entry->activations_total = activations_total;
+        entry->activations_last = activations_last;
+        entry->activations_first = activations_first;
+        lti_cache->set_dirty(true);
+    }
+    else
+    {
+        SQL->lti_access_set->bind_double(1, activations_total);
+        SQL->lti_access_set->bind_int(2, activations_last);
+        SQL->lti_access_set->bind_int(3, activations_first);
+        SQL->lti_access_set->bind_int(4, pLTI_ID);
+        SQL->lti_access_set->execute(soar_module::op_reinit);
+    }
+}
+
+// returns whether the LTI has a history row (history is zeroed if not)
+bool SMem_Manager::read_lti_history(uint64_t pLTI_ID, smem_lti_history& history)
+{
+    bool has_history;
+
+    SQL->history_get->bind_int(1, pLTI_ID);
+    has_history = (SQL->history_get->execute() == soar_module::row);
+    for (int i = 0; i < SMEM_ACT_HISTORY_ENTRIES; i++)
+    {
+        history.t[i] = has_history ? SQL->history_get->column_int(i) : 0;
+        history.touches[i] = has_history ? SQL->history_get->column_double(i + SMEM_ACT_HISTORY_ENTRIES) : 0.0;
+    }
+    SQL->history_get->reinitialize();
+
+    return has_history;
+}
+
+smem_cached_lti* SMem_Manager::cache_lti_history(uint64_t pLTI_ID)
+{
+    smem_cached_lti* entry = cache_lti(pLTI_ID);
+
+    count_lti_cache_lookup(entry->history_loaded);
+    if (!entry->history_loaded)
+    {
+        entry->has_history = read_lti_history(pLTI_ID, entry->history);
+        entry->history_loaded = true;
+    }
+
+    return entry;
+}
+
+void SMem_Manager::get_lti_history(uint64_t pLTI_ID, smem_lti_history& history)
+{
+    if (lti_cache->enabled())
+    {
+        history = cache_lti_history(pLTI_ID)->history;
+    }
+    else
+    {
+        read_lti_history(pLTI_ID, history);
+    }
+}
+
+// records an access at the front of an existing history
+void SMem_Manager::push_lti_history(uint64_t pLTI_ID, int64_t time_now, double touches)
+{
+    if (lti_cache->enabled())
+    {
+        smem_cached_lti* entry = cache_lti_history(pLTI_ID);
+        if (entry->has_history)
+        {
+            memmove(&(entry->history.t[1]), &(entry->history.t[0]), sizeof(int64_t) * (SMEM_ACT_HISTORY_ENTRIES - 1));
+            memmove(&(entry->history.touches[1]), &(entry->history.touches[0]), sizeof(double) * (SMEM_ACT_HISTORY_ENTRIES - 1));
+            entry->history.t[0] = time_now;
+            entry->history.touches[0] = touches;
+            entry->history_dirty = true;
+            entry->base_level_valid = false;
+            lti_cache->set_dirty(true);
+        }
+    }
+    else
+    {
+        SQL->history_push->bind_int(1, time_now);
+        SQL->history_push->bind_double(2, touches);
+        SQL->history_push->bind_int(3, pLTI_ID);
+        SQL->history_push->execute(soar_module::op_reinit);
+    }
+}
+
+// starts the history of an LTI on its first access
+void SMem_Manager::add_lti_history(uint64_t pLTI_ID, int64_t time_now, double touches)
+{
+    if (lti_cache->enabled())
+    {
+        smem_cached_lti* entry = cache_lti(pLTI_ID);
+        memset(&(entry->history), 0, sizeof(smem_lti_history));
+        entry->history.t[0] = time_now;
+        entry->history.touches[0] = touches;
+        entry->has_history = true;
+        entry->history_loaded = true;
+        entry->history_dirty = true;
+        entry->base_level_valid = false;
+        lti_cache->set_dirty(true);
+    }
+    else
+    {
+        SQL->history_add->bind_int(1, pLTI_ID);
+        SQL->history_add->bind_int(2, time_now);
+        SQL->history_add->bind_double(3, touches);
+        SQL->history_add->execute(soar_module::op_reinit);
+    }
+}
+
+// drops the most recent access from an existing history
+void SMem_Manager::pop_lti_history(uint64_t pLTI_ID)
+{
+    if (lti_cache->enabled())
+    {
+        smem_cached_lti* entry = cache_lti_history(pLTI_ID);
+        if (entry->has_history)
+        {
+            memmove(&(entry->history.t[0]), &(entry->history.t[1]), sizeof(int64_t) * (SMEM_ACT_HISTORY_ENTRIES - 1));
+            memmove(&(entry->history.touches[0]), &(entry->history.touches[1]), sizeof(double) * (SMEM_ACT_HISTORY_ENTRIES - 1));
+            entry->history.t[SMEM_ACT_HISTORY_ENTRIES - 1] = 0;
+            entry->history.touches[SMEM_ACT_HISTORY_ENTRIES - 1] = 0.0;
+            entry->history_dirty = true;
+            entry->base_level_valid = false;
+            lti_cache->set_dirty(true);
+        }
+    }
+    else
+    {
+        SQL->history_remove->bind_int(1, pLTI_ID);
+        SQL->history_remove->execute(soar_module::op_reinit);
+    }
+}
+
+uint64_t SMem_Manager::get_lti_child_ct(uint64_t pLTI_ID)
+{
+    smem_cached_lti* entry = NULL;
+    uint64_t child_ct;
+
+    if (lti_cache->enabled())
+    {
+        entry = cache_lti(pLTI_ID);
+        count_lti_cache_lookup(entry->child_ct_loaded);
+        if (entry->child_ct_loaded)
+        {
+            return entry->child_ct;
+        }
+    }
+
+    SQL->act_lti_child_ct_get->bind_int(1, pLTI_ID);
+    SQL->act_lti_child_ct_get->execute();
+    child_ct = static_cast<uint64_t>(SQL->act_lti_child_ct_get->column_int(0));
+    SQL->act_lti_child_ct_get->reinitialize();
+
+    if (entry)
+    {
+        entry->child_ct = child_ct;
+        entry->child_ct_loaded = true;
+    }
+
+    return child_ct;
+}
+
+// the count is written through; a cached copy is kept current
+void SMem_Manager::set_lti_child_ct(uint64_t pLTI_ID, uint64_t child_ct)
+{
+    SQL->act_lti_child_ct_set->bind_int(1, child_ct);
+    SQL->act_lti_child_ct_set->bind_int(2, pLTI_ID);
+    SQL->act_lti_child_ct_set->execute(soar_module::op_reinit);
+
+    if (lti_cache->enabled())
+    {
+        smem_cached_lti* entry = lti_cache->find(pLTI_ID);
+        if (entry)
+        {
+            entry->child_ct = child_ct;
+            entry->child_ct_loaded = true;
+        }
+    }
+}
+
+void SMem_Manager::get_lti_augmentations(uint64_t pLTI_ID, smem_cached_aug_list& augs)
+{
+    smem_cached_lti* entry = NULL;
+    soar_module::sqlite_statement* expand_q = SQL->web_expand;
+    smem_cached_aug aug;
+
+    if (lti_cache->enabled())
+    {
+        entry = cache_lti(pLTI_ID);
+        count_lti_cache_lookup(entry->augs_loaded);
+        if (entry->augs_loaded)
+        {
+            augs = entry->augs;
+            return;
+        }
+    }
+
+    // get direct children: attr_type, attr_hash, value_type, value_hash, value_lti
+    augs.clear();
+    expand_q->bind_int(1, pLTI_ID);
+    while (expand_q->execute() == soar_module::row)
+    {
+        aug.attr_type = static_cast<byte>(expand_q->column_int(0));
+        aug.attr_hash = static_cast<smem_hash_id>(expand_q->column_int(1));
+        aug.value_type = static_cast<byte>(expand_q->column_int(2));
+        aug.value_hash = static_cast<smem_hash_id>(expand_q->column_int(3));
+        aug.value_lti = static_cast<uint64_t>(expand_q->column_int(4));
+        augs.push_back(aug);
+    }
+    expand_q->reinitialize();
+
+    if (entry)
+    {
+        entry->augs = augs;
+        entry->augs_loaded = true;
+    }
+}
+
+// called whenever the LTI's rows in smem_augmentations change
+void SMem_Manager::invalidate_lti_augmentations(uint64_t pLTI_ID)
+{
+    if (lti_cache->enabled())
+    {
+        smem_cached_lti* entry = lti_cache->find(pLTI_ID);
+        if (entry)
+        {
+            entry->augs_loaded = false;
+            entry->augs.clear();
+        }
+    }
+}
@@ -0,0 +1,133 @@
+/*************************************************************************
+ * PLEASE SEE THE FILE "COPYING" (INCLUDED WITH THIS SOFTWARE PACKAGE)
+ * FOR LICENSE AND COPYRIGHT INFORMATION.
+ *************************************************************************/
+
+/*************************************************************************
+ *
+ *  file:  smem_lti_cache.h
+ *
+ * =======================================================================
+ *
+ * A least-recently-used cache of the per-LTI rows that retrievals and
+ * activation updates read over and over: the access record and
+ * augmentation count in smem_lti, the smem_activation_history row and
+ * the direct augmentations returned by web_expand.  Each entry also
+ * remembers the last base-level activation computed from its history,
+ * so that recomputing it at the same time is free.
+ *
+ * Augmentations and counts are read-through; stores update or drop
+ * them as they write the tables.  Access records and histories are
+ * write-back: changes stay in the entry, marked dirty, until the entry
+ * is evicted or SMem_Manager::flush_lti_cache writes them out at a
+ * commit point.
+ *
+ * The cache holds no SQL of its own; SMem_Manager loads and writes the
+ * entries.
+ *
+ * =======================================================================
+ */
+
+#ifndef SMEM_LTI_CACHE_H
+#define SMEM_LTI_CACHE_H
+
+#include "kernel.h"
+
+#include "constants.h"
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+// one row of web_expand
+typedef struct smem_cached_aug_struct
+{
+    byte            attr_type;
+    smem_hash_id    attr_hash;
+    byte            value_type;
+    smem_hash_id    value_hash;
+    uint64_t        value_lti;
+} smem_cached_aug;
+
+typedef std::vector<smem_cached_aug> smem_cached_aug_list;
+
+// smem_activation_history, most recent access first; zeros when the row
+// is absent or not yet filled
+typedef struct smem_lti_history_struct
+{
+    int64_t         t[SMEM_ACT_HISTORY_ENTRIES];
+    double          touches[SMEM_ACT_HISTORY_ENTRIES];
+} smem_lti_history;
+
+typedef struct smem_cached_lti_struct
+{
+    uint64_t                lti_id;
+
+    // activations_total, activations_last, activations_first
+    bool                    access_loaded;
+    bool                    access_dirty;
+    double                  activations_total;
+    int64_t                 activations_last;
+    int64_t                 activations_first;
+
+    bool                    history_loaded;
+    bool                    history_dirty;
+    bool                    has_history;
+    smem_lti_history        history;
+
+    // total_augmentations
+    bool                    child_ct_loaded;
+    uint64_t                child_ct;
+
+    bool                    augs_loaded;
+    smem_cached_aug_list    augs;
+
+    // the last base-level value computed from this history, and its inputs
+    bool                    base_level_valid;
+    int64_t                 base_level_time;
+    uint64_t                base_level_n;
+    uint64_t                base_level_first;
+    uint64_t                base_level_epoch;
+    double                  base_level;
+} smem_cached_lti;
+
+class smem_lti_cache
+{
+    public:
+        smem_lti_cache(): capacity(0), dirty(false) {}
+
+        bool enabled() const { return (capacity > 0); }
+        void set_capacity(uint64_t new_capacity) { capacity = new_capacity; }
+        uint64_t size() const { return entries.size(); }
+
+        // whether any entry may hold changes not yet written back
+        bool is_dirty() const { return dirty; }
+        void set_dirty(bool new_dirty) { dirty = new_dirty; }
+
+        // marks the entry most recently used; NULL if not cached
+        smem_cached_lti* find(uint64_t lti_id);
+
+        // finds or adds the entry (with nothing loaded)
+        smem_cached_lti* get(uint64_t lti_id);
+
+        // least recently used entry, while more than capacity are cached;
+        // the caller writes it back if dirty and then calls pop_oldest
+        smem_cached_lti* over_capacity();
+        void pop_oldest();
+
+        void clear();
+
+        // iteration for write-back
+        std::list<smem_cached_lti>::iterator begin() { return entries.begin(); }
+        std::list<smem_cached_lti>::iterator end() { return entries.end(); }
+
+    private:
+        uint64_t capacity;
+        bool dirty;
+
+        // most recently used first
+        std::list<smem_cached_lti> entries;
+        std::unordered_map<uint64_t, std::list<smem_cached_lti>::iterator> lookup;
+};
+
+#endif // SMEM_LTI_CACHE_H
@@ -360,8 +360,6 @@ void SMem_Manager::print_smem_object(uint64_t pLTI_ID, uint64_t depth, std::stri
     id_set::iterator next_it;
 
     soar_module::sqlite_statement* act_q;// = thisAgent->SMem->SQL->vis_lti_act;
-    soar_module::sqlite_statement* hist_q = thisAgent->SMem->SQL->history_get;
-    soar_module::sqlite_statement* lti_access_q = thisAgent->SMem->SQL->lti_access_get;
     unsigned int i;
 
 
@@ -398,20 +396,19 @@ void SMem_Manager::print_smem_object(uint64_t pLTI_ID, uint64_t depth, std::stri
             std::list<uint64_t> access_history;
             if (history)
             {
-                lti_access_q->bind_int(1, c.first);
-                lti_access_q->execute();
-                uint64_t n = lti_access_q->column_int(0);
-                lti_access_q->reinitialize();
-                hist_q->bind_int(1, c.first);
-                hist_q->execute();
-                for (int i = 0; i < n && i < 10; ++i) //10 because of the length of the history record kept for smem.
+                double activations_total;
+                uint64_t activations_last, activations_first;
+                smem_lti_history lti_history;
+                get_lti_access(c.first, activations_total, activations_last, activations_first);
+                uint64_t n = static_cast<uint64_t>(activations_total);
+                get_lti_history(c.first, lti_history);
+                for (int i = 0; i < n && i < SMEM_ACT_HISTORY_ENTRIES; ++i) //10 because of the length of the history record kept for smem.
                 {
-                    if (thisAgent->SMem->SQL->history_get->column_int(i) != 0)
+                    if (lti_history.t[i] != 0)
                     {
-                        access_history.push_back(hist_q->column_int(i));
+                        access_history.push_back(lti_history.t[i]);
                     }
                 }
-                hist_q->reinitialize();
             }
 
             if (history && !access_history.empty())
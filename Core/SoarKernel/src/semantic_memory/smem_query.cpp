@@ -580,10 +580,7 @@ uint64_t SMem_Manager::process_query(Symbol* state, std::list<Symbol*> query, Sy
                         to_update.insert(q->column_int(0));
                     }
 
-                    for (std::set< uint64_t >::iterator it = to_update.begin(); it != to_update.end(); it++)
-                    {
-                        lti_activate((*it), false);
-                    }
+                    lti_activate_batch(std::vector< uint64_t >(to_update.begin(), to_update.end()));
 
                     q->reinitialize();
                 }
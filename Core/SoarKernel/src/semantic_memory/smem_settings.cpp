@@ -10,6 +10,7 @@
 #include "output_manager.h"
 #include "semantic_memory.h"
 #include "smem_db.h"
+#include "smem_shared_store.h"
 #include "smem_stats.h"
 #include "soar_module.h"
 
@@ -27,6 +28,7 @@ smem_param_container::smem_param_container(agent* new_agent): soar_module::param
     database = new soar_module::constant_param<db_choices>("database", memory, new soar_module::f_predicate<db_choices>());
     database->add_mapping(memory, "memory");
     database->add_mapping(file, "file");
+    database->add_mapping(shared, "shared");
     add(database);
 
     // append database or dump data on init
@@ -64,12 +66,27 @@ smem_param_container::smem_param_container(agent* new_agent): soar_module::param
     cache_size = new soar_module::integer_param("cache-size", 10000, new soar_module::gt_predicate<int64_t>(1, true), new smem_db_predicate<int64_t>(thisAgent));
     add(cache_size);
 
+    // lti_cache_size - number of LTIs whose rows are kept in memory (0 = off)
+    lti_cache_size = new soar_module::integer_param("lti-cache-size", 1000, new soar_module::gt_predicate<int64_t>(0, true), new smem_db_predicate<int64_t>(thisAgent));
+    add(lti_cache_size);
+
     // opt
     opt = new soar_module::constant_param<opt_choices>("optimization", opt_speed, new smem_db_predicate<opt_choices>(thisAgent));
     opt->add_mapping(opt_safety, "safety");
     opt->add_mapping(opt_speed, "performance");
+    opt->add_mapping(opt_wal, "wal");
     add(opt);
 
+    // group commit (optimization = wal)
+    commit_interval = new soar_module::integer_param("commit-interval", 100, new soar_module::gt_predicate<int64_t>(0, true), new smem_db_predicate<int64_t>(thisAgent));
+    add(commit_interval);
+
+    commit_interval_ms = new soar_module::integer_param("commit-interval-ms", 1000, new soar_module::gt_predicate<int64_t>(0, true), new smem_db_predicate<int64_t>(thisAgent));
+    add(commit_interval_ms);
+
+    checkpoint_thread = new soar_module::boolean_param("checkpoint-thread", off, new smem_db_predicate<boolean>(thisAgent));
+    add(checkpoint_thread);
+
     // thresh
     thresh = new soar_module::integer_param("thresh", 100, new soar_module::predicate<int64_t>(), new smem_db_predicate<int64_t>(thisAgent));
     add(thresh);
@@ -108,6 +125,10 @@ smem_param_container::smem_param_container(agent* new_agent): soar_module::param
     base_incremental_threshes = new soar_module::int_set_param("base-incremental-threshes", new soar_module::f_predicate< int64_t >());
     add(base_incremental_threshes);
 
+    // base_batch - recompute base-level activations of many LTIs together
+    base_batch = new soar_module::boolean_param("base-batch", on, new soar_module::f_predicate<boolean>());
+    add(base_batch);
+
     // initial variable id
     initial_variable_id = new soar_module::unsigned_integer_param("initial-variable-id", 1, new soar_module::predicate<uint64_t>(), new smem_db_predicate<uint64_t>(thisAgent));
     add(initial_variable_id);
@@ -151,6 +172,10 @@ smem_param_container::smem_param_container(agent* new_agent): soar_module::param
     // using wma to supply the starting magnitude for a source of spread
     spreading_wma_source = new soar_module::boolean_param("spreading-wma-source", off, new soar_module::f_predicate<boolean>());
     add(spreading_wma_source);
+
+    // spreading graph - traverse an in-memory copy of the LTI-to-LTI edges rather than querying for children
+    spreading_graph = new soar_module::boolean_param("spreading-graph", on, new soar_module::f_predicate<boolean>());
+    add(spreading_graph);
 }
 
 //
@@ -257,6 +282,17 @@ smem_stat_container::smem_stat_container(agent* new_agent): soar_module::stat_co
     mem_high = new smem_mem_high_stat(thisAgent, "mem-high", 0, new soar_module::predicate<int64_t>());
     add(mem_high);
 
+    // bytes of a shared database this agent has written a private copy of
+    overlay_size = new smem_overlay_size_stat(thisAgent, "overlay-size", 0, new soar_module::predicate<int64_t>());
+    add(overlay_size);
+
+    // commits / checkpoints made by commit-interval since the database was opened
+    commits = new smem_group_commit_stat(thisAgent, "commits", false, new soar_module::predicate<int64_t>());
+    add(commits);
+
+    checkpoints = new smem_group_commit_stat(thisAgent, "checkpoints", true, new soar_module::predicate<int64_t>());
+    add(checkpoints);
+
     retrievals = new soar_module::integer_stat("retrieves", 0, new soar_module::f_predicate<int64_t>());
     add(retrievals);
 
@@ -278,6 +314,13 @@ smem_stat_container::smem_stat_container(agent* new_agent): soar_module::stat_co
     // A count of spread trajectories
     trajectories_total = new soar_module::integer_stat("trajectories_total", 0, new soar_module::f_predicate<int64_t>());
     add(trajectories_total);
+
+    // LTI cache lookups answered from memory / from the database
+    lti_cache_hits = new soar_module::integer_stat("lti-cache-hits", 0, new soar_module::f_predicate<int64_t>());
+    add(lti_cache_hits);
+
+    lti_cache_misses = new soar_module::integer_stat("lti-cache-misses", 0, new soar_module::f_predicate<int64_t>());
+    add(lti_cache_misses);
 }
 
 //
@@ -303,6 +346,29 @@ int64_t smem_mem_high_stat::get_value()
     return thisAgent->SMem->DB->memory_highwater();
 }
 
+smem_overlay_size_stat::smem_overlay_size_stat(agent* new_agent, const char* new_name, int64_t new_value, soar_module::predicate<int64_t>* new_prot_pred): soar_module::integer_stat(new_name, new_value, new_prot_pred), thisAgent(new_agent) {}
+
+int64_t smem_overlay_size_stat::get_value()
+{
+    if (!thisAgent->SMem->connected())
+    {
+        return 0;
+    }
+    return static_cast<int64_t>(smem_shared_store_overlay_size(thisAgent->SMem->DB->get_db()));
+}
+
+smem_group_commit_stat::smem_group_commit_stat(agent* new_agent, const char* new_name, bool new_count_checkpoints, soar_module::predicate<int64_t>* new_prot_pred): soar_module::integer_stat(new_name, 0, new_prot_pred), thisAgent(new_agent), count_checkpoints(new_count_checkpoints) {}
+
+int64_t smem_group_commit_stat::get_value()
+{
+    soar_module::sqlite_group_commit* group_commit = thisAgent->SMem->group_commit;
+    if (!group_commit)
+    {
+        return 0;
+    }
+    return static_cast<int64_t>(count_checkpoints ? group_commit->get_checkpoints() : group_commit->get_commits());
+}
+
 bool SMem_Manager::enabled()
 {
     return (settings->learning->get_value() == on);
@@ -324,7 +390,7 @@ void smem_param_container::print_settings(agent* thisAgent)
     outputManager->printa(thisAgent, "-      Semantic Memory Sub-Commands and Options       -\n");
     outputManager->printa(thisAgent, "=======================================================\n");
     outputManager->printa_sf(thisAgent, "%s   %-\n", concatJustified("enabled",learning->get_string(), 55).c_str());
-    outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("database", database->get_string(), 55).c_str(), "Store database in memory or file");
+    outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("database", database->get_string(), 55).c_str(), "Store database in memory or file, or share one");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("append", append_db->get_string(), 55).c_str(), "Append or overwrite after init");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("path", path->get_cstring(), 55).c_str(), "Path to database on disk");
     outputManager->printa(thisAgent, "-------------------------------------------------------\n");
@@ -348,6 +414,7 @@ void smem_param_container::print_settings(agent* thisAgent)
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("base-decay", base_decay->get_string(), 55).c_str(), "Decay parameter for base-level activation computation");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("base-update-policy", base_update->get_string(), 55).c_str(), "stable, naive, incremental");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("base-incremental-threshes", base_incremental_threshes->get_string(), 55).c_str(), "integer > 0");
+    outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("base-batch", base_batch->get_string(), 55).c_str(), "on, off");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("thresh", thresh->get_string(), 55).c_str(), "integer >= 0");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("base-inhibition", base_inhibition->get_string(), 55).c_str(), "on, off");
     outputManager->printa(thisAgent, "------------ Experimental Spreading Activation --------\n");
@@ -360,10 +427,15 @@ void smem_param_container::print_settings(agent* thisAgent)
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("spreading-edge-updating", spreading_edge_updating->get_string(), 55).c_str(), "on, off");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("spreading-wma-source", spreading_wma_source->get_string(), 55).c_str(), "on, off");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("spreading-edge-update-factor", spreading_edge_update_factor->get_string(), 55).c_str(), "1 > decimal > 0");
+    outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("spreading-graph", spreading_graph->get_string(), 55).c_str(), "on, off");
     outputManager->printa(thisAgent, "------------- Database Optimization Settings ----------\n");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("lazy-commit", lazy_commit->get_string(), 55).c_str(), "Delay writing semantic store until exit");
-    outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("optimization", opt->get_string(), 55).c_str(), "safety, performance");
+    outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("optimization", opt->get_string(), 55).c_str(), "safety, performance, wal");
+    outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("commit-interval", commit_interval->get_string(), 55).c_str(), "Decisions between group commits (wal)");
+    outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("commit-interval-ms", commit_interval_ms->get_string(), 55).c_str(), "Milliseconds between group commits (wal)");
+    outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("checkpoint-thread", checkpoint_thread->get_string(), 55).c_str(), "Checkpoint the log on a separate thread (wal)");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("cache-size", cache_size->get_string(), 55).c_str(), "Number of memory pages used for SQLite cache");
+    outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("lti-cache-size", lti_cache_size->get_string(), 55).c_str(), "Number of LTIs cached in memory (0 = off)");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("page-size", page_size->get_string(), 55).c_str(), "Size of each memory page used");
     outputManager->printa(thisAgent, "----------------- Timers and Statistics ---------------\n");
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("timers <detail>", timers->get_string(), 55).c_str(), "How detailed timers should be (use --set)");
@@ -375,8 +447,9 @@ void smem_param_container::print_settings(agent* thisAgent)
         "Timers: smem_api, smem_hash, smem_init, smem_query,\n"
         "        smem_ncb_retrieval, three_activation\n"
         "        smem_storage, _total\n"
-        "Stats:  act_updates, db-lib-version, edges, mem-usage,\n"
-        "        mem-high, nodes, queries, retrieves, stores\n");
+        "Stats:  act_updates, db-lib-version, edges, lti-cache-hits,\n"
+        "        lti-cache-misses, mem-usage, mem-high, nodes,\n"
+        "        overlay-size, queries, retrieves, stores\n");
     outputManager->printa(thisAgent, "-------------------------------------------------------\n\n");
     outputManager->printa_sf(thisAgent, "For a detailed explanation of these settings:  %-%- help smem\n");
 }
@@ -393,7 +466,7 @@ void smem_param_container::print_summary(agent* thisAgent)
     outputManager->printa_sf(thisAgent, "              Semantic Memory Summary\n");
     outputManager->printa(thisAgent,    "====================================================\n");
     outputManager->printa_sf(thisAgent, "%s   %-\n", concatJustified("Enabled",learning->get_string(), 52).c_str());
-    tempString = (database->get_value() == memory) ? "Memory" : "File";
+    tempString = (database->get_value() == memory) ? "Memory" : ((database->get_value() == file) ? "File" : "Shared");
     tempString2 = append_db->get_value() ? "(append after init)" : "(overwrite after init)";
     outputManager->printa_sf(thisAgent, "%s   %-%s\n", concatJustified("Storage", tempString.c_str(), 52).c_str(), tempString2.c_str());
 //    outputManager->printa_sf(thisAgent, "%s   %-\n", concatJustified("database", database->get_string(), 52).c_str());
@@ -17,10 +17,10 @@ class smem_path_param;
 class smem_param_container: public soar_module::param_container
 {
     public:
-        enum db_choices { memory, file };
+        enum db_choices { memory, file, shared };
         enum cache_choices { cache_S, cache_M, cache_L };
         enum page_choices { page_1k, page_2k, page_4k, page_8k, page_16k, page_32k, page_64k };
-        enum opt_choices { opt_safety, opt_speed };
+        enum opt_choices { opt_safety, opt_speed, opt_wal };
         enum act_choices { act_recency, act_frequency, act_base };
 
         soar_module::boolean_param* learning;
@@ -33,7 +33,11 @@ class smem_param_container: public soar_module::param_container
 
         soar_module::constant_param<page_choices>* page_size;
         soar_module::integer_param* cache_size;
+        soar_module::integer_param* lti_cache_size;
         soar_module::constant_param<opt_choices>* opt;
+        soar_module::integer_param* commit_interval;
+        soar_module::integer_param* commit_interval_ms;
+        soar_module::boolean_param* checkpoint_thread;
 
         soar_module::integer_param* thresh;
 
@@ -47,6 +51,7 @@ class smem_param_container: public soar_module::param_container
         soar_module::integer_param* base_unused_age_offset;
 
         soar_module::int_set_param* base_incremental_threshes;
+        soar_module::boolean_param* base_batch;
 
         soar_module::boolean_param* spreading;
         soar_module::integer_param* spreading_limit;
@@ -57,6 +62,7 @@ class smem_param_container: public soar_module::param_container
         soar_module::boolean_param* spreading_edge_updating;
         soar_module::boolean_param* spreading_wma_source;
         soar_module::decimal_param* spreading_edge_update_factor;
+        soar_module::boolean_param* spreading_graph;
         soar_module::boolean_param* base_inhibition;
 
         void print_settings(agent* thisAgent);
@@ -0,0 +1,527 @@
+#include "smem_shared_store.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define SMEM_SHARED_STORE_VFS "soar-smem-shared"
+
+// a knowledge base file, mapped once for all of the connections that open it
+typedef struct smem_shared_base_struct
+{
+    std::string             path;
+    const char*             bytes;
+    sqlite3_int64           size;
+    void*                   mapping;
+    size_t                  mapping_size;
+    std::vector<char>       buffer;
+    bool                    wal_format;     // the header says the file was last used in WAL mode
+    uint64_t                connections;
+} smem_shared_base;
+
+typedef std::unordered_map<sqlite3_int64, char*> smem_shared_page_map;
+
+// a connection's view of a knowledge base: the base with the pages the
+// connection has written laid over it
+typedef struct smem_shared_file_struct
+{
+    sqlite3_file            file;           // must come first
+    smem_shared_base*       base;
+    sqlite3_int64           size;           // size of the database as this connection sees it
+    sqlite3_int64           base_limit;     // base bytes at or past this have been truncated away
+    sqlite3_int64           page_size;
+    smem_shared_page_map*   pages;
+} smem_shared_file;
+
+static std::mutex smem_shared_bases_mutex;
+static std::unordered_map<std::string, smem_shared_base*> smem_shared_bases;
+static sqlite3_vfs smem_shared_vfs;
+static sqlite3_vfs* smem_shared_default_vfs = NULL;
+
+//////////////////////////////////////////////////////////
+// Knowledge bases
+//////////////////////////////////////////////////////////
+
+static smem_shared_base* smem_shared_base_open(const char* path)
+{
+    std::lock_guard<std::mutex> guard(smem_shared_bases_mutex);
+
+    std::unordered_map<std::string, smem_shared_base*>::iterator p = smem_shared_bases.find(path);
+    if (p != smem_shared_bases.end())
+    {
+        p->second->connections++;
+        return p->second;
+    }
+
+    FILE* f = fopen(path, "rb");
+    if (!f)
+    {
+        return NULL;
+    }
+
+    smem_shared_base* base = new smem_shared_base;
+    base->path = path;
+    base->bytes = NULL;
+    base->size = 0;
+    base->mapping = NULL;
+    base->mapping_size = 0;
+    base->connections = 1;
+
+#ifndef _WIN32
+    struct stat st;
+    if ((fstat(fileno(f), &st) == 0) && S_ISREG(st.st_mode) && (st.st_size > 0))
+    {
+        void* mapping = mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fileno(f), 0);
+        if (mapping != MAP_FAILED)
+        {
+            base->mapping = mapping;
+            base->mapping_size = static_cast<size_t>(st.st_size);
+            base->bytes = static_cast<const char*>(mapping);
+            base->size = static_cast<sqlite3_int64>(st.st_size);
+        }
+    }
+#endif
+
+    if (!base->mapping)
+    {
+        /* --- can't map it, so read it in --- */
+        char chunk[65536];
+        size_t n;
+        while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0)
+        {
+            base->buffer.insert(base->buffer.end(), chunk, chunk + n);
+        }
+        if (ferror(f))
+        {
+            fclose(f);
+            delete base;
+            return NULL;
+        }
+        base->bytes = base->buffer.empty() ? NULL : &(base->buffer[0]);
+        base->size = static_cast<sqlite3_int64>(base->buffer.size());
+    }
+
+    // a mapping outlives the descriptor it was made from
+    fclose(f);
+
+    // bytes 18 and 19 of the header are the write and read versions, 2 for WAL
+    base->wal_format = (base->size >= 100) && ((base->bytes[18] == 2) || (base->bytes[19] == 2));
+
+    smem_shared_bases[base->path] = base;
+    return base;
+}
+
+static void smem_shared_base_close(smem_shared_base* base)
+{
+    std::lock_guard<std::mutex> guard(smem_shared_bases_mutex);
+
+    if (--(base->connections) == 0)
+    {
+#ifndef _WIN32
+        if (base->mapping)
+        {
+            munmap(base->mapping, base->mapping_size);
+        }
+#endif
+        smem_shared_bases.erase(base->path);
+        delete base;
+    }
+}
+
+// the page size recorded in the database header, which is what SQLite
+// will read and write in
+static sqlite3_int64 smem_shared_base_page_size(smem_shared_base* base)
+{
+    if (base->size >= 100)
+    {
+        sqlite3_int64 page_size = (static_cast<unsigned char>(base->bytes[16]) << 8) | static_cast<unsigned char>(base->bytes[17]);
+        if (page_size == 1)
+        {
+            return 65536;
+        }
+        if ((page_size >= 512) && ((page_size & (page_size - 1)) == 0))
+        {
+            return page_size;
+        }
+    }
+    return 4096;
+}
+
+// a knowledge base last used in WAL mode has frames still to be
+// checkpointed into it if its -wal file is not empty
+static bool smem_shared_base_has_wal_frames(const char* path)
+{
+    std::string wal_path(path);
+    wal_path.append("-wal");
+
+    FILE* f = fopen(wal_path.c_str(), "rb");
+    if (!f)
+    {
+        return false;
+    }
+    bool frames = (fseek(f, 0, SEEK_END) == 0) && (ftell(f) > 0);
+    fclose(f);
+    return frames;
+}
+
+// connections have no shared memory to keep a WAL index in, so a base
+// built in WAL mode is shown in rollback mode; the base itself is never
+// written, so nothing but this view changes
+static void smem_shared_base_rollback_header(smem_shared_base* base, char* out, sqlite3_int64 offset, sqlite3_int64 n)
+{
+    if (!base->wal_format)
+    {
+        return;
+    }
+    for (sqlite3_int64 i = std::max<sqlite3_int64>(offset, 18); i < std::min<sqlite3_int64>(offset + n, 20); i++)
+    {
+        out[i - offset] = 1;
+    }
+}
+
+//////////////////////////////////////////////////////////
+// Connections (sqlite3_io_methods)
+//////////////////////////////////////////////////////////
+
+// the overlay copy of a page, made from the base on first write
+static char* smem_shared_overlay_page(smem_shared_file* f, sqlite3_int64 page)
+{
+    smem_shared_page_map::iterator p = f->pages->find(page);
+    if (p != f->pages->end())
+    {
+        return p->second;
+    }
+
+    char* data = static_cast<char*>(sqlite3_malloc64(f->page_size));
+    if (!data)
+    {
+        return NULL;
+    }
+
+    sqlite3_int64 start = page * f->page_size;
+    sqlite3_int64 from_base = std::max<sqlite3_int64>(0, std::min<sqlite3_int64>(f->page_size, f->base_limit - start));
+    if (from_base > 0)
+    {
+        memcpy(data, f->base->bytes + start, static_cast<size_t>(from_base));
+        smem_shared_base_rollback_header(f->base, data, start, from_base);
+    }
+    memset(data + from_base, 0, static_cast<size_t>(f->page_size - from_base));
+
+    (*f->pages)[page] = data;
+    return data;
+}
+
+static int smem_shared_close(sqlite3_file* file)
+{
+    smem_shared_file* f = reinterpret_cast<smem_shared_file*>(file);
+
+    for (smem_shared_page_map::iterator p = f->pages->begin(); p != f->pages->end(); p++)
+    {
+        sqlite3_free(p->second);
+    }
+    delete f->pages;
+    f->pages = NULL;
+
+    smem_shared_base_close(f->base);
+    f->base = NULL;
+
+    return SQLITE_OK;
+}
+
+static int smem_shared_read(sqlite3_file* file, void* buffer, int amount, sqlite3_int64 offset)
+{
+    smem_shared_file* f = reinterpret_cast<smem_shared_file*>(file);
+    char* out = static_cast<char*>(buffer);
+
+    // as with a real file, bytes past the end read as zeros
+    int rc = ((offset + amount) > f->size) ? SQLITE_IOERR_SHORT_READ : SQLITE_OK;
+
+    while (amount > 0)
+    {
+        sqlite3_int64 page = offset / f->page_size;
+        sqlite3_int64 within = offset % f->page_size;
+        int n = static_cast<int>(std::min<sqlite3_int64>(amount, f->page_size - within));
+
+        smem_shared_page_map::iterator p = f->pages->find(page);
+        if (p != f->pages->end())
+        {
+            memcpy(out, p->second + within, n);
+        }
+        else
+        {
+            sqlite3_int64 from_base = std::max<sqlite3_int64>(0, std::min<sqlite3_int64>(n, f->base_limit - offset));
+            if (from_base > 0)
+            {
+                memcpy(out, f->base->bytes + offset, static_cast<size_t>(from_base));
+                smem_shared_base_rollback_header(f->base, out, offset, from_base);
+            }
+            memset(out + from_base, 0, static_cast<size_t>(n - from_base));
+        }
+
+        out += n;
+        offset += n;
+        amount -= n;
+    }
+
+    return rc;
+}
+
+static int smem_shared_write(sqlite3_file* file, const void* buffer, int amount, sqlite3_int64 offset)
+{
+    smem_shared_file* f = reinterpret_cast<smem_shared_file*>(file);
+    const char* in = static_cast<const char*>(buffer);
+    sqlite3_int64 end = offset + amount;
+
+    while (amount > 0)
+    {
+        sqlite3_int64 page = offset / f->page_size;
+        sqlite3_int64 within = offset % f->page_size;
+        int n = static_cast<int>(std::min<sqlite3_int64>(amount, f->page_size - within));
+
+        char* data = smem_shared_overlay_page(f, page);
+        if (!data)
+        {
+            return SQLITE_IOERR_NOMEM;
+        }
+        memcpy(data + within, in, n);
+
+        in += n;
+        offset += n;
+        amount -= n;
+    }
+
+    if (end > f->size)
+    {
+        f->size = end;
+    }
+
+    return SQLITE_OK;
+}
+
+static int smem_shared_truncate(sqlite3_file* file, sqlite3_int64 size)
+{
+    smem_shared_file* f = reinterpret_cast<smem_shared_file*>(file);
+
+    f->size = size;
+    f->base_limit = std::min(f->base_limit, size);
+
+    // drop the pages past the end, and clear the tail of the last one, so
+    // that growing the file again reads zeros there
+    for (smem_shared_page_map::iterator p = f->pages->begin(); p != f->pages->end();)
+    {
+        sqlite3_int64 start = p->first * f->page_size;
+        if (start >= size)
+        {
+            sqlite3_free(p->second);
+            p = f->pages->erase(p);
+        }
+        else
+        {
+            if ((start + f->page_size) > size)
+            {
+                memset(p->second + (size - start), 0, static_cast<size_t>(start + f->page_size - size));
+            }
+            p++;
+        }
+    }
+
+    return SQLITE_OK;
+}
+
+static int smem_shared_sync(sqlite3_file* /*file*/, int /*flags*/)
+{
+    return SQLITE_OK;
+}
+
+static int smem_shared_file_size(sqlite3_file* file, sqlite3_int64* size)
+{
+    *size = reinterpret_cast<smem_shared_file*>(file)->size;
+    return SQLITE_OK;
+}
+
+// the overlay is private to its connection, so there is nothing to lock
+static int smem_shared_lock(sqlite3_file* /*file*/, int /*lock*/)
+{
+    return SQLITE_OK;
+}
+
+static int smem_shared_check_reserved_lock(sqlite3_file* /*file*/, int* reserved)
+{
+    *reserved = 0;
+    return SQLITE_OK;
+}
+
+static int smem_shared_file_control(sqlite3_file* /*file*/, int /*op*/, void* /*arg*/)
+{
+    return SQLITE_NOTFOUND;
+}
+
+static int smem_shared_sector_size(sqlite3_file* /*file*/)
+{
+    return 4096;
+}
+
+static int smem_shared_device_characteristics(sqlite3_file* /*file*/)
+{
+    return 0;
+}
+
+static const sqlite3_io_methods smem_shared_io_methods =
+{
+    1,
+    smem_shared_close,
+    smem_shared_read,
+    smem_shared_write,
+    smem_shared_truncate,
+    smem_shared_sync,
+    smem_shared_file_size,
+    smem_shared_lock,
+    smem_shared_lock,
+    smem_shared_check_reserved_lock,
+    smem_shared_file_control,
+    smem_shared_sector_size,
+    smem_shared_device_characteristics,
+    // version 2 and 3 methods (shared memory, memory-mapped reads)
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL
+};
+
+//////////////////////////////////////////////////////////
+// The VFS
+//////////////////////////////////////////////////////////
+
+static int smem_shared_vfs_open(sqlite3_vfs* /*vfs*/, const char* name, sqlite3_file* file, int flags, int* out_flags)
+{
+    file->pMethods = NULL;
+
+    if (!(flags & SQLITE_OPEN_MAIN_DB) || !name)
+    {
+        // nothing is ever written next to a knowledge base: connections
+        // journal in memory, and only temporary files go to the default VFS
+        if (flags & (SQLITE_OPEN_MAIN_JOURNAL | SQLITE_OPEN_MASTER_JOURNAL | SQLITE_OPEN_WAL))
+        {
+            return SQLITE_CANTOPEN;
+        }
+        return smem_shared_default_vfs->xOpen(smem_shared_default_vfs, name, file, flags, out_flags);
+    }
+
+    smem_shared_file* f = reinterpret_cast<smem_shared_file*>(file);
+    f->base = smem_shared_base_open(name);
+    if (!f->base)
+    {
+        return SQLITE_CANTOPEN;
+    }
+    if (f->base->wal_format && smem_shared_base_has_wal_frames(name))
+    {
+        smem_shared_base_close(f->base);
+        f->base = NULL;
+        return SQLITE_CANTOPEN;
+    }
+    f->size = f->base->size;
+    f->base_limit = f->base->size;
+    f->page_size = smem_shared_base_page_size(f->base);
+    f->pages = new smem_shared_page_map();
+    f->file.pMethods = &smem_shared_io_methods;
+
+    if (out_flags)
+    {
+        *out_flags = flags;
+    }
+    return SQLITE_OK;
+}
+
+static int smem_shared_vfs_delete(sqlite3_vfs* /*vfs*/, const char* /*name*/, int /*sync_dir*/)
+{
+    return SQLITE_OK;
+}
+
+// there are never journals to find, so a stale one left next to the
+// knowledge base is not mistaken for a hot journal
+static int smem_shared_vfs_access(sqlite3_vfs* /*vfs*/, const char* /*name*/, int /*flags*/, int* result)
+{
+    *result = 0;
+    return SQLITE_OK;
+}
+
+static int smem_shared_vfs_full_pathname(sqlite3_vfs* /*vfs*/, const char* name, int size, char* out)
+{
+    return smem_shared_default_vfs->xFullPathname(smem_shared_default_vfs, name, size, out);
+}
+
+static int smem_shared_vfs_randomness(sqlite3_vfs* /*vfs*/, int size, char* out)
+{
+    return smem_shared_default_vfs->xRandomness(smem_shared_default_vfs, size, out);
+}
+
+static int smem_shared_vfs_sleep(sqlite3_vfs* /*vfs*/, int microseconds)
+{
+    return smem_shared_default_vfs->xSleep(smem_shared_default_vfs, microseconds);
+}
+
+static int smem_shared_vfs_current_time(sqlite3_vfs* /*vfs*/, double* now)
+{
+    return smem_shared_default_vfs->xCurrentTime(smem_shared_default_vfs, now);
+}
+
+static int smem_shared_vfs_get_last_error(sqlite3_vfs* /*vfs*/, int size, char* out)
+{
+    return smem_shared_default_vfs->xGetLastError(smem_shared_default_vfs, size, out);
+}
+
+const char* smem_shared_store_vfs()
+{
+    std::lock_guard<std::mutex> guard(smem_shared_bases_mutex);
+
+    if (!smem_shared_default_vfs)
+    {
+        smem_shared_default_vfs = sqlite3_vfs_find(NULL);
+
+        memset(&smem_shared_vfs, 0, sizeof(smem_shared_vfs));
+        smem_shared_vfs.iVersion = 1;
+        smem_shared_vfs.szOsFile = std::max(static_cast<int>(sizeof(smem_shared_file)), smem_shared_default_vfs->szOsFile);
+        smem_shared_vfs.mxPathname = smem_shared_default_vfs->mxPathname;
+        smem_shared_vfs.zName = SMEM_SHARED_STORE_VFS;
+        smem_shared_vfs.xOpen = smem_shared_vfs_open;
+        smem_shared_vfs.xDelete = smem_shared_vfs_delete;
+        smem_shared_vfs.xAccess = smem_shared_vfs_access;
+        smem_shared_vfs.xFullPathname = smem_shared_vfs_full_pathname;
+        smem_shared_vfs.xRandomness = smem_shared_vfs_randomness;
+        smem_shared_vfs.xSleep = smem_shared_vfs_sleep;
+        smem_shared_vfs.xCurrentTime = smem_shared_vfs_current_time;
+        smem_shared_vfs.xGetLastError = smem_shared_vfs_get_last_error;
+
+        sqlite3_vfs_register(&smem_shared_vfs, 0);
+    }
+
+    return SMEM_SHARED_STORE_VFS;
+}
+
+bool smem_shared_store_has_wal_frames(const char* path)
+{
+    return smem_shared_base_has_wal_frames(path);
+}
+
+uint64_t smem_shared_store_overlay_size(sqlite3* db)
+{
+    sqlite3_file* file = NULL;
+    if ((sqlite3_file_control(db, "main", SQLITE_FCNTL_FILE_POINTER, &file) != SQLITE_OK) || !file || (file->pMethods != &smem_shared_io_methods))
+    {
+        return 0;
+    }
+
+    smem_shared_file* f = reinterpret_cast<smem_shared_file*>(file);
+    return static_cast<uint64_t>(f->pages->size()) * static_cast<uint64_t>(f->page_size);
+}
@@ -0,0 +1,48 @@
+/*************************************************************************
+ * PLEASE SEE THE FILE "COPYING" (INCLUDED WITH THIS SOFTWARE PACKAGE)
+ * FOR LICENSE AND COPYRIGHT INFORMATION.
+ *************************************************************************/
+
+/*************************************************************************
+ *
+ *  file:  smem_shared_store.h
+ *
+ * =======================================================================
+ *
+ * Read-mostly semantic memory shared by the agents of one process.
+ *
+ * With database set to shared, an agent opens the knowledge base at its
+ * path through the SQLite VFS defined here instead of the default one.
+ * The file is mapped into memory once per process, however many agents
+ * open it, and is never written.  Each connection gets a private
+ * overlay: pages SQLite writes (the agent's own stores, activation and
+ * history updates) are kept in memory and read back in place of the
+ * base's.  Queries thus see the knowledge base and the agent's changes
+ * as one database, and an agent's memory costs its overlay and page
+ * cache rather than a copy of the knowledge base.  The overlay is
+ * dropped when the agent's connection closes.
+ *
+ * The knowledge base must not be changed while agents share it.  One
+ * built in WAL mode can be shared once it has been checkpointed, that
+ * is, once its -wal file is gone or empty.
+ *
+ * =======================================================================
+ */
+
+#ifndef SMEM_SHARED_STORE_H
+#define SMEM_SHARED_STORE_H
+
+#include "kernel.h"
+#include "sqlite3.h"
+
+// name of the VFS to open a shared knowledge base with (registered on first use)
+const char* smem_shared_store_vfs();
+
+// whether the knowledge base at path has WAL frames not yet checkpointed
+// into it, which keeps it from being shared
+bool smem_shared_store_has_wal_frames(const char* path);
+
+// bytes held by the overlay of a connection opened with smem_shared_store_vfs
+uint64_t smem_shared_store_overlay_size(sqlite3* db);
+
+#endif // SMEM_SHARED_STORE_H
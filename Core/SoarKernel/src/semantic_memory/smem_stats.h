@@ -16,6 +16,9 @@ class smem_stat_container: public soar_module::stat_container
         smem_db_lib_version_stat* db_lib_version;
         smem_mem_usage_stat* mem_usage;
         smem_mem_high_stat* mem_high;
+        smem_overlay_size_stat* overlay_size;
+        smem_group_commit_stat* commits;
+        smem_group_commit_stat* checkpoints;
 
         soar_module::integer_stat* retrievals;
         soar_module::integer_stat* queries;
@@ -23,6 +26,9 @@ class smem_stat_container: public soar_module::stat_container
         soar_module::integer_stat* act_updates;
         soar_module::integer_stat* trajectories_total;
 
+        soar_module::integer_stat* lti_cache_hits;
+        soar_module::integer_stat* lti_cache_misses;
+
         soar_module::integer_stat* nodes;
         soar_module::integer_stat* edges;
 
@@ -59,4 +65,25 @@ class smem_mem_high_stat: public soar_module::integer_stat
         int64_t get_value();
 };
 
+class smem_overlay_size_stat: public soar_module::integer_stat
+{
+    protected:
+        agent* thisAgent;
+
+    public:
+        smem_overlay_size_stat(agent* new_agent, const char* new_name, int64_t new_value, soar_module::predicate<int64_t>* new_prot_pred);
+        int64_t get_value();
+};
+
+class smem_group_commit_stat: public soar_module::integer_stat
+{
+    protected:
+        agent* thisAgent;
+        bool count_checkpoints;
+
+    public:
+        smem_group_commit_stat(agent* new_agent, const char* new_name, bool new_count_checkpoints, soar_module::predicate<int64_t>* new_prot_pred);
+        int64_t get_value();
+};
+
 #endif /* CORE_SOARKERNEL_SRC_SEMANTIC_MEMORY_SMEM_STATS_H_ */
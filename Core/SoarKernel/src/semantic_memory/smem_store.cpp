@@ -177,6 +177,8 @@ void SMem_Manager::disconnect_ltm(uint64_t pLTI_ID, std::map<uint64_t, uint64_t>
     {
         SQL->web_truncate->bind_int(1, pLTI_ID);
         SQL->web_truncate->execute(soar_module::op_reinit);
+        invalidate_lti_augmentations(pLTI_ID);
+        invalidate_lti_graph_row(pLTI_ID);
     }
 }
 
@@ -215,12 +217,7 @@ void SMem_Manager::LTM_to_DB(uint64_t pLTI_ID, ltm_slot_map* children, bool remo
     }
     else
     {
-        SQL->act_lti_child_ct_get->bind_int(1, pLTI_ID);
-        SQL->act_lti_child_ct_get->execute();
-
-        existing_edges = static_cast<uint64_t>(SQL->act_lti_child_ct_get->column_int(0));
-
-        SQL->act_lti_child_ct_get->reinitialize();
+        existing_edges = get_lti_child_ct(pLTI_ID);
 
         //
 
@@ -426,9 +423,7 @@ void SMem_Manager::LTM_to_DB(uint64_t pLTI_ID, ltm_slot_map* children, bool remo
 
     // update edge counter
     {
-        SQL->act_lti_child_ct_set->bind_int(1, new_edges);
-        SQL->act_lti_child_ct_set->bind_int(2, pLTI_ID);
-        SQL->act_lti_child_ct_set->execute(soar_module::op_reinit);
+        set_lti_child_ct(pLTI_ID, new_edges);
     }
     {
         SQL->act_lti_child_lti_ct_set->bind_int(1, new_lti_edges);
@@ -459,6 +454,9 @@ void SMem_Manager::LTM_to_DB(uint64_t pLTI_ID, ltm_slot_map* children, bool remo
 
     // insert new edges, update counters
     {
+        invalidate_lti_augmentations(pLTI_ID);
+        invalidate_lti_graph_row(pLTI_ID);
+
         // attr/const pairs
         {
             for (std::set< std::pair< smem_hash_id, smem_hash_id > >::iterator p = const_new.begin(); p != const_new.end(); p++)
@@ -94,6 +94,29 @@ typedef struct smem_edge_update_struct
 
 typedef std::unordered_map<uint64_t, std::list<smem_edge_update*>> smem_update_map;
 
+/* An LTI's base-level activation at time_now, for lti_calc_base_batch */
+typedef struct smem_base_level_query_struct
+{
+    uint64_t                lti_id;
+    int64_t                 time_now;
+    uint64_t                n;                  // activations_total (0 = look it up)
+    uint64_t                activations_first;
+    double                  activation;         // result
+} smem_base_level_query;
+
+/* What a bulk import has written to an LTI, for the rebuild at the end */
+typedef struct smem_import_lti_struct
+{
+    bool lti_edges;         // imported LTI-valued augmentations
+    bool edge_weights;      // some of which came with an explicit edge weight
+} smem_import_lti;
+
+typedef struct smem_import_state_struct
+{
+    std::unordered_map<uint64_t, smem_import_lti> ltis;
+    uint64_t augmentations;
+} smem_import_state;
+
 typedef union ltm_value_union
 {
     struct ltm_value_const       val_const;
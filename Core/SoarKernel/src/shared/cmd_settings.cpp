@@ -123,7 +123,7 @@ void load_param_container::print_settings(agent* thisAgent)
     outputManager->printa_sf(thisAgent, "load %-[? | help]\n");
     outputManager->printa(thisAgent,    "------------------------------------------------------------\n");
     outputManager->printa_sf(thisAgent, "load file %-[--all --disable] %-<filename>\n");
-    outputManager->printa_sf(thisAgent, "load file %-[--verbose]     ]\n");
+    outputManager->printa_sf(thisAgent, "load file %-[--verbose --bulk]\n");
     outputManager->printa(thisAgent,    "------------------------------------------------------------\n");
     outputManager->printa_sf(thisAgent, "load library %-<filename> <args...>\n");
     outputManager->printa(thisAgent,    "------------------------------------------------------------\n");
@@ -191,6 +191,8 @@ production_param_container::production_param_container(agent* new_agent): soar_m
     add(firing_counts_cmd);
     matches_cmd = new soar_module::boolean_param("matches", on, new soar_module::f_predicate<boolean>());
     add(matches_cmd);
+    match_profile_cmd = new soar_module::boolean_param("match-profile", on, new soar_module::f_predicate<boolean>());
+    add(match_profile_cmd);
     memories_cmd = new soar_module::boolean_param("memory-usage", on, new soar_module::f_predicate<boolean>());
     add(memories_cmd);
     multi_attributes_cmd = new soar_module::boolean_param("optimize-attribute", on, new soar_module::f_predicate<boolean>());
@@ -243,6 +245,10 @@ void production_param_container::print_settings(agent* thisAgent)
     outputManager->printa_sf(thisAgent, "production matches %-[--names --count  ] [--assertions ]\n");
     outputManager->printa_sf(thisAgent, "                   %-[--timetags --wmes] [--retractions]\n");
     outputManager->printa(thisAgent,    "------------------------------------------------------------------\n");
+    outputManager->printa_sf(thisAgent, "production match-profile %-[--enable --disable --reset]\n");
+    outputManager->printa_sf(thisAgent, "production match-profile %-[n]\n");
+    outputManager->printa_sf(thisAgent, "production match-profile %-<prod-name>\n");
+    outputManager->printa(thisAgent,    "------------------------------------------------------------------\n");
     outputManager->printa_sf(thisAgent, "production memory-usage   %-[options] [max] %-\n");
     outputManager->printa_sf(thisAgent, "production memory-usage   %-<production_name> %-\n");
     outputManager->printa(thisAgent,    "------------------------------------------------------------------\n");
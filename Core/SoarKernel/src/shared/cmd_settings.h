@@ -57,6 +57,7 @@ class production_param_container: public soar_module::param_container
         soar_module::boolean_param* excise_cmd;
         soar_module::boolean_param* firing_counts_cmd;
         soar_module::boolean_param* matches_cmd;
+        soar_module::boolean_param* match_profile_cmd;
         soar_module::boolean_param* memories_cmd;
         soar_module::boolean_param* multi_attributes_cmd;
         soar_module::boolean_param* break_cmd;
@@ -511,7 +511,7 @@ enum epmem_variable_key
 {
     var_rit_offset_1, var_rit_leftroot_1, var_rit_rightroot_1, var_rit_minstep_1,
     var_rit_offset_2, var_rit_leftroot_2, var_rit_rightroot_2, var_rit_minstep_2,
-    var_next_id
+    var_next_id, var_retention_floor, var_index_stamp
 };
 
 enum smem_query_levels { qry_search, qry_full };
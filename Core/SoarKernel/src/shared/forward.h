@@ -55,6 +55,7 @@ class soar_timer;
 class Soar_Instance;
 class Memory_Manager;
 class Symbol_Manager;
+class Symbol_Table;
 
 class SoarDecider;
 class WM_Manager;
@@ -111,8 +112,10 @@ class rl_stat_container;
 class SMem_Manager;
 class MathQuery;
 class smem_db_lib_version_stat;
+class smem_group_commit_stat;
 class smem_mem_high_stat;
 class smem_mem_usage_stat;
+class smem_overlay_size_stat;
 class smem_param_container;
 class smem_path_param;
 class smem_stat_container;
@@ -137,6 +140,7 @@ namespace sml
 
 namespace soar_module {
     class sqlite_database;
+    class sqlite_group_commit;
     class sqlite_statement;
     class timer;
 }
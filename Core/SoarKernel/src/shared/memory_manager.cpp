@@ -7,8 +7,10 @@
 #include "sml_Names.h"
 #include "stats.h"
 
+#include <algorithm>
 #include <iostream>
 #include <stdlib.h>
+#include <vector>
 
 /* ====================================================================
 
@@ -39,8 +41,29 @@
    number, must be prime */
 #define DEFAULT_BLOCK_SIZE 0x7FF0   /* about 32K bytes per block */
 
+/* The MPM that pool allocators created on this thread should use */
+static thread_local Memory_Manager* tCurrentMPM = NULL;
+
+Memory_Manager& Memory_Manager::Get_Current_MPM()
+{
+    return tCurrentMPM ? *tCurrentMPM : Get_MPM();
+}
+
+Memory_Manager::thread_scope::thread_scope(Memory_Manager* pMM)
+{
+    m_previous = tCurrentMPM;
+    tCurrentMPM = pMM;
+}
+
+Memory_Manager::thread_scope::~thread_scope()
+{
+    tCurrentMPM = m_previous;
+}
+
 Memory_Manager::Memory_Manager()
 {
+    m_thread_safe = false;
+    memory_pools_in_use = NIL;
     memory_for_usage_overhead = memory_for_usage + STATS_OVERHEAD_MEM_USAGE;
 
     for (int i = 0; i < NUM_MEM_USAGE_CODES; i++)
@@ -117,6 +140,7 @@ void Memory_Manager::init_memory_pool(MemoryPoolType mempool_index, size_t item_
 
 memory_pool* Memory_Manager::get_memory_pool(size_t size)
 {
+    pool_lock lock(this);
     memory_pool* return_val = NULL;
 
     std::unordered_map< size_t, memory_pool* >::iterator it = dyn_memory_pools.find(size);
@@ -160,6 +184,117 @@ void Memory_Manager::free_memory_pool(MemoryPoolType mempool_index)
     free_memory_pool_by_ptr(&(memory_pools[mempool_index]));
 }
 
+/* Returns the index of the block in the sorted blocks vector that holds pItem,
+ * or blocks.size() if none of them does */
+static size_t find_pool_block(std::vector<char*>& blocks, size_t block_size, void* pItem)
+{
+    char* lItem = static_cast<char*>(pItem);
+    std::vector<char*>::iterator it = std::upper_bound(blocks.begin(), blocks.end(), lItem);
+    if (it == blocks.begin() || lItem >= *(it - 1) + block_size)
+    {
+        return blocks.size();
+    }
+    return (it - blocks.begin()) - 1;
+}
+
+/* Blocks are only released when every item in them is on the free list, so
+ * this is safe to call at any time.  It walks each pool's free list, counts
+ * the free items in every block, then rebuilds the free list and block chain
+ * without the blocks that are completely unused.  Items that don't belong to
+ * any of the pool's blocks are left on the free list. */
+size_t Memory_Manager::release_unused_blocks_by_ptr(memory_pool* pThisPool)
+{
+#if MEM_POOLS_ENABLED
+    if (pThisPool->num_blocks == 0)
+    {
+        return 0;
+    }
+
+    size_t block_size = pThisPool->item_size * pThisPool->items_per_block + sizeof(char*);
+    std::vector<char*> blocks;
+    blocks.reserve(pThisPool->num_blocks);
+    char* cur_block = static_cast<char*>(pThisPool->first_block);
+    for (size_t i = 0; i < pThisPool->num_blocks; i++)
+    {
+        blocks.push_back(cur_block);
+        cur_block = *(char**)cur_block;
+    }
+    std::sort(blocks.begin(), blocks.end());
+
+    std::vector<size_t> free_items(blocks.size(), 0);
+    for (void* item = pThisPool->free_list; item != NIL; item = *(void**)item)
+    {
+        size_t lBlock = find_pool_block(blocks, block_size, item);
+        if (lBlock < blocks.size())
+        {
+            free_items[lBlock]++;
+        }
+    }
+
+    bool found_unused = false;
+    for (size_t i = 0; i < blocks.size(); i++)
+    {
+        if (free_items[i] == pThisPool->items_per_block)
+        {
+            found_unused = true;
+            break;
+        }
+    }
+    if (!found_unused)
+    {
+        return 0;
+    }
+
+    /* Drop the items of unused blocks from the free list, keeping the rest in order */
+    void** tail = &(pThisPool->free_list);
+    void* next_item;
+    for (void* item = pThisPool->free_list; item != NIL; item = next_item)
+    {
+        next_item = *(void**)item;
+        size_t lBlock = find_pool_block(blocks, block_size, item);
+        if ((lBlock == blocks.size()) || (free_items[lBlock] != pThisPool->items_per_block))
+        {
+            *tail = item;
+            tail = (void**)item;
+        }
+    }
+    *tail = NIL;
+
+    size_t released = 0;
+    pThisPool->first_block = NIL;
+    pThisPool->num_blocks = 0;
+    for (size_t i = 0; i < blocks.size(); i++)
+    {
+        if (free_items[i] == pThisPool->items_per_block)
+        {
+            free_memory(blocks[i], POOL_MEM_USAGE);
+            released += block_size;
+        }
+        else
+        {
+            *(char**)blocks[i] = static_cast<char*>(pThisPool->first_block);
+            pThisPool->first_block = blocks[i];
+            pThisPool->num_blocks++;
+        }
+    }
+    return released;
+#else
+    return 0;
+#endif
+}
+
+size_t Memory_Manager::release_unused_blocks()
+{
+    pool_lock lock(this);
+    size_t released = 0;
+
+    for (memory_pool* p = memory_pools_in_use; p != NIL; p = p->next)
+    {
+        released += release_unused_blocks_by_ptr(p);
+    }
+    return released;
+}
+
 /* This is only called by the CLI DoAllocate command */
 bool Memory_Manager::add_block_to_memory_pool_by_name(const std::string& pool_name, int blocks)
 {
@@ -185,6 +320,7 @@ bool Memory_Manager::add_block_to_memory_pool_by_name(const std::string& pool_na
 
 void Memory_Manager::add_block_to_memory_pool(memory_pool* pThisPool)
 {
+    pool_lock lock(this);
     char* new_block;
     size_t size, i, item_num, interleave_factor;
     char* item, *prev_item;
@@ -258,6 +394,7 @@ thisAgent->Decider->settings[DECIDER_MAX_MEMORY_USAGE]);
 
 void* Memory_Manager::allocate_memory(size_t size, int usage_code)
 {
+    pool_lock lock(this);
     char* p;
 
     memory_for_usage[usage_code] += size;
@@ -299,6 +436,7 @@ void* Memory_Manager::allocate_memory_and_zerofill(size_t size, int usage_code)
 
 void Memory_Manager::free_memory(void* mem, int usage_code)
 {
+    pool_lock lock(this);
     size_t size;
 
     if (mem == 0)
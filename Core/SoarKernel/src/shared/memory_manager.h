@@ -10,19 +10,31 @@
  * A memory manager class that decouples memory pools from the individual
  * agent.
  *
- * - MPM is a singleton like the OutputManager and SoarInstance.  It
- *   is created on Kernel creation.
+ * - Each agent owns its own MPM, created with the agent and deleted
+ *   after everything else in the agent has been released, so all of
+ *   the agent's pool blocks go back to the OS when it is destroyed.
+ *   Agents never share pool free lists, so they can run on different
+ *   threads without locking.
+ *
+ * - There is also a shared MPM singleton (Get_MPM).  It backs STL
+ *   containers that are created outside of any agent.
+ *
+ * - The STL pool allocators bind to the calling thread's current MPM
+ *   (Get_Current_MPM) when they are constructed.  Code that works on an
+ *   agent sets the current MPM with a thread_scope object.  Without
+ *   one, the allocators fall back to the shared MPM.  Two allocators
+ *   compare equal only if they use the same MPM, so containers that
+ *   belong to different MPMs never share nodes: move assignment copies
+ *   between them and list splices go through soar_module::splice_all.
  *
  * - MPM uses an enum list for all the core memory pool types.  Kernel
  *   calls that deal with memory pools now pass in a parameter to
- *   specify which pool instead of the actual pool itself (which was
- *   in the agent, but is now in the MPM)
+ *   specify which pool instead of the actual pool itself.
  *
- * - Memory pools now have an initialized flag, since more than one
- *   agent may try to initialize a pool.
+ * - Memory pools have an initialized flag, since a pool may be
+ *   initialized more than once.
  *
- * - Agent caches a pointer to MPM to ease access.  Also made
- *   refactoring slightly less painful.
+ * - Agent caches a pointer to its MPM to ease access.
  *
  * =======================================================================
  */
@@ -32,6 +44,7 @@
 
 #include "kernel.h"
 
+#include <mutex>
 #include <unordered_map>
 
 #ifndef _WIN32
@@ -119,11 +132,27 @@ class Memory_Manager
         friend class cli::CommandLineInterface;
 
     public:
+        /* The MPM shared by code that is not working on behalf of an agent */
         static Memory_Manager& Get_MPM()
         {
             static Memory_Manager instance;
             return instance;
         }
+
+        /* The MPM set by the innermost thread_scope on this thread, or the shared one */
+        static Memory_Manager& Get_Current_MPM();
+
+        /* Makes pMM the current MPM of the calling thread until the scope ends */
+        class thread_scope
+        {
+            public:
+                thread_scope(Memory_Manager* pMM);
+                ~thread_scope();
+            private:
+                Memory_Manager* m_previous;
+        };
+
+        Memory_Manager();
         virtual ~Memory_Manager();
 
         void init_memory_pool(MemoryPoolType mempool_index, size_t item_size, const char* name);
@@ -138,16 +167,24 @@ class Memory_Manager
         void* allocate_memory_and_zerofill(size_t size, int usage_code);
         void free_memory(void* mem, int usage_code);
 
+        /* Gives back every pool block whose items are all free.  Returns bytes released. */
+        size_t release_unused_blocks();
+
         void print_memory_statistics();
         void debug_print_memory_stats(agent* thisAgent);
 
+        /* While the run scheduler is stepping agents on several threads at once,
+         * it turns on thread-safe mode for the shared MPM so that pool and
+         * allocation bookkeeping is serialized.  It costs one well-predicted
+         * branch when off. */
+        void set_thread_safe(bool pEnabled) { m_thread_safe = pEnabled; }
+        bool is_thread_safe() { return m_thread_safe; }
+
         std::unordered_map< size_t, memory_pool* >   dyn_memory_pools;
 
     private:
 
-        Memory_Manager();
-
-        /* The following two functions are declared but not implemented to avoid copies of singletons */
+        /* The following two functions are declared but not implemented to avoid copies */
         Memory_Manager(Memory_Manager const&) {};
         void operator=(Memory_Manager const&) {};
 
@@ -157,11 +194,33 @@ class Memory_Manager
         size_t*             memory_for_usage_overhead;
 
         void free_memory_pool_by_ptr(memory_pool* pThisPool);
+        size_t release_unused_blocks_by_ptr(memory_pool* pThisPool);
+
+        bool                    m_thread_safe;
+        std::recursive_mutex    m_pool_mutex;
+
+        /* Holds m_pool_mutex for the life of the object, but only if thread-safe
+         * mode was on when it was created */
+        class pool_lock
+        {
+            public:
+                pool_lock(Memory_Manager* pMM) : m_mutex(pMM->m_thread_safe ? &pMM->m_pool_mutex : NULL)
+                {
+                    if (m_mutex) m_mutex->lock();
+                }
+                ~pool_lock()
+                {
+                    if (m_mutex) m_mutex->unlock();
+                }
+            private:
+                std::recursive_mutex* m_mutex;
+        };
 
     public:
         template <typename T>
         inline void allocate_with_pool(MemoryPoolType mempool_index, T** dest_item_pointer)
         {
+            pool_lock lock(this);
             memory_pool* lThisPool = &(memory_pools[mempool_index]);
 
         #if MEM_POOLS_ENABLED
@@ -199,6 +258,7 @@ class Memory_Manager
         template <typename T>
         inline void allocate_with_pool_ptr(memory_pool* pThisPool, T** dest_item_pointer)
         {
+            pool_lock lock(this);
 
         #if MEM_POOLS_ENABLED
             // if there's no memory blocks left in the pool, then allocate a new one
@@ -235,6 +295,7 @@ class Memory_Manager
         template <typename T>
         inline void free_with_pool(MemoryPoolType mempool_index, T* item)
         {
+            pool_lock lock(this);
             memory_pool* lThisPool = &(memory_pools[mempool_index]);
             fill_with_garbage((item), lThisPool->item_size);
 //            fill_with_zeroes((item), lThisPool->item_size);
@@ -257,6 +318,7 @@ class Memory_Manager
         template <typename T>
         inline void free_with_pool_ptr(memory_pool* pThisPool, T* item)
         {
+            pool_lock lock(this);
             fill_with_garbage((item), pThisPool->item_size);
 //            fill_with_zeroes((item), pThisPool->item_size);
         #if MEM_POOLS_ENABLED
@@ -25,6 +25,7 @@
 #include <assert.h>
 #include <cmath>
 #include <iostream>
+#include <type_traits>
 
 // separates this functionality
 // just for Soar modules
@@ -54,7 +55,7 @@ namespace soar_module
         public:
             soar_memory_pool_allocator() : mem_pool(NULL), memory_manager(NULL)
         {
-                memory_manager = &(Memory_Manager::Get_MPM());
+                memory_manager = &(Memory_Manager::Get_Current_MPM());
                 mem_pool = memory_manager->get_memory_pool(sizeof(value_type));
         }
 
@@ -62,7 +63,7 @@ namespace soar_module
             {
                 // useful for debugging
                 // std::string temp_this( typeid( value_type ).name() );
-                memory_manager = &(Memory_Manager::Get_MPM());
+                memory_manager = &(Memory_Manager::Get_Current_MPM());
                 mem_pool = memory_manager->get_memory_pool(sizeof(value_type));
             }
 
@@ -70,7 +71,7 @@ namespace soar_module
             {
                 // useful for debugging
                 // std::string temp_this( typeid( value_type ).name() );
-                memory_manager = &(Memory_Manager::Get_MPM());
+                memory_manager = obj.get_memory_manager();
                 mem_pool = memory_manager->get_memory_pool(sizeof(value_type));
             }
 
@@ -80,7 +81,7 @@ namespace soar_module
                     // useful for debugging
                     // std::string temp_this( typeid( T ).name() );
                     // std::string temp_other( typeid( _other ).name() );
-                    memory_manager = &(Memory_Manager::Get_MPM());
+                    memory_manager = other.get_memory_manager();
                     mem_pool = memory_manager->get_memory_pool(sizeof(value_type));
             }
 
@@ -136,6 +137,19 @@ namespace soar_module
                     typedef soar_memory_pool_allocator<U> other;
             };
 
+            // Containers keep using the memory manager they were created with.
+            // Move-assigning one into a container with a different manager (i.e.
+            // another agent's) copies the elements into the destination's pools
+            // instead of adopting the source's manager.  Swapping takes the
+            // allocators along with the nodes, which is safe either way.
+            typedef std::false_type propagate_on_container_move_assignment;
+            typedef std::true_type propagate_on_container_swap;
+
+            Memory_Manager* get_memory_manager() const
+            {
+                return memory_manager;
+            }
+
 
         private:
             //            agent* thisAgent;
@@ -161,7 +175,7 @@ namespace soar_module
         public:
             soar_memory_pool_allocator_n() : mem_pool(NULL), memory_manager(NULL)
         {
-                memory_manager = &(Memory_Manager::Get_MPM());
+                memory_manager = &(Memory_Manager::Get_Current_MPM());
                 mem_pool = memory_manager->get_memory_pool(sizeof(value_type));
         }
 
@@ -169,7 +183,7 @@ namespace soar_module
             {
                 // useful for debugging
                 // std::string temp_this( typeid( value_type ).name() );
-                memory_manager = &(Memory_Manager::Get_MPM());
+                memory_manager = &(Memory_Manager::Get_Current_MPM());
                 mem_pool = memory_manager->get_memory_pool(sizeof(value_type));
             }
 
@@ -177,7 +191,7 @@ namespace soar_module
             {
                 // useful for debugging
                 // std::string temp_this( typeid( value_type ).name() );
-                memory_manager = &(Memory_Manager::Get_MPM());
+                memory_manager = obj.get_memory_manager();
                 mem_pool = memory_manager->get_memory_pool(sizeof(value_type));
             }
 
@@ -187,7 +201,7 @@ namespace soar_module
                     // useful for debugging
                     // std::string temp_this( typeid( T ).name() );
                     // std::string temp_other( typeid( _other ).name() );
-                    memory_manager = &(Memory_Manager::Get_MPM());
+                    memory_manager = other.get_memory_manager();
                     mem_pool = memory_manager->get_memory_pool(sizeof(value_type));
             }
 
@@ -256,6 +270,19 @@ namespace soar_module
                     typedef soar_memory_pool_allocator_n<U> other;
             };
 
+            // Containers keep using the memory manager they were created with.
+            // Move-assigning one into a container with a different manager (i.e.
+            // another agent's) copies the elements into the destination's pools
+            // instead of adopting the source's manager.  Swapping takes the
+            // allocators along with the nodes, which is safe either way.
+            typedef std::false_type propagate_on_container_move_assignment;
+            typedef std::true_type propagate_on_container_swap;
+
+            Memory_Manager* get_memory_manager() const
+            {
+                return memory_manager;
+            }
+
 
         private:
             //            agent* thisAgent;
@@ -263,10 +290,28 @@ namespace soar_module
             memory_pool* mem_pool;
 
     };
-    template<class T> bool operator==(const soar_memory_pool_allocator_n<T>&, const soar_memory_pool_allocator_n<T>&) { return true; }
-    template<class T> bool operator!=(const soar_memory_pool_allocator_n<T>&, const soar_memory_pool_allocator_n<T>&) { return false; }
-    template<class T> bool operator==(const soar_memory_pool_allocator<T>&, const soar_memory_pool_allocator<T>&) { return true; }
-    template<class T> bool operator!=(const soar_memory_pool_allocator<T>&, const soar_memory_pool_allocator<T>&) { return false; }
+    template<class T> bool operator==(const soar_memory_pool_allocator_n<T>& a, const soar_memory_pool_allocator_n<T>& b) { return a.get_memory_manager() == b.get_memory_manager(); }
+    template<class T> bool operator!=(const soar_memory_pool_allocator_n<T>& a, const soar_memory_pool_allocator_n<T>& b) { return a.get_memory_manager() != b.get_memory_manager(); }
+    template<class T> bool operator==(const soar_memory_pool_allocator<T>& a, const soar_memory_pool_allocator<T>& b) { return a.get_memory_manager() == b.get_memory_manager(); }
+    template<class T> bool operator!=(const soar_memory_pool_allocator<T>& a, const soar_memory_pool_allocator<T>& b) { return a.get_memory_manager() != b.get_memory_manager(); }
 #endif
+
+    // Moves every element of src to pos in dest.  list::splice is undefined
+    // when the two lists' allocators differ, which happens when they were
+    // built under different agents' memory managers, so in that case the
+    // elements are copied into dest's pools instead.
+    template <class List>
+    void splice_all(List& dest, typename List::iterator pos, List& src)
+    {
+        if (dest.get_allocator() == src.get_allocator())
+        {
+            dest.splice(pos, src);
+        }
+        else
+        {
+            dest.insert(pos, src.begin(), src.end());
+            src.clear();
+        }
+    }
 }
 #endif
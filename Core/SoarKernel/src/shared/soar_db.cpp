@@ -22,9 +22,9 @@ static void trace_sql(void* /*arg*/, const char* query)
 
 namespace soar_module
 {
-    void sqlite_database::connect(const char* file_name, int flags)
+    void sqlite_database::connect(const char* file_name, int flags, const char* vfs_name)
     {
-        int sqlite_err = sqlite3_open_v2(file_name, &(my_db), flags, NULL);
+        int sqlite_err = sqlite3_open_v2(file_name, &(my_db), flags, vfs_name);
         
         if (sqlite_err == SQLITE_OK)
         {
@@ -51,7 +51,8 @@ namespace soar_module
     
     void sqlite_database::disconnect()
     {
-        if (get_status() == connected)
+        // a failed open still leaves a handle to release
+        if ((get_status() == connected) || (get_status() == problem))
         {
             sqlite3_close(my_db);
             set_status(disconnected);
@@ -154,4 +155,104 @@ namespace soar_module
         }
         return false;
     }
+
+    sqlite_group_commit::sqlite_group_commit(sqlite_statement* new_begin, sqlite_statement* new_commit, uint64_t new_decisions, uint64_t new_ms, uint64_t decision):
+        begin_stmt(new_begin), commit_stmt(new_commit), every_decisions(new_decisions), every_ms(new_ms),
+        last_decision(decision), last_time(std::chrono::steady_clock::now()), commits(0),
+        checkpoint_pending(false), stopping(false), checkpoints(0)
+    {
+    }
+
+    sqlite_group_commit::~sqlite_group_commit()
+    {
+        if (checkpointer.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(checkpoint_mutex);
+                stopping = true;
+            }
+            checkpoint_wanted.notify_one();
+            checkpointer.join();
+        }
+    }
+
+    void sqlite_group_commit::start_checkpointer(const char* file_name)
+    {
+        checkpointer = std::thread(&sqlite_group_commit::checkpoint_loop, this, std::string(file_name));
+    }
+
+    bool sqlite_group_commit::due(uint64_t decision)
+    {
+        if (every_decisions && ((decision - last_decision) >= every_decisions))
+        {
+            return true;
+        }
+
+        if (every_ms)
+        {
+            std::chrono::milliseconds elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - last_time);
+            return (static_cast<uint64_t>(elapsed.count()) >= every_ms);
+        }
+
+        return false;
+    }
+
+    void sqlite_group_commit::commit(uint64_t decision)
+    {
+        commit_stmt->execute(op_reinit);
+        begin_stmt->execute(op_reinit);
+
+        last_decision = decision;
+        last_time = std::chrono::steady_clock::now();
+        commits++;
+
+        if (checkpointer.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(checkpoint_mutex);
+                checkpoint_pending = true;
+            }
+            checkpoint_wanted.notify_one();
+        }
+    }
+
+    uint64_t sqlite_group_commit::get_checkpoints()
+    {
+        std::lock_guard<std::mutex> lock(checkpoint_mutex);
+        return checkpoints;
+    }
+
+    // Runs on the checkpoint thread.  A passive checkpoint copies whatever
+    // committed frames it can without waiting on the agent's connection.
+    void sqlite_group_commit::checkpoint_loop(std::string file_name)
+    {
+        sqlite_database checkpoint_db;
+
+        checkpoint_db.connect(file_name.c_str(), SQLITE_OPEN_READWRITE);
+        if (checkpoint_db.get_status() != connected)
+        {
+            return;
+        }
+
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(checkpoint_mutex);
+                checkpoint_wanted.wait(lock, [this] { return stopping || checkpoint_pending; });
+                if (stopping)
+                {
+                    break;
+                }
+                checkpoint_pending = false;
+            }
+
+            if (sqlite3_wal_checkpoint_v2(checkpoint_db.get_db(), NULL, SQLITE_CHECKPOINT_PASSIVE, NULL, NULL) == SQLITE_OK)
+            {
+                std::lock_guard<std::mutex> lock(checkpoint_mutex);
+                checkpoints++;
+            }
+        }
+
+        checkpoint_db.disconnect();
+    }
 }
@@ -14,6 +14,11 @@
 
 #include <list>
 #include <assert.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
 
 /* -- Tracing functions that print SQL processing and errors -- */
 //    #define DEBUG_SQL_ERRORS
@@ -49,7 +54,7 @@ namespace soar_module
 
     // performance
     enum page_choices { page_1k, page_2k, page_4k, page_8k, page_16k, page_32k, page_64k };
-    enum opt_choices { opt_safety, opt_speed };
+    enum opt_choices { opt_safety, opt_speed, opt_wal };
 
 
     ///////////////////////////////////////////////////////////////////////////
@@ -76,7 +81,8 @@ namespace soar_module
             {
                 if (my_errmsg)
                 {
-                    delete my_errmsg;
+                    delete [] my_errmsg;
+                    my_errmsg = NULL;
                 }
 
                 if (new_msg)
@@ -290,7 +296,7 @@ namespace soar_module
                 return my_db;
             }
 
-            void connect(const char* file_name, int flags = (SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE));
+            void connect(const char* file_name, int flags = (SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE), const char* vfs_name = NULL);
             void disconnect();
             bool backup(const char* file_name, std::string* err);
             bool print_table(const char* table_name);
@@ -616,6 +622,50 @@ namespace soar_module
             }
     };
 
+    ///////////////////////////////////////////////////////////////////////////
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Breaks a lazy-commit transaction into groups for a write-ahead-log
+    // database: the open transaction is committed and a new one begun once
+    // enough decisions or milliseconds have passed since the last commit.
+    // A crash then loses at most the changes made since that commit.
+    //
+    // Optionally, a second connection on its own thread checkpoints the
+    // log after each commit, so the agent never pays for a checkpoint.
+    class sqlite_group_commit
+    {
+        public:
+            sqlite_group_commit(sqlite_statement* new_begin, sqlite_statement* new_commit, uint64_t new_decisions, uint64_t new_ms, uint64_t decision);
+            ~sqlite_group_commit();
+
+            void start_checkpointer(const char* file_name);
+
+            bool due(uint64_t decision);
+            void commit(uint64_t decision);
+
+            uint64_t get_commits() { return commits; }
+            uint64_t get_checkpoints();
+
+        private:
+            void checkpoint_loop(std::string file_name);
+
+            sqlite_statement* begin_stmt;
+            sqlite_statement* commit_stmt;
+            uint64_t every_decisions;
+            uint64_t every_ms;
+
+            uint64_t last_decision;
+            std::chrono::steady_clock::time_point last_time;
+            uint64_t commits;
+
+            std::thread checkpointer;
+            std::mutex checkpoint_mutex;
+            std::condition_variable checkpoint_wanted;
+            bool checkpoint_pending;
+            bool stopping;
+            uint64_t checkpoints;
+    };
+
     inline bool sqlite_database::sql_simple_get_int(const char* sql, int64_t& return_value)
     {
         soar_module::sqlite_statement* temp_q = new soar_module::sqlite_statement(this, sql);
@@ -2,39 +2,58 @@
 
 static MTRand gSoarRand;
 
+// Generator bound to the current thread, if any.  When this is NULL the
+// shared generator is used, which is the normal single-threaded case.
+static thread_local MTRand* tSoarRand = NULL;
+
+static inline MTRand& CurrentSoarRand()
+{
+    return tSoarRand ? *tSoarRand : gSoarRand;
+}
+
 // real number in [0,1]
 double SoarRand()
 {
-    return gSoarRand.rand();
+    return CurrentSoarRand().rand();
 }
 
 // real number in [0,n]
 double SoarRand(const double& max)
 {
-    return gSoarRand.rand(max);
+    return CurrentSoarRand().rand(max);
 }
 
 // integer in [0,2^32-1]
 uint32_t SoarRandInt()
 {
-    return gSoarRand.randInt();
+    return CurrentSoarRand().randInt();
 }
 
 // integer in [0,n] for n < 2^32
 uint32_t SoarRandInt(const uint32_t& max)
 {
-    return gSoarRand.randInt(max);
+    return CurrentSoarRand().randInt(max);
 }
 
 
 // automatically seed with a value based on the time or /dev/urandom
 void SoarSeedRNG()
 {
-    gSoarRand.seed();
+    CurrentSoarRand().seed();
 }
 
 // seed with a provided value
 void SoarSeedRNG(const uint32_t seed)
 {
-    gSoarRand.seed(seed);
+    CurrentSoarRand().seed(seed);
+}
+
+void SoarSetThreadRNG(MTRand* pRand)
+{
+    tSoarRand = pRand;
+}
+
+MTRand* SoarGetThreadRNG()
+{
+    return tSoarRand;
 }
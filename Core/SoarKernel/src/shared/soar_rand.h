@@ -491,6 +491,30 @@ EXPORT void SoarSeedRNG();
 // seed with a provided value
 EXPORT void SoarSeedRNG(const uint32_t seed);
 
+// Route the functions above through pRand for the calling thread only.  Pass
+// NULL to go back to the shared generator.  Used by KernelSML so that each
+// agent draws from its own generator, whichever thread it is running on.
+EXPORT void SoarSetThreadRNG(MTRand* pRand);
+EXPORT MTRand* SoarGetThreadRNG();
+
+// Routes the calling thread through pRand for the life of this object, then
+// goes back to whichever generator it was using before.
+class SoarThreadRNGScope
+{
+    public:
+        SoarThreadRNGScope(MTRand* pRand)
+        {
+            m_pPrevious = SoarGetThreadRNG();
+            SoarSetThreadRNG(pRand);
+        }
+        ~SoarThreadRNGScope()
+        {
+            SoarSetThreadRNG(m_pPrevious);
+        }
+    private:
+        MTRand* m_pPrevious;
+};
+
 #endif  // SOAR_RAND_H
 
 // Change log:
@@ -78,6 +78,7 @@
 =================================================================== */
 void init_soar_agent(agent* thisAgent)
 {
+    Memory_Manager::thread_scope lMemoryScope(thisAgent->memoryManager);
 
     thisAgent->rhs_functions = NIL;
 
@@ -164,6 +165,12 @@ agent* create_soar_agent(char* agent_name)
 {
     char cur_path[MAXPATHLEN];
 
+    /* Each agent gets its own memory pools.  Anything the agent's modules
+     * allocate through the STL pool allocators while being built here is
+     * bound to them as well. */
+    Memory_Manager* lMemoryManager = new Memory_Manager();
+    Memory_Manager::thread_scope lMemoryScope(lMemoryManager);
+
     agent* thisAgent = new agent();
     thisAgent->name                                     = savestring(agent_name);
     thisAgent->output_settings                          = new AgentOutput_Info();
@@ -256,7 +263,7 @@ agent* create_soar_agent(char* agent_name)
     soar_init_callbacks(thisAgent);
 
     //
-    thisAgent->memoryManager = &Memory_Manager::Get_MPM();
+    thisAgent->memoryManager = lMemoryManager;
     init_memory_utilities(thisAgent);
 
     //
@@ -356,6 +363,8 @@ void destroy_soar_agent(agent* delete_agent)
 
     delete_agent->memoryManager->free_with_pool(MP_rete_node, delete_agent->dummy_top_node);
     delete_agent->memoryManager->free_with_pool(MP_token, delete_agent->dummy_top_token);
+    delete delete_agent->rete_bulk_load_nodes;
+    delete delete_agent->rete_node_profiles;
 
     soar_remove_all_monitorable_callbacks(delete_agent);
 
@@ -401,8 +410,11 @@ void destroy_soar_agent(agent* delete_agent)
     /* Release data used by XML generation */
     xml_destroy(delete_agent);
 
-    /* Release agent data structure */
+    /* Release agent data structure.  Its memory pools go last, since the agent's
+     * own containers hand their nodes back to them as they are destroyed. */
+    Memory_Manager* lMemoryManager = delete_agent->memoryManager;
     delete delete_agent;
+    delete lMemoryManager;
 }
 
 void reinitialize_agent(agent* thisAgent)
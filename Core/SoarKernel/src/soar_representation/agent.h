@@ -77,6 +77,10 @@ typedef struct EXPORT agent_struct
     /* Hash tables for alpha memories, and for entries in left & right memories */
     void*               left_ht;
     void*               right_ht;
+    uint32_t            left_ht_log2size;
+    uint32_t            right_ht_log2size;
+    uint64_t            left_ht_count;
+    uint64_t            right_ht_count;
     hash_table*        (alpha_hash_tables[16]);
 
     /* Number of WMEs, and list of WMEs, the Rete has been told about */
@@ -87,6 +91,12 @@ typedef struct EXPORT agent_struct
     struct rete_node_struct* dummy_top_node;
     struct token_struct* dummy_top_token;
 
+    /* Nodes made since begin_rete_bulk_load() that are still waiting for
+     * their matches, with the order they were made in */
+    int            rete_bulk_load_depth;
+    uint64_t       rete_bulk_load_count;
+    std::unordered_map< struct rete_node_struct*, uint64_t >* rete_bulk_load_nodes;
+
     /* Various Rete statistics counters */
     uint64_t       rete_node_counts[256];
     uint64_t       rete_node_counts_if_no_sharing[256];
@@ -97,6 +107,11 @@ typedef struct EXPORT agent_struct
     uint64_t       num_null_right_activations;
     uint64_t       num_null_left_activations;
 
+    /* Match profiler, see "production match-profile" */
+    bool           rete_profiling;
+    uint64_t       rete_profile_child_time;
+    std::unordered_map< struct rete_node_struct*, struct rete_node_profile_struct >* rete_node_profiles;
+
 
     /* Miscellaneous other stuff */
     uint32_t       alpha_mem_id_counter; /* node id's for hashing */
@@ -707,7 +707,7 @@ Symbol* trim_rhs_function_code(agent* thisAgent, cons* args, void* /*user_data*/
         str = str.substr(start_pos, end_pos - start_pos + 1);
     }
 
-    returnSym = thisAgent->symbolManager->make_str_constant(str.c_str());
+    returnSym = thisAgent->symbolManager->make_str_constant(str.c_str(), str.length());
     free(symbol_to_trim);
     return returnSym;
 
@@ -18,6 +18,7 @@
 #include "soar_instance.h"
 #include "smem_db.h"
 #include "symbol.h"
+#include "symbol_table.h"
 
 Symbol_Manager::Symbol_Manager(agent* pAgent)
 {
@@ -32,132 +33,68 @@ Symbol_Manager::Symbol_Manager(agent* pAgent)
 
 Symbol_Manager::~Symbol_Manager()
 {
-    free_hash_table(thisAgent, variable_hash_table);
-    free_hash_table(thisAgent, identifier_hash_table);
-    free_hash_table(thisAgent, str_constant_hash_table);
-    free_hash_table(thisAgent, int_constant_hash_table);
-    free_hash_table(thisAgent, float_constant_hash_table);
+    delete variable_hash_table;
+    delete identifier_hash_table;
+    delete str_constant_hash_table;
+    delete int_constant_hash_table;
+    delete float_constant_hash_table;
 }
 
 /* -------------------------------------------------------------------
                            Hash Functions
 
-   Compress() takes a 32-bit hash value and compresses it down to a few
-   bits, xor-ing pieces of the 32-bit value to avoid throwing away bits
-   that might be important for the hash function to be effective.
+   These produce the full 32-bit hash that each symbol caches in its
+   table_hash field.  The symbol tables take the low-order bits of it
+   as the home slot, so every function here finishes with a mixing step
+   that spreads the input across all 32 bits.
 
-   Hash_string() produces a hash value for a string of characters.
-
-   Hash_xxx_raw_info() are the hash functions for the five kinds of
-   symbols.  These functions operate on the basic info about the symbol
-   (i.e., the name, value, etc.).  Hash_xxx(), on the other hand,
-   operate on the symbol table entries for the five kinds of symbols--
-   these routines are the callback hashing functions used by the
-   resizable hash table routines.
+   Hash_string() hashes a counted string (FNV-1a), so callers that
+   already know a name's length don't need it null-terminated.
 ------------------------------------------------------------------- */
 
-uint32_t compress(uint32_t h, short num_bits)
+inline uint32_t mix_hash_bits(uint64_t h)
 {
-    uint32_t result;
-
-    if (num_bits < 16)
-    {
-        h = (h & 0xFFFF) ^ (h >> 16);
-    }
-    if (num_bits < 8)
-    {
-        h = (h & 0xFF) ^ (h >> 8);
-    }
-    result = 0;
-    while (h)
-    {
-        result ^= (h & masks_for_n_low_order_bits[num_bits]);
-        h = h >> num_bits;
-    }
-    return result;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return static_cast<uint32_t>(h);
 }
 
-uint32_t hash_string(const char* s)      /* AGR 600 */
+uint32_t hash_string(const char* s, size_t length)
 {
-    uint32_t h;
+    uint32_t h = 2166136261U;
 
-    h = 0;
-    while (*s != 0)
+    for (size_t i = 0; i < length; i++)
     {
-        h = ((h << 8) | (h >> 24)) ^ (*s);
-        s++;
+        h ^= static_cast<unsigned char>(s[i]);
+        h *= 16777619U;
     }
-    return h;
-}
-
-/* -----------------------------------------
-   Hashing symbols using their basic info
------------------------------------------ */
-
-uint32_t hash_variable_raw_info(const char* name, short num_bits)
-{
-    return compress(hash_string(name), num_bits);
+    return mix_hash_bits(h);
 }
 
-uint32_t hash_identifier_raw_info(char name_letter,
-                                  uint64_t name_number,
-                                  short num_bits)
+uint32_t hash_identifier(char name_letter, uint64_t name_number)
 {
-    return compress(static_cast<uint32_t>(name_number) ^ (static_cast<uint32_t>(name_letter) << 24), num_bits);  // FIXME: cast from 64 to 32 bits
+    return mix_hash_bits(name_number ^ (static_cast<uint64_t>(static_cast<unsigned char>(name_letter)) << 56));
 }
 
-uint32_t hash_str_constant_raw_info(const char* name, short num_bits)
+uint32_t hash_int_constant(int64_t value)
 {
-    return compress(hash_string(name), num_bits);
+    return mix_hash_bits(static_cast<uint64_t>(value));
 }
 
-uint32_t hash_int_constant_raw_info(int64_t value, short num_bits)
+uint32_t hash_float_constant(double value)
 {
-    return compress(static_cast<uint32_t>(value), num_bits);
-}
+    uint64_t bits;
 
-uint32_t hash_float_constant_raw_info(double value, short num_bits)
-{
-    return compress(static_cast<uint32_t>(value), num_bits);
-}
-
-/* ---------------------------------------------------
-   Hashing symbols using their symbol table entries
---------------------------------------------------- */
-
-uint32_t hash_variable(void* item, short num_bits)
-{
-    varSymbol* var;
-    var = static_cast<varSymbol*>(item);
-    return compress(hash_string(var->name), num_bits);
-}
-
-uint32_t hash_identifier(void* item, short num_bits)
-{
-    idSymbol* id;
-    id = static_cast<idSymbol*>(item);
-    return compress(static_cast<uint32_t>(id->name_number) ^ (static_cast<uint32_t>(id->name_letter) << 24), num_bits);  // FIXME: cast from 64 to 32 bits
-}
-
-uint32_t hash_str_constant(void* item, short num_bits)
-{
-    strSymbol* sc;
-    sc = static_cast<strSymbol*>(item);
-    return compress(hash_string(sc->name), num_bits);
-}
-
-uint32_t hash_int_constant(void* item, short num_bits)
-{
-    intSymbol* ic;
-    ic = static_cast<intSymbol*>(item);
-    return compress(static_cast<uint32_t>(ic->value), num_bits);
-}
-
-uint32_t hash_float_constant(void* item, short num_bits)
-{
-    floatSymbol* fc;
-    fc = static_cast<floatSymbol*>(item);
-    return compress(static_cast<uint32_t>(fc->value), num_bits);
+    /* -- 0.0 and -0.0 compare equal, so they must hash the same -- */
+    if (value == 0.0)
+    {
+        value = 0.0;
+    }
+    memcpy(&bits, &value, sizeof(bits));
+    return mix_hash_bits(bits);
 }
 
 /* -----------------------------------------------------------------
@@ -215,11 +152,11 @@ uint32_t hash_float_constant(void* item, short num_bits)
 
 void Symbol_Manager::init_symbol_tables()
 {
-    variable_hash_table = make_hash_table(thisAgent, 0, hash_variable);
-    identifier_hash_table = make_hash_table(thisAgent, 0, hash_identifier);
-    str_constant_hash_table = make_hash_table(thisAgent, 0, hash_str_constant);
-    int_constant_hash_table = make_hash_table(thisAgent, 0, hash_int_constant);
-    float_constant_hash_table = make_hash_table(thisAgent, 0, hash_float_constant);
+    variable_hash_table = new Symbol_Table(thisAgent);
+    identifier_hash_table = new Symbol_Table(thisAgent);
+    str_constant_hash_table = new Symbol_Table(thisAgent);
+    int_constant_hash_table = new Symbol_Table(thisAgent);
+    float_constant_hash_table = new Symbol_Table(thisAgent);
 
     thisAgent->memoryManager->init_memory_pool(MP_variable, sizeof(varSymbol), "variable");
     thisAgent->memoryManager->init_memory_pool(MP_identifier, sizeof(idSymbol), "identifier");
@@ -247,104 +184,66 @@ void Symbol_Manager::retesave(FILE* f)
 {
     thisAgent->current_retesave_symindex = 0;
 
-    retesave_eight_bytes(str_constant_hash_table->count, f);
-    retesave_eight_bytes(variable_hash_table->count, f);
-    retesave_eight_bytes(int_constant_hash_table->count, f);
-    retesave_eight_bytes(float_constant_hash_table->count, f);
+    retesave_eight_bytes(str_constant_hash_table->count(), f);
+    retesave_eight_bytes(variable_hash_table->count(), f);
+    retesave_eight_bytes(int_constant_hash_table->count(), f);
+    retesave_eight_bytes(float_constant_hash_table->count(), f);
 
-    do_for_all_items_in_hash_table(thisAgent, str_constant_hash_table, retesave_symbol_and_assign_index, f);
-    do_for_all_items_in_hash_table(thisAgent, variable_hash_table, retesave_symbol_and_assign_index, f);
-    do_for_all_items_in_hash_table(thisAgent, int_constant_hash_table, retesave_symbol_and_assign_index, f);
-    do_for_all_items_in_hash_table(thisAgent, float_constant_hash_table, retesave_symbol_and_assign_index, f);
+    str_constant_hash_table->do_for_all_items(retesave_symbol_and_assign_index, f);
+    variable_hash_table->do_for_all_items(retesave_symbol_and_assign_index, f);
+    int_constant_hash_table->do_for_all_items(retesave_symbol_and_assign_index, f);
+    float_constant_hash_table->do_for_all_items(retesave_symbol_and_assign_index, f);
 }
 Symbol* Symbol_Manager::find_variable(const char* name)
 {
-    uint32_t hash_value;
-    varSymbol* sym;
+    size_t length = strlen(name);
 
-    hash_value = hash_variable_raw_info(name, variable_hash_table->log2size);
-    sym = reinterpret_cast<varSymbol*>(*(variable_hash_table->buckets + hash_value));
-    for (; sym != NIL; sym = static_cast<varSymbol*>(sym->next_in_hash_table))
+    return variable_hash_table->find(hash_string(name, length), [name, length](Symbol* sym)
     {
-        if (!strcmp(sym->name, name))
-        {
-            return sym;
-        }
-    }
-    return NIL;
+        return (strncmp(sym->var->name, name, length) == 0) && (sym->var->name[length] == 0);
+    });
 }
 
 Symbol* Symbol_Manager::find_identifier(char name_letter, uint64_t name_number)
 {
-    uint32_t hash_value;
-    idSymbol* sym;
-
-    hash_value = hash_identifier_raw_info(name_letter, name_number,
-                                          identifier_hash_table->log2size);
-    sym = reinterpret_cast<idSymbol*>(*(identifier_hash_table->buckets + hash_value));
-    for (; sym != NIL; sym = static_cast<idSymbol*>(sym->next_in_hash_table))
+    return identifier_hash_table->find(hash_identifier(name_letter, name_number), [name_letter, name_number](Symbol* sym)
     {
-        if ((name_letter == sym->name_letter) &&
-                (name_number == sym->name_number))
-        {
-            return sym;
-        }
-    }
-    return NIL;
+        return (sym->id->name_letter == name_letter) && (sym->id->name_number == name_number);
+    });
 }
 
 Symbol* Symbol_Manager::find_str_constant(const char* name)
 {
-    uint32_t hash_value;
-    strSymbol* sym;
+    return find_str_constant(name, strlen(name));
+}
 
-    hash_value = hash_str_constant_raw_info(name,
-                                            str_constant_hash_table->log2size);
-    sym = reinterpret_cast<strSymbol*>(*(str_constant_hash_table->buckets + hash_value));
-    for (; sym != NIL; sym = static_cast<strSymbol*>(sym->next_in_hash_table))
+Symbol* Symbol_Manager::find_str_constant(const char* name, size_t length)
+{
+    return find_str_constant(name, length, hash_string(name, length));
+}
+
+Symbol* Symbol_Manager::find_str_constant(const char* name, size_t length, uint32_t hash)
+{
+    return str_constant_hash_table->find(hash, [name, length](Symbol* sym)
     {
-        if (!strcmp(sym->name, name))
-        {
-            return sym;
-        }
-    }
-    return NIL;
+        return (strncmp(sym->sc->name, name, length) == 0) && (sym->sc->name[length] == 0);
+    });
 }
 
 Symbol* Symbol_Manager::find_int_constant(int64_t value)
 {
-    uint32_t hash_value;
-    intSymbol* sym;
-
-    hash_value = hash_int_constant_raw_info(value,
-                                            int_constant_hash_table->log2size);
-    sym = reinterpret_cast<intSymbol*>(*(int_constant_hash_table->buckets + hash_value));
-    for (; sym != NIL; sym = static_cast<intSymbol*>(sym->next_in_hash_table))
+    return int_constant_hash_table->find(hash_int_constant(value), [value](Symbol* sym)
     {
-        if (value == sym->value)
-        {
-            return sym;
-        }
-    }
-    return NIL;
+        return (sym->ic->value == value);
+    });
 }
 
 Symbol* Symbol_Manager::find_float_constant(double value)
 {
-    uint32_t hash_value;
-    floatSymbol* sym;
-
-    hash_value = hash_float_constant_raw_info(value,
-                 float_constant_hash_table->log2size);
-    sym = reinterpret_cast<floatSymbol*>(*(float_constant_hash_table->buckets + hash_value));
-    for (; sym != NIL; sym = static_cast<floatSymbol*>(sym->next_in_hash_table))
+    return float_constant_hash_table->find(hash_float_constant(value), [value](Symbol* sym)
     {
-        if (value == sym->value)
-        {
-            return sym;
-        }
-    }
-    return NIL;
+        return (sym->fc->value == value);
+    });
 }
 
 Symbol* Symbol_Manager::make_variable(const char* name)
@@ -363,6 +262,7 @@ Symbol* Symbol_Manager::make_variable(const char* name)
     sym->symbol_type = VARIABLE_SYMBOL_TYPE;
     sym->reference_count = 0;
     sym->hash_id = get_next_symbol_hash_id(thisAgent);
+    sym->table_hash = hash_string(name, strlen(name));
     sym->tc_num = 0;
     sym->name = make_memory_block_for_string(thisAgent, name);
     sym->gensym_number = 0;
@@ -376,7 +276,7 @@ Symbol* Symbol_Manager::make_variable(const char* name)
     sym->id = NULL;
     sym->var = sym;
     symbol_add_ref(sym);
-    add_to_hash_table(thisAgent, variable_hash_table, sym);
+    variable_hash_table->insert(sym);
 
     return sym;
 }
@@ -423,6 +323,7 @@ Symbol* Symbol_Manager::make_new_identifier(char name_letter, goal_stack_level l
         }
     }
     sym->name_number = name_number;
+    sym->table_hash = hash_identifier(name_letter, name_number);
     sym->level = level;
     sym->promotion_level = level;
     sym->slots = NULL;
@@ -465,7 +366,7 @@ Symbol* Symbol_Manager::make_new_identifier(char name_letter, goal_stack_level l
     sym->var = NULL;
     sym->id = sym;
     symbol_add_ref(sym);
-    add_to_hash_table(thisAgent, identifier_hash_table, sym);
+    identifier_hash_table->insert(sym);
 
     return sym;
 }
@@ -474,6 +375,13 @@ Symbol* Symbol_Manager::make_new_identifier(char name_letter, goal_stack_level l
  * Avoids calling find
  */
 Symbol* Symbol_Manager::make_str_constant_no_find(char const* name)
+{
+    size_t length = strlen(name);
+
+    return make_str_constant_no_find(name, length, hash_string(name, length));
+}
+
+Symbol* Symbol_Manager::make_str_constant_no_find(char const* name, size_t length, uint32_t hash)
 {
     strSymbol* sym;
 
@@ -481,13 +389,16 @@ Symbol* Symbol_Manager::make_str_constant_no_find(char const* name)
     sym->symbol_type = STR_CONSTANT_SYMBOL_TYPE;
     sym->reference_count = 0;
     sym->hash_id = get_next_symbol_hash_id(thisAgent);
+    sym->table_hash = hash;
     sym->tc_num = 0;
     sym->singleton.possible = false;
     sym->epmem_hash = 0;
     sym->epmem_valid = 0;
     sym->smem_hash = 0;
     sym->smem_valid = 0;
-    sym->name = make_memory_block_for_string(thisAgent, name);
+    sym->name = static_cast<char*>(thisAgent->memoryManager->allocate_memory(length + 1, STRING_MEM_USAGE));
+    memcpy(sym->name, name, length);
+    sym->name[length] = 0;
     sym->thisAgent = thisAgent;
     sym->cached_rereadable_print_str = NULL;
     sym->production = NULL;
@@ -497,21 +408,28 @@ Symbol* Symbol_Manager::make_str_constant_no_find(char const* name)
     sym->var = NULL;
     sym->sc = sym;
     symbol_add_ref(sym);
-    add_to_hash_table(thisAgent, str_constant_hash_table, sym);
+    str_constant_hash_table->insert(sym);
 
     return sym;
 }
 
 Symbol* Symbol_Manager::make_str_constant(char const* name)
+{
+    return make_str_constant(name, strlen(name));
+}
+
+Symbol* Symbol_Manager::make_str_constant(char const* name, size_t length)
 {
     strSymbol* sym;
-    sym = static_cast<strSymbol*>(find_str_constant(name));
+    uint32_t hash = hash_string(name, length);
+
+    sym = static_cast<strSymbol*>(find_str_constant(name, length, hash));
     if (sym)
     {
         symbol_add_ref(sym);
         return sym;
     }
-    return make_str_constant_no_find(name);
+    return make_str_constant_no_find(name, length, hash);
 }
 
 Symbol* Symbol_Manager::make_int_constant(int64_t value)
@@ -529,6 +447,7 @@ Symbol* Symbol_Manager::make_int_constant(int64_t value)
         sym->symbol_type = INT_CONSTANT_SYMBOL_TYPE;
         sym->reference_count = 0;
         sym->hash_id = get_next_symbol_hash_id(thisAgent);
+        sym->table_hash = hash_int_constant(value);
         sym->tc_num = 0;
         sym->epmem_hash = 0;
         sym->epmem_valid = 0;
@@ -543,7 +462,7 @@ Symbol* Symbol_Manager::make_int_constant(int64_t value)
         sym->var = NULL;
         sym->ic = sym;
         symbol_add_ref(sym);
-        add_to_hash_table(thisAgent, int_constant_hash_table, sym);
+        int_constant_hash_table->insert(sym);
     }
     return sym;
 }
@@ -563,6 +482,7 @@ Symbol* Symbol_Manager::make_float_constant(double value)
         sym->symbol_type = FLOAT_CONSTANT_SYMBOL_TYPE;
         sym->reference_count = 0;
         sym->hash_id = get_next_symbol_hash_id(thisAgent);
+        sym->table_hash = hash_float_constant(value);
         sym->tc_num = 0;
         sym->epmem_hash = 0;
         sym->epmem_valid = 0;
@@ -577,7 +497,7 @@ Symbol* Symbol_Manager::make_float_constant(double value)
         sym->var = NULL;
         sym->fc = sym;
         symbol_add_ref(sym);
-        add_to_hash_table(thisAgent, float_constant_hash_table, sym);
+        float_constant_hash_table->insert(sym);
     }
     return sym;
 }
@@ -904,31 +824,31 @@ void Symbol_Manager::deallocate_symbol(Symbol*& sym)
     switch (sym->symbol_type)
     {
         case VARIABLE_SYMBOL_TYPE:
-            remove_from_hash_table(thisAgent, variable_hash_table, sym);
+            variable_hash_table->remove(sym);
             free_memory_block_for_string(thisAgent, sym->var->name);
             thisAgent->memoryManager->free_with_pool(MP_variable, sym);
             break;
         case IDENTIFIER_SYMBOL_TYPE:
             if (sym->id->cached_print_str) free_memory_block_for_string(thisAgent, sym->id->cached_print_str);
             if (sym->id->cached_lti_str) free_memory_block_for_string(thisAgent, sym->id->cached_lti_str);
-            remove_from_hash_table(thisAgent, identifier_hash_table, sym);
+            identifier_hash_table->remove(sym);
             thisAgent->memoryManager->free_with_pool(MP_identifier, sym);
             break;
         case STR_CONSTANT_SYMBOL_TYPE:
             if (sym->sc->cached_rereadable_print_str && (sym->sc->cached_rereadable_print_str != sym->sc->name))
                 free_memory_block_for_string(thisAgent, sym->sc->cached_rereadable_print_str);
-            remove_from_hash_table(thisAgent, str_constant_hash_table, sym);
+            str_constant_hash_table->remove(sym);
             free_memory_block_for_string(thisAgent, sym->sc->name);
             thisAgent->memoryManager->free_with_pool(MP_str_constant, sym);
             break;
         case INT_CONSTANT_SYMBOL_TYPE:
             if (sym->ic->cached_print_str) free_memory_block_for_string(thisAgent, sym->ic->cached_print_str);
-            remove_from_hash_table(thisAgent, int_constant_hash_table, sym);
+            int_constant_hash_table->remove(sym);
             thisAgent->memoryManager->free_with_pool(MP_int_constant, sym);
             break;
         case FLOAT_CONSTANT_SYMBOL_TYPE:
             if (sym->fc->cached_print_str) free_memory_block_for_string(thisAgent, sym->fc->cached_print_str);
-            remove_from_hash_table(thisAgent, float_constant_hash_table, sym);
+            float_constant_hash_table->remove(sym);
             thisAgent->memoryManager->free_with_pool(MP_float_constant, sym);
             break;
         default:
@@ -1019,40 +939,40 @@ bool print_sym(agent* thisAgent, void* item, void*)
 
 void Symbol_Manager::clear_variable_gensym_numbers()
 {
-    do_for_all_items_in_hash_table(thisAgent, variable_hash_table, clear_gensym_number, 0);
+    variable_hash_table->do_for_all_items(clear_gensym_number, 0);
 }
 
 void Symbol_Manager::print_internal_symbols()
 {
     thisAgent->outputManager->printa_sf(thisAgent,  "\n--- Symbolic Constants: ---\n");
-    do_for_all_items_in_hash_table(thisAgent, str_constant_hash_table, print_sym, 0);
+    str_constant_hash_table->do_for_all_items(print_sym, 0);
     thisAgent->outputManager->printa_sf(thisAgent,  "\n--- Integer Constants: ---\n");
-    do_for_all_items_in_hash_table(thisAgent, int_constant_hash_table, print_sym, 0);
+    int_constant_hash_table->do_for_all_items(print_sym, 0);
     thisAgent->outputManager->printa_sf(thisAgent,  "\n--- Floating-Point Constants: ---\n");
-    do_for_all_items_in_hash_table(thisAgent, float_constant_hash_table, print_sym, 0);
+    float_constant_hash_table->do_for_all_items(print_sym, 0);
     thisAgent->outputManager->printa_sf(thisAgent,  "\n--- Identifiers: ---\n");
-    do_for_all_items_in_hash_table(thisAgent, identifier_hash_table, print_sym, 0);
+    identifier_hash_table->do_for_all_items(print_sym, 0);
     thisAgent->outputManager->printa_sf(thisAgent,  "\n--- Variables: ---\n");
-    do_for_all_items_in_hash_table(thisAgent, variable_hash_table, print_sym, 0);
+    variable_hash_table->do_for_all_items(print_sym, 0);
 }
 
 void Symbol_Manager::reset_hash_table(MemoryPoolType lHashTable)
 {
     if (lHashTable == MP_identifier)
     {
-        if (identifier_hash_table->count != 0)
+        if (identifier_hash_table->count() != 0)
         {
             if (Soar_Instance::Get_Soar_Instance().was_run_from_unit_test())
             {
                 /* If you #define CONFIGURE_SOAR_FOR_UNIT_TESTS and INIT_AFTER_RUN unit_tests.h, the following
                  * detect refcount leaks in unit tests and print out a message accordingly */
                 #ifndef SOAR_RELEASE_VERSION
-                    if (identifier_hash_table->count < 23)
-                        do_for_all_items_in_hash_table(thisAgent, identifier_hash_table, print_sym, 0);
+                    if (identifier_hash_table->count() < 23)
+                        identifier_hash_table->do_for_all_items(print_sym, 0);
                     else
-                        std::cout << "Refcount leak of " << identifier_hash_table->count << " identifiers detected. ";
+                        std::cout << "Refcount leak of " << identifier_hash_table->count() << " identifiers detected. ";
                 #else
-                    std::cout << "Refcount leak of " << identifier_hash_table->count << " identifiers detected. ";
+                    std::cout << "Refcount leak of " << identifier_hash_table->count() << " identifiers detected. ";
                 #endif
             }
             else
@@ -1060,16 +980,15 @@ void Symbol_Manager::reset_hash_table(MemoryPoolType lHashTable)
             if (thisAgent->outputManager->settings[OM_WARNINGS])
             #endif
             {
-                thisAgent->outputManager->printa_sf(thisAgent, "%d identifiers still exist.  Forcing deletion.\n", identifier_hash_table->count);
-                /* Note:  The do_for_all_items_in_hash_table printing could cause a crash if there's
+                thisAgent->outputManager->printa_sf(thisAgent, "%d identifiers still exist.  Forcing deletion.\n", identifier_hash_table->count());
+                /* Note:  The do_for_all_items printing could cause a crash if there's
                  *        memory corruption, but usually prints out and is good for debugging. */
                 #ifndef SOAR_RELEASE_VERSION
-                do_for_all_items_in_hash_table(thisAgent, identifier_hash_table, print_sym, 0);
+                identifier_hash_table->do_for_all_items(print_sym, 0);
                 #endif
             }
-            free_hash_table(thisAgent, identifier_hash_table);
+            identifier_hash_table->reset();
             thisAgent->memoryManager->free_memory_pool(MP_identifier);
-            identifier_hash_table = make_hash_table(thisAgent, 0, hash_identifier);
         }
     }
 }
@@ -1090,8 +1009,8 @@ bool reset_tc_num(agent* /*thisAgent*/, void* item, void*)
 
 void Symbol_Manager::reset_id_and_variable_tc_numbers()
 {
-    do_for_all_items_in_hash_table(thisAgent, identifier_hash_table, reset_tc_num, 0);
-    do_for_all_items_in_hash_table(thisAgent, variable_hash_table, reset_tc_num, 0);
+    identifier_hash_table->do_for_all_items(reset_tc_num, 0);
+    variable_hash_table->do_for_all_items(reset_tc_num, 0);
 }
 
 Symbol* Symbol_Manager::generate_new_str_constant(const char* prefix, uint64_t* counter)
@@ -40,6 +40,7 @@ class EXPORT Symbol_Manager {
 
         Symbol* make_variable(const char* name);
         Symbol* make_str_constant(char const* name);
+        Symbol* make_str_constant(char const* name, size_t length);
         Symbol* make_int_constant(int64_t value);
         Symbol* make_float_constant(double value);
         Symbol* make_new_identifier(char name_letter, goal_stack_level level, uint64_t name_number = NIL, bool prohibit_S = true);
@@ -52,6 +53,7 @@ class EXPORT Symbol_Manager {
         Symbol* find_variable(const char* name);
         Symbol* find_identifier(char name_letter, uint64_t name_number);
         Symbol* find_str_constant(const char* name);
+        Symbol* find_str_constant(const char* name, size_t length);
         Symbol* find_int_constant(int64_t value);
         Symbol* find_float_constant(double value);
 
@@ -109,16 +111,19 @@ class EXPORT Symbol_Manager {
         uint64_t    current_variable_gensym_number;
         uint64_t    gensymed_variable_count[26];
 
-        struct hash_table_struct* float_constant_hash_table;
-        struct hash_table_struct* identifier_hash_table;
-        struct hash_table_struct* int_constant_hash_table;
-        struct hash_table_struct* str_constant_hash_table;
-        struct hash_table_struct* variable_hash_table;
+        Symbol_Table* float_constant_hash_table;
+        Symbol_Table* identifier_hash_table;
+        Symbol_Table* int_constant_hash_table;
+        Symbol_Table* str_constant_hash_table;
+        Symbol_Table* variable_hash_table;
 
         void clear_variable_gensym_numbers();
 
         void deallocate_symbol(Symbol*& sym);
 
+        Symbol* find_str_constant(const char* name, size_t length, uint32_t hash);
+        Symbol* make_str_constant_no_find(char const* name, size_t length, uint32_t hash);
+
         uint32_t get_next_symbol_hash_id(agent* thisAgent) { return (current_symbol_hash_id += 137); }
 
 };
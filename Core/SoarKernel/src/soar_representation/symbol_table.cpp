@@ -0,0 +1,125 @@
+#include "symbol_table.h"
+
+#include "agent.h"
+#include "memory_manager.h"
+
+#include <assert.h>
+
+#define SYMBOL_TABLE_MINIMUM_SIZE 64
+
+Symbol_Table::Symbol_Table(agent* pAgent)
+{
+    thisAgent = pAgent;
+    m_count = 0;
+    allocate_slots(SYMBOL_TABLE_MINIMUM_SIZE);
+}
+
+Symbol_Table::~Symbol_Table()
+{
+    thisAgent->memoryManager->free_memory(m_slots, HASH_TABLE_MEM_USAGE);
+}
+
+void Symbol_Table::allocate_slots(uint32_t new_size)
+{
+    m_slots = static_cast<symbol_table_slot*>(thisAgent->memoryManager->allocate_memory_and_zerofill(new_size * sizeof(symbol_table_slot),
+              HASH_TABLE_MEM_USAGE));
+    m_size = new_size;
+    m_mask = new_size - 1;
+}
+
+void Symbol_Table::resize(uint32_t new_size)
+{
+    symbol_table_slot* old_slots = m_slots;
+    uint32_t old_size = m_size;
+    uint32_t i, j;
+
+    allocate_slots(new_size);
+    for (i = 0; i < old_size; i++)
+    {
+        if (old_slots[i].sym)
+        {
+            j = old_slots[i].hash & m_mask;
+            while (m_slots[j].sym)
+            {
+                j = (j + 1) & m_mask;
+            }
+            m_slots[j] = old_slots[i];
+        }
+    }
+    thisAgent->memoryManager->free_memory(old_slots, HASH_TABLE_MEM_USAGE);
+}
+
+void Symbol_Table::insert(Symbol* sym)
+{
+    uint32_t i;
+
+    if ((m_count + 1) * 4 > static_cast<uint64_t>(m_size) * 3)
+    {
+        resize(m_size * 2);
+    }
+    i = sym->table_hash & m_mask;
+    while (m_slots[i].sym)
+    {
+        i = (i + 1) & m_mask;
+    }
+    m_slots[i].hash = sym->table_hash;
+    m_slots[i].sym = sym;
+    m_count++;
+}
+
+/* --- Backward-shift deletion:  after emptying a slot, move up any later
+ *     entry in the same run whose home slot is at or before the hole, so
+ *     that every remaining entry can still be reached from its home. --- */
+void Symbol_Table::remove(Symbol* sym)
+{
+    uint32_t hole, i, home;
+
+    hole = sym->table_hash & m_mask;
+    while (m_slots[hole].sym != sym)
+    {
+        assert(m_slots[hole].sym && "Symbol_Table::remove called on a symbol that isn't in the table");
+        hole = (hole + 1) & m_mask;
+    }
+
+    i = hole;
+    for (;;)
+    {
+        i = (i + 1) & m_mask;
+        if (!m_slots[i].sym)
+        {
+            break;
+        }
+        home = m_slots[i].hash & m_mask;
+        if (((i - home) & m_mask) >= ((i - hole) & m_mask))
+        {
+            m_slots[hole] = m_slots[i];
+            hole = i;
+        }
+    }
+    m_slots[hole].sym = NIL;
+    m_slots[hole].hash = 0;
+    m_count--;
+
+    if ((m_size > SYMBOL_TABLE_MINIMUM_SIZE) && (m_count < m_size / 8))
+    {
+        resize(m_size / 2);
+    }
+}
+
+void Symbol_Table::reset()
+{
+    thisAgent->memoryManager->free_memory(m_slots, HASH_TABLE_MEM_USAGE);
+    m_count = 0;
+    allocate_slots(SYMBOL_TABLE_MINIMUM_SIZE);
+}
+
+void Symbol_Table::do_for_all_items(hash_table_callback_fn2 f, void* userdata)
+{
+    for (uint32_t i = 0; i < m_size; i++)
+    {
+        if (m_slots[i].sym && (*f)(thisAgent, m_slots[i].sym, userdata))
+        {
+            return;
+        }
+    }
+}
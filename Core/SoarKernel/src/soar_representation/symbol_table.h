@@ -0,0 +1,85 @@
+/*************************************************************************
+ * PLEASE SEE THE FILE "license.txt" (INCLUDED WITH THIS SOFTWARE PACKAGE)
+ * FOR LICENSE AND COPYRIGHT INFORMATION.
+ *************************************************************************/
+
+/* ---------------------------------------------------------------------
+                            symbol_table.h
+
+   Symbol_Table is the hash table the symbol manager uses to intern each
+   of the five kinds of symbols.  It uses open addressing with linear
+   probing: the table is a single array of slots, each holding a symbol
+   and that symbol's full 32-bit hash (which is also cached in the
+   symbol's table_hash field).  A lookup walks consecutive slots and
+   only dereferences a symbol when the cached hash matches, so a miss
+   usually touches one or two cache lines and never compares a string.
+
+   Find() takes the full hash of the thing being looked for and a
+   predicate that is called on each candidate whose hash matches.
+
+   Insert() adds a symbol whose table_hash field has already been set.
+   Remove() takes it back out, shifting later entries of the same probe
+   run back so that no tombstones are needed.  The table doubles when it
+   is three-quarters full and halves when it falls below one-eighth.
+
+   Do_for_all_items() calls a hash_table_callback_fn2 on every symbol in
+   the table, in the same way as do_for_all_items_in_hash_table().  The
+   callback must not add or remove symbols.
+--------------------------------------------------------------------- */
+
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+#include "kernel.h"
+
+#include "mem.h"
+#include "symbol.h"
+
+class Symbol_Table
+{
+    public:
+        Symbol_Table(agent* pAgent);
+        ~Symbol_Table();
+
+        uint64_t count() const { return m_count; }
+
+        template <typename Matches>
+        Symbol* find(uint32_t hash, Matches matches) const
+        {
+            uint32_t i = hash & m_mask;
+            while (m_slots[i].sym)
+            {
+                if ((m_slots[i].hash == hash) && matches(m_slots[i].sym))
+                {
+                    return m_slots[i].sym;
+                }
+                i = (i + 1) & m_mask;
+            }
+            return NIL;
+        }
+
+        void insert(Symbol* sym);
+        void remove(Symbol* sym);
+        void reset();
+
+        void do_for_all_items(hash_table_callback_fn2 f, void* userdata);
+
+    private:
+
+        typedef struct symbol_table_slot_struct
+        {
+            uint32_t    hash;
+            Symbol*     sym;
+        } symbol_table_slot;
+
+        agent*              thisAgent;
+        symbol_table_slot*  m_slots;
+        uint32_t            m_size;
+        uint32_t            m_mask;
+        uint64_t            m_count;
+
+        void allocate_slots(uint32_t new_size);
+        void resize(uint32_t new_size);
+};
+
+#endif
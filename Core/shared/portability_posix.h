@@ -39,6 +39,12 @@
 // Use local sockets instead of internet sockets for same-machine interprocess communication
 #define ENABLE_LOCAL_SOCKETS
 
+// Allow clients on the same machine as the kernel to pass messages through shared memory rather than
+// the socket (they switch when they connect, see Kernel::CreateRemoteConnection())
+#ifdef __linux__
+#define ENABLE_SHARED_MEMORY
+#endif
+
 #include <dlfcn.h>      // Needed for dlopen and dlsym
 #define GetProcAddress dlsym
 
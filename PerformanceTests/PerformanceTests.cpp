@@ -4,6 +4,14 @@
 #include "sml_Client.h"
 #include "sml_Connection.h"
 
+#include "agent.h"
+#include "sml_AgentSML.h"
+#include "soar_instance.h"
+#include "symbol.h"
+#include "symbol_manager.h"
+
+#include <chrono>
+
 using namespace std;
 using namespace sml;
 
@@ -12,7 +20,9 @@ void MyPrintEventHandler(smlPrintEventId id, void* pUserData, Agent* pAgent, cha
     cout << pMessage << endl;
 }
 
-void Run_PerformanceTest(int numTrials, int numDecisions, StatsTracker* pSt, const vector<string>& commands, int numInits, const vector<string>& init_commands)
+// With timedCmd set, each pass times that command instead of a run.  The
+// command's own elapsed time is recorded in place of the kernel times.
+void Run_PerformanceTest(int numTrials, int numDecisions, StatsTracker* pSt, const vector<string>& commands, int numInits, const vector<string>& init_commands, const string& timedCmd = "")
 {
 
     for (int i = 0; i < numTrials; i++)
@@ -21,6 +31,7 @@ void Run_PerformanceTest(int numTrials, int numDecisions, StatsTracker* pSt, con
         Agent* agent = kernel->CreateAgent("Soar1");
         string runCmd = "time run ";
         if (numDecisions > 0) runCmd += to_string(numDecisions);
+        if (!timedCmd.empty()) runCmd = "time " + timedCmd;
         cout << (i+1) << " ";
         cout.flush();
 
@@ -50,6 +61,12 @@ void Run_PerformanceTest(int numTrials, int numDecisions, StatsTracker* pSt, con
                 agent->ExecuteCommandLineXML(runCmd.c_str(), &response);
 
                 pSt->realtimes.push_back(response.GetArgFloat(sml_Names::kParamRealSeconds, 0.0));
+                if (!timedCmd.empty())
+                {
+                    pSt->kerneltimes.push_back(pSt->realtimes.back());
+                    pSt->totaltimes.push_back(pSt->realtimes.back());
+                    continue;
+                }
 
                 agent->ExecuteCommandLineXML("stats", &response);
                 pSt->kerneltimes.push_back(response.GetArgFloat(sml_Names::kParamStatsKernelCPUTime, 0.0));
@@ -67,6 +84,101 @@ void Run_PerformanceTest(int numTrials, int numDecisions, StatsTracker* pSt, con
     cout.flush();
 }
 
+// Times an agent's symbol tables directly, with count fresh string and
+// integer constants: creating them, finding each one again, finding names
+// that aren't there, and releasing them.  Each step gets its own line of
+// results.  Every lookup is checked; returns false if one was wrong.
+bool Run_SymbolTableTest(int numTrials, int count)
+{
+    const char* steps[] = { "string insert", "string lookup", "string lookup (miss)", "integer insert", "integer lookup", "remove (both)" };
+    const int numSteps = sizeof(steps) / sizeof(steps[0]);
+    const int64_t intBase = static_cast<int64_t>(1) << 40;
+    vector<StatsTracker> stepStats(numSteps);
+    vector<string> names, missingNames;
+    bool ok = true;
+
+    for (int i = 0; i < count; i++)
+    {
+        names.push_back("symbol-benchmark-" + to_string(i));
+        missingNames.push_back("symbol-benchmark-missing-" + to_string(i));
+    }
+
+    for (int trial = 0; trial < numTrials; trial++)
+    {
+        Kernel* kernel = Kernel::CreateKernelInCurrentThread();
+        kernel->CreateAgent("Soar1");
+        Symbol_Manager* symbols = Soar_Instance::Get_Soar_Instance().Get_Agent_Info("Soar1")->GetSoarAgent()->symbolManager;
+        vector<Symbol*> strSyms(count), intSyms(count);
+        int step = 0;
+        chrono::steady_clock::time_point start;
+        auto record = [&]()
+        {
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            stepStats[step].realtimes.push_back(seconds);
+            stepStats[step].kerneltimes.push_back(seconds);
+            stepStats[step].totaltimes.push_back(seconds);
+            step++;
+        };
+        cout << (trial + 1) << " ";
+        cout.flush();
+
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < count; i++)
+        {
+            strSyms[i] = symbols->make_str_constant(names[i].c_str(), names[i].length());
+        }
+        record();
+
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < count; i++)
+        {
+            ok &= (symbols->find_str_constant(names[i].c_str(), names[i].length()) == strSyms[i]);
+        }
+        record();
+
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < count; i++)
+        {
+            ok &= (symbols->find_str_constant(missingNames[i].c_str(), missingNames[i].length()) == NULL);
+        }
+        record();
+
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < count; i++)
+        {
+            intSyms[i] = symbols->make_int_constant(intBase + i);
+        }
+        record();
+
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < count; i++)
+        {
+            ok &= (symbols->find_int_constant(intBase + i) == intSyms[i]);
+        }
+        record();
+
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < count; i++)
+        {
+            symbols->symbol_remove_ref(&strSyms[i]);
+            symbols->symbol_remove_ref(&intSyms[i]);
+        }
+        record();
+
+        kernel->Shutdown();
+        delete kernel;
+        cout << (ok ? "✅  " : "❌  ");
+        cout.flush();
+    }
+    cout << endl;
+
+    for (int step = 0; step < numSteps; step++)
+    {
+        stepStats[step].PrintResults((string("symbol-tables ") + steps[step]).c_str());
+    }
+    return ok;
+}
+
 int main(int argc, char* argv[])
 {
     set_working_directory_to_executable_path();
@@ -104,7 +216,7 @@ int main(int argc, char* argv[])
     }
     else
     {
-        cout << "Usage: " << argv[0] << " [default | <agent name>] [<numtrials>] [<num_decisions>] [<num_init_and_rerun>]" << endl;
+        cout << "Usage: " << argv[0] << " [default | <agent name> | <rete-net file>.soarx | symbol-tables] [<numtrials>] [<num_decisions> | <num_symbols>] [<num_init_and_rerun>]" << endl;
         return 1;
     }
     if (!strcmp(agentname, "default"))
@@ -113,12 +225,46 @@ int main(int argc, char* argv[])
     }
     if (!numDCs) numDCs = DEFAULT_DCS;
 
+    if (!strcmp(agentname, "symbol-tables"))
+    {
+        // The decisions argument is the number of symbols of each kind
+        int numSymbols = (numDCs > 0) ? numDCs : 1000000;
+        cout << "\e[1;31m" << agentname << "\e[0;37m" << ": ";
+        if (numTrials > 1) cout << numTrials << " trials"; else cout << "single run";
+        cout << ", " << numSymbols << " symbols" << endl;
+        return Run_SymbolTableTest(numTrials, numSymbols) ? 0 : 1;
+    }
+
     cout << "\e[1;31m" << agentname << "\e[0;37m" << ": ";
     if (numTrials > 1) cout << numTrials << " trials"; else cout << "single run";
     if (numDCs > 0) cout << ", " << numDCs << " DCs"; else cout << ", run forever";
     if (numInits > 0) cout << ", " << numInits << " extra init-soar/runs\n"; else cout << endl;
     cout.flush();
 
+    string agentfile(agentname);
+    if ((agentfile.size() > 6) && (agentfile.compare(agentfile.size() - 6, 6, ".soarx") == 0))
+    {
+        // Times loading a rete-net.  The file is saved again first, so the
+        // timings are for the current checksummed format whatever the
+        // version of the original.
+        StatsTracker l_testStats;
+        vector<string> commands, init_commands;
+
+        commands.push_back("pushd SoarPerformanceTests");
+        commands.push_back("output console off");
+        commands.push_back("output callbacks off");
+        commands.push_back("watch 0");
+        commands.push_back("rete-net -l " + agentfile);
+        commands.push_back("rete-net -s rete-load-benchmark.soarx");
+
+        Run_PerformanceTest(numTrials, numDCs, &l_testStats, commands, numInits, init_commands, "rete-net -l rete-load-benchmark.soarx");
+
+        l_testStats.PrintResults(agentname);
+        set_working_directory_to_executable_path();  // undo the agent's pushd
+        remove("SoarPerformanceTests/rete-load-benchmark.soarx");
+        return 0;
+    }
+
     {
         StatsTracker l_testStats;
         vector<string> commands, init_commands;
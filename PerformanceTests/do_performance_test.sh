@@ -33,10 +33,20 @@ if [ $lTestSuite == "full" ] ; then
     nice -n -10 ./PerformanceTests fifteen96_learning 10 500
     nice -n -10 ./PerformanceTests count-test-5000 3
     nice -n -10 ./PerformanceTests count-test-5000_learning 3
+    nice -n -10 ./PerformanceTests count-test-5000.soarx 3 0 20
+    nice -n -10 ./PerformanceTests symbol-tables 3 1000000
     nice -n -10 ./PerformanceTests mac-planning96 1 300 15
     nice -n -10 ./PerformanceTests mac-planning96_learning 4 165 64
     nice -n -10 ./PerformanceTests water-jug-lookahead96 15 10000
     nice -n -10 ./PerformanceTests water-jug-lookahead96_learning 2 102 100
+    nice -n -10 ./PerformanceTests epmem-query 3 10000
+    nice -n -10 ./PerformanceTests epmem-query_index 3 10000
+    nice -n -10 ./PerformanceTests smem-retrieve 3 10000
+    nice -n -10 ./PerformanceTests smem-retrieve_nocache 3 10000
+    nice -n -10 ./PerformanceTests smem-base-level 3 10000
+    nice -n -10 ./PerformanceTests smem-base-level_unbatched 3 10000
+    nice -n -10 ./PerformanceTests smem-spread 3 2000
+    nice -n -10 ./PerformanceTests smem-spread_nograph 3 2000
   elif [ $lVersion == "9.4" ] ; then
     nice -n -10 ./PerformanceTests wait 3 1000000
     nice -n -10 ./PerformanceTests wait_learning 1 1000000 2
@@ -66,10 +76,20 @@ elif [ $lTestSuite == "fast" ] ; then
     nice -n -10 ./PerformanceTests fifteen96_learning 2 500
     nice -n -10 ./PerformanceTests count-test-5000 1
     nice -n -10 ./PerformanceTests count-test-5000_learning 1
+    nice -n -10 ./PerformanceTests count-test-5000.soarx 1 0 5
+    nice -n -10 ./PerformanceTests symbol-tables 1 1000000
     nice -n -10 ./PerformanceTests mac-planning96 1 300 3
     nice -n -10 ./PerformanceTests mac-planning96_learning 2 165 32
     nice -n -10 ./PerformanceTests water-jug-lookahead96 3 10000
     nice -n -10 ./PerformanceTests water-jug-lookahead96_learning 2 102 100
+    nice -n -10 ./PerformanceTests epmem-query 1 5000
+    nice -n -10 ./PerformanceTests epmem-query_index 1 5000
+    nice -n -10 ./PerformanceTests smem-retrieve 1 5000
+    nice -n -10 ./PerformanceTests smem-retrieve_nocache 1 5000
+    nice -n -10 ./PerformanceTests smem-base-level 1 5000
+    nice -n -10 ./PerformanceTests smem-base-level_unbatched 1 5000
+    nice -n -10 ./PerformanceTests smem-spread 1 1000
+    nice -n -10 ./PerformanceTests smem-spread_nograph 1 1000
 
   elif [ $lVersion == "9.4" ] ; then
     nice -n -10 ./PerformanceTests wait 1 1000000
@@ -11,6 +11,8 @@
 #include <string>
 
 #include "ElementXML.h"
+#include "sml_BinaryEncoding.h"
+#include "sml_Names.h"
 
 const std::string tag1("tag1");
 const std::string att11("att11");
@@ -300,3 +302,179 @@ void ElementXMLTest::testEquals()
 	assertTrue_msg(soarxml::ElementXML::GetLastParseErrorDescription(), element != 0);
 	delete element;
 }
+
+void ElementXMLTest::testBinaryEncoding()
+{
+	soarxml::ElementXML* pXML1 = createXML1();
+	soarxml::ElementXML* pXML2 = createXML2();
+	soarxml::ElementXML* pXML3 = createXML3();
+	soarxml::ElementXML* pXML5 = createXML5();
+	
+	// A mix of dictionary names, integers and values that only look like integers
+	soarxml::ElementXML* pRoot = new soarxml::ElementXML();
+	pRoot->SetTagName("sml");
+	pRoot->AddAttribute("doctype", "call");
+	pRoot->AddAttribute("id", "42");
+	pRoot->AddAttribute("ack", "-9000000000");
+	pRoot->AddAttribute("att31", "007");
+	pRoot->AddAttribute("att32", "-0");
+	pRoot->AddAttribute("att33", "12345678901234567890");
+	pRoot->AddAttribute("att34", "");
+	
+	pXML3->AddChild(pXML2);
+	pRoot->AddChild(pXML1);
+	pRoot->AddChild(pXML3);
+	pRoot->AddChild(pXML5);
+	
+	std::string encoded;
+	sml::BinaryEncoding::EncodeMessage(pRoot, &encoded);
+	assertTrue(sml::BinaryEncoding::IsBinaryMessage(encoded.data(), encoded.size()));
+	
+	char* pStr = pRoot->GenerateXMLString(true);
+	assertTrue(!sml::BinaryEncoding::IsBinaryMessage(pStr, strlen(pStr)));
+	assertTrue(encoded.size() < strlen(pStr));
+	
+	soarxml::ElementXML* pDecoded = sml::BinaryEncoding::DecodeMessage(encoded.data(), encoded.size());
+	assertTrue(pDecoded != NULL);
+	
+	// The decoded message is the same message
+	char* pDecodedStr = pDecoded->GenerateXMLString(true);
+	assertTrue_msg(pDecodedStr, std::string(pStr) == pDecodedStr);
+	
+	soarxml::ElementXML child(NULL);
+	assertTrue(pDecoded->GetChild(&child, 2));
+	assertTrue(child.IsCharacterDataBinary());
+	assertTrue(child.GetCharacterDataLength() == BUFFER_LENGTH);
+	assertTrue(verifyBuffer(child.GetCharacterData()));
+	
+	assertTrue(pDecoded->GetChild(&child, 0));
+	assertTrue(std::string(child.GetComment()) == comment1);
+	
+	// A message cut short is rejected rather than half read
+	for (size_t length = 0 ; length < encoded.size() ; length++)
+	{
+		assertTrue(sml::BinaryEncoding::DecodeMessage(encoded.data(), length) == NULL);
+	}
+	
+	soarxml::ElementXML::DeleteString(pStr);
+	soarxml::ElementXML::DeleteString(pDecodedStr);
+	
+	delete pDecoded;
+	delete pRoot;
+	
+	// "version" is the last dictionary entry; one past it is rejected
+	soarxml::ElementXML last;
+	last.SetTagName("version");
+	encoded.clear();
+	sml::BinaryEncoding::EncodeMessage(&last, &encoded);
+	assertTrue(static_cast<unsigned char>(encoded[2]) < 0x7F);
+	pDecoded = sml::BinaryEncoding::DecodeMessage(encoded.data(), encoded.size());
+	assertTrue(pDecoded != NULL && std::string(pDecoded->GetTagName()) == "version");
+	delete pDecoded;
+	encoded[2]++;
+	assertTrue(sml::BinaryEncoding::DecodeMessage(encoded.data(), encoded.size()) == NULL);
+	
+	// Elements nested 1000 deep are read, but not 1001
+	for (int depth = 1000; depth <= 1001; depth++)
+	{
+		std::string nested("\0\1", 2);
+		for (int i = 1; i <= depth; i++)
+		{
+			// name "sml", no attributes, no flags, one child but the last
+			const char element[] = { 1, 0, 0, static_cast<char>((i < depth) ? 1 : 0) };
+			nested.append(element, sizeof(element));
+		}
+		pDecoded = sml::BinaryEncoding::DecodeMessage(nested.data(), nested.size());
+		assertTrue((depth <= 1000) == (pDecoded != NULL));
+		delete pDecoded;
+	}
+}
+
+void ElementXMLTest::testBinaryEncodingOffer()
+{
+	soarxml::ElementXML* pRoot = new soarxml::ElementXML();
+	pRoot->SetTagName("sml");
+	pRoot->AddAttribute("doctype", "call");
+	pRoot->SetComment(comment1.c_str());
+	pRoot->AddChild(createXML1());
+	
+	char* pStr = pRoot->GenerateXMLString(true);
+	std::string xml(pStr);
+	sml::BinaryEncoding::AddVersionOffer(&xml);
+	
+	// The offer goes into the text only
+	assertTrue(pRoot->GetAttribute(sml::sml_Names::kBinaryEncoding) == NULL);
+	char* pAfter = pRoot->GenerateXMLString(true);
+	assertTrue(std::string(pStr) == pAfter);
+	
+	soarxml::ElementXML* pParsed = soarxml::ElementXML::ParseXMLFromString(xml.c_str());
+	assertTrue_msg(soarxml::ElementXML::GetLastParseErrorDescription(), pParsed != NULL);
+	assertTrue(std::string(pParsed->GetTagName()) == "sml");
+	assertTrue(std::string(pParsed->GetComment()) == comment1);
+	assertTrue(std::string(pParsed->GetAttribute("doctype")) == "call");
+	assertTrue(std::string(pParsed->GetAttribute(sml::sml_Names::kBinaryEncoding)) == sml::BinaryEncoding::kVersionValue);
+	assertTrue(pParsed->GetNumberChildren() == 1);
+	
+	soarxml::ElementXML::DeleteString(pStr);
+	soarxml::ElementXML::DeleteString(pAfter);
+	delete pParsed;
+	delete pRoot;
+	
+	// An element with no attributes or children is written as "<sml/>"
+	soarxml::ElementXML empty;
+	empty.SetTagName("sml");
+	pStr = empty.GenerateXMLString(true);
+	xml = pStr;
+	soarxml::ElementXML::DeleteString(pStr);
+	sml::BinaryEncoding::AddVersionOffer(&xml);
+	pParsed = soarxml::ElementXML::ParseXMLFromString(xml.c_str());
+	assertTrue_msg(soarxml::ElementXML::GetLastParseErrorDescription(), pParsed != NULL);
+	assertTrue(std::string(pParsed->GetAttribute(sml::sml_Names::kBinaryEncoding)) == sml::BinaryEncoding::kVersionValue);
+	delete pParsed;
+}
+
+void ElementXMLTest::testLargeElements()
+{
+	// More attributes and children than an element keeps inline
+	soarxml::ElementXML* pRoot = new soarxml::ElementXML();
+	pRoot->SetTagName("root");
+	
+	for (int i = 0 ; i < 50 ; i++)
+	{
+		std::string name = "att" + std::to_string(i);
+		pRoot->AddAttribute(name.c_str(), std::to_string(i).c_str());
+		
+		soarxml::ElementXML* pChild = new soarxml::ElementXML();
+		pChild->SetTagName(("child" + std::to_string(i)).c_str());
+		pChild->SetCharacterData(std::string(i * 10, 'x').c_str());
+		pRoot->AddChild(pChild);
+	}
+	
+	// Adding an attribute again replaces its value
+	pRoot->AddAttribute("att7", "seven");
+	
+	assertTrue(pRoot->GetNumberAttributes() == 50);
+	assertTrue(pRoot->GetNumberChildren() == 50);
+	assertTrue(std::string(pRoot->GetAttribute("att7")) == "seven");
+	assertTrue(std::string(pRoot->GetAttribute("att49")) == "49");
+	
+	// The copy is the same message
+	soarxml::ElementXML* pCopy = pRoot->MakeCopy();
+	char* pStr = pRoot->GenerateXMLString(true);
+	char* pCopyStr = pCopy->GenerateXMLString(true);
+	assertTrue(std::string(pStr) == pCopyStr);
+	soarxml::ElementXML::DeleteString(pStr);
+	soarxml::ElementXML::DeleteString(pCopyStr);
+	
+	// A child kept after its message has gone still works
+	soarxml::ElementXML* pChild = new soarxml::ElementXML(NULL);
+	assertTrue(pCopy->GetChild(pChild, 42));
+	
+	delete pCopy;
+	delete pRoot;
+	
+	assertTrue(std::string(pChild->GetTagName()) == "child42");
+	assertTrue(pChild->GetCharacterDataLength() == 421);
+	
+	delete pChild;
+}
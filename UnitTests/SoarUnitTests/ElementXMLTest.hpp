@@ -41,6 +41,15 @@ public:
 	TEST(testEquals, -1);
 	void testEquals();
 	
+	TEST(testBinaryEncoding, -1);
+	void testBinaryEncoding();
+	
+	TEST(testBinaryEncodingOffer, -1);
+	void testBinaryEncodingOffer();
+	
+	TEST(testLargeElements, -1);
+	void testLargeElements();
+	
 private:
 	soarxml::ElementXML* createXML1();
 	soarxml::ElementXML* createXML2();
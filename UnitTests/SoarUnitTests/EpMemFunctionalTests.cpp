@@ -9,11 +9,16 @@
 #include "EpMemFunctionalTests.hpp"
 
 #include <cassert>
+#include <fstream>
+#include <iterator>
+#include <sstream>
 #include <string>
 #include <list>
 #include <thread>
+#include <chrono>
 
 #include "SoarHelper.hpp"
+#include "handlers.hpp"
 
 void EpMemFunctionalTests::tearDown(bool caught)
 {
@@ -38,6 +43,116 @@ void EpMemFunctionalTests::testKB()
 	runTest("testKB", 246);
 }
 
+void EpMemFunctionalTests::testKB_StorageThread()
+{
+    agent->ExecuteCommandLine("epmem --set storage-thread on");
+    assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+	runTest("testKB", 246);
+}
+
+void EpMemFunctionalTests::testKB_WALGroupCommit()
+{
+    std::string pwd = agent->ExecuteCommandLine("pwd");
+    std::string db = pwd + "/epmem-wal-test.sqlite";
+    remove(db.c_str());
+
+    const char* settings[] = { "epmem --set database file", "epmem --set optimization wal",
+                               "epmem --set commit-interval 10", "epmem --set checkpoint-thread on" };
+    agent->ExecuteCommandLine(std::string("epmem --set path \"" + db + "\"").c_str());
+    assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+    for (const char* setting : settings)
+    {
+        agent->ExecuteCommandLine(setting);
+        assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+    }
+
+	runTest("testKB", 246);
+
+    // checkpoints are made in the background, shortly after a commit
+    assertTrue_msg("no group commits were made", std::stoll(agent->ExecuteCommandLine("epmem --stats commits")) > 0);
+    for (int i = 0; (i < 100) && (std::stoll(agent->ExecuteCommandLine("epmem --stats checkpoints")) == 0); i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    assertTrue_msg("no WAL checkpoints were made", std::stoll(agent->ExecuteCommandLine("epmem --stats checkpoints")) > 0);
+
+    // every episode survives closing and reopening the database
+    int64_t time = std::stoll(agent->ExecuteCommandLine("epmem --stats time"));
+    agent->ExecuteCommandLine("epmem --close");
+    agent->ExecuteCommandLine("epmem --set append on");
+    assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+    assertTrue_msg("episodes were lost on reopening", std::stoll(agent->ExecuteCommandLine("epmem --stats time")) == time);
+    agent->ExecuteCommandLine(std::string("epmem --print " + std::to_string(time - 1)).c_str());
+    assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+
+    agent->ExecuteCommandLine("epmem --close");
+    agent->ExecuteCommandLine("epmem --set database memory");
+    remove(db.c_str());
+    remove((db + "-wal").c_str());
+    remove((db + "-shm").c_str());
+}
+
+void EpMemFunctionalTests::testKB_IntervalIndexFile()
+{
+    std::string pwd = agent->ExecuteCommandLine("pwd");
+    std::string db = pwd + "/epmem-index-test.sqlite";
+    std::string index = db + "-index";
+    remove(db.c_str());
+    remove(index.c_str());
+
+    const char* settings[] = { "epmem --set database file", "epmem --set append on", "epmem --set optimization safety", "epmem --set interval-index on" };
+    agent->ExecuteCommandLine(std::string("epmem --set path \"" + db + "\"").c_str());
+    assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+    for (const char* setting : settings)
+    {
+        agent->ExecuteCommandLine(setting);
+        assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+    }
+
+    std::string opt = agent->ExecuteCommandLine("epmem --get optimization");
+    assertTrue_msg("optimization does not read back as safety: " + opt, opt.find("safety") != std::string::npos);
+
+	runTest("testKB", 246);
+
+    // closing saves the index next to the database; reopening reads it back
+    agent->ExecuteCommandLine("epmem --close");
+    FILE* f = fopen(index.c_str(), "rb");
+    assertTrue_msg("interval index was not saved", f != NULL);
+    fclose(f);
+    std::ifstream saved(index.c_str(), std::ios::binary);
+    std::string old_index((std::istreambuf_iterator<char>(saved)), std::istreambuf_iterator<char>());
+    saved.close();
+
+    // the trace says whether the index was loaded or rebuilt
+    std::stringstream trace;
+    std::string loaded_trace, stale_trace;
+    int callback = agent->RegisterForPrintEvent(sml::smlEVENT_PRINT, Handlers::MyPrintEventHandler, &trace);
+    agent->ExecuteCommandLine("trace --epmem");
+    agent->ExecuteCommandLine("epmem --init");
+    loaded_trace = trace.str();
+
+    // an index from an earlier close no longer matches, even though the
+    // episode clock and entry counts are the same
+    agent->ExecuteCommandLine("epmem --close");
+    std::ofstream stale(index.c_str(), std::ios::binary | std::ios::trunc);
+    stale << old_index;
+    stale.close();
+    trace.str("");
+    agent->ExecuteCommandLine("epmem --init");
+    stale_trace = trace.str();
+    agent->UnregisterForPrintEvent(callback);
+
+    assertTrue_msg("saved interval index was not used: " + loaded_trace, loaded_trace.find("loaded episodic memory interval index") != std::string::npos);
+    assertTrue_msg("stale interval index was used: " + stale_trace, stale_trace.find("built episodic memory interval index") != std::string::npos);
+    agent->ExecuteCommandLine("epmem --print 5");
+    assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+
+    agent->ExecuteCommandLine("epmem --close");
+    agent->ExecuteCommandLine("epmem --set database memory");
+    remove(db.c_str());
+    remove(index.c_str());
+}
+
 void EpMemFunctionalTests::testSingleStoreRetrieve()
 {
 	runTest("testSingleStoreRetrieve", 2);
@@ -171,6 +286,55 @@ void EpMemFunctionalTests::testReadCSoarDB()
 	assertTrue_msg("Unexpected output from CSoar database!", actualResult == expectedResult);
 }
 
+void EpMemFunctionalTests::testRetention()
+{
+    runTest("testRetention", -1);
+}
+
+void EpMemFunctionalTests::testRetention_IntervalIndex()
+{
+    agent->ExecuteCommandLine("epmem --set interval-index on");
+    assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+    runTest("testRetention", -1);
+}
+
+void EpMemFunctionalTests::testRetention_StorageThread()
+{
+    agent->ExecuteCommandLine("epmem --set storage-thread on");
+    assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+    runTest("testRetention", -1);
+}
+
+void EpMemFunctionalTests::testRetention_Reopen()
+{
+    std::string pwd = agent->ExecuteCommandLine("pwd");
+    std::string db = pwd + "/epmem-retention-test.sqlite";
+    remove(db.c_str());
+
+    const char* settings[] = { "epmem --set database file", "epmem --set append on", "epmem --set storage-thread on" };
+    agent->ExecuteCommandLine(std::string("epmem --set path \"" + db + "\"").c_str());
+    assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+    for (const char* setting : settings)
+    {
+        agent->ExecuteCommandLine(setting);
+        assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+    }
+
+    runTest("testRetention", -1);
+
+    // the oldest kept episode is stored with the episodes
+    int64_t floor = std::stoll(agent->ExecuteCommandLine("epmem --stats retention-floor"));
+    assertTrue_msg("retention never expired an episode", floor > 0);
+    agent->ExecuteCommandLine("epmem --close");
+    agent->ExecuteCommandLine("epmem --init");
+    assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+    assertTrue_msg("retention floor was not restored", std::stoll(agent->ExecuteCommandLine("epmem --stats retention-floor")) == floor);
+
+    agent->ExecuteCommandLine("epmem --close");
+    agent->ExecuteCommandLine("epmem --set database memory");
+    remove(db.c_str());
+}
+
 
 void EpMemFunctionalTests::testMultiAgent()
 {
@@ -238,6 +402,22 @@ void EpMemFunctionalTests::testEpmemUnit_1()
     runTest("epmem_unit_test_1", 113);
 }
 
+void EpMemFunctionalTests::testEpmemUnit_1_StorageThread()
+{
+    agent->ExecuteCommandLine("epmem --set storage-thread on");
+    assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+    agent->ExecuteCommandLine("epmem --set lazy-commit off");
+    assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+    runTest("epmem_unit_test_1", 113);
+}
+
+void EpMemFunctionalTests::testEpmemUnit_1_IntervalIndex()
+{
+    agent->ExecuteCommandLine("epmem --set interval-index on");
+    assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+    runTest("epmem_unit_test_1", 113);
+}
+
 void EpMemFunctionalTests::testEpmemUnit_2()
 {
     runTest("epmem_unit_test_2", 113);
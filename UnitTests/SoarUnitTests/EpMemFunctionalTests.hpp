@@ -27,6 +27,8 @@ public:
 	TEST(testEpMemEncodeSelection_WMA, -1)
 //	TEST(testEpMemSmemFactorizationCombinationTest, -1)
 	TEST(testEpmemUnit_1, -1)
+	TEST(testEpmemUnit_1_StorageThread, -1)
+	TEST(testEpmemUnit_1_IntervalIndex, -1)
 	TEST(testEpmemUnit_2, -1)
 	TEST(testEpmemUnit_3, -1)
 	TEST(testEpmemUnit_4, -1)
@@ -43,6 +45,9 @@ public:
 	TEST(testHamilton, -1)
 	TEST(testHamiltonian, -1)
 	TEST(testKB, -1)
+	TEST(testKB_StorageThread, -1)
+	TEST(testKB_WALGroupCommit, -1)
+	TEST(testKB_IntervalIndexFile, -1)
 	TEST(testMaxDoublePrecision_Irrational, -1)
 	TEST(testMaxDoublePrecisionEpMem, -1)
 	TEST(testMultiAgent, -1)
@@ -50,6 +55,10 @@ public:
 	TEST(testNonExistingEpisode, -1)
 	TEST(testOddEven, -1)
 	TEST(testReadCSoarDB, -1)
+	TEST(testRetention, -1)
+	TEST(testRetention_IntervalIndex, -1)
+	TEST(testRetention_StorageThread, -1)
+	TEST(testRetention_Reopen, -1)
 	TEST(testSimpleFloatEpMem, -1)
 	TEST(testSingleStoreRetrieve, -1)
 	TEST(testSVS, -1)
@@ -71,6 +80,8 @@ public:
 	void testEpMemEncodeSelection_NoWMA();
 	void testEpMemEncodeSelection_WMA();
 	void testEpmemUnit_1();
+	void testEpmemUnit_1_StorageThread();
+	void testEpmemUnit_1_IntervalIndex();
 	void testEpmemUnit_2();
 	void testEpmemUnit_3();
 	void testEpmemUnit_4();
@@ -89,6 +100,9 @@ public:
 	void testHamilton();
 	void testHamiltonian();
 	void testKB();
+	void testKB_StorageThread();
+	void testKB_WALGroupCommit();
+	void testKB_IntervalIndexFile();
 	void testMaxDoublePrecision_Irrational();
 	void testMaxDoublePrecisionEpMem();
 	void testMultiAgent();
@@ -96,6 +110,10 @@ public:
 	void testNonExistingEpisode();
 	void testOddEven();
 	void testReadCSoarDB();
+	void testRetention();
+	void testRetention_IntervalIndex();
+	void testRetention_StorageThread();
+	void testRetention_Reopen();
 	void testSimpleFloatEpMem();
 	void testSingleStoreRetrieve();
 	void testSVS();
@@ -17,6 +17,10 @@
 #include "sml_AgentSML.h"
 #include "soar_instance.h"
 
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
 bool g_Cancel = false;
 
 #ifdef _WIN32
@@ -1061,6 +1065,107 @@ void FullTests_Parent::test64BitReteNet()
     SoarHelper::init_check_to_find_refcount_leaks(agent);
 }
 
+// Returns the names of all loaded productions, sorted, since a reloaded net lists them in a different order
+static std::vector<std::string> sortedProductionNames(sml::Agent* pAgent)
+{
+    std::istringstream lNames(pAgent->ExecuteCommandLine("print"));
+    std::vector<std::string> lResult;
+    std::string lName;
+    while (lNames >> lName)
+    {
+        lResult.push_back(lName);
+    }
+    std::sort(lResult.begin(), lResult.end());
+    return lResult;
+}
+
+void FullTests_Parent::testReteNetSaveAndReload()
+{
+    const char* kFile = "testReteNetSaveAndReload.soarx";
+    
+    agent->ExecuteCommandLine(("rete-net -l \"" + SoarHelper::GetResource("test64.soarx") + "\"").c_str());
+    no_agent_assertTrue(agent->GetLastCommandLineResult());
+    std::vector<std::string> lBefore = sortedProductionNames(agent);
+    no_agent_assertTrue(!lBefore.empty());
+    
+    agent->ExecuteCommandLine((std::string("rete-net -s ") + kFile).c_str());
+    no_agent_assertTrue(agent->GetLastCommandLineResult());
+    agent->ExecuteCommandLine("excise --all");
+    agent->ExecuteCommandLine((std::string("rete-net -l ") + kFile).c_str());
+    no_agent_assertTrue(agent->GetLastCommandLineResult());
+    no_agent_assertTrue(sortedProductionNames(agent) == lBefore);
+    
+    // Damage the last byte; the checksum should catch it before the agent's rules are excised
+    FILE* lFile = fopen(kFile, "r+b");
+    no_agent_assertTrue(lFile != NULL);
+    fseek(lFile, -1, SEEK_END);
+    int lLast = fgetc(lFile);
+    fseek(lFile, -1, SEEK_END);
+    fputc(lLast ^ 0xFF, lFile);
+    fclose(lFile);
+    
+    agent->ExecuteCommandLine((std::string("rete-net -l ") + kFile).c_str());
+    no_agent_assertTrue(!agent->GetLastCommandLineResult());
+    no_agent_assertTrue(sortedProductionNames(agent) == lBefore);
+    
+    remove(kFile);
+    SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
+// Writes the 64-bit FNV-1a checksum, or any other word, LSB first
+static void writeLittleEndian(std::string& pOut, uint64_t pWord)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        pOut.push_back(static_cast<char>((pWord >> (8 * i)) & 0xFF));
+    }
+}
+
+void FullTests_Parent::testChecksummed32BitReteNet()
+{
+    const char* kFile = "testChecksummed32BitReteNet.soarx";
+    const size_t kHeaderSize = sizeof("SoarCompactReteNet\n");
+    
+    // test.soarx is an old version 3 file with 4-byte words and no checksum
+    std::ifstream lOld(SoarHelper::GetResource("test.soarx").c_str(), std::ios::binary);
+    std::string lBytes((std::istreambuf_iterator<char>(lOld)), std::istreambuf_iterator<char>());
+    no_agent_assertTrue(lBytes.size() > kHeaderSize && lBytes[kHeaderSize] == 3);
+    
+    // Rewrap its body as version 6, which keeps the 4-byte words but adds a length and checksum
+    std::string lBody = lBytes.substr(kHeaderSize + 1);
+    uint64_t lChecksum = 14695981039346656037ULL;
+    for (size_t i = 0; i < lBody.size(); i++)
+    {
+        lChecksum ^= static_cast<uint8_t>(lBody[i]);
+        lChecksum *= 1099511628211ULL;
+    }
+    std::string lFile = lBytes.substr(0, kHeaderSize);
+    lFile.push_back(6);
+    writeLittleEndian(lFile, lBody.size());
+    writeLittleEndian(lFile, lChecksum);
+    std::ofstream(kFile, std::ios::binary) << lFile << lBody;
+    
+    agent->ExecuteCommandLine(("rete-net -l \"" + SoarHelper::GetResource("test.soarx") + "\"").c_str());
+    no_agent_assertTrue(agent->GetLastCommandLineResult());
+    std::vector<std::string> lBefore = sortedProductionNames(agent);
+    no_agent_assertTrue(!lBefore.empty());
+    
+    agent->ExecuteCommandLine("excise --all");
+    agent->ExecuteCommandLine((std::string("rete-net -l ") + kFile).c_str());
+    no_agent_assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+    no_agent_assertTrue(sortedProductionNames(agent) == lBefore);
+    
+    // Damage a byte in the middle of the body; the load should be refused and leave the rules alone
+    lBody[lBody.size() / 2] ^= 0x01;
+    std::ofstream(kFile, std::ios::binary | std::ios::trunc) << lFile << lBody;
+    agent->ExecuteCommandLine((std::string("rete-net -l ") + kFile).c_str());
+    no_agent_assertTrue(!agent->GetLastCommandLineResult());
+    no_agent_assertTrue(sortedProductionNames(agent) == lBefore);
+    
+    remove(kFile);
+    SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
+
 void FullTests_Parent::testOSupportCopyDestroy()
 {
     loadProductions(SoarHelper::GetResource("testOSupportCopyDestroy.soar"));
@@ -1661,3 +1766,63 @@ void FullTests_Parent::testOutputLinkRemovalOrdering()
 
     SoarHelper::init_check_to_find_refcount_leaks(agent);
 }
+
+void FullTests_Parent::testAsyncCommands()
+{
+    // Held commands aren't sent (or finished) until the batch goes out
+    m_pKernel->BeginCommandBatch();
+    sml::CommandFuture* pProduction = agent->ExecuteCommandLineAsync("sp {async-test (state <s> ^superstate nil) --> (<s> ^async-test 1)}");
+    sml::CommandFuture* pEcho = agent->ExecuteCommandLineAsync("echo async-hello");
+    sml::CommandFuture* pBad = agent->ExecuteCommandLineAsync("this-is-not-a-command");
+    no_agent_assertTrue(!pEcho->IsReady());
+    m_pKernel->SendCommandBatch();
+
+    // Responses can be collected in any order
+    no_agent_assertTrue(!pBad->Wait());
+    no_agent_assertTrue(pEcho->Wait());
+    no_agent_assertTrue(strstr(pEcho->GetResult(), "async-hello") != NULL);
+    no_agent_assertTrue(pProduction->Wait());
+    no_agent_assertTrue(pProduction->IsReady());
+    delete pProduction;
+    delete pEcho;
+    delete pBad;
+
+    // Deleting a command we never waited for is fine, and doesn't disturb the next one
+    delete agent->ExecuteCommandLineAsync("echo abandoned");
+    no_agent_assertTrue(agent->IsProductionLoaded("async-test"));
+
+    // Working memory changes can be committed without waiting too
+    m_pKernel->SetAutoCommit(false);
+    agent->GetInputLink()->CreateIntWME("async-wme", 7);
+    sml::CommandFuture* pCommit = agent->CommitAsync();
+    no_agent_assertTrue(!agent->IsCommitRequired());
+    no_agent_assertTrue(pCommit->Wait());
+    delete pCommit;
+    agent->RunSelf(1);
+    no_agent_assertTrue(strstr(agent->ExecuteCommandLine("print i2"), "^async-wme 7") != NULL);
+
+    // With nothing to commit the result is ready straight away
+    pCommit = agent->CommitAsync();
+    no_agent_assertTrue(pCommit->IsReady() && pCommit->Wait());
+    delete pCommit;
+
+    // CommitAll() sends the commits but keeps holding the caller's batch
+    m_pKernel->BeginCommandBatch();
+    sml::CommandFuture* pHeld = agent->ExecuteCommandLineAsync("echo held-across-commit");
+    agent->GetInputLink()->CreateIntWME("commit-all-wme", 8);
+    m_pKernel->CommitAll();
+    no_agent_assertTrue(!agent->IsCommitRequired());
+    no_agent_assertTrue(!pHeld->IsReady());
+    sml::CommandFuture* pHeldAfter = agent->ExecuteCommandLineAsync("echo held-after-commit");
+    no_agent_assertTrue(!pHeldAfter->IsReady());
+    m_pKernel->SendCommandBatch();
+    no_agent_assertTrue(pHeld->Wait());
+    no_agent_assertTrue(strstr(pHeld->GetResult(), "held-across-commit") != NULL);
+    no_agent_assertTrue(pHeldAfter->Wait());
+    delete pHeld;
+    delete pHeldAfter;
+    agent->RunSelf(1);
+    no_agent_assertTrue(strstr(agent->ExecuteCommandLine("print i2"), "^commit-all-wme 8") != NULL);
+
+    SoarHelper::init_check_to_find_refcount_leaks(agent);
+}
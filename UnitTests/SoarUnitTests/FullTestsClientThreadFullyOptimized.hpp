@@ -41,6 +41,12 @@ public:
 	TEST(test64BitReteNet, -1);
 	void test64BitReteNet() { this->FullTests_Parent::test64BitReteNet(); }
 	
+	TEST(testReteNetSaveAndReload, -1);
+	void testReteNetSaveAndReload() { this->FullTests_Parent::testReteNetSaveAndReload(); }
+	
+	TEST(testChecksummed32BitReteNet, -1);
+	void testChecksummed32BitReteNet() { this->FullTests_Parent::testChecksummed32BitReteNet(); }
+	
 	TEST(testOSupportCopyDestroy, -1);
 	void testOSupportCopyDestroy() { this->FullTests_Parent::testOSupportCopyDestroy(); }
 	
@@ -115,6 +121,9 @@ public:
 	TEST(testOutputLinkRemovalOrdering, -1);
 	void testOutputLinkRemovalOrdering() { this->FullTests_Parent::testOutputLinkRemovalOrdering(); }
 	
+	TEST(testAsyncCommands, -1);
+	void testAsyncCommands() { this->FullTests_Parent::testAsyncCommands(); }
+	
 	void before() { setUp(); }
 	void after(bool caught) { tearDown(caught); }
 	
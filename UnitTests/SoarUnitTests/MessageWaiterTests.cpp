@@ -0,0 +1,162 @@
+//
+//  MessageWaiterTests.cpp
+//
+
+#include "MessageWaiterTests.hpp"
+
+#ifndef _WIN32
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <sys/socket.h>
+
+#include "sml_Connection.h"
+#include "sml_MessageWaiter.h"
+#include "sock_Socket.h"
+
+namespace
+{
+	// Sockets are normally made by a listener or a client socket,
+	// but here we just want one end of a socket pair.
+	class TestSocket : public sock::Socket
+	{
+	public:
+		TestSocket(int descriptor) : sock::Socket(descriptor) {}
+	};
+
+	double millisecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+void MessageWaiterTests::setUp()
+{
+	connection = nullptr;
+	peer = nullptr;
+}
+
+void MessageWaiterTests::tearDown(bool caught)
+{
+	delete connection;
+	delete peer;
+	connection = nullptr;
+	peer = nullptr;
+}
+
+void MessageWaiterTests::createPair()
+{
+	int sockets[2];
+	no_agent_assertTrue(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == 0);
+
+	connection = sml::Connection::CreateRemoteConnection(new TestSocket(sockets[0]));
+	peer = sml::Connection::CreateRemoteConnection(new TestSocket(sockets[1]));
+}
+
+void MessageWaiterTests::testTimeout()
+{
+	sml::MessageWaiter waiter;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	bool woken = waiter.Wait(0, 100);
+	double elapsed = millisecondsSince(start);
+
+	no_agent_assertTrue_msg("Woke with nothing to read", !woken);
+	no_agent_assertTrue_msg("Timed out after " + std::to_string(elapsed) + "ms instead of 100ms", elapsed >= 90 && elapsed < 2000);
+}
+
+void MessageWaiterTests::testSignal()
+{
+	sml::MessageWaiter waiter;
+
+	// A signal from another thread ends the wait early
+	std::thread signaller([&waiter]()
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		waiter.Signal();
+	});
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	bool woken = waiter.Wait(5, 0);
+	double elapsed = millisecondsSince(start);
+	signaller.join();
+
+	no_agent_assertTrue_msg("Wasn't woken by the signal", woken);
+	no_agent_assertTrue_msg("Took " + std::to_string(elapsed) + "ms to wake", elapsed < 2500);
+
+	// A signal with nobody waiting is kept for the next wait, and only that one
+	waiter.Signal();
+	no_agent_assertTrue_msg("Lost a signal made before the wait", waiter.Wait(0, 0));
+	no_agent_assertTrue_msg("A signal woke two waits", !waiter.Wait(0, 50));
+}
+
+void MessageWaiterTests::testMessageArrival()
+{
+	createPair();
+
+	sml::MessageWaiter waiter;
+	connection->AddMessageWaiter(&waiter);
+
+	std::thread sender([this]()
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		soarxml::ElementXML* pMsg = peer->CreateSMLCommand("test");
+		peer->SendMsg(pMsg);
+		delete pMsg;
+	});
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	bool woken = waiter.Wait(5, 0);
+	double elapsed = millisecondsSince(start);
+	sender.join();
+
+	no_agent_assertTrue_msg("Wasn't woken by the message", woken);
+	no_agent_assertTrue_msg("Took " + std::to_string(elapsed) + "ms to wake", elapsed < 2500);
+
+	// The socket stays ready until the message is read
+	no_agent_assertTrue(waiter.Wait(0, 0));
+	no_agent_assertTrue_msg("The message wasn't there to read", connection->ReceiveMessages(true));
+
+#ifdef __linux__
+	// Other platforms check sockets by waking at short intervals
+	no_agent_assertTrue_msg("Woke again after the message was read", !waiter.Wait(0, 50));
+#endif
+
+	connection->RemoveMessageWaiter(&waiter);
+}
+
+void MessageWaiterTests::testConnectionClose()
+{
+	createPair();
+
+	sml::MessageWaiter waiter;
+	connection->AddMessageWaiter(&waiter);
+
+	std::thread closer([this]()
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		peer->CloseConnection();
+	});
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	bool woken = waiter.Wait(5, 0);
+	double elapsed = millisecondsSince(start);
+	closer.join();
+
+	no_agent_assertTrue_msg("Wasn't woken when the other side closed", woken);
+	no_agent_assertTrue_msg("Took " + std::to_string(elapsed) + "ms to wake", elapsed < 2500);
+
+	// Reading finds the socket closed, and the connection closes too
+	no_agent_assertTrue_msg("Received a message from a closed connection", !connection->ReceiveMessages(true));
+	no_agent_assertTrue(connection->IsClosed());
+
+	connection->RemoveMessageWaiter(&waiter);
+
+#ifdef __linux__
+	no_agent_assertTrue_msg("Woke on a connection that was no longer watched", !waiter.Wait(0, 50));
+#endif
+}
+
+#endif // _WIN32
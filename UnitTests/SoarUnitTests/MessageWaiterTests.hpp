@@ -0,0 +1,53 @@
+//
+//  MessageWaiterTests.hpp
+//
+//  Tests for the MessageWaiter a thread sleeps on until one of its
+//  connections has a message for it (see sml_MessageWaiter.h).
+//
+
+#ifndef MessageWaiterTests_cpp
+#define MessageWaiterTests_cpp
+
+#ifndef _WIN32
+
+#include "TestCategory.hpp"
+
+namespace sml
+{
+	class Connection;
+}
+
+class MessageWaiterTests : public TestCategory
+{
+public:
+	TEST_CATEGORY(MessageWaiterTests);
+
+	void before() { setUp(); }
+	void setUp();
+
+	void after(bool caught) { tearDown(caught); }
+	void tearDown(bool caught);
+
+	TEST(testTimeout, -1);
+	void testTimeout();
+
+	TEST(testSignal, -1);
+	void testSignal();
+
+	TEST(testMessageArrival, -1);
+	void testMessageArrival();
+
+	TEST(testConnectionClose, -1);
+	void testConnectionClose();
+
+private:
+	// Two remote connections talking over a socket pair
+	void createPair();
+
+	sml::Connection* connection;
+	sml::Connection* peer;
+};
+
+#endif // _WIN32
+
+#endif /* MessageWaiterTests_cpp */
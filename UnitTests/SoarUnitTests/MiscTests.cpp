@@ -14,10 +14,18 @@
 #include "soar_rand.h"
 #include "sml_Utils.h"
 #include "sml_Client.h"
+#include "sml_ClientAnalyzedXML.h"
 #include "sml_Names.h"
+#include "sml_AgentSML.h"
+#include "soar_instance.h"
+#include "symbol.h"
+#include "symbol_manager.h"
+#include "agent.h"
 
 #include <string>
+#include <sstream>
 #include <iostream>
+#include <vector>
 
 #include "SoarHelper.hpp"
 #include "handlers.hpp"
@@ -354,6 +362,238 @@ void MiscTests::testPreferenceDeallocation()
 	SoarHelper::init_check_to_find_refcount_leaks(agent);
 }
 
+// Reads the "bytes for various memory pools" line out of stats -m
+static size_t poolBytes(sml::Agent* pAgent)
+{
+	std::string lStats = pAgent->ExecuteCommandLine("stats -m");
+	size_t lEnd = lStats.find(" bytes for various memory pools");
+	if (lEnd == std::string::npos)
+	{
+		return 0;
+	}
+	size_t lStart = lStats.rfind('\n', lEnd);
+	lStart = (lStart == std::string::npos) ? 0 : lStart + 1;
+	return static_cast<size_t>(std::stoull(lStats.substr(lStart, lEnd - lStart)));
+}
+
+void MiscTests::testPerAgentMemoryPools()
+{
+	sml::Agent* agent2 = kernel->CreateAgent("soar2");
+	assertTrue(agent2 != NULL);
+	assertTrue(internal_agent->memoryManager != Soar_Instance::Get_Soar_Instance().Get_Agent_Info("soar2")->GetSoarAgent()->memoryManager);
+	size_t lOtherBefore = poolBytes(agent2);
+	
+	source("testGrowWorkingMemory.soar");
+	agent->ExecuteCommandLine("run -s 2010");
+	assertTrue(agent->GetLastCommandLineResult());
+	size_t lAfterRun = poolBytes(agent);
+	
+	// The first agent's working memory should not have touched the second agent's pools
+	assertTrue(poolBytes(agent2) == lOtherBefore);
+	
+	// Clearing working memory empties whole blocks, which init-soar gives back
+	agent->ExecuteCommandLine("soar init");
+	assertTrue(agent->GetLastCommandLineResult());
+	assertTrue(poolBytes(agent) < lAfterRun);
+	
+	assertTrue(kernel->DestroyAgent(agent2));
+}
+
+void MiscTests::testReteHashTableResizing()
+{
+	source("testGrowWorkingMemory.soar");
+	uint32_t lLeftStart = internal_agent->left_ht_log2size;
+	uint32_t lRightStart = internal_agent->right_ht_log2size;
+	
+	agent->ExecuteCommandLine("run -s 2010");
+	assertTrue(agent->GetLastCommandLineResult());
+	
+	// Tables are only resized as things enter the rete, so add a rule to pick up the last cycle's growth
+	agent->ExecuteCommandLine("sp {test*resize (state <s> ^nothing) --> (<s> ^nothing-else 1)}");
+	assertTrue(internal_agent->left_ht_log2size > lLeftStart);
+	assertTrue(internal_agent->right_ht_log2size > lRightStart);
+	
+	// stats -r reports each table's buckets and entries, which should match the agent's counts
+	std::string lStats = agent->ExecuteCommandLine("stats -r");
+	uint64_t lBuckets = 0, lEntries = 0;
+	std::istringstream lLeft(lStats.substr(lStats.find("left (tokens)") + strlen("left (tokens)")));
+	lLeft >> lBuckets >> lEntries;
+	assertTrue(lBuckets == (static_cast<uint64_t>(1) << internal_agent->left_ht_log2size));
+	assertTrue(lEntries == internal_agent->left_ht_count);
+	assertTrue(lEntries < 2 * lBuckets);
+	std::istringstream lRight(lStats.substr(lStats.find("right (wmes)") + strlen("right (wmes)")));
+	lRight >> lBuckets >> lEntries;
+	assertTrue(lBuckets == (static_cast<uint64_t>(1) << internal_agent->right_ht_log2size));
+	assertTrue(lEntries == internal_agent->right_ht_count);
+	assertTrue(lEntries < 2 * lBuckets);
+	
+	// Clearing working memory shrinks both tables back down
+	agent->ExecuteCommandLine("soar init");
+	assertTrue(internal_agent->left_ht_log2size == lLeftStart);
+	assertTrue(internal_agent->right_ht_log2size == lRightStart);
+}
+
+// Reads the left activation and token counts from a production's row of "production match-profile"
+static bool matchProfileRow(sml::Agent* pAgent, const std::string& pProduction, uint64_t& pLeft, uint64_t& pTokens)
+{
+	std::istringstream lProfile(pAgent->ExecuteCommandLine("production match-profile"));
+	std::string lLine;
+	while (std::getline(lProfile, lLine))
+	{
+		if (lLine.size() > pProduction.size() && lLine.compare(lLine.size() - pProduction.size(), pProduction.size(), pProduction) == 0)
+		{
+			double lTime;
+			uint64_t lNullLeft, lRight, lNullRight;
+			std::istringstream lRow(lLine);
+			lRow >> lTime >> pLeft >> lNullLeft >> lRight >> lNullRight >> pTokens;
+			return !lRow.fail();
+		}
+	}
+	return false;
+}
+
+void MiscTests::testReteMatchProfile()
+{
+	source("testGrowWorkingMemory.soar");
+	uint64_t lLeft = 0, lTokens = 0;
+	
+	// Nothing is counted until the profiler is turned on
+	agent->ExecuteCommandLine("run -s 10");
+	assertTrue(matchProfileRow(agent, "elaborate*item", lLeft, lTokens));
+	assertTrue(lLeft == 0 && lTokens == 0);
+	
+	agent->ExecuteCommandLine("production match-profile --enable");
+	assertTrue(agent->GetLastCommandLineResult());
+	agent->ExecuteCommandLine("run -s 10");
+	assertTrue(matchProfileRow(agent, "elaborate*item", lLeft, lTokens));
+	assertTrue(lLeft > 0 && lTokens > 0);
+	
+	// The per-node listing runs from the p-node up to the top of the net
+	std::string lNodes = agent->ExecuteCommandLine("production match-profile elaborate*item");
+	assertTrue(agent->GetLastCommandLineResult());
+	assertTrue(lNodes.find("production") != std::string::npos);
+	
+	// Structured output carries each node's time, starting with the p-node
+	sml::ClientAnalyzedXML lResponse;
+	assertTrue(agent->ExecuteCommandLineXML("production match-profile elaborate*item", &lResponse));
+	soarxml::ElementXML const* lResult = lResponse.GetResultTag();
+	assertTrue(lResult != NULL && lResult->GetNumberChildren() >= 3);
+	soarxml::ElementXML lName, lTime, lCount;
+	assertTrue(lResult->GetChild(&lName, 0) && lResult->GetChild(&lTime, 1) && lResult->GetChild(&lCount, 2));
+	assertTrue(std::string(lName.GetAttribute(sml::sml_Names::kArgParam)) == sml::sml_Names::kParamName);
+	assertTrue(std::string(lName.GetCharacterData()) == "production");
+	assertTrue(std::string(lTime.GetAttribute(sml::sml_Names::kArgParam)) == sml::sml_Names::kParamRealSeconds);
+	assertTrue(atof(lTime.GetCharacterData()) > 0.0);
+	assertTrue(std::string(lCount.GetAttribute(sml::sml_Names::kArgParam)) == sml::sml_Names::kParamCount);
+	assertTrue(atoi(lCount.GetCharacterData()) > 0);
+	
+	// Counts stay put while the profiler is off, and --reset clears them
+	agent->ExecuteCommandLine("production match-profile --disable");
+	uint64_t lLeftBefore = lLeft;
+	agent->ExecuteCommandLine("run -s 10");
+	assertTrue(matchProfileRow(agent, "elaborate*item", lLeft, lTokens));
+	assertTrue(lLeft == lLeftBefore);
+	agent->ExecuteCommandLine("production match-profile --reset");
+	assertTrue(matchProfileRow(agent, "elaborate*item", lLeft, lTokens));
+	assertTrue(lLeft == 0 && lTokens == 0);
+	
+	agent->ExecuteCommandLine("production match-profile no*such*rule");
+	assertTrue(!agent->GetLastCommandLineResult());
+}
+
+// Reads "N complete matches." from the output of "matches <production>"
+static int completeMatches(sml::Agent* pAgent, const std::string& pProduction)
+{
+	std::string lMatches = pAgent->ExecuteCommandLine(("matches " + pProduction).c_str());
+	size_t lPos = lMatches.find(" complete match");
+	if (lPos == std::string::npos)
+	{
+		return -1;
+	}
+	size_t lStart = lMatches.find_last_not_of("0123456789", lPos - 1) + 1;
+	return atoi(lMatches.substr(lStart, lPos - lStart).c_str());
+}
+
+void MiscTests::testBulkProductionLoad()
+{
+	source("testGrowWorkingMemory.soar");
+	agent->ExecuteCommandLine("run 100 -d");
+	int lItems = completeMatches(agent, "elaborate*item");
+	assertTrue(lItems > 30);
+	
+	agent->ExecuteCommandLine(("load file --bulk " + SoarHelper::GetResource("testBulkLoad.soar")).c_str());
+	assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+	
+	// The rules end up with the same matches they get when loaded one at a time
+	assertTrue(completeMatches(agent, "bulk*all") == lItems);
+	assertTrue(completeMatches(agent, "bulk*low") == 20);
+	assertTrue(completeMatches(agent, "bulk*shared") == 20);
+	assertTrue(completeMatches(agent, "bulk*negated") == 0);
+	assertTrue(completeMatches(agent, "bulk*ncc") == 30);
+	assertTrue(completeMatches(agent, "bulk*after") == 0);
+	
+	// and go on matching as working memory changes
+	agent->ExecuteCommandLine("run 1 -d");
+	assertTrue(completeMatches(agent, "bulk*after") == 5);
+}
+
+void MiscTests::testSymbolTable()
+{
+	Symbol_Manager* lSymbols = internal_agent->symbolManager;
+	const int lCount = 20000;
+	const int64_t lIntBase = static_cast<int64_t>(1) << 40;
+	std::vector<std::string> lNames;
+	std::vector<Symbol*> lStrings, lInts;
+	
+	// Inserting grows the tables through several doublings, and every
+	// symbol is found again afterwards
+	for (int i = 0; i < lCount; i++)
+	{
+		lNames.push_back("symbol-table-test-" + std::to_string(i));
+		lStrings.push_back(lSymbols->make_str_constant(lNames[i].c_str()));
+		lInts.push_back(lSymbols->make_int_constant(lIntBase + i));
+	}
+	for (int i = 0; i < lCount; i++)
+	{
+		assertTrue(lSymbols->find_str_constant(lNames[i].c_str()) == lStrings[i]);
+		assertTrue(lSymbols->find_int_constant(lIntBase + i) == lInts[i]);
+	}
+	assertTrue(lSymbols->find_str_constant("symbol-table-test-missing") == NULL);
+	
+	// Removing every other symbol shifts later entries of each probe run
+	// back into the hole, so the rest must all still be found
+	for (int i = 1; i < lCount; i += 2)
+	{
+		lSymbols->symbol_remove_ref(&lStrings[i]);
+		lSymbols->symbol_remove_ref(&lInts[i]);
+	}
+	for (int i = 0; i < lCount; i++)
+	{
+		assertTrue(lSymbols->find_str_constant(lNames[i].c_str()) == lStrings[i]);
+		assertTrue(lSymbols->find_int_constant(lIntBase + i) == lInts[i]);
+	}
+	
+	// Removing the rest shrinks the tables without losing the agent's own symbols
+	for (int i = 0; i < lCount; i += 2)
+	{
+		lSymbols->symbol_remove_ref(&lStrings[i]);
+		lSymbols->symbol_remove_ref(&lInts[i]);
+	}
+	for (int i = 0; i < lCount; i += 101)
+	{
+		assertTrue(lSymbols->find_str_constant(lNames[i].c_str()) == NULL);
+	}
+	assertTrue(lSymbols->find_str_constant("state") != NULL);
+	
+	// 0.0 and -0.0 are equal, so they are the same float constant
+	Symbol* lZero = lSymbols->make_float_constant(0.0);
+	Symbol* lNegativeZero = lSymbols->make_float_constant(-0.0);
+	assertTrue(lZero == lNegativeZero);
+	assertTrue(lSymbols->find_float_constant(-0.0) == lZero);
+	lSymbols->symbol_remove_ref(&lNegativeZero);
+	lSymbols->symbol_remove_ref(&lZero);
+}
+
 //void MiscTests::testSoarDebugger()
 //{
 //	bool result = agent->SpawnDebugger();
@@ -47,6 +47,18 @@ public:
 	void testSoarRand();
 	TEST(testPreferenceDeallocation, -1)
 	void testPreferenceDeallocation();
+	TEST(testPerAgentMemoryPools, -1)
+	void testPerAgentMemoryPools();
+	TEST(testReteHashTableResizing, -1)
+	void testReteHashTableResizing();
+	TEST(testReteMatchProfile, -1)
+	void testReteMatchProfile();
+	
+	TEST(testBulkProductionLoad, -1);
+	void testBulkProductionLoad();
+	
+	TEST(testSymbolTable, -1);
+	void testSymbolTable();
 	
 	TEST(testGDS_Failed_Justification_Crash, -1);
 	TEST(testIsupported_Smem_Chunk_Crash, -1);
@@ -15,6 +15,9 @@ const int MultiAgentTest::MAX_AGENTS = 100;
 void MultiAgentTest::setUp()
 {
 	updateEventHandler = user_data_struct(std::bind(&MultiAgentTest::MyUpdateEventHandler, this));
+	runThreads = 1;
+	interleave = sml::sml_PHASE;
+	seedAgents = false;
 }
 
 void MultiAgentTest::tearDown(bool caught)
@@ -158,6 +161,42 @@ void MultiAgentTest::testMaxAgents()
 	doTest();
 }
 
+void MultiAgentTest::testTenAgentsParallel()
+{
+	numberAgents = 10;
+	runThreads = 4;
+	// Only agents interleaved by decision or output are stepped in parallel
+	interleave = sml::sml_DECISION;
+	doTest();
+}
+
+void MultiAgentTest::testParallelMatchesSerial()
+{
+	// Each agent is seeded differently and fires a rule that draws from its
+	// generator, so the runs only match if every agent keeps its own stream
+	numberAgents = 10;
+	interleave = sml::sml_DECISION;
+	seedAgents = true;
+	
+	runThreads = 1;
+	doTest();
+	std::vector< std::string > serialTraces = finalTraces;
+	std::vector< std::string > serialStates = finalStates;
+	
+	runThreads = 4;
+	doTest();
+	
+	no_agent_assertTrue(finalTraces.size() == serialTraces.size());
+	for (size_t agentCounter = 0 ; agentCounter < finalTraces.size() ; ++agentCounter)
+	{
+		no_agent_assertTrue_msg("Agent trace differs between serial and parallel runs", finalTraces[agentCounter] == serialTraces[agentCounter]);
+		no_agent_assertTrue_msg("Agent working memory differs between serial and parallel runs", finalStates[agentCounter] == serialStates[agentCounter]);
+	}
+	
+	// Differently seeded agents should not have drawn the same numbers
+	no_agent_assertTrue(finalStates[0] != finalStates[1]);
+}
+
 void MultiAgentTest::doTest()
 {
 	pKernel = sml::Kernel::CreateKernelInCurrentThread(true, sml::Kernel::kUseAnyPort);
@@ -192,6 +231,15 @@ void MultiAgentTest::doTest()
 		std::stringstream path;
 		// TODO: use boost filesystem
 		assertTrue(agent->LoadProductions(SoarHelper::GetResource("testmulti.soar").c_str()));
+		if (seedAgents)
+		{
+			std::stringstream seed;
+			seed << "srand " << 1 + agentCounter;
+			agent->ExecuteCommandLine(seed.str().c_str());
+			assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+			agent->ExecuteCommandLine("sp {apply*add*random (state <s> ^operator.name add) --> (<s> ^random (rand-int 1000000))}");
+			assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+		}
 		createInput(agent, 0);
 		
 		// Collect the trace output from the run
@@ -209,6 +257,18 @@ void MultiAgentTest::doTest()
 															 trace[agentCounter]));
 	}
 	
+	if (runThreads > 1)
+	{
+		std::stringstream command;
+		command << "soar run-threads " << runThreads;
+		pKernel->ExecuteCommandLine(command.str().c_str(), names[0].c_str());
+		no_agent_assertTrue_msg(pKernel->GetLastErrorDescription(), pKernel->GetLastCommandLineResult());
+
+		// it's the kernel's setting, so every agent reports it
+		std::string setting = pKernel->ExecuteCommandLine("soar run-threads", names[numberAgents - 1].c_str());
+		no_agent_assertTrue_msg("run-threads read back as " + setting, setting.find(std::to_string(runThreads)) != std::string::npos);
+	}
+	
 	auto lambda = [](sml::smlUpdateEventId, void* data, sml::Kernel*, sml::smlRunFlags)
 	{
 		static_cast<user_data_struct*>(data)->function();
@@ -217,7 +277,7 @@ void MultiAgentTest::doTest()
 	pKernel->RegisterForUpdateEvent(sml::smlEVENT_AFTER_ALL_GENERATED_OUTPUT, lambda, &updateEventHandler);
 	
 	// Run for a first set of output, so we can see whether that worked
-	pKernel->RunAllTilOutput() ;
+	pKernel->RunAllTilOutput(interleave) ;
 	
 	// Print out some information
 	reportAgentStatus(pKernel, numberAgents, trace) ;
@@ -227,7 +287,7 @@ void MultiAgentTest::doTest()
 	for (int i = 0 ; i < kFirstRun ; i++)
 	{
 		// Run for a bit
-		pKernel->RunAllTilOutput() ;
+		pKernel->RunAllTilOutput(interleave) ;
 	}
 	
 	reportAgentStatus(pKernel, numberAgents, trace) ;
@@ -240,11 +300,26 @@ void MultiAgentTest::doTest()
 	for (int i = 0 ; i < kSecondRun ; i++)
 	{
 		// Run for a bit
-		pKernel->RunAllTilOutput() ;
+		pKernel->RunAllTilOutput(interleave) ;
 	}
 	
 	reportAgentStatus(pKernel, numberAgents, trace) ;
 	
+	// The agents are identical, so however they were stepped they should all be at the same point
+	for (int agentCounter = 1 ; agentCounter < numberAgents ; ++agentCounter)
+	{
+		no_agent_assertTrue(agents[agentCounter]->GetDecisionCycleCounter() == agents[0]->GetDecisionCycleCounter());
+	}
+	
+	// Keep what each agent did so runs with different settings can be compared
+	finalTraces.clear();
+	finalStates.clear();
+	for (int agentCounter = 0 ; agentCounter < numberAgents ; ++agentCounter)
+	{
+		finalTraces.push_back(trace[agentCounter]->str());
+		finalStates.push_back(agents[agentCounter]->ExecuteCommandLine("print --depth 4 s1"));
+	}
+	
 	for (std::vector< std::stringstream* >::iterator iter = trace.begin(); iter != trace.end(); ++iter)
 	{
 		delete *iter;
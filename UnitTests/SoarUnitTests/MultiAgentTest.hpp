@@ -41,6 +41,12 @@ public:
 	TEST(testMaxAgents, -1)
 	void testMaxAgents();
 	
+	TEST(testTenAgentsParallel, -1)
+	void testTenAgentsParallel();
+	
+	TEST(testParallelMatchesSerial, -1)
+	void testParallelMatchesSerial();
+	
 private:
 	struct user_data_struct
 	{
@@ -64,6 +70,11 @@ private:
 	
 	static const int MAX_AGENTS;
 	int numberAgents;
+	int runThreads;
+	sml::smlRunStepSize interleave;
+	bool seedAgents;
+	std::vector< std::string > finalTraces;
+	std::vector< std::string > finalStates;
 	sml::Kernel* pKernel;
 };
 
@@ -16,6 +16,11 @@
 #include "sml_Client.h"
 #include "sml_Names.h"
 
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
 void SMemFunctionalTests::setUp()
 {
     FunctionalTestHarness::setUp();
@@ -45,6 +50,51 @@ void SMemFunctionalTests::testSimpleStore()
 	runTest("testSimpleStore", 2);
 }
 
+void SMemFunctionalTests::testSimpleStore_WALGroupCommit()
+{
+    std::string pwd = agent->ExecuteCommandLine("pwd");
+    std::string db = pwd + "/smem-wal-test.sqlite";
+    remove(db.c_str());
+
+    agent->ExecuteCommandLine("smem --set database file");
+    agent->ExecuteCommandLine(std::string("smem --set path \"" + db + "\"").c_str());
+    agent->ExecuteCommandLine("smem --set append off");
+    agent->ExecuteCommandLine("smem --set optimization wal");
+    assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+    agent->ExecuteCommandLine("smem --set commit-interval 1");
+    agent->ExecuteCommandLine("smem --set checkpoint-thread on");
+    assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+
+	SoarHelper::setStopPhase(agent, SoarHelper::StopPhase::OUTPUT);
+	runTest("testSimpleStore", 2);
+
+    // checkpoints are made in the background, shortly after a commit
+    assertTrue_msg("no group commits were made", std::stoll(agent->ExecuteCommandLine("smem --stats commits")) > 0);
+    for (int i = 0; (i < 100) && (std::stoll(agent->ExecuteCommandLine("smem --stats checkpoints")) == 0); i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    assertTrue_msg("no WAL checkpoints were made", std::stoll(agent->ExecuteCommandLine("smem --stats checkpoints")) > 0);
+
+    // the stored memory survives closing and reopening the database
+    int64_t nodes = std::stoll(agent->ExecuteCommandLine("smem --stats nodes"));
+    assertTrue_msg("nothing was stored", nodes > 0);
+    agent->ExecuteCommandLine("smem --set database memory");
+    agent->ExecuteCommandLine("smem --init");
+    agent->ExecuteCommandLine("smem --set database file");
+    agent->ExecuteCommandLine("smem --set append on");
+    assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+    assertTrue_msg("stored memories were lost on reopening", std::stoll(agent->ExecuteCommandLine("smem --stats nodes")) == nodes);
+    std::string stored = agent->ExecuteCommandLine("smem --print");
+    assertTrue_msg("stored memory is missing after reopening: " + stored, stored.find("jobs@apple.com") != std::string::npos);
+
+    agent->ExecuteCommandLine("smem --set database memory");
+    agent->ExecuteCommandLine("smem --init");
+    remove(db.c_str());
+    remove((db + "-wal").c_str());
+    remove((db + "-shm").c_str());
+}
+
 void SMemFunctionalTests::testTrivialMathQuery()
 {
 	SoarHelper::setStopPhase(agent, SoarHelper::StopPhase::OUTPUT);
@@ -320,6 +370,91 @@ void SMemFunctionalTests::testSimpleNonCueBasedRetrieval_ActivationBaseLevel_Inc
     assertTrue_msg(std::string("Activation value ") + expected + std::string(" != " + result), result == expected);
 }
 
+void SMemFunctionalTests::testSimpleNonCueBasedRetrieval_ActivationBaseLevel_Stable_NoLTICache()
+{
+    agent->ExecuteCommandLine("smem --set lti-cache-size 0");
+    assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+
+    testSimpleNonCueBasedRetrieval_ActivationBaseLevel_Stable();
+}
+
+void SMemFunctionalTests::testSimpleNonCueBasedRetrieval_ActivationBaseLevel_Incremental_SmallLTICache()
+{
+    agent->ExecuteCommandLine("smem --set lti-cache-size 1");
+    assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+
+    testSimpleNonCueBasedRetrieval_ActivationBaseLevel_Incremental();
+}
+
+void SMemFunctionalTests::testLTICacheStats()
+{
+    testSimpleNonCueBasedRetrieval_ActivationBaseLevel_Stable();
+
+    int64_t hits = std::stoll(agent->ExecuteCommandLine("smem --stats lti-cache-hits"));
+    int64_t misses = std::stoll(agent->ExecuteCommandLine("smem --stats lti-cache-misses"));
+    assertTrue_msg("Repeated retrievals were not served from the LTI cache.", hits > 0);
+    assertTrue_msg("LTI cache was never filled from the database.", misses > 0);
+
+    agent->ExecuteCommandLine("smem --set lti-cache-size 10");
+    assertTrue_msg("lti-cache-size changed while the database was connected.", !agent->GetLastCommandLineResult());
+}
+
+// Runs one agent with base-batch on and one with it off, under each update
+// policy that recomputes in batches and several decay settings, and checks
+// that every memory has the same activation after each stretch of
+// decisions.
+void SMemFunctionalTests::testBaseLevelBatch()
+{
+    std::string sourceName = getCategoryName() + "_testBaseLevelBatch.soar";
+    std::string sourceUrl = SoarHelper::GetResource(sourceName);
+    assertNonZeroSize_msg("Could not find test file " + sourceName, sourceUrl);
+
+    const char* policies[] = { "naive", "incremental" };
+    const char* decays[] = { "0.3", "0.5", "0.8" };
+    const char* inhibitions[] = { "off", "on" };
+
+    for (const char* policy : policies)
+    {
+        for (const char* decay : decays)
+        {
+            for (const char* inhibition : inhibitions)
+            {
+                std::string config = std::string("policy ") + policy + ", decay " + decay + ", inhibition " + inhibition;
+                sml::Agent* batched = kernel->CreateAgent("batched");
+                sml::Agent* unbatched = kernel->CreateAgent("unbatched");
+                std::string mismatch;
+
+                for (sml::Agent* a : { batched, unbatched })
+                {
+                    a->ExecuteCommandLine((std::string("smem --set base-batch ") + ((a == batched) ? "on" : "off")).c_str());
+                    a->ExecuteCommandLine((std::string("smem --set base-update-policy ") + policy).c_str());
+                    a->ExecuteCommandLine((std::string("smem --set base-decay ") + decay).c_str());
+                    a->ExecuteCommandLine((std::string("smem --set base-inhibition ") + inhibition).c_str());
+                    a->ExecuteCommandLine("smem --set base-incremental-threshes 3");
+                    a->ExecuteCommandLine(("source \"" + sourceUrl + "\"").c_str());
+                }
+
+                for (int stretch = 1; (stretch <= 6) && mismatch.empty(); stretch++)
+                {
+                    batched->RunSelf(10);
+                    unbatched->RunSelf(10);
+
+                    std::string batchedLTMs = batched->ExecuteCommandLine("print @");
+                    std::string unbatchedLTMs = unbatched->ExecuteCommandLine("print @");
+                    if ((batchedLTMs != unbatchedLTMs) || (batchedLTMs.find("[-") == std::string::npos))
+                    {
+                        mismatch = config + ", after " + std::to_string(stretch * 10) + " decisions:\n" + batchedLTMs + "!=\n" + unbatchedLTMs;
+                    }
+                }
+
+                kernel->DestroyAgent(batched);
+                kernel->DestroyAgent(unbatched);
+                assertTrue_msg("Batched activations differ, " + mismatch, mismatch.empty());
+            }
+        }
+    }
+}
+
 void SMemFunctionalTests::testSpreadingActivation_AlphabetAgentAllOn()
 {
     SoarHelper::start_log(agent, "testSpreadingActivation_AlphabetAgentAllOn");
@@ -335,6 +470,61 @@ void SMemFunctionalTests::testSpreadingActivation_AlphabetAgentAllOn()
     assertTrue_msg(msg.append("testSpreadingActivation_AlphabetAgentAllOn functional test did not halt. DC = ").append(dc_count).c_str(), halted);
 }
 
+void SMemFunctionalTests::testSpreadingActivation_AlphabetAgentAllOn_NoGraph()
+{
+    agent->ExecuteCommandLine("smem --set spreading-graph off");
+    assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+
+    testSpreadingActivation_AlphabetAgentAllOn();
+}
+
+// Runs the alphabet agent once with spreading-graph on and once with it
+// off, from the same seed, and checks that every memory has the same
+// activation, spread included, after each stretch of decisions.
+void SMemFunctionalTests::testSpreadingGraph()
+{
+    std::string sourceName = getCategoryName() + "_testSpreadingGraph.soar";
+    std::string sourceUrl = SoarHelper::GetResource(sourceName);
+    assertNonZeroSize_msg("Could not find test file " + sourceName, sourceUrl);
+
+    // the last run turns spreading off, to check that the agent's retrievals depend on it
+    const char* settings[] = { "smem --set spreading-graph on", "smem --set spreading-graph off", "smem --set spreading off" };
+    std::vector<std::string> memories[3];
+
+    for (int i = 0; i < 3; i++)
+    {
+        sml::Agent* a = kernel->CreateAgent("spreading-graph");
+        if (i < 2)
+        {
+            a->ExecuteCommandLine(settings[i]);
+            assertTrue_msg(a->GetLastErrorDescription(), a->GetLastCommandLineResult());
+        }
+        a->ExecuteCommandLine(("source \"" + sourceUrl + "\"").c_str());
+        if (i == 2)
+        {
+            a->ExecuteCommandLine(settings[i]);
+            assertTrue_msg(a->GetLastErrorDescription(), a->GetLastCommandLineResult());
+        }
+
+        for (int decision = 1; decision <= 20; decision++)
+        {
+            a->RunSelf(1);
+            memories[i].push_back(a->ExecuteCommandLine("print @"));
+        }
+        memories[i].push_back(a->ExecuteCommandLine("print --depth 3 s1"));
+
+        kernel->DestroyAgent(a);
+    }
+
+    for (size_t decision = 0; decision < memories[0].size(); decision++)
+    {
+        std::string after = "after " + std::to_string(decision + 1) + " decisions:\n";
+        assertTrue_msg("Activations differ with the spreading graph off, " + after + memories[0][decision] + "!=\n" + memories[1][decision],
+                       memories[0][decision] == memories[1][decision]);
+    }
+    assertTrue_msg("The agent retrieved the same memories without spreading.", memories[0].back() != memories[2].back());
+}
+
 void SMemFunctionalTests::testDbBackupAndLoadTests()
 {
 	runTestSetup("testFactorization");
@@ -411,6 +601,163 @@ void SMemFunctionalTests::testReadCSoarDB()
 	assertTrue_msg("Unexpected output from CSoar database!", actualResult == expectedResult);
 }
 
+void SMemFunctionalTests::testImport()
+{
+	std::string addFile = SoarHelper::GetResource("SMemFunctionalTests_testImport.soar");
+	assertNonZeroSize_msg("Could not find test file SMemFunctionalTests_testImport.soar", addFile);
+	std::string csvFile = SoarHelper::GetResource("SMemFunctionalTests_testImport.csv");
+	assertNonZeroSize_msg("Could not find test file SMemFunctionalTests_testImport.csv", csvFile);
+
+	// the same knowledge added clause by clause
+	agent->ExecuteCommandLine(std::string("source \"" + addFile + "\"").c_str());
+	assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+	std::string expected = agent->ExecuteCommandLine("print @");
+	assertTrue_msg("smem --add did not add the test knowledge", expected.find("(@3 ^back @1 ^name |gamma ray| ^side @2") != std::string::npos);
+
+	agent->ExecuteCommandLine("smem --clear");
+	agent->ExecuteCommandLine(std::string("smem --import \"" + addFile + "\"").c_str());
+	assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+	std::string result = agent->ExecuteCommandLine("print @");
+	assertTrue_msg("Importing smem --add clauses gave " + result + " rather than " + expected, result == expected);
+
+	agent->ExecuteCommandLine("smem --clear");
+	agent->ExecuteCommandLine(std::string("smem --import \"" + csvFile + "\"").c_str());
+	assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+	result = agent->ExecuteCommandLine("print @");
+	assertTrue_msg("Importing an edge list gave " + result + " rather than " + expected, result == expected);
+
+	// retrievals use the rebuilt indices
+	result = agent->ExecuteCommandLine("smem --query {(<x> ^name beta)}");
+	assertTrue_msg("Query after import did not retrieve @2: " + result, result.find("@2") != std::string::npos);
+}
+
+static std::string readWholeFile(const std::string& path)
+{
+	std::ifstream in(path.c_str(), std::ios::binary);
+	std::stringstream contents;
+	contents << in.rdbuf();
+	return contents.str();
+}
+
+void SMemFunctionalTests::testSharedStore()
+{
+	std::string addFile = SoarHelper::GetResource("SMemFunctionalTests_testImport.soar");
+	assertNonZeroSize_msg("Could not find test file SMemFunctionalTests_testImport.soar", addFile);
+
+	// build a knowledge base on disk
+	agent->ExecuteCommandLine(std::string("source \"" + addFile + "\"").c_str());
+	assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+	std::string expected = agent->ExecuteCommandLine("print @");
+
+	std::string kbFile = std::string(agent->ExecuteCommandLine("pwd")) + "/shared-kb.sqlite";
+	remove(kbFile.c_str());
+	agent->ExecuteCommandLine(std::string("smem --backup \"" + kbFile + "\"").c_str());
+	assertTrue_msg(agent->GetLastErrorDescription(), agent->GetLastCommandLineResult());
+	std::string kbBefore = readWholeFile(kbFile);
+	assertNonZeroSize_msg("smem --backup did not write the knowledge base", kbBefore);
+
+	sml::Agent* agents[2];
+	std::string before[2], after[2], query[2], overlay[2];
+	for (int i = 0; i < 2; i++)
+	{
+		std::stringstream name;
+		name << "shared-" << (i + 1);
+		agents[i] = kernel->CreateAgent(name.str().c_str());
+		agents[i]->ExecuteCommandLine("smem --set database shared");
+		agents[i]->ExecuteCommandLine(std::string("smem --set path \"" + kbFile + "\"").c_str());
+		agents[i]->ExecuteCommandLine("smem --init");
+		before[i] = agents[i]->ExecuteCommandLine("print @");
+	}
+
+	// a store by one agent goes to its overlay only
+	agents[0]->ExecuteCommandLine("smem --add {(<x> ^name delta)}");
+	for (int i = 0; i < 2; i++)
+	{
+		after[i] = agents[i]->ExecuteCommandLine("print @");
+		query[i] = agents[i]->ExecuteCommandLine("smem --query {(<x> ^name beta)}");
+		overlay[i] = agents[i]->ExecuteCommandLine("smem --stats overlay-size");
+	}
+
+	for (int i = 0; i < 2; i++)
+	{
+		kernel->DestroyAgent(agents[i]);
+	}
+	std::string kbAfter = readWholeFile(kbFile);
+	remove(kbFile.c_str());
+
+	for (int i = 0; i < 2; i++)
+	{
+		assertTrue_msg("Shared knowledge base printed as " + before[i] + " rather than " + expected, before[i] == expected);
+		assertTrue_msg("Query of the shared knowledge base did not retrieve @2: " + query[i], query[i].find("@2") != std::string::npos);
+	}
+	assertTrue_msg("Store did not reach the storing agent's overlay: " + after[0], after[0].find("delta") != std::string::npos);
+	assertTrue_msg("Overlay of the storing agent is empty", overlay[0] != "0");
+	assertTrue_msg("Store by one agent was seen by another: " + after[1], after[1] == expected);
+	assertTrue_msg("Sharing the knowledge base changed it", kbAfter == kbBefore);
+}
+
+void SMemFunctionalTests::testSharedStoreWAL()
+{
+	std::string addFile = SoarHelper::GetResource("SMemFunctionalTests_testImport.soar");
+	assertNonZeroSize_msg("Could not find test file SMemFunctionalTests_testImport.soar", addFile);
+
+	// build a knowledge base in WAL mode, committing every store, in an
+	// agent that keeps it open
+	std::string kbFile = std::string(agent->ExecuteCommandLine("pwd")) + "/shared-kb-wal.sqlite";
+	remove(kbFile.c_str());
+	sml::Agent* builder = kernel->CreateAgent("wal-builder");
+	const char* settings[] = { "smem --set database file", "smem --set optimization wal", "smem --set lazy-commit off" };
+	builder->ExecuteCommandLine(std::string("smem --set path \"" + kbFile + "\"").c_str());
+	assertTrue_msg(builder->GetLastErrorDescription(), builder->GetLastCommandLineResult());
+	for (const char* setting : settings)
+	{
+		builder->ExecuteCommandLine(setting);
+		assertTrue_msg(builder->GetLastErrorDescription(), builder->GetLastCommandLineResult());
+	}
+	builder->ExecuteCommandLine(std::string("source \"" + addFile + "\"").c_str());
+	assertTrue_msg(builder->GetLastErrorDescription(), builder->GetLastCommandLineResult());
+	std::string expected = builder->ExecuteCommandLine("print @");
+
+	// while its WAL holds frames it can't be shared, and the sharing agent
+	// falls back to a memory database of its own
+	sml::Agent* refused = kernel->CreateAgent("shared-wal-refused");
+	refused->ExecuteCommandLine("smem --set database shared");
+	refused->ExecuteCommandLine(std::string("smem --set path \"" + kbFile + "\"").c_str());
+	refused->ExecuteCommandLine("smem --init");
+	std::string refusedPrint = refused->ExecuteCommandLine("print @");
+	std::string refusedQuery = refused->ExecuteCommandLine("smem --query {(<x> ^name beta)}");
+	std::string refusedDatabase = refused->ExecuteCommandLine("smem --get database");
+	kernel->DestroyAgent(refused);
+
+	// destroying the builder checkpoints the WAL into the knowledge base,
+	// but leaves the header saying WAL
+	kernel->DestroyAgent(builder);
+
+	std::string kbBefore = readWholeFile(kbFile);
+	assertTrue_msg("Knowledge base was not built in WAL mode", (kbBefore.size() >= 100) && (kbBefore[18] == 2) && (kbBefore[19] == 2));
+
+	sml::Agent* shared = kernel->CreateAgent("shared-wal");
+	shared->ExecuteCommandLine("smem --set database shared");
+	shared->ExecuteCommandLine(std::string("smem --set path \"" + kbFile + "\"").c_str());
+	shared->ExecuteCommandLine("smem --init");
+	std::string before = shared->ExecuteCommandLine("print @");
+	std::string query = shared->ExecuteCommandLine("smem --query {(<x> ^name beta)}");
+	shared->ExecuteCommandLine("smem --add {(<x> ^name delta)}");
+	std::string after = shared->ExecuteCommandLine("print @");
+	kernel->DestroyAgent(shared);
+
+	std::string kbAfter = readWholeFile(kbFile);
+	remove(kbFile.c_str());
+
+	assertTrue_msg("Knowledge base with WAL frames was not refused: " + refusedDatabase, refusedDatabase.find("memory") != std::string::npos);
+	assertTrue_msg("Refused agent printed the knowledge base: " + refusedPrint, refusedPrint.find("beta") == std::string::npos);
+	assertTrue_msg("Refused agent queried the knowledge base: " + refusedQuery, refusedQuery.find("@2") == std::string::npos);
+	assertTrue_msg("Shared WAL knowledge base printed as " + before + " rather than " + expected, before == expected);
+	assertTrue_msg("Query of the shared WAL knowledge base did not retrieve @2: " + query, query.find("@2") != std::string::npos);
+	assertTrue_msg("Store did not reach the overlay: " + after, after.find("delta") != std::string::npos);
+	assertTrue_msg("Sharing the WAL knowledge base changed it", kbAfter == kbBefore);
+}
+
 void SMemFunctionalTests::testMultiAgent()
 {
 	std::vector<sml::Agent*> agents;
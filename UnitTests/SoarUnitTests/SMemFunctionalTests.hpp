@@ -30,6 +30,8 @@ public:
 	
 	TEST(testSimpleStore, -1)
 	void testSimpleStore();
+	TEST(testSimpleStore_WALGroupCommit, -1)
+	void testSimpleStore_WALGroupCommit();
 	
 	TEST(testTrivialMathQuery, -1)
 	void testTrivialMathQuery();
@@ -121,15 +123,39 @@ public:
 	TEST(testSimpleNonCueBasedRetrieval_ActivationBaseLevel_Incremental, -1)
 	void testSimpleNonCueBasedRetrieval_ActivationBaseLevel_Incremental();
 
+	TEST(testSimpleNonCueBasedRetrieval_ActivationBaseLevel_Stable_NoLTICache, -1)
+	void testSimpleNonCueBasedRetrieval_ActivationBaseLevel_Stable_NoLTICache();
+	TEST(testSimpleNonCueBasedRetrieval_ActivationBaseLevel_Incremental_SmallLTICache, -1)
+	void testSimpleNonCueBasedRetrieval_ActivationBaseLevel_Incremental_SmallLTICache();
+	TEST(testLTICacheStats, -1)
+	void testLTICacheStats();
+	TEST(testBaseLevelBatch, -1)
+	void testBaseLevelBatch();
+
 	TEST(testSpreadingActivation_AlphabetAgentAllOn, -1)
     void testSpreadingActivation_AlphabetAgentAllOn();
 
+	TEST(testSpreadingActivation_AlphabetAgentAllOn_NoGraph, -1)
+	void testSpreadingActivation_AlphabetAgentAllOn_NoGraph();
+
+	TEST(testSpreadingGraph, -1)
+	void testSpreadingGraph();
+
 	TEST(testDbBackupAndLoadTests, -1)
 	void testDbBackupAndLoadTests();
 	
 	TEST(testReadCSoarDB, -1)
 	void testReadCSoarDB();
 
+	TEST(testImport, -1)
+	void testImport();
+
+	TEST(testSharedStore, -1)
+	void testSharedStore();
+
+	TEST(testSharedStoreWAL, -1)
+	void testSharedStoreWAL();
+
 	TEST(testMultiAgent, -1)
 	void testMultiAgent();
 };
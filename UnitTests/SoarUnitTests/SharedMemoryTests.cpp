@@ -0,0 +1,363 @@
+//
+//  SharedMemoryTests.cpp
+//
+
+#include "SharedMemoryTests.hpp"
+
+#ifdef ENABLE_SHARED_MEMORY
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "sml_Client.h"
+#include "sml_Connection.h"
+#include "sml_AnalyzeXML.h"
+#include "sock_SharedMemory.h"
+#include "sock_Socket.h"
+
+namespace
+{
+	// Sockets are normally made by a listener or a client socket,
+	// but here we just want one end of a socket pair.
+	class TestSocket : public sock::Socket
+	{
+	public:
+		TestSocket(int descriptor) : sock::Socket(descriptor) {}
+	};
+
+	// Larger than a ring, so the writer has to wait for the reader to make room
+	std::string bigMessage(size_t length, char seed)
+	{
+		std::string message(length, ' ');
+		for (size_t i = 0; i < length; i++)
+		{
+			message[i] = static_cast<char>('a' + (i * 7 + seed) % 26);
+		}
+		return message;
+	}
+
+	double millisecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+void SharedMemoryTests::setUp()
+{
+	sockets[0] = -1;
+	sockets[1] = -1;
+	client = nullptr;
+	kernel = nullptr;
+}
+
+void SharedMemoryTests::tearDown(bool caught)
+{
+	delete client;
+	delete kernel;
+	client = nullptr;
+	kernel = nullptr;
+
+	// Descriptors that were never handed over to a segment
+	for (int i = 0; i < 2; i++)
+	{
+		if (sockets[i] != -1)
+		{
+			close(sockets[i]);
+			sockets[i] = -1;
+		}
+	}
+}
+
+void SharedMemoryTests::createPair()
+{
+	no_agent_assertTrue(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == 0);
+
+	client = sock::SharedMemory::CreateSegment();
+	no_agent_assertTrue_msg("Couldn't create a shared memory segment", client != nullptr);
+
+	kernel = sock::SharedMemory::OpenSegment(client->GetSegmentName());
+	client->UnlinkSegment();
+	no_agent_assertTrue_msg("Couldn't open the client's segment", kernel != nullptr);
+
+	client->Attach(new TestSocket(sockets[0]));
+	kernel->Attach(new TestSocket(sockets[1]));
+	sockets[0] = -1;
+	sockets[1] = -1;
+}
+
+void SharedMemoryTests::testOpenFailure()
+{
+	// The kernel refusing the client's segment is what sends the client
+	// back to the socket, so anything it can't use has to be turned down.
+	no_agent_assertTrue(sock::SharedMemory::OpenSegment(nullptr) == nullptr);
+	no_agent_assertTrue(sock::SharedMemory::OpenSegment("") == nullptr);
+	no_agent_assertTrue(sock::SharedMemory::OpenSegment("/not-a-soar-segment") == nullptr);
+	no_agent_assertTrue(sock::SharedMemory::OpenSegment("/soar-sml-not/ours") == nullptr);
+
+	std::string name = "/soar-sml-test-" + std::to_string(getpid());
+	no_agent_assertTrue(sock::SharedMemory::OpenSegment(name.c_str()) == nullptr);
+
+	// A segment that's the wrong size
+	int descriptor = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+	no_agent_assertTrue(descriptor != -1);
+	bool truncated = ftruncate(descriptor, 4096) == 0;
+	close(descriptor);
+	sock::SharedMemory* pShared = sock::SharedMemory::OpenSegment(name.c_str());
+	shm_unlink(name.c_str());
+	delete pShared;
+	no_agent_assertTrue(truncated);
+	no_agent_assertTrue_msg("Opened a segment of the wrong size", pShared == nullptr);
+
+	// A segment whose name has gone (as it will once the client has unlinked it)
+	sock::SharedMemory* pCreated = sock::SharedMemory::CreateSegment();
+	no_agent_assertTrue(pCreated != nullptr);
+	name = pCreated->GetSegmentName();
+	pCreated->UnlinkSegment();
+	delete pCreated;
+	no_agent_assertTrue(sock::SharedMemory::OpenSegment(name.c_str()) == nullptr);
+
+	// Embedded connections have no socket to move off
+	sml::Kernel* pKernel = sml::Kernel::CreateKernelInCurrentThread(true, sml::Kernel::kSuppressListener);
+	bool switched = pKernel->GetConnection()->UseSharedMemory();
+	pKernel->Shutdown();
+	delete pKernel;
+	no_agent_assertTrue_msg("An embedded connection moved to shared memory", !switched);
+}
+
+void SharedMemoryTests::testLocalConnection()
+{
+	sml::Kernel* pKernel = sml::Kernel::CreateKernelInNewThread(sml::Kernel::kUseAnyPort);
+	no_agent_assertTrue_msg(pKernel->GetLastErrorDescription(), !pKernel->HadError());
+	int port = pKernel->GetListenerPort();
+
+	sml::Kernel* pShared = sml::Kernel::CreateRemoteConnection(true, 0, port);
+	sml::Kernel* pSocket = sml::Kernel::CreateRemoteConnection(true, 0, port, false, false);
+
+	bool connected = !pShared->HadError() && !pSocket->HadError();
+	std::string sharedResult, socketResult, refusedResult, switchedResult;
+	bool sharedAgain = true, refused = true, switched = false;
+
+	if (connected)
+	{
+		sml::Agent* pAgent = pShared->CreateAgent("shared-memory");
+		connected = pAgent != nullptr;
+		if (connected)
+		{
+			sharedResult = pAgent->ExecuteCommandLine("echo over shared memory");
+
+			// Having switched, there's no socket left to move off
+			sharedAgain = pShared->GetConnection()->UseSharedMemory();
+
+			// The other connection turned it off, so it's still on its socket
+			socketResult = pSocket->ExecuteCommandLine("echo over the socket", "shared-memory");
+
+			// The kernel turning down a segment leaves the connection as it was
+			sml::Connection* pConnection = pSocket->GetConnection();
+			soarxml::ElementXML* pMsg = pConnection->CreateSMLCommand(sml::sml_Names::kCommand_SharedMemory);
+			pConnection->AddParameterToSMLCommand(pMsg, sml::sml_Names::kParamName, "/soar-sml-missing");
+			sml::AnalyzeXML response;
+			refused = !(pConnection->SendMessageGetResponse(&response, pMsg) && response.GetResultBool(false));
+			delete pMsg;
+			refusedResult = pSocket->ExecuteCommandLine("echo still on the socket", "shared-memory");
+
+			// And it can still switch later
+			switched = pConnection->UseSharedMemory();
+			switchedResult = pSocket->ExecuteCommandLine("echo switched later", "shared-memory");
+		}
+	}
+
+	delete pShared;
+	delete pSocket;
+	pKernel->Shutdown();
+	delete pKernel;
+
+	no_agent_assertTrue_msg("Couldn't connect to the kernel", connected);
+	no_agent_assertTrue_msg("Shared memory connection: " + sharedResult, sharedResult.find("over shared memory") != std::string::npos);
+	no_agent_assertTrue_msg("Switched to shared memory twice", !sharedAgain);
+	no_agent_assertTrue_msg("Socket connection: " + socketResult, socketResult.find("over the socket") != std::string::npos);
+	no_agent_assertTrue_msg("The kernel opened a segment that isn't there", refused);
+	no_agent_assertTrue_msg("After the kernel refused: " + refusedResult, refusedResult.find("still on the socket") != std::string::npos);
+	no_agent_assertTrue_msg("Couldn't switch after the kernel refused a segment", switched);
+	no_agent_assertTrue_msg("After switching: " + switchedResult, switchedResult.find("switched later") != std::string::npos);
+}
+
+void SharedMemoryTests::testRoundTrip()
+{
+	createPair();
+
+	std::string received;
+	no_agent_assertTrue(client->SendString("command from the client"));
+	no_agent_assertTrue(kernel->ReceiveString(&received));
+	no_agent_assertTrue_msg(received, received == "command from the client");
+
+	no_agent_assertTrue(kernel->SendString("response from the kernel"));
+	no_agent_assertTrue(client->ReceiveString(&received));
+	no_agent_assertTrue_msg(received, received == "response from the kernel");
+
+	// Enough small messages to wrap around the ring several times
+	std::string message = bigMessage(1000, 3);
+	for (int i = 0; i < 5000; i++)
+	{
+		no_agent_assertTrue(client->SendString(message.c_str()));
+		no_agent_assertTrue(kernel->ReceiveString(&received));
+		no_agent_assertTrue(received == message);
+	}
+}
+
+void SharedMemoryTests::testLargeMessage()
+{
+	createPair();
+
+	// Three times the size of a ring each way, so both writers fill their ring
+	// and sleep until the reader makes room.
+	const std::string toKernel = bigMessage(3 << 20, 1);
+	const std::string toClient = bigMessage((3 << 20) + 12345, 2);
+
+	bool sent = false;
+	std::thread writer([&]() { sent = client->SendString(toKernel.c_str()); });
+	std::string received;
+	bool ok = kernel->ReceiveString(&received);
+	writer.join();
+
+	no_agent_assertTrue(sent && ok);
+	no_agent_assertTrue_msg("Large message to the kernel was corrupted", received == toKernel);
+
+	writer = std::thread([&]() { sent = kernel->SendString(toClient.c_str()); });
+	ok = client->ReceiveString(&received);
+	writer.join();
+
+	no_agent_assertTrue(sent && ok);
+	no_agent_assertTrue_msg("Large message to the client was corrupted", received == toClient);
+}
+
+void SharedMemoryTests::testPeerClose()
+{
+	createPair();
+
+	kernel->Close();
+
+	// The reader notices when it next checks the socket, which it does
+	// at least once a second while it's waiting.
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::string received;
+	bool ok = client->ReceiveString(&received);
+	double elapsed = millisecondsSince(start);
+
+	no_agent_assertTrue_msg("Received a message after the kernel closed", !ok);
+	no_agent_assertTrue_msg("Took " + std::to_string(elapsed) + "ms to notice the kernel had closed", elapsed < 2500);
+	no_agent_assertTrue(!client->IsAlive());
+	no_agent_assertTrue_msg("Sent a message after the kernel closed", !client->SendString("nobody there"));
+}
+
+void SharedMemoryTests::testPeerCrash()
+{
+	no_agent_assertTrue(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == 0);
+
+	client = sock::SharedMemory::CreateSegment();
+	no_agent_assertTrue(client != nullptr);
+	client->Attach(new TestSocket(sockets[0]));
+	sockets[0] = -1;
+
+	// The "kernel" is another process, which dies part way through
+	// sending a message twice the size of the ring.
+	pid_t child = fork();
+	no_agent_assertTrue(child != -1);
+
+	if (child == 0)
+	{
+		sock::SharedMemory* pKernel = sock::SharedMemory::OpenSegment(client->GetSegmentName());
+		if (pKernel)
+		{
+			pKernel->Attach(new TestSocket(sockets[1]));
+			pKernel->SendString(bigMessage(2 << 20, 4).c_str());
+		}
+		_exit(0);
+	}
+
+	close(sockets[1]);
+	sockets[1] = -1;
+
+	// Wait for the child to fill the ring
+	bool started = false;
+	for (int i = 0; i < 10 && !started; i++)
+	{
+		started = client->IsReadDataAvailable(0, 500);
+	}
+	client->UnlinkSegment();
+
+	kill(child, SIGKILL);
+	int status;
+	waitpid(child, &status, 0);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::string received;
+	bool ok = client->ReceiveString(&received);
+	double elapsed = millisecondsSince(start);
+
+	no_agent_assertTrue_msg("The other process never started sending", started);
+	no_agent_assertTrue_msg("Received a message the other process never finished", !ok);
+	no_agent_assertTrue_msg("Took " + std::to_string(elapsed) + "ms to notice the other process had gone", elapsed < 2500);
+	no_agent_assertTrue(!client->IsAlive());
+}
+
+void SharedMemoryTests::testFutexWake()
+{
+	createPair();
+
+	// The reader gives up spinning and sleeps long before the message arrives,
+	// so it's only woken promptly if the writer wakes it (rather than it
+	// waking up by itself to check the socket a second later).
+	std::chrono::steady_clock::time_point sentAt, receivedAt;
+	std::string received;
+	bool ok = false;
+	std::thread reader([&]()
+	{
+		ok = kernel->ReceiveString(&received);
+		receivedAt = std::chrono::steady_clock::now();
+	});
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(300));
+	sentAt = std::chrono::steady_clock::now();
+	bool sent = client->SendString("wake up");
+	reader.join();
+
+	double latency = std::chrono::duration<double, std::milli>(receivedAt - sentAt).count();
+
+	no_agent_assertTrue(sent && ok);
+	no_agent_assertTrue_msg(received, received == "wake up");
+	no_agent_assertTrue_msg("Took " + std::to_string(latency) + "ms to wake the reader", latency < 250);
+}
+
+void SharedMemoryTests::testSocketWakeup()
+{
+	createPair();
+
+	// A reader that isn't waiting in the ring (e.g. a client's event thread)
+	// waits on the socket instead, and gets a byte sent down it.
+	no_agent_assertTrue(!client->IsReadDataAvailable());
+	no_agent_assertTrue(kernel->SendString("event"));
+
+	pollfd waiting = { client->GetReadDescriptor(), POLLIN, 0 };
+	no_agent_assertTrue_msg("The socket wasn't woken", poll(&waiting, 1, 1000) == 1);
+
+	std::string received;
+	no_agent_assertTrue(client->IsReadDataAvailable());
+	no_agent_assertTrue(client->ReceiveString(&received));
+	no_agent_assertTrue_msg(received, received == "event");
+
+	// Having drained the wake up, the socket's quiet again
+	no_agent_assertTrue(!client->IsReadDataAvailable());
+	waiting.revents = 0;
+	no_agent_assertTrue(poll(&waiting, 1, 0) == 0);
+}
+
+#endif // ENABLE_SHARED_MEMORY
@@ -0,0 +1,68 @@
+//
+//  SharedMemoryTests.hpp
+//
+//  Tests for passing messages between a client and the kernel through
+//  shared memory (see sock_SharedMemory.h), rather than over a socket.
+//
+
+#ifndef SharedMemoryTests_cpp
+#define SharedMemoryTests_cpp
+
+#include "portability.h"
+
+#ifdef ENABLE_SHARED_MEMORY
+
+#include "TestCategory.hpp"
+
+namespace sock
+{
+	class SharedMemory;
+}
+
+class SharedMemoryTests : public TestCategory
+{
+public:
+	TEST_CATEGORY(SharedMemoryTests);
+
+	void before() { setUp(); }
+	void setUp();
+
+	void after(bool caught) { tearDown(caught); }
+	void tearDown(bool caught);
+
+	TEST(testOpenFailure, -1);
+	void testOpenFailure();
+
+	TEST(testLocalConnection, -1);
+	void testLocalConnection();
+
+	TEST(testRoundTrip, -1);
+	void testRoundTrip();
+
+	TEST(testLargeMessage, -1);
+	void testLargeMessage();
+
+	TEST(testPeerClose, -1);
+	void testPeerClose();
+
+	TEST(testPeerCrash, -1);
+	void testPeerCrash();
+
+	TEST(testFutexWake, -1);
+	void testFutexWake();
+
+	TEST(testSocketWakeup, -1);
+	void testSocketWakeup();
+
+private:
+	// A connected pair of segments, as the client and kernel would have once they've switched
+	void createPair();
+
+	int sockets[2];
+	sock::SharedMemory* client;
+	sock::SharedMemory* kernel;
+};
+
+#endif // ENABLE_SHARED_MEMORY
+
+#endif /* SharedMemoryTests_cpp */
@@ -32,8 +32,10 @@
 #include "FullTestsRemote.hpp"
 #include "FunctionalTests.hpp"
 #include "IOTests.hpp"
+#include "MessageWaiterTests.hpp"
 #include "MiscTests.hpp"
 #include "MultiAgentTest.hpp"
+#include "SharedMemoryTests.hpp"
 #include "SimpleListener.hpp"
 #include "SMemFunctionalTests.hpp"
 #include "TokenizerTest.hpp"
@@ -201,8 +203,14 @@ int main(int argc, char** argv)
     //	TEST_DECLARATION(FullTestsRemote);
     TEST_DECLARATION(FunctionalTests);
     TEST_DECLARATION(IOTests);
+#ifndef _WIN32
+    TEST_DECLARATION(MessageWaiterTests);
+#endif
     TEST_DECLARATION(MiscTests);
     TEST_DECLARATION(MultiAgentTest);
+#ifdef ENABLE_SHARED_MEMORY
+    TEST_DECLARATION(SharedMemoryTests);
+#endif
     TEST_DECLARATION(SMemFunctionalTests);
     TEST_DECLARATION(TokenizerTest);
     TEST_DECLARATION(WmaFunctionalTests);